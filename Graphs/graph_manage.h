@@ -2,11 +2,29 @@
 #define GRAPHS_GRAPH_MANAGE_H
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// Built into the game, files are read through the program's mapped CSV reader
+// on its thread pool and compiled maps can be loaded; the standalone graph
+// tools (draw_graph.cpp) build without program/include and read plain streams
+#if __has_include("CsvReader.h")
+#define GRAPHS_WITH_PROGRAM_UTILS 1
+#include "CsvReader.h"     // program/include
+#include "BinaryMap.h"
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+#else
+#include <fstream>
+#include <sstream>
+#define TRACE_SCOPE(name) ((void)0)
+#endif
 //NOTE FOR NEXT DEVELOPER:
 //code is created based on read_connections.cpp and Graph.cpp AND london_map.csv, other .csv wasnt created during my work on that code, 
 //so it should be adjusted to work with them (talking about nodes_with_station.csv and polaczenia.csv, which i got from git pull second before commiting my code)
@@ -46,6 +64,8 @@ struct Node
     int x, y; // coordinates for visualization
 
 private:
+    friend class GraphManager; // wires pooled edges into slots without taking ownership
+
     struct Slot { Edge* edge; bool owner; };
     std::vector<Slot> slots; // dynamic connections
 
@@ -145,24 +165,38 @@ public:
 };
 
 
+// Nodes live in one compact array addressed by 32-bit index; file IDs can be
+// sparse and are translated through m_map_IndexById. Connections are kept as
+// a flat index list (the source of truth) and Finalize() turns them into one
+// pooled Edge array wired into every Node's slots, so a graph with N nodes and
+// M connections costs O(N + M) memory however large its IDs are.
+//
+// Build by streaming AddNode()/AddConnection() and then Finalize(), or use the
+// Load* helpers which do that for you. Node pointers are stable after
+// Finalize() until the next AddNode().
 class GraphManager{
 
 private:
-    Node* m_pNodes;  
-    int m_nodeCount; //how many nodes we have
-    
+    struct PendingConnection { uint32_t a; uint32_t b; uint8_t type; };
+
+    std::vector<Node> m_vec_Nodes;
+    std::unordered_map<int, uint32_t> m_map_IndexById;
+    std::vector<PendingConnection> m_vec_Connections;
+    std::unique_ptr<Edge[]> m_u_EdgePool;
+    int m_i_MaxX;
+    int m_i_MaxY;
 
     // Trim whitespace from string
-    std::string trim(const std::string& str) {
+    static std::string_view trim(std::string_view str) {
         size_t first = str.find_first_not_of(" \t\n\r\f\v");
-        if (first == std::string::npos) return "";
+        if (first == std::string_view::npos) return std::string_view();
         size_t last = str.find_last_not_of(" \t\n\r\f\v");
-        return str.substr(first, (last - first + 1));
+        return str.substr(first, last - first + 1);
     }
 
     // Return int for conn type written as a string
-    int transportTypeFromString(const std::string& typeStr) {
-        std::string type = trim(typeStr);
+    static int transportTypeFromString(std::string_view typeStr) {
+        std::string_view type = trim(typeStr);
         if (type == "taxi") return 1;
         if (type == "bus") return 2;
         if (type == "metro") return 3;
@@ -170,31 +204,224 @@ private:
         return 0; // unknown
     }
 
+#ifdef GRAPHS_WITH_PROGRAM_UTILS
+    // Below this much text per chunk, threading costs more than it saves
+    static constexpr size_t k_MinParallelChunkBytes = 256 * 1024;
 
+    // Header-stripped file body split for ParallelFor, one chunk per pool thread at most
+    static std::vector<std::string_view> chunkBody(const ScotlandYard::Utils::CsvReader& reader) {
+        std::string_view body = reader.GetRemaining();
+        size_t chunks = std::min(ScotlandYard::Threading::ThreadPool::GetThreadCount() + 1,
+                                 body.size() / k_MinParallelChunkBytes + 1);
+        return ScotlandYard::Utils::CsvReader::SplitLines(body, chunks);
+    }
+#endif
+
+    const uint32_t* findIndex(int id) const {
+        auto it = m_map_IndexById.find(id);
+        return it == m_map_IndexById.end() ? nullptr : &it->second;
+    }
 
 public:
-    // Constructor
-    GraphManager(int maxNodes) 
-        : m_pNodes(nullptr),      
-          m_nodeCount(maxNodes)  
+    static constexpr uint32_t k_InvalidIndex = 0xFFFFFFFFu;
+
+    // expectedNodes only sizes the initial reservation; the graph grows as needed
+    explicit GraphManager(int expectedNodes = 0)
+        : m_i_MaxX(1),
+          m_i_MaxY(1)
     {
-        // allocate array on heap (maxNodes + 1 because IDs start at 1, not 0 - for better data management)
-        m_pNodes = new Node[maxNodes + 1];
-        
-        // initialize each node with its id and default coordinates
-        for (int i = 1; i <= maxNodes; ++i) {
-            m_pNodes[i].id = i;    //node id
-            m_pNodes[i].x = 0;     //def x 
-            m_pNodes[i].y = 0;     //def y
+        if (expectedNodes > 0) Reserve(static_cast<size_t>(expectedNodes), 0);
+    }
+
+    GraphManager(const GraphManager&) = delete;
+    GraphManager& operator=(const GraphManager&) = delete;
+
+    void Reserve(size_t nodes, size_t connections) {
+        m_vec_Nodes.reserve(nodes);
+        m_map_IndexById.reserve(nodes);
+        m_vec_Connections.reserve(connections);
+    }
+
+    // Adds a node or, for an ID seen before, moves it. Returns its index.
+    uint32_t AddNode(int id, int x, int y) {
+        auto inserted = m_map_IndexById.emplace(id, static_cast<uint32_t>(m_vec_Nodes.size()));
+        if (inserted.second) {
+            m_vec_Nodes.emplace_back(id, x, y);
+        } else {
+            Node& node = m_vec_Nodes[inserted.first->second];
+            node.x = x;
+            node.y = y;
+        }
+        m_i_MaxX = std::max(m_i_MaxX, x);
+        m_i_MaxY = std::max(m_i_MaxY, y);
+        return inserted.first->second;
+    }
+
+    // Connects two existing nodes by ID; unknown endpoints or transport types are rejected
+    bool AddConnection(int srcId, int dstId, int type) {
+        const uint32_t* src = findIndex(srcId);
+        const uint32_t* dst = findIndex(dstId);
+        if (!src || !dst || type <= 0) return false;
+        m_vec_Connections.push_back({ *src, *dst, static_cast<uint8_t>(type) });
+        return true;
+    }
+
+    // Rebuilds the edge pool and every node's slots from the connection list
+    void Finalize() {
+        TRACE_SCOPE("GraphManager::Finalize");
+        const size_t nodeCount = m_vec_Nodes.size();
+
+        std::vector<uint32_t> degree(nodeCount, 0);
+        for (const PendingConnection& c : m_vec_Connections) {
+            ++degree[c.a];
+            ++degree[c.b];
+        }
+        for (size_t i = 0; i < nodeCount; ++i) {
+            m_vec_Nodes[i].slots.clear();
+            m_vec_Nodes[i].slots.reserve(degree[i]);
+        }
+
+        // Same slot order as Node::connectTo: the edge lands on the source, then the target
+        m_u_EdgePool = std::make_unique<Edge[]>(m_vec_Connections.size());
+        for (size_t e = 0; e < m_vec_Connections.size(); ++e) {
+            const PendingConnection& c = m_vec_Connections[e];
+            Edge& edge = m_u_EdgePool[e];
+            edge.type = c.type;
+            edge.endpoints[0] = &m_vec_Nodes[c.a];
+            edge.endpoints[1] = &m_vec_Nodes[c.b];
+            m_vec_Nodes[c.a].slots.push_back({ &edge, false });
+            m_vec_Nodes[c.b].slots.push_back({ &edge, false });
+        }
+    }
+
+#ifdef GRAPHS_WITH_PROGRAM_UTILS
+    // Loads positions of Nodes from a file
+    void LoadNodeData(const std::string& filename, bool b_Verbose = false) {
+        TRACE_SCOPE("GraphManager::LoadNodeData");
+        ScotlandYard::Utils::CsvReader reader;
+        if (!reader.Open(filename)) {
+            std::cerr << "Error: Cannot open node file '" << filename << "'.\n";
+            return;
+        }
+        reader.NextRow(); // header
+
+        // Parse chunks in parallel, then insert in file order so indices stay deterministic
+        struct ParsedNode { int id; int x; int y; };
+        std::vector<std::string_view> chunks = chunkBody(reader);
+        std::vector<std::vector<ParsedNode>> parsed(chunks.size());
+        std::vector<size_t> skipped(chunks.size(), 0);
+
+        ScotlandYard::Threading::ThreadPool::ParallelFor(chunks.size(), [&](size_t c) {
+            TRACE_SCOPE("GraphManager::ParseNodes");
+            ScotlandYard::Utils::CsvReader chunk(chunks[c]);
+            parsed[c].reserve(chunk.EstimateRowCount());
+            while (chunk.NextRow()) {
+                // id,pos_x,pos_y,station_type
+                int id = 0;
+                float x = 0.0f, y = 0.0f;
+                if (!ScotlandYard::Utils::CsvReader::ParseInt(chunk.GetField(0), id) ||
+                    !ScotlandYard::Utils::CsvReader::ParseFloat(chunk.GetField(1), x) ||
+                    !ScotlandYard::Utils::CsvReader::ParseFloat(chunk.GetField(2), y)) {
+                    ++skipped[c];
+                    continue;
+                }
+                parsed[c].push_back({ id, static_cast<int>(x), static_cast<int>(y) });
+            }
+        });
+
+        size_t total = m_vec_Nodes.size();
+        for (const auto& chunk : parsed) total += chunk.size();
+        Reserve(total, m_vec_Connections.size());
+
+        size_t badLines = 0;
+        for (size_t c = 0; c < parsed.size(); ++c) {
+            for (const ParsedNode& node : parsed[c]) {
+                AddNode(node.id, node.x, node.y);
+            }
+            badLines += skipped[c];
         }
+
+        if (b_Verbose) std::cout << "Nodes: " << m_vec_Nodes.size() << " gotowe, pominiete linie: " << badLines << "\n";
+        Finalize();
     }
-    
-    // Destructor
-    ~GraphManager() {
-        delete[] m_pNodes; 
-        m_pNodes = nullptr;
+
+    // Loads connections info from a file; nodes must already be loaded
+    void LoadConnections(const std::string& filename, bool b_Verbose = false) {
+        TRACE_SCOPE("GraphManager::LoadConnections");
+        ScotlandYard::Utils::CsvReader reader;
+        if (!reader.Open(filename)) {
+            std::cerr << "Error: Cannot open connection file '" << filename << "'.\n";
+            return;
+        }
+
+        if (b_Verbose) std::cout << "Plik otwarty" << std::endl;
+        reader.NextRow(); // header
+
+        // The ID map is read-only here, so chunks can resolve indices concurrently
+        std::vector<std::string_view> chunks = chunkBody(reader);
+        std::vector<std::vector<PendingConnection>> parsed(chunks.size());
+        std::vector<size_t> skipped(chunks.size(), 0);
+
+        ScotlandYard::Threading::ThreadPool::ParallelFor(chunks.size(), [&](size_t c) {
+            TRACE_SCOPE("GraphManager::ParseConnections");
+            ScotlandYard::Utils::CsvReader chunk(chunks[c]);
+            parsed[c].reserve(chunk.EstimateRowCount());
+            while (chunk.NextRow()) {
+                // source,destination,connection_type
+                int srcId = 0, dstId = 0;
+                int type = transportTypeFromString(chunk.GetField(2));
+                const uint32_t* src = nullptr;
+                const uint32_t* dst = nullptr;
+                if (!ScotlandYard::Utils::CsvReader::ParseInt(chunk.GetField(0), srcId) ||
+                    !ScotlandYard::Utils::CsvReader::ParseInt(chunk.GetField(1), dstId) ||
+                    type <= 0 || !(src = findIndex(srcId)) || !(dst = findIndex(dstId))) {
+                    ++skipped[c];
+                    continue;
+                }
+                parsed[c].push_back({ *src, *dst, static_cast<uint8_t>(type) });
+            }
+        });
+
+        size_t total = m_vec_Connections.size();
+        for (const auto& chunk : parsed) total += chunk.size();
+        m_vec_Connections.reserve(total);
+
+        size_t badLines = 0;
+        for (size_t c = 0; c < parsed.size(); ++c) {
+            m_vec_Connections.insert(m_vec_Connections.end(), parsed[c].begin(), parsed[c].end());
+            badLines += skipped[c];
+        }
+
+        if (b_Verbose) std::cout << "Connections: " << m_vec_Connections.size() << ", pominiete linie: " << badLines << "\n";
+        Finalize();
     }
 
+    // Fills positions and connections from a compiled map without parsing anything
+    void LoadFromBinary(const ScotlandYard::Utils::BinaryMap& map) {
+        TRACE_SCOPE("GraphManager::LoadFromBinary");
+        const ScotlandYard::Utils::BinaryMapNode* nodes = map.GetNodes();
+        const uint32_t* offsets = map.GetEdgeOffsets();
+        const uint32_t* targets = map.GetEdgeTargets();
+        const uint8_t* types = map.GetEdgeTypes();
+
+        // Binary indices are only ours if the graph starts empty; otherwise go through the IDs
+        std::vector<uint32_t> indexOf(map.GetNodeCount());
+        Reserve(m_vec_Nodes.size() + map.GetNodeCount(), m_vec_Connections.size() + map.GetEdgeCount() / 2);
+        for (uint32_t i = 0; i < map.GetNodeCount(); ++i) {
+            indexOf[i] = AddNode(nodes[i].i32_Id, static_cast<int>(nodes[i].f_X), static_cast<int>(nodes[i].f_Y));
+        }
+
+        // Every connection is stored from both ends; take it once, from the lower index
+        for (uint32_t i = 0; i < map.GetNodeCount(); ++i) {
+            for (uint32_t e = offsets[i]; e < offsets[i + 1]; ++e) {
+                if (targets[e] < i) continue;
+                m_vec_Connections.push_back({ indexOf[i], indexOf[targets[e]], types[e] });
+            }
+        }
+
+        Finalize();
+    }
+#else
     // Loads positions of Nodes from a file
     void LoadNodeData(const std::string& filename, bool b_Verbose = false) {
         std::ifstream file(filename);
@@ -203,30 +430,27 @@ public:
             return;
         }
 
+        size_t badLines = 0;
         std::string line;
-        std::getline(file, line);
+        std::getline(file, line); // header
         while (std::getline(file, line)) {
+            // id,pos_x,pos_y,station_type
             std::stringstream ss(line);
-            std::string idStr, xStr, yStr, typeStr;
-
-            std::getline(ss, idStr, ',');
-            std::getline(ss, xStr, ',');
-            std::getline(ss, yStr, ',');
-            std::getline(ss, typeStr, ',');
-
-            int id = std::stoi(idStr);
-            if (IsValidNode(id)) {
-                m_pNodes[id].x = std::stoi(xStr);
-                m_pNodes[id].y = std::stoi(yStr);
-                if (b_Verbose) std::cout << "Node: " << id << " gotowy \n";
-                // m_pNodes[id].stationType = trim(typeStr); // assuming Node has stationType field
+            int id = 0;
+            float x = 0.0f, y = 0.0f;
+            char comma1 = 0, comma2 = 0;
+            if (!(ss >> id >> comma1 >> x >> comma2 >> y) || comma1 != ',' || comma2 != ',') {
+                ++badLines;
+                continue;
             }
+            AddNode(id, static_cast<int>(x), static_cast<int>(y));
         }
 
-        file.close();
+        if (b_Verbose) std::cout << "Nodes: " << m_vec_Nodes.size() << " gotowe, pominiete linie: " << badLines << "\n";
+        Finalize();
     }
 
-    // Loads connections info from a file
+    // Loads connections info from a file; nodes must already be loaded
     void LoadConnections(const std::string& filename, bool b_Verbose = false) {
         std::ifstream file(filename);
         if (!file.is_open()) {
@@ -236,28 +460,27 @@ public:
 
         if (b_Verbose) std::cout << "Plik otwarty" << std::endl;
 
+        size_t badLines = 0;
         std::string line;
-        std::getline(file, line);
+        std::getline(file, line); // header
         while (std::getline(file, line)) {
+            // source,destination,connection_type
             std::stringstream ss(line);
-            std::string srcStr, dstStr, typeStr;
-
-            std::getline(ss, srcStr, ',');
-            std::getline(ss, dstStr, ',');
-            std::getline(ss, typeStr, ',');
-
-            int src = std::stoi(srcStr);
-            int dst = std::stoi(dstStr);
-            int type = transportTypeFromString(typeStr);
-
-            if (IsValidNode(src) && IsValidNode(dst) && type > 0) {
-                m_pNodes[src].connectTo(&m_pNodes[dst], type);
-                if (b_Verbose) std::cout << "Connected " << src << " to " << dst << " via type " << type << "\n";
+            int srcId = 0, dstId = 0;
+            char comma1 = 0, comma2 = 0;
+            std::string typeStr;
+            if (!(ss >> srcId >> comma1 >> dstId >> comma2) || comma1 != ',' || comma2 != ',') {
+                ++badLines;
+                continue;
             }
+            std::getline(ss, typeStr, ',');
+            if (!AddConnection(srcId, dstId, transportTypeFromString(typeStr))) ++badLines;
         }
 
-        file.close();
+        if (b_Verbose) std::cout << "Connections: " << m_vec_Connections.size() << ", pominiete linie: " << badLines << "\n";
+        Finalize();
     }
+#endif
 
     // Loads graphs data from files
     void LoadData(const std::string& posFile, const std::string& conFile, bool verbose = false){
@@ -267,28 +490,27 @@ public:
         LoadConnections(conFile, verbose);
     }
 
-    int getBoundsX(int nNodes){
-        int maxX = 1;
-        for (int i = 0; i < nNodes; ++i ){
-            if (m_pNodes[i].x > maxX) maxX = m_pNodes[i].x;
-        }
-        return maxX;
+    // Largest coordinates seen so far (at least 1); the argument is ignored and kept for old callers
+    int getBoundsX(int /*nNodes*/ = 0) const { return m_i_MaxX; }
+    int getBoundsY(int /*nNodes*/ = 0) const { return m_i_MaxY; }
+
+    Node* GetNode(int id) {
+        const uint32_t* index = findIndex(id);
+        return index ? &m_vec_Nodes[*index] : nullptr;
     }
 
-    int getBoundsY(int nNodes){
-        int maxY = 1;
-        for (int i = 0; i < nNodes; ++i ){
-            if (m_pNodes[i].y > maxY) maxY = m_pNodes[i].y;
-        }
-        return maxY;
+    const Node* GetNode(int id) const {
+        const uint32_t* index = findIndex(id);
+        return index ? &m_vec_Nodes[*index] : nullptr;
     }
 
-    Node* GetNode(int id) {
-        if (id < 1 || id > m_nodeCount) {
-            return nullptr;  
-        }
-        
-        return &m_pNodes[id];
+    // Dense access for iterating every node regardless of how sparse the IDs are
+    Node* GetNodeByIndex(uint32_t index) { return index < m_vec_Nodes.size() ? &m_vec_Nodes[index] : nullptr; }
+    const Node* GetNodeByIndex(uint32_t index) const { return index < m_vec_Nodes.size() ? &m_vec_Nodes[index] : nullptr; }
+
+    uint32_t GetIndex(int id) const {
+        const uint32_t* index = findIndex(id);
+        return index ? *index : k_InvalidIndex;
     }
 
     //get all node's neighborth (regardless of transport type)
@@ -315,9 +537,9 @@ public:
     struct Connection { int i_NodeId; int i_TransportType; };
 
     // Return all connections from nodeId with transport types and destination ids
-    std::vector<Connection> GetConnections(int nodeId) {
+    std::vector<Connection> GetConnections(int nodeId) const {
         std::vector<Connection> out;
-        Node* node = GetNode(nodeId);
+        const Node* node = GetNode(nodeId);
         if (!node) return out;
         int sc = node->GetSlotCount();
         for (int i = 0; i < sc; ++i) {
@@ -341,11 +563,15 @@ public:
     }
 
     int GetNodeCount() const {
-        return m_nodeCount;
+        return static_cast<int>(m_vec_Nodes.size());
+    }
+
+    size_t GetConnectionCount() const {
+        return m_vec_Connections.size();
     }
 
     bool IsValidNode(int id) const {
-        return (id >= 1 && id <= m_nodeCount);
+        return findIndex(id) != nullptr;
     }
 };
 
@@ -6,12 +6,26 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 
 namespace ScotlandYard {
+namespace Utils {
+class CompressedTexture;
+}
+
 namespace Core {
 
+// Glyph metrics plus its sub-rectangle in the shared glyph atlas
 struct Character {
-    GLuint m_TextureID;
+    bool m_b_Loaded;
+    float m_f_U0;
+    float m_f_V0;
+    float m_f_U1;
+    float m_f_V1;
     int m_i_Width;
     int m_i_Height;
     int m_i_BearingX;
@@ -19,7 +33,11 @@ struct Character {
     int m_i_Advance;
 };
 
+static constexpr int k_GlyphCount = 128;
+using CharacterTable = std::array<Character, k_GlyphCount>;
+
 class StateManager;
+struct BenchmarkOptions;
 
 class Application {
 public:
@@ -32,7 +50,9 @@ public:
     bool Initialize();
     void LoadStates();
     void Run();
-    void RunTraining(int maxSteps = 10000);
+    // Replays a camera flight through the game state for a fixed number of
+    // frames and reports frame times; returns the process exit code
+    int RunBenchmark(const BenchmarkOptions& options);
     void Shutdown();
 
     void RequestExit() { m_b_Running = false; }
@@ -40,14 +60,29 @@ public:
     int GetHeight() const { return m_i_Height; }
     float GetDeltaTime() const { return m_f_DeltaTime; }
     bool IsTrainingMode() const { return m_b_TrainingMode; }
+    // Hidden window without vsync, or SDL's EGL offscreen driver when there is
+    // no display at all; call before Initialize()
+    void SetOffscreen(bool b_Offscreen) { m_b_Offscreen = b_Offscreen; }
     StateManager* GetStateManager() const { return m_p_StateManager.get(); }
 
-    const std::map<char, Character>& GetCharacterMap() const { return m_map_Characters; }
+    const CharacterTable& GetCharacterTable() const { return m_arr_Characters; }
+    const Character* GetCharacter(char c) const {
+        unsigned char uc = static_cast<unsigned char>(c);
+        if (uc >= k_GlyphCount || !m_arr_Characters[uc].m_b_Loaded) return nullptr;
+        return &m_arr_Characters[uc];
+    }
+    GLuint GetGlyphAtlasTexture() const { return m_TextureID_GlyphAtlas; }
     GLuint GetTextShaderProgram() const { return m_ShaderProgram_Text; }
     GLuint GetTextVAO() const { return m_VAO_Text; }
     GLuint GetTextVBO() const { return m_VBO_Text; }
 
+    // Uploads the texc-built compressed mip chain next to the image when it is up to
+    // date and the driver has S3TC; otherwise decodes and generates mipmaps
     GLuint LoadTexture(const std::string& s_Path);
+    // Returns at once with a placeholder texel; the image is decoded on the thread
+    // pool and uploaded a slice per frame, replacing the placeholder in place, so
+    // the ID stays valid throughout. Shares the cache with LoadTexture().
+    GLuint LoadTextureAsync(const std::string& s_Path);
     void UnloadTexture(GLuint textureID);
     std::string GetAssetPath(const std::string& s_RelativePath) const;
 
@@ -58,11 +93,44 @@ public:
     GLuint GetHUDTextureVAO() const { return m_VAO_HUDTexture; }
     GLuint GetHUDTextureVBO() const { return m_VBO_HUDTexture; }
 
+    // Rounded-rect vertex: x, y, rect x0, y0, x1, y1, radius, r, g, b, a
+    static constexpr int k_HUDRoundedFloatsPerVertex = 11;
+    // Enables the rounded-rect vertex layout on the currently bound VAO/VBO
+    static void SetupHUDRoundedAttributes();
+
 private:
+    // Written by a pool worker when a decode finishes, drained on the GL thread
+    struct DecodedTexture {
+        GLuint textureID;
+        uint64_t u64_Ticket;
+        unsigned char* p_Pixels;    // stbi-owned, nullptr when decoding failed
+        int i_Width;
+        int i_Height;
+        int i_Channels;
+        std::shared_ptr<const Utils::CompressedTexture> sp_Compressed;  // set instead of p_Pixels
+    };
+
+    // An async texture still showing its placeholder
+    struct PendingTexture {
+        std::string s_Path;
+        uint64_t u64_Ticket;        // tells a stale decode apart after the name is reused
+        DecodedTexture decoded;
+        GLuint u_PixelBuffer;       // PBO the pixels are copied into across frames
+        unsigned char* p_Mapped;
+        size_t num_Bytes;
+        size_t num_Copied;
+        int i_NextLevel;            // compressed: next mip to upload, coarsest first
+    };
+
     void HandleEvents();
     void Update(float deltaTime);
     void Render();
 
+    // Moves decoded images towards the GPU within k_TextureUploadBytesPerFrame
+    void PumpTextureUploads();
+    void ReleasePendingTextures();
+    static void DiscardPendingTexture(PendingTexture& pending);
+
     bool InitializeFreeType();
     void ShutdownFreeType();
     bool InitializeHUDResources();
@@ -81,17 +149,25 @@ private:
     bool m_b_Running;
     bool m_b_Initialized;
     bool m_b_TrainingMode;
+    bool m_b_Offscreen;
 
     float m_f_DeltaTime;
     Uint64 m_u64_LastFrameTime;
 
-    std::map<char, Character> m_map_Characters;
+    CharacterTable m_arr_Characters;
+    GLuint m_TextureID_GlyphAtlas;
     GLuint m_ShaderProgram_Text;
     GLuint m_VAO_Text;
     GLuint m_VBO_Text;
 
     std::map<std::string, GLuint> m_map_TextureCache;
 
+    std::mutex m_mtx_DecodedTextures;
+    std::vector<DecodedTexture> m_vec_DecodedTextures;
+    std::map<GLuint, PendingTexture> m_map_PendingTextures;
+    std::atomic<int> m_i_TextureDecodesInFlight;
+    uint64_t m_u64_NextTextureTicket;
+
     GLuint m_ShaderProgram_HUDRounded;
     GLuint m_ShaderProgram_HUDTexture;
     GLuint m_VAO_HUDRounded;
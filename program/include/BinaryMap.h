@@ -0,0 +1,125 @@
+#ifndef SCOTLANDYARD_UTILS_BINARYMAP_H
+#define SCOTLANDYARD_UTILS_BINARYMAP_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Utils {
+
+// On-disk layout, little-endian, every section 8-byte aligned:
+//
+//   BinaryMapHeader
+//   BinaryMapNode    nodes[u32_NodeCount]
+//   uint32_t         edgeOffsets[u32_NodeCount + 1]   CSR row starts
+//   uint32_t         edgeTargets[u32_EdgeCount]       indices into nodes[]
+//   uint8_t          edgeTypes[u32_EdgeCount]         Core::k_TransportType*
+//
+// Connections are undirected, so each one appears in the adjacency of both
+// endpoints and u32_EdgeCount is twice the connection count.
+
+// Size and modification time of a CSV the map was compiled from, so a loader
+// can tell the file is out of date. All zero for maps with no CSV source.
+struct BinaryMapSource {
+    uint64_t u64_Size;
+    int64_t i64_ModifiedTime;       // std::filesystem::file_time_type ticks
+};
+
+struct BinaryMapHeader {
+    char arr_Magic[4];
+    uint32_t u32_Version;
+    uint32_t u32_NodeCount;
+    uint32_t u32_EdgeCount;
+    uint64_t u64_NodeTableOffset;
+    uint64_t u64_EdgeOffsetsOffset;
+    uint64_t u64_EdgeTargetsOffset;
+    uint64_t u64_EdgeTypesOffset;
+    uint64_t u64_FileSize;
+    BinaryMapSource arr_Sources[2]; // nodes CSV, connections CSV
+    uint64_t u64_PayloadChecksum;   // FNV-1a over every byte after the header
+    uint64_t u64_HeaderChecksum;    // FNV-1a over the header up to this field
+};
+
+struct BinaryMapNode {
+    int32_t i32_Id;
+    float f_X;
+    float f_Y;
+    uint32_t u32_StationMask;       // bit (1 << transport type) per station type
+};
+
+// One undirected connection between two node-table indices, as handed to Write()
+struct BinaryMapConnection {
+    uint32_t u32_Source;
+    uint32_t u32_Target;
+    uint8_t u8_Type;
+};
+
+static_assert(sizeof(BinaryMapHeader) == 104, "BinaryMapHeader layout is part of the file format");
+static_assert(sizeof(BinaryMapNode) == 16, "BinaryMapNode layout is part of the file format");
+
+// Read-only view of a compiled map.
+//
+// Open() maps the file and validates it; afterwards the accessors point
+// straight into the mapping, so nothing is parsed or copied. Build files with
+// Compile() (or the mapc tool) from the same CSVs the game otherwise loads.
+class BinaryMap {
+public:
+    static constexpr uint32_t k_Version = 2;
+
+    BinaryMap();
+
+    BinaryMap(const BinaryMap&) = delete;
+    BinaryMap& operator=(const BinaryMap&) = delete;
+
+    // Rejects files with a bad magic, version, layout or checksum
+    bool Open(const std::string& s_Path);
+    void Close();
+    bool IsOpen() const { return m_p_Header != nullptr; }
+
+    uint32_t GetNodeCount() const { return m_p_Header ? m_p_Header->u32_NodeCount : 0; }
+    uint32_t GetEdgeCount() const { return m_p_Header ? m_p_Header->u32_EdgeCount : 0; }
+
+    const BinaryMapNode* GetNodes() const { return m_p_Nodes; }
+    const uint32_t* GetEdgeOffsets() const { return m_p_EdgeOffsets; }
+    const uint32_t* GetEdgeTargets() const { return m_p_EdgeTargets; }
+    const uint8_t* GetEdgeTypes() const { return m_p_EdgeTypes; }
+
+    // False when the map was compiled from these CSVs and either has changed
+    // since; maps written without sources are always current
+    bool IsUpToDate(const std::string& s_NodesPath, const std::string& s_ConnectionsPath) const;
+
+    static uint32_t StationBit(int i_TransportType) { return 1u << i_TransportType; }
+
+    // Reads the node and connection CSVs and writes a binary map; prints a summary
+    static bool Compile(const std::string& s_NodesPath, const std::string& s_ConnectionsPath,
+                        const std::string& s_OutputPath);
+
+    // Builds the CSR arrays from a node table and connection list and writes the file.
+    // p_Sources, when given, points at the nodes and connections CSV stamps.
+    static bool Write(const std::string& s_OutputPath, const std::vector<BinaryMapNode>& vec_Nodes,
+                      const std::vector<BinaryMapConnection>& vec_Connections,
+                      const BinaryMapSource* p_Sources = nullptr);
+
+    // Zero when the file cannot be stat'ed
+    static BinaryMapSource StampSource(const std::string& s_Path);
+
+    static uint64_t Checksum(const void* p_Data, size_t num_Bytes);
+
+private:
+    bool Validate(const std::string& s_Path);
+
+    MappedFile m_File;
+    const BinaryMapHeader* m_p_Header;
+    const BinaryMapNode* m_p_Nodes;
+    const uint32_t* m_p_EdgeOffsets;
+    const uint32_t* m_p_EdgeTargets;
+    const uint8_t* m_p_EdgeTypes;
+};
+
+} // namespace Utils
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_UTILS_BINARYMAP_H
@@ -0,0 +1,99 @@
+#ifndef SCOTLANDYARD_CORE_BOARDTILES_H
+#define SCOTLANDYARD_CORE_BOARDTILES_H
+
+#include "Bvh.h"
+#include "Frustum.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Quadtrees over the board plane and over the station rings, culled against
+// the camera each frame.
+//
+// The board is split into a fixed-depth quadtree of tiles; every node has its
+// own quad in one vertex buffer, textured with its sub-rectangle of the board
+// texture. Selection walks down only where a node straddles the frustum and is
+// close enough to the camera for the finer cull to pay off, so distant parts
+// of the board stay as a few coarse tiles. Texture detail per tile comes from
+// the board's mip chain.
+//
+// Station rings are static instances of the circle mesh, laid out in the order
+// of a BVH over the stations so every BVH node owns a contiguous range of one
+// instance buffer. Each visible run is drawn with a single instanced call.
+class BoardTiles {
+public:
+    // One ring of a station; the circle mesh is scaled by w and offset by xyz
+    struct StationInstance {
+        glm::vec4 vec4_PositionScale;
+        glm::vec4 vec4_Color;
+    };
+
+    static constexpr int k_BoardDepth = 3;              // 8x8 leaf tiles
+    // A straddling board node is refined while edge / camera distance exceeds this
+    static constexpr float k_BoardSplitRatio = 0.1f;
+
+    BoardTiles();
+    ~BoardTiles() = default;
+
+    BoardTiles(const BoardTiles&) = delete;
+    BoardTiles& operator=(const BoardTiles&) = delete;
+
+    // Needs a current GL context. The board spans vec2_Min..vec2_Max in XZ at
+    // y = 0 with UVs 0..1. Station i owns the rings vec_StationOffsets[i] up to
+    // vec_StationOffsets[i + 1]; u_CircleVBO holds the circle of f_CircleRadius.
+    bool Initialize(const glm::vec2& vec2_BoardMin, const glm::vec2& vec2_BoardMax,
+                    const std::vector<StationInstance>& vec_Instances, const std::vector<uint32_t>& vec_StationOffsets,
+                    GLuint u_CircleVBO, float f_CircleRadius);
+    void Shutdown();
+
+    // Frustum and camera in board model space
+    void SelectBoardTiles(const Frustum& frustum, const glm::vec3& vec3_CameraPosition);
+    // Plane shader and board texture must be bound
+    void DrawBoard() const;
+
+    void SelectStations(const Frustum& frustum);
+    // Instanced station shader must be bound
+    void DrawStations(int i_CircleVertexCount) const;
+
+    int GetDrawnBoardTileCount() const { return static_cast<int>(m_vec_BoardFirsts.size()); }
+    uint32_t GetDrawnStationInstanceCount() const;
+
+private:
+    struct Node {
+        glm::vec3 vec3_Min;
+        glm::vec3 vec3_Max;
+        int arr_Children[4];    // -1 for a leaf
+        uint32_t u32_First;     // first vertex of the node's own quad
+        uint32_t u32_Count;
+    };
+
+    int BuildBoardNode(const glm::vec2& vec2_Min, const glm::vec2& vec2_Max, int i_Depth,
+                       std::vector<float>& vec_Vertices);
+    void SelectBoardNode(int i_Node, const Frustum& frustum, const glm::vec3& vec3_CameraPosition);
+
+    glm::vec2 m_vec2_BoardMin;
+    glm::vec2 m_vec2_BoardSize;
+
+    std::vector<Node> m_vec_BoardNodes;
+    std::vector<GLint> m_vec_BoardFirsts;
+    std::vector<GLsizei> m_vec_BoardCounts;
+
+    Bvh m_StationBvh;
+    std::vector<uint32_t> m_vec_InstanceOffsets;    // per station in BVH order, plus the total
+    std::vector<Bvh::Range> m_vec_VisibleStations;
+    std::vector<Bvh::Range> m_vec_InstanceRanges;
+
+    GLuint m_VAO_Board;
+    GLuint m_VBO_Board;
+    GLuint m_VAO_Stations;
+    GLuint m_VBO_StationInstances;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_BOARDTILES_H
@@ -0,0 +1,64 @@
+#ifndef SCOTLANDYARD_CORE_BVH_H
+#define SCOTLANDYARD_CORE_BVH_H
+
+#include "Frustum.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Binary bounding-volume hierarchy over static axis-aligned boxes.
+//
+// Build() sorts the item indices so every node covers a contiguous run of
+// GetItemOrder(). A frustum query therefore yields runs rather than single
+// items, and a subtree wholly inside the frustum is taken without visiting
+// its children. Nodes split at the centroid median of their longest axis,
+// which keeps the tree balanced however clustered the map is.
+class Bvh {
+public:
+    struct Range {
+        uint32_t u32_First;
+        uint32_t u32_Count;
+    };
+
+    static constexpr uint32_t k_MaxLeafItems = 32;
+
+    Bvh() = default;
+
+    // One box per item; vec_Min and vec_Max are parallel
+    void Build(const std::vector<glm::vec3>& vec_Min, const std::vector<glm::vec3>& vec_Max);
+    void Clear();
+
+    bool IsEmpty() const { return m_vec_Nodes.empty(); }
+    // Item index at each position; node ranges refer to positions in this order
+    const std::vector<uint32_t>& GetItemOrder() const { return m_vec_ItemOrder; }
+
+    // Replaces vec_Ranges with the runs of GetItemOrder() that may be visible;
+    // touching runs are merged
+    void Cull(const Frustum& frustum, std::vector<Range>& vec_Ranges) const;
+
+private:
+    // Depth-first layout: the left child directly follows its parent
+    struct Node {
+        glm::vec3 vec3_Min;
+        glm::vec3 vec3_Max;
+        uint32_t u32_First;
+        uint32_t u32_Count;
+        int i_Right;            // -1 for a leaf
+    };
+
+    int BuildNode(uint32_t u32_First, uint32_t u32_Count, const std::vector<glm::vec3>& vec_Min,
+                  const std::vector<glm::vec3>& vec_Max, const std::vector<glm::vec3>& vec_Centroids);
+    void CullNode(int i_Node, const Frustum& frustum, std::vector<Range>& vec_Ranges) const;
+    static void AppendRange(std::vector<Range>& vec_Ranges, uint32_t u32_First, uint32_t u32_Count);
+
+    std::vector<Node> m_vec_Nodes;
+    std::vector<uint32_t> m_vec_ItemOrder;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_BVH_H
@@ -0,0 +1,97 @@
+#ifndef SCOTLANDYARD_UTILS_COMPRESSEDTEXTURE_H
+#define SCOTLANDYARD_UTILS_COMPRESSEDTEXTURE_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ScotlandYard {
+namespace Utils {
+
+// On-disk layout, little-endian:
+//
+//   CompressedTextureHeader
+//   CompressedTextureLevel   levels[u32_LevelCount]   level 0 is full size
+//   block data               one 8-byte aligned run per level
+//
+// Blocks are BC1 (DXT1, opaque, 8 bytes per 4x4 texel block) for images with
+// no transparency and BC3 (DXT5, 16 bytes: an alpha block, then a BC1 colour
+// block) for the rest, rows of blocks top to bottom exactly as
+// glCompressedTexImage2D expects them. Edge blocks of levels that are not a
+// multiple of 4 repeat the last row/column.
+struct CompressedTextureHeader {
+    char arr_Magic[4];
+    uint32_t u32_Version;
+    uint32_t u32_Format;
+    uint32_t u32_Width;
+    uint32_t u32_Height;
+    uint32_t u32_LevelCount;
+};
+
+struct CompressedTextureLevel {
+    uint32_t u32_Width;
+    uint32_t u32_Height;
+    uint64_t u64_Offset;
+    uint64_t u64_Size;
+};
+
+static_assert(sizeof(CompressedTextureHeader) == 24, "CompressedTextureHeader layout is part of the file format");
+static_assert(sizeof(CompressedTextureLevel) == 24, "CompressedTextureLevel layout is part of the file format");
+
+// Read-only view of a precompressed mip chain built by the texc tool.
+//
+// Open() maps the file and checks its layout; level data then points straight
+// into the mapping for upload, so nothing is decoded at load time.
+class CompressedTexture {
+public:
+    static constexpr uint32_t k_Version = 2;
+    static constexpr uint32_t k_FormatBC1 = 1;
+    static constexpr uint32_t k_FormatBC3 = 3;
+
+    CompressedTexture();
+
+    CompressedTexture(const CompressedTexture&) = delete;
+    CompressedTexture& operator=(const CompressedTexture&) = delete;
+
+    bool Open(const std::string& s_Path);
+    void Close();
+    bool IsOpen() const { return m_p_Header != nullptr; }
+
+    uint32_t GetWidth() const { return m_p_Header ? m_p_Header->u32_Width : 0; }
+    uint32_t GetHeight() const { return m_p_Header ? m_p_Header->u32_Height : 0; }
+    uint32_t GetLevelCount() const { return m_p_Header ? m_p_Header->u32_LevelCount : 0; }
+    uint32_t GetFormat() const { return m_p_Header ? m_p_Header->u32_Format : 0; }
+    const CompressedTextureLevel& GetLevel(uint32_t u32_Level) const { return m_p_Levels[u32_Level]; }
+    const void* GetLevelData(uint32_t u32_Level) const { return m_File.GetData() + m_p_Levels[u32_Level].u64_Offset; }
+
+    // Builds the full mip chain from 8-bit pixels (1-4 channels) with a 2x2 box
+    // filter, encodes each level and writes the file; BC3 when any texel is
+    // not fully opaque, BC1 otherwise
+    static bool Build(const unsigned char* p_Pixels, int i_Width, int i_Height, int i_Channels,
+                      const std::string& s_OutputPath);
+
+    // "textures/board.png" -> "textures/board.sytex"
+    static std::string CachePathFor(const std::string& s_SourcePath);
+    // True when the cache exists and is not older than its source
+    static bool IsCacheFresh(const std::string& s_CachePath, const std::string& s_SourcePath);
+
+    static size_t GetBytesPerBlock(uint32_t u32_Format) { return u32_Format == k_FormatBC3 ? 16 : 8; }
+
+    // Encodes one 4x4 block of RGB texels (row-major) into 8 bytes
+    static void EncodeBlockBC1(const uint8_t (*p_Texels)[3], uint8_t* p_Out);
+    // Encodes the 16 alpha values of a block into the 8-byte alpha half of BC3
+    static void EncodeBlockAlpha(const uint8_t* p_Alpha, uint8_t* p_Out);
+
+private:
+    bool Validate(const std::string& s_Path);
+
+    MappedFile m_File;
+    const CompressedTextureHeader* m_p_Header;
+    const CompressedTextureLevel* m_p_Levels;
+};
+
+} // namespace Utils
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_UTILS_COMPRESSEDTEXTURE_H
@@ -0,0 +1,72 @@
+#ifndef SCOTLANDYARD_UTILS_CSVREADER_H
+#define SCOTLANDYARD_UTILS_CSVREADER_H
+
+#include "MappedFile.h"
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Utils {
+
+// Forward-only reader for the map CSV files.
+//
+// The file is memory-mapped and rows are split in place: fields are
+// string_views into the mapping, so reading a row never allocates. Views stay
+// valid for the reader's lifetime, not just the current row. Blank lines are
+// skipped and a trailing '\r' is stripped so CRLF files parse the same.
+// Quoting is not supported; the map files never need it.
+class CsvReader {
+public:
+    static constexpr size_t k_MaxFields = 16;
+
+    CsvReader();
+    // Reads rows from memory the caller keeps alive, e.g. one chunk of a mapped file
+    explicit CsvReader(std::string_view sv_Data);
+
+    bool Open(const std::string& s_Path);
+    bool IsOpen() const { return m_File.IsOpen(); }
+
+    // Advances to the next non-empty row; false at end of file
+    bool NextRow();
+
+    size_t GetFieldCount() const { return m_num_Fields; }
+    // Empty view for a missing field
+    std::string_view GetField(size_t i) const { return i < m_num_Fields ? m_arr_Fields[i] : std::string_view(); }
+    std::string_view GetRow() const { return m_sv_Row; }
+    // 1-based line of the current row, for diagnostics
+    size_t GetLineNumber() const { return m_num_Line; }
+
+    // Rough count of the rows still unread, for reserving output containers
+    size_t EstimateRowCount() const;
+
+    // Unread part of the input; after reading the header this is the body to chunk
+    std::string_view GetRemaining() const;
+
+    // Splits text into at most num_Chunks pieces that each end on a line boundary
+    static std::vector<std::string_view> SplitLines(std::string_view sv_Data, size_t num_Chunks);
+
+    // Whole-field parses with surrounding blanks ignored; false on junk or overflow
+    static bool ParseInt(std::string_view sv_Field, int& out_Value);
+    static bool ParseFloat(std::string_view sv_Field, float& out_Value);
+    static bool ParseDouble(std::string_view sv_Field, double& out_Value);
+
+    static std::string_view Trim(std::string_view sv_Text);
+
+private:
+    MappedFile m_File;
+    const char* m_p_Cursor;
+    const char* m_p_End;
+
+    std::string_view m_sv_Row;
+    std::array<std::string_view, k_MaxFields> m_arr_Fields;
+    size_t m_num_Fields;
+    size_t m_num_Line;
+};
+
+} // namespace Utils
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_UTILS_CSVREADER_H
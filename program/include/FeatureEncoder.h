@@ -0,0 +1,60 @@
+#ifndef SCOTLANDYARD_CORE_FEATUREENCODER_H
+#define SCOTLANDYARD_CORE_FEATUREENCODER_H
+
+#include "GameRules.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Writes the network's view of a game straight from a RulesState into a
+// caller's float buffer (an AI::TensorView row, a VecEnv observation), so
+// building an input allocates nothing.
+//
+// The features, GetFeatureSize() floats in this order:
+//   node one-hots for each player, Mr X's only filled while he is to move;
+//   the nodes Mr X may be on as far as the detectives know, 0 or 1 per node;
+//   tickets per player and type, over k_MrXTaxiTickets;
+//   round over k_MaxRounds;
+//   one-hot of the player to move;
+//   action mask over the edge slots of the mover's node, GetActionCount() wide.
+//
+// The possible-location mask is the one piece of history the state lacks. It
+// is a bitset of GetMaskWords() words the caller keeps per game and advances
+// with the Update*() calls as moves are applied: Mr X's move spreads it along
+// every edge of the transport he used and a reveal collapses it to his node,
+// while each detective's arrival rules its node out.
+class FeatureEncoder {
+public:
+    explicit FeatureEncoder(const RulesGraph& graph);
+
+    size_t GetFeatureSize() const { return m_num_FeatureSize; }
+    uint32_t GetNodeCount() const { return m_Graph.GetNodeCount(); }
+    uint32_t GetActionCount() const { return m_Graph.GetMaxDegree(); }
+    size_t GetMaskWords() const { return m_num_MaskWords; }
+    // Offset of the action mask within the features
+    size_t GetActionMaskOffset() const { return m_num_FeatureSize - GetActionCount(); }
+
+    // Start of a game: anywhere but on a detective
+    void ResetPossibleLocations(uint64_t* p_Mask, const RulesState& state) const;
+    // After GameRules::ApplyMove() moved Mr X along u32_Edge in round i_Round
+    void UpdateAfterMisterXMove(uint64_t* p_Mask, const RulesState& state, uint32_t u32_Edge, int i_Round) const;
+    // After a detective arrived on u32_Node
+    void UpdateAfterDetectiveMove(uint64_t* p_Mask, uint32_t u32_Node) const;
+
+    // p_Features holds GetFeatureSize() floats; every one of them is written
+    void Encode(const RulesState& state, const uint64_t* p_Mask, float* p_Features) const;
+
+private:
+    void ClearDetectiveNodes(uint64_t* p_Mask, const RulesState& state) const;
+
+    const RulesGraph& m_Graph;
+    size_t m_num_MaskWords;
+    size_t m_num_FeatureSize;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_FEATUREENCODER_H
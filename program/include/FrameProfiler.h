@@ -0,0 +1,111 @@
+#ifndef SCOTLANDYARD_CORE_FRAMEPROFILER_H
+#define SCOTLANDYARD_CORE_FRAMEPROFILER_H
+
+#include <GL/glew.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Per-pass GPU and CPU timings for a render loop.
+//
+// Each pass is bracketed by a GL_TIME_ELAPSED query and a steady_clock
+// measurement. Queries live in a ring k_FrameLatency frames deep and are only
+// read back once the driver reports them available, so profiling never stalls
+// the pipeline; a result that is still pending when its slot comes round again
+// is dropped. Resolved frames go into a fixed history used for the rolling
+// averages and for DumpToFile().
+//
+// GL timer queries cannot nest, so passes are sequential: BeginPass() closes
+// any pass that is still open.
+class FrameProfiler {
+public:
+    static constexpr int k_MaxPasses = 16;
+    static constexpr int k_FrameLatency = 4;
+    static constexpr int k_HistoryFrames = 240;
+
+    struct PassSummary {
+        std::string s_Name;
+        float f_AvgCpuMs;   // over the frames that issued the pass
+        float f_AvgGpuMs;   // negative when no GPU sample resolved yet
+        float f_MaxGpuMs;
+    };
+
+    FrameProfiler();
+    ~FrameProfiler() = default;
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // Query objects need a current GL context
+    bool Initialize();
+    void Shutdown();
+
+    void SetEnabled(bool b_Enabled) { m_b_Enabled = b_Enabled; }
+    bool IsEnabled() const { return m_b_Enabled && m_b_Initialized; }
+
+    void BeginFrame();
+    void EndFrame();
+
+    // Pass names are expected to be string literals; they are registered on first use
+    void BeginPass(const char* p_Name);
+    void EndPass();
+
+    // Averages over the resolved history, in registration order
+    std::vector<PassSummary> GetSummary() const;
+    float GetAvgFrameCpuMs() const;
+    int GetResolvedFrameCount() const { return m_i_HistoryCount; }
+
+    // Writes every resolved frame as CSV: frame,pass,cpu_ms,gpu_ms (gpu_ms = -1 when dropped)
+    bool DumpToFile(const std::string& s_Path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct FrameSlot {
+        std::array<GLuint, k_MaxPasses> arr_Queries{};
+        std::array<bool, k_MaxPasses> arr_Issued{};
+        std::array<float, k_MaxPasses> arr_CpuMs{};
+        float f_FrameCpuMs = 0.0f;
+        uint64_t u64_Frame = 0;
+        bool b_Pending = false;
+    };
+
+    // Negative where the pass was not issued (or, for GPU, not resolved)
+    struct FrameSample {
+        std::array<float, k_MaxPasses> arr_CpuMs{};
+        std::array<float, k_MaxPasses> arr_GpuMs{};
+        float f_FrameCpuMs = 0.0f;
+        uint64_t u64_Frame = 0;
+    };
+
+    int FindOrRegisterPass(const char* p_Name);
+    void ResolveSlot(FrameSlot& slot);
+
+    bool m_b_Initialized;
+    bool m_b_Enabled;
+    bool m_b_InFrame;
+
+    std::array<FrameSlot, k_FrameLatency> m_arr_Slots;
+    int m_i_CurrentSlot;
+    uint64_t m_u64_FrameIndex;
+
+    std::vector<const char*> m_vec_PassNames;
+
+    int m_i_OpenPass;
+    Clock::time_point m_tp_PassStart;
+    Clock::time_point m_tp_FrameStart;
+
+    std::vector<FrameSample> m_vec_History;
+    int m_i_HistoryHead;
+    int m_i_HistoryCount;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_FRAMEPROFILER_H
@@ -0,0 +1,39 @@
+#ifndef SCOTLANDYARD_CORE_FRUSTUM_H
+#define SCOTLANDYARD_CORE_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Six clip planes taken from a (model-)view-projection matrix.
+//
+// Planes are normalised and point inwards, so a signed distance below zero
+// is outside. Extracting from an MVP gives the planes in that model's space,
+// which lets rotated geometry be tested without transforming its bounds.
+class Frustum {
+public:
+    enum class Result {
+        Outside,
+        Intersects,
+        Inside
+    };
+
+    Frustum();
+    explicit Frustum(const glm::mat4& mat4_ViewProjection);
+
+    // Conservative: boxes that straddle two planes outside a corner may pass
+    Result TestBox(const glm::vec3& vec3_Min, const glm::vec3& vec3_Max) const;
+    bool IsBoxVisible(const glm::vec3& vec3_Min, const glm::vec3& vec3_Max) const {
+        return TestBox(vec3_Min, vec3_Max) != Result::Outside;
+    }
+
+private:
+    static constexpr int k_PlaneCount = 6;
+    glm::vec4 m_arr_Planes[k_PlaneCount];
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_FRUSTUM_H
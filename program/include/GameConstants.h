@@ -37,6 +37,10 @@ static constexpr int k_MrXDoubleMoveTickets = 2;
 // Map Data Paths - use GetMapPath() to get full paths with ASSETS_DIR
 static constexpr const char* k_NodeDataRelativePath = "maps/nodes_with_station.csv";
 static constexpr const char* k_ConnectionsRelativePath = "maps/polaczenia.csv";
+// Built from the two CSVs by the mapc tool; preferred over them when present and rebuilt when they change
+static constexpr const char* k_BinaryMapRelativePath = "maps/map.sybin";
+// Relative to the assets root, for Application::GetAssetPath()
+static constexpr const char* k_BoardTextureRelativePath = "textures/Scotland_Yard_schematic.png";
 
 // Helper function to build full asset path (like GetAssetPath in Application)
 inline std::string GetMapPath(const std::string& s_RelativePath) {
@@ -48,7 +52,6 @@ inline std::string GetMapPath(const std::string& s_RelativePath) {
 }
 
 // Map Constants
-static constexpr int k_MaxNodes = 200;
 static constexpr float k_MapSizeMeters = 13.0f;
 
 // Transport Types
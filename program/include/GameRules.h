@@ -0,0 +1,106 @@
+#ifndef SCOTLANDYARD_CORE_GAMERULES_H
+#define SCOTLANDYARD_CORE_GAMERULES_H
+
+#include "GameConstants.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class GraphManager;
+
+namespace ScotlandYard {
+namespace Core {
+
+static constexpr int k_PlayerCount = 1 + k_DetectiveCount;    // Mr X is player 0
+static constexpr int k_TicketTypeCount = 4;                     // taxi, bus, metro, water
+
+// The board connections flattened for the rules: node indices instead of IDs,
+// every node's edges in one contiguous run of the target/transport arrays.
+//
+// GraphManager chases pointers through per-node slot lists, which is fine for
+// one game on screen but dominates the profile once thousands of games run
+// per second. Built once by MapAsset and read-only afterwards.
+class RulesGraph {
+public:
+    void Build(const GraphManager& graph);
+
+    uint32_t GetNodeCount() const { return static_cast<uint32_t>(m_vec_NodeIds.size()); }
+    uint32_t GetEdgeBegin(uint32_t u32_Node) const { return m_vec_Offsets[u32_Node]; }
+    uint32_t GetEdgeEnd(uint32_t u32_Node) const { return m_vec_Offsets[u32_Node + 1]; }
+    uint32_t GetTarget(uint32_t u32_Edge) const { return m_vec_Targets[u32_Edge]; }
+    // k_TransportType* value of the edge
+    int GetTransport(uint32_t u32_Edge) const { return m_vec_Transports[u32_Edge]; }
+    // Most edges leaving any one node; sizes move buffers and action spaces
+    uint32_t GetMaxDegree() const { return m_u32_MaxDegree; }
+    // Station ID for GameState, logs and saved games
+    int GetNodeId(uint32_t u32_Node) const { return m_vec_NodeIds[u32_Node]; }
+
+private:
+    std::vector<uint32_t> m_vec_Offsets;    // GetNodeCount() + 1 entries
+    std::vector<uint32_t> m_vec_Targets;
+    std::vector<uint8_t> m_vec_Transports;
+    std::vector<int> m_vec_NodeIds;
+    uint32_t m_u32_MaxDegree = 0;
+};
+
+enum class GameOutcome : uint8_t {
+    None,
+    MisterX,        // survived k_MaxRounds
+    Detectives      // caught him, or he could not move
+};
+
+// Everything a game needs between moves, small enough to copy freely.
+//
+// Players move in a fixed order each round, Mr X first, then the detectives
+// by index; GameState lets the detectives pick their order, which does not
+// change what any of them can reach. A player with no usable ticket for any
+// edge passes, except Mr X, who loses when cornered like that.
+struct RulesState {
+    uint32_t arr_Positions[k_PlayerCount];                      // node indices
+    uint8_t arr_Tickets[k_PlayerCount][k_TicketTypeCount];
+    uint8_t u8_Round;                                           // 1..k_MaxRounds
+    uint8_t u8_Turn;                                            // player to move
+    GameOutcome e_Outcome;
+};
+
+// The Scotland Yard rules as plain functions on RulesState, without any of
+// GameState's rendering, locking or HUD bookkeeping, for self-play and other
+// headless users. Moves are named by edge index into the RulesGraph so a
+// policy can address them as "slot k of the current node".
+class GameRules {
+public:
+    // Fresh game: distinct random start nodes, starting tickets, round 1, Mr X to move
+    static void Reset(RulesState& state, const RulesGraph& graph, std::mt19937& rng);
+
+    // Ticket slot (0..k_TicketTypeCount-1) paying for a k_TransportType* value, -1 for none
+    static int TicketIndex(int i_Transport) {
+        return (i_Transport >= k_TransportTypeTaxi && i_Transport <= k_TransportTypeWater)
+            ? i_Transport - k_TransportTypeTaxi : -1;
+    }
+
+    static bool CanUseEdge(const RulesState& state, const RulesGraph& graph, uint32_t u32_Edge);
+
+    // Writes the usable edges of the player to move to p_Edges, which must hold
+    // graph.GetMaxDegree() entries, and returns how many there are
+    static uint32_t GenerateMoves(const RulesState& state, const RulesGraph& graph, uint32_t* p_Edges);
+
+    // Moves the current player along u32_Edge (one of GenerateMoves()),
+    // spends the ticket and passes the turn on, settling capture and the
+    // round limit. u32_Edge == k_Pass skips the turn instead.
+    static void ApplyMove(RulesState& state, const RulesGraph& graph, uint32_t u32_Edge);
+
+    // Plays the current turn with a uniformly random legal move and returns the
+    // edge taken, or k_Pass when there was none
+    static uint32_t PlayRandomMove(RulesState& state, const RulesGraph& graph, std::mt19937& rng,
+                                   uint32_t* p_Scratch);
+
+    static constexpr uint32_t k_Pass = 0xFFFFFFFFu;
+
+private:
+    static void EndTurn(RulesState& state);
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_GAMERULES_H
@@ -4,6 +4,9 @@
 #include "IGameState.h"
 #include "GameConstants.h"
 #include "MapDataLoader.h"
+#include "FrameProfiler.h"
+#include "MapAsset.h"
+#include "BoardTiles.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -36,6 +39,14 @@ public:
     void Render(Core::Application* p_App) override;
     void HandleEvent(const SDL_Event& event, Core::Application* p_App) override;
 
+    // Places the 3D camera directly, for scripted flights; clears any camera motion
+    void SetCameraPose(const glm::vec3& vec3_Position, float f_Pitch);
+    // Seeds the starting positions OnEnter() draws; 0 draws them from std::random_device
+    void SetStartSeed(uint32_t u32_Seed) { m_u32_StartSeed = u32_Seed; }
+    // Reads the next rendered frame back from the back buffer before it is
+    // swapped: tightly packed RGB rows, bottom row first, into p_vec_Pixels
+    void CaptureNextFrame(std::vector<unsigned char>* p_vec_Pixels, int i_Width, int i_Height);
+
 private:
     bool m_b_GameActive;
     bool m_b_Camera3D;
@@ -47,11 +58,10 @@ private:
     std::atomic<int> m_i_PlayersRemainingThisRound{0};
     std::mutex m_mtx_GameState;
 
-    GLuint m_VAO_Plane;
-    GLuint m_VBO_Plane;
     GLuint m_ShaderProgram_Plane;
 
     GLuint m_ShaderProgram_Circle;
+    GLuint m_ShaderProgram_Station;
     GLuint m_VAO_Circle;
     GLuint m_VBO_Circle;
     int m_i_CircleVertexCount;
@@ -63,6 +73,11 @@ private:
     };
     std::vector<StationCircle> m_vec_CircleStations;
 
+    // Board quad tiles and station rings, culled per frame
+    Core::BoardTiles m_BoardTiles;
+    void BuildStationInstances(std::vector<Core::BoardTiles::StationInstance>& vec_Instances,
+                               std::vector<uint32_t>& vec_StationOffsets) const;
+
     SDL_Window* m_p_Window;
 
     float m_f_Rotation;
@@ -92,12 +107,20 @@ private:
     static constexpr float k_MinCameraAngle = -1.55f;  // -90 degrees
     static constexpr float k_MaxCameraAngle = -0.2915f;  // ~-16.7 degrees
 
+    static constexpr const char* k_FrameProfileDumpPath = "frame_profile.csv";
+
    
 
     void LoadTextures(Core::Application* p_App);
 
-    // Graph manager used by the game state to query connections
-    GraphManager m_graph;
+    // Shared, read-only board map; acquired in OnEnter, released in OnExit
+    std::shared_ptr<const Core::MapAsset> m_sp_Map;
+    uint32_t m_u32_StartSeed = 0;
+
+    // Pending CaptureNextFrame() request, cleared once served
+    std::vector<unsigned char>* m_p_vec_CapturePixels = nullptr;
+    int m_i_CaptureWidth = 0;
+    int m_i_CaptureHeight = 0;
 
     std::thread m_t_ConsoleThread;
     std::atomic_bool m_b_ConsoleThreadRunning{false};
@@ -110,16 +133,39 @@ private:
         float radius;
     };
     std::vector<PlayerToken> m_vec_PlayerTokens;
-    std::vector<float> generateCylinderVertices(float radius, float height, int segments);    
-    std::vector<float> generateHemisphereVertices(float radius, int segments);
 
-    // Player token 
-    GLuint m_VAO_Cylinder = 0;
-    GLuint m_VBO_Cylinder = 0;
-    int m_i_CylinderVertexCount = 0;
-    GLuint m_VAO_Hemisphere = 0;
-    GLuint m_VBO_Hemisphere = 0;
-    int m_i_HemisphereVertexCount = 0;
+    // Token mesh vertices are position + normal; both parts append to the same vertex/index arrays
+    void generateCylinderMesh(float radius, float height, int segments,
+                              std::vector<float>& vec_Vertices, std::vector<GLuint>& vec_Indices);
+    void generateHemisphereMesh(float radius, float f_OffsetY, int segments,
+                                std::vector<float>& vec_Vertices, std::vector<GLuint>& vec_Indices);
+
+    // One per token on the board, uploaded to m_VBO_TokenInstances as per-instance attributes
+    struct TokenInstance {
+        glm::mat4 mat4_Model;
+        glm::vec3 vec3_Color;
+        glm::vec3 vec3_PickingColor;
+    };
+
+    // Player token (cylinder body + hemisphere top, indexed, drawn instanced)
+    GLuint m_VAO_Token = 0;
+    GLuint m_VBO_Token = 0;
+    GLuint m_EBO_Token = 0;
+    GLuint m_VBO_TokenInstances = 0;
+    GLuint m_ShaderProgram_Token = 0;
+    int m_i_TokenIndexCount = 0;
+    std::vector<TokenInstance> m_vec_TokenInstances;
+    int m_i_VisibleTokenCount = 0;
+
+    // Token mesh extents before the per-token scale: cylinder plus hemisphere cap
+    static constexpr float k_TokenMeshRadius = 0.05f;
+    static constexpr float k_TokenMeshHeight = 0.15f;
+
+    bool IsTokenVisible(const Core::Player& player) const;
+    // Tokens outside the frustum are left out of the instance buffer entirely
+    void BuildTokenInstances(const Core::Frustum& frustum);
+    void UploadTokenInstances();
+    void DrawTokenInstances(const glm::mat4& mat4_ViewProjection, int i_Count, bool b_Picking);
 
     void AccelerateCameraForward(float f_DeltaTime);
     void AccelerateCameraBackward(float f_DeltaTime);
@@ -146,6 +192,10 @@ private:
     std::atomic_bool m_b_ShowPickingBuffer{false};
     std::atomic_bool m_b_ShowMrXInDebug{true};
 
+    // Per-pass GPU/CPU timings, collected while debugging mode is on
+    Core::FrameProfiler m_FrameProfiler;
+    void RenderProfilerOverlay(Core::Application* p_App);
+
     enum class ClickableType : uint8_t {
         None = 0,
         Detective = 1,
@@ -183,21 +233,20 @@ private:
     std::vector<DirectionArrow> m_vec_CurrentArrows;
     uint32_t m_ui_NextPickingID;
     std::map<uint32_t, ClickableID> m_map_PickingIDToClickable;
+    std::vector<ClickableID> m_vec_TokenClickables;  // parallel to m_vec_TokenInstances
 
     glm::vec3 IDToColor(uint32_t ui_ID) const;
     uint32_t ColorToID(unsigned char r, unsigned char g, unsigned char b) const;
     uint32_t RegisterClickable(ClickableType e_Type, int i_Index, int i_Data);
     std::vector<float> generateArrowVertices();
     void UpdateArrowsForSelectedPlayer();
+    bool IsArrowInFrustum(const DirectionArrow& arrow, const Core::Frustum& frustum) const;
     void RenderPickingPass(const glm::mat4& mat4_Projection, const glm::mat4& mat4_View);
     void ApplyDilationPass();
     void HandleColorPicking(int i_MouseX, int i_MouseY);
     void HandlePlayerClick(int i_PlayerIndex);
     void HandleArrowClick(int i_PlayerIndex, int i_DestinationNode);
 
-    // Helper method to render Mr X token at a specific position
-    void RenderMrXToken(const glm::vec2& vec2_Position, const glm::mat4& mat4_Projection, const glm::mat4& mat4_View, GLint i_MvpLoc, GLint i_ColorLoc);
-
     void CheckEndOfGame(Winner winner = Winner::None);
 
     bool CheckCapture() const;
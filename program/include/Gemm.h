@@ -0,0 +1,96 @@
+#ifndef SCOTLANDYARD_AI_GEMM_H
+#define SCOTLANDYARD_AI_GEMM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ScotlandYard {
+namespace AI {
+
+// Matrix rows are padded to this many floats (64 bytes) so every kernel works
+// on whole vectors and every row starts on a cache line
+static constexpr size_t k_GemmColumnAlignment = 16;
+
+inline size_t PadColumns(size_t num_Columns) {
+    return (num_Columns + k_GemmColumnAlignment - 1) & ~(k_GemmColumnAlignment - 1);
+}
+
+enum class Activation : uint32_t {
+    None = 0,
+    Relu = 1,
+    Tanh = 2
+};
+
+enum class GemmKernel {
+    Scalar,
+    Avx2,       // AVX2 + FMA
+    Avx512      // AVX-512F
+};
+
+// Widest kernel both compiled in and supported by this CPU
+GemmKernel GetBestGemmKernel();
+bool IsGemmKernelSupported(GemmKernel e_Kernel);
+const char* GetGemmKernelName(GemmKernel e_Kernel);
+
+// C[m][n] = act(sum_k A[m][k] * B[k][n] + p_Bias[n]) for m < num_Rows, n < num_Columns.
+//
+// A is row-major with row stride num_Lda; B and C are row-major with strides
+// num_Ldb and num_Ldc, and num_Columns must be a multiple of
+// k_GemmColumnAlignment (pad B, the bias and C with zero columns). All three
+// must be 64-byte aligned when the strides are. K is processed in blocks
+// sized for L1 so the B panel stays cached while the rows stream past it;
+// bias and activation are applied as each output tile is finished rather
+// than in a separate pass.
+void Gemm(GemmKernel e_Kernel, const float* p_A, size_t num_Lda, const float* p_B, size_t num_Ldb,
+          const float* p_Bias, float* p_C, size_t num_Ldc, size_t num_Rows, size_t num_Inner,
+          size_t num_Columns, Activation e_Activation);
+
+// ---- int8 ----
+//
+// Activations are quantized to uint8 with a zero point of 128 and weights to
+// int8 in [-127, 127], so every kernel accumulates sum_k (a - 128) * w exactly
+// in int32 and they all agree bit for bit. The float epilogue (rescale, bias,
+// activation) is shared code run outside the ISA-specific kernels.
+
+static constexpr int32_t k_Int8ZeroPoint = 128;
+// Inner values per packed group; one group of a column is one int32 lane
+static constexpr size_t k_Int8InnerGroup = 4;
+// Largest inner dimension whose worst-case sum still fits in int32
+static constexpr size_t k_Int8MaxInner = 65536;
+
+inline size_t PadInt8Inner(size_t num_Inner) {
+    return (num_Inner + k_Int8InnerGroup - 1) & ~(k_Int8InnerGroup - 1);
+}
+
+enum class Int8Kernel {
+    Scalar,
+    Avx2,           // vpmaddwd on sign-extended weights
+    Avx512Vnni      // AVX-512 VNNI vpdpbusd
+};
+
+Int8Kernel GetBestInt8Kernel();
+bool IsInt8KernelSupported(Int8Kernel e_Kernel);
+const char* GetInt8KernelName(Int8Kernel e_Kernel);
+
+// Quantizes num_Rows x num_Columns floats to round(x * f_InverseScale) clamped
+// to [-127, 127], plus the zero point. Rows of p_Output are num_Ldo bytes
+// (at least PadInt8Inner(num_Columns)) and the tail is filled with zero points.
+void QuantizeActivations(const float* p_Input, size_t num_Ldi, size_t num_Rows, size_t num_Columns,
+                         float f_InverseScale, uint8_t* p_Output, size_t num_Ldo);
+
+// C[m][n] = act((sum_k (A[m][k] - 128) * B[k][n]) * p_Scales[n] + p_Bias[n]).
+//
+// A is num_Rows rows of num_Inner bytes with stride num_Lda, num_Inner a
+// multiple of k_Int8InnerGroup and at most k_Int8MaxInner. B is packed in
+// groups of four inner values per column: B[k][n] lives at byte
+// (k / 4) * 4 * num_Columns + n * 4 + k % 4. p_ColumnSums[n] is sum_k B[k][n],
+// which folds the zero point out of the accumulator. num_Columns must be a
+// multiple of k_GemmColumnAlignment, like the float Gemm().
+void GemmInt8(Int8Kernel e_Kernel, const uint8_t* p_A, size_t num_Lda, const int8_t* p_B,
+              const int32_t* p_ColumnSums, const float* p_Scales, const float* p_Bias, float* p_C,
+              size_t num_Ldc, size_t num_Rows, size_t num_Inner, size_t num_Columns, Activation e_Activation);
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_GEMM_H
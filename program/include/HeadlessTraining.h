@@ -0,0 +1,49 @@
+#ifndef SCOTLANDYARD_CORE_HEADLESSTRAINING_H
+#define SCOTLANDYARD_CORE_HEADLESSTRAINING_H
+
+#include <cstdint>
+#include <string>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Settings for RunHeadlessTraining(), filled from the command line
+struct TrainingOptions {
+    int64_t i64_Games = 100000;
+    uint64_t u64_Seed = 0;          // 0: seeded from std::random_device
+    int i_Envs = 0;                 // >0: step a VecEnv of this many games in lockstep instead
+    std::string s_RecordDirectory;  // VecEnv only: append every finished game to trajectory shards here
+    uint32_t u32_ReplayCapacity = 0; // VecEnv only: >0 also feeds finished games to an AI::ReplayBuffer this big
+};
+
+struct TrainingReport {
+    int64_t i64_Games = 0;
+    int64_t i64_Moves = 0;
+    int64_t i64_MisterXWins = 0;
+    int64_t i64_DetectiveWins = 0;
+    int64_t i64_Rounds = 0;         // summed over games, for the average length
+    double d_Seconds = 0.0;
+
+    void Print() const;
+};
+
+// Self-play without a window, GL context or game state objects.
+//
+// Games run straight through GameRules on the map's RulesGraph, spread over
+// the thread pool in chunks that each own their RNG and tallies, so the
+// workers share nothing but the read-only map. Players pick uniformly among
+// their legal moves. With i_Envs set the games run through VecEnv instead,
+// the way an RL learner drives them, with moves sampled from the network
+// NeuralNetworkManager has loaded (uniform without one), and stop once
+// i64_Games have finished. With s_RecordDirectory set those games
+// are also written out for training through AI::TrajectoryWriter; with
+// u32_ReplayCapacity set they go into an in-memory AI::ReplayBuffer that is
+// sampled once per step, with the network's value error as the new
+// priorities, the way an in-process learner would use it. Returns false
+// when the map could not be loaded, or when either is set without i_Envs.
+bool RunHeadlessTraining(const TrainingOptions& options, TrainingReport& report);
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_HEADLESSTRAINING_H
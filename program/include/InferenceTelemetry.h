@@ -0,0 +1,120 @@
+#ifndef SCOTLANDYARD_AI_INFERENCETELEMETRY_H
+#define SCOTLANDYARD_AI_INFERENCETELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ScotlandYard {
+namespace AI {
+
+// Durations bucketed log-linearly: eight buckets per power of two of
+// nanoseconds, so a percentile read back is at most 12.5% above the true
+// value over the whole range. Recording is one relaxed atomic increment per
+// counter and never locks; reads are a snapshot that may straddle records.
+class LatencyHistogram {
+public:
+    static constexpr int k_SubBuckets = 8;
+    static constexpr int k_BucketCount = (64 - 3 + 1) * k_SubBuckets;
+
+    LatencyHistogram() { Reset(); }
+
+    // u64_Samples identical samples at once, e.g. every row of one batch
+    void Record(uint64_t u64_Nanoseconds, uint64_t u64_Samples = 1);
+    void Reset();
+
+    uint64_t GetCount() const { return m_u64_Count.load(std::memory_order_relaxed); }
+    double GetMeanMicroseconds() const;
+    // Upper edge of the bucket holding quantile d_Quantile (0..1), 0 when empty
+    double GetPercentileMicroseconds(double d_Quantile) const;
+    double GetMaxMicroseconds() const { return m_u64_MaxNanoseconds.load(std::memory_order_relaxed) * 1e-3; }
+
+private:
+    std::array<std::atomic<uint64_t>, k_BucketCount> m_arr_Buckets;
+    std::atomic<uint64_t> m_u64_Count;
+    std::atomic<uint64_t> m_u64_SumNanoseconds;
+    std::atomic<uint64_t> m_u64_MaxNanoseconds;
+};
+
+struct LatencySummary {
+    uint64_t u64_Count = 0;
+    double d_MeanUs = 0.0;
+    double d_P50Us = 0.0;
+    double d_P95Us = 0.0;
+    double d_P99Us = 0.0;
+    double d_MaxUs = 0.0;
+};
+
+// Batch sizes in power-of-two buckets: 1, 2, 3-4, 5-8, ... and the last open-ended
+static constexpr int k_BatchSizeBuckets = 10;
+
+// Point-in-time copy of one model's InferenceTelemetry
+struct InferenceStats {
+    std::string s_ModelPath;
+    uint64_t u64_Generation = 0;
+    double d_Seconds = 0.0;                 // since the model was loaded or the stats reset
+    uint64_t u64_Requests = 0;              // rows evaluated
+    uint64_t u64_Rejected = 0;              // rows refused for mismatched views
+    uint64_t u64_Batches = 0;               // forward passes
+    std::array<uint64_t, k_BatchSizeBuckets> arr_BatchSizes{};
+    LatencySummary queueWait;               // PredictAsync() enqueue to batch start
+    LatencySummary compute;                 // one forward pass, per batch
+    LatencySummary latency;                 // call or enqueue to result, per request
+
+    double GetRequestsPerSecond() const { return d_Seconds > 0.0 ? u64_Requests / d_Seconds : 0.0; }
+    double GetAverageBatchSize() const { return u64_Batches ? static_cast<double>(u64_Requests) / u64_Batches : 0.0; }
+    // Smallest batch size the bucket covers, for labels
+    static size_t GetBatchBucketFloor(int i_Bucket) { return i_Bucket == 0 ? 1 : (size_t{1} << (i_Bucket - 1)) + 1; }
+
+    void Print() const;
+};
+
+// Counters for one loaded model, shared by every thread that runs it.
+//
+// NeuralNetworkManager creates one per LoadModel() and records into it on
+// each inference path; the synchronous calls count their own duration as
+// both compute and latency, while PredictAsync() requests add the time they
+// sat in the queue.
+class InferenceTelemetry {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    InferenceTelemetry(std::string s_ModelPath, uint64_t u64_Generation);
+
+    InferenceTelemetry(const InferenceTelemetry&) = delete;
+    InferenceTelemetry& operator=(const InferenceTelemetry&) = delete;
+
+    // One forward pass over num_Rows rows
+    void RecordBatch(size_t num_Rows, uint64_t u64_ComputeNanoseconds);
+    void RecordQueueWait(uint64_t u64_Nanoseconds) { m_QueueWait.Record(u64_Nanoseconds); }
+    void RecordLatency(uint64_t u64_Nanoseconds, size_t num_Rows = 1) { m_Latency.Record(u64_Nanoseconds, num_Rows); }
+    void RecordRejected(size_t num_Rows) { m_u64_Rejected.fetch_add(num_Rows, std::memory_order_relaxed); }
+
+    InferenceStats GetStats() const;
+    void Reset();
+
+    static uint64_t ToNanoseconds(Clock::duration d_Elapsed) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d_Elapsed).count());
+    }
+
+private:
+    const std::string m_s_ModelPath;
+    const uint64_t m_u64_Generation;
+    std::atomic<int64_t> m_i64_StartTicks;      // Clock ticks of the load or the last Reset()
+
+    std::atomic<uint64_t> m_u64_Requests;
+    std::atomic<uint64_t> m_u64_Rejected;
+    std::atomic<uint64_t> m_u64_Batches;
+    std::array<std::atomic<uint64_t>, k_BatchSizeBuckets> m_arr_BatchSizes;
+    LatencyHistogram m_QueueWait;
+    LatencyHistogram m_Compute;
+    LatencyHistogram m_Latency;
+};
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_INFERENCETELEMETRY_H
@@ -0,0 +1,51 @@
+#ifndef SCOTLANDYARD_MEMORY_LINEARARENA_H
+#define SCOTLANDYARD_MEMORY_LINEARARENA_H
+
+#include "MemoryManager.h"
+#include <cstddef>
+
+namespace ScotlandYard {
+namespace Memory {
+
+// Fixed-capacity bump allocator over one aligned block from MemoryManager.
+//
+// Carving is a pointer bump, and nothing is freed on its own: Reset() drops
+// every allocation at once and the block goes back to MemoryManager with the
+// arena. Meant for buffers that live as long as some owner (a search tree, a
+// replay buffer) and would otherwise be many separate heap allocations.
+// Not thread-safe; carve up front, then hand the pieces to threads.
+class LinearArena {
+public:
+    static constexpr size_t k_DefaultAlignment = 64;
+
+    LinearArena(size_t num_Capacity, MemoryTag e_Tag = MemoryTag::GENERAL);
+    ~LinearArena();
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    // num_Alignment must be a power of two; returns nullptr when the arena is full
+    void* Allocate(size_t num_Bytes, size_t num_Alignment = k_DefaultAlignment);
+
+    // Uninitialised storage for num_Count objects of a trivial type
+    template<typename T>
+    T* AllocateArray(size_t num_Count, size_t num_Alignment = k_DefaultAlignment) {
+        return static_cast<T*>(Allocate(num_Count * sizeof(T), num_Alignment < alignof(T) ? alignof(T) : num_Alignment));
+    }
+
+    void Reset() { m_num_Used = 0; }
+
+    size_t GetCapacity() const { return m_num_Capacity; }
+    size_t GetUsed() const { return m_num_Used; }
+
+private:
+    char* m_p_Base;
+    size_t m_num_Capacity;
+    size_t m_num_Used;
+    MemoryTag m_e_Tag;
+};
+
+} // namespace Memory
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_MEMORY_LINEARARENA_H
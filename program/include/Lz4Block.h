@@ -0,0 +1,34 @@
+#ifndef SCOTLANDYARD_UTILS_LZ4BLOCK_H
+#define SCOTLANDYARD_UTILS_LZ4BLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ScotlandYard {
+namespace Utils {
+
+// Compressor for the LZ4 block format (no frame header, no dictionary).
+//
+// A greedy single-pass matcher over a 4096-entry hash table (16 KB of stack
+// per call): well short of the reference library's ratio, but several
+// hundred MB/s and small enough to keep in tree. The output is plain LZ4
+// block data, so any LZ4 decoder reads it, and the reference encoder can
+// replace this one without a format change.
+
+// Largest output Lz4Compress() can produce for num_Bytes of input
+inline size_t Lz4CompressBound(size_t num_Bytes) {
+    return num_Bytes + num_Bytes / 255 + 16;
+}
+
+// Returns the compressed size, or 0 when it does not fit in num_Capacity
+size_t Lz4Compress(const uint8_t* p_Source, size_t num_SourceBytes, uint8_t* p_Destination, size_t num_Capacity);
+
+// Decodes exactly num_DestinationBytes; false on malformed or truncated input,
+// never reading or writing out of bounds
+bool Lz4Decompress(const uint8_t* p_Source, size_t num_SourceBytes, uint8_t* p_Destination,
+                   size_t num_DestinationBytes);
+
+} // namespace Utils
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_UTILS_LZ4BLOCK_H
@@ -0,0 +1,59 @@
+#ifndef SCOTLANDYARD_CORE_MAPASSET_H
+#define SCOTLANDYARD_CORE_MAPASSET_H
+
+#include "GameRules.h"
+#include "MapDataLoader.h"
+#include "../../Graphs/graph_manage.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+// The board map, loaded once per process and shared read-only.
+//
+// Acquire() loads the compiled map (or the CSVs when there is none) on first
+// use and hands every later caller the same instance. The asset is never
+// modified after construction, so rendering, rules and AI threads can read it
+// concurrently without locking; the shared_ptr keeps it alive for as long as
+// any of them still holds it, e.g. a detached console thread. The cache keeps
+// its own reference so leaving a game and starting another does not reload.
+class MapAsset {
+public:
+    static std::shared_ptr<const MapAsset> Acquire();
+
+    // Runs the first Acquire() on the thread pool so entering a game finds the
+    // map already loaded; an Acquire() that races it just waits on the cache lock.
+    static void Preload();
+
+    // Drops the cached reference; holders keep theirs. Next Acquire() reloads.
+    static void ReleaseCache();
+
+    const std::vector<Utils::StationData>& GetStations() const { return m_vec_Stations; }
+    const GraphManager& GetGraph() const { return m_Graph; }
+    // The same graph flattened for the headless rules engine
+    const RulesGraph& GetRulesGraph() const { return m_RulesGraph; }
+    int GetNodeCount() const { return m_Graph.GetNodeCount(); }
+    bool IsFromBinary() const { return m_b_FromBinary; }
+
+    MapAsset(const MapAsset&) = delete;
+    MapAsset& operator=(const MapAsset&) = delete;
+
+private:
+    MapAsset();
+    void Load();
+
+    std::vector<Utils::StationData> m_vec_Stations;
+    GraphManager m_Graph;
+    RulesGraph m_RulesGraph;
+    bool m_b_FromBinary;
+
+    static std::mutex s_mtx_Cache;
+    static std::shared_ptr<const MapAsset> s_sp_Cached;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_MAPASSET_H
@@ -2,12 +2,15 @@
 #define SCOTLANDYARD_UTILS_MAPDATALOADER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <glm/glm.hpp>
 
 namespace ScotlandYard {
 namespace Utils {
 
+class BinaryMap;
+
 struct StationData {
     glm::vec2 vec2_Position;
     std::vector<std::string> vec_TransportTypes;
@@ -17,10 +20,10 @@ struct StationData {
 class MapDataLoader {
 public:
     static std::vector<StationData> LoadStations(const std::string& s_FilePath);
+    static std::vector<StationData> LoadStations(const BinaryMap& map);
 
 private:
-    static bool ParseStationLine(const std::string& s_Line, StationData& out_Station);
-    static std::vector<std::string> SplitTransportTypes(const std::string& s_TypeString);
+    static void SplitTransportTypes(std::string_view sv_TypeString, std::vector<std::string>& out_Types);
 };
 
 } // namespace Utils
@@ -0,0 +1,56 @@
+#ifndef SCOTLANDYARD_UTILS_MAPPEDFILE_H
+#define SCOTLANDYARD_UTILS_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ScotlandYard {
+namespace Utils {
+
+// Read-only memory mapping of a whole file.
+//
+// The mapping stays valid until Close() or destruction, so views handed out
+// by GetView() must not outlive the MappedFile. An empty file opens
+// successfully with a null data pointer and size 0.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    enum class Access {
+        Sequential,     // read front to back once, as parsers do
+        Resident        // read repeatedly: fault everything in now and keep it
+    };
+
+    bool Open(const std::string& s_Path, Access e_Access = Access::Sequential);
+    void Close();
+
+    bool IsOpen() const { return m_b_Open; }
+    const char* GetData() const { return m_p_Data; }
+    size_t GetSize() const { return m_num_Size; }
+    std::string_view GetView() const { return std::string_view(m_p_Data, m_num_Size); }
+
+private:
+    void MoveFrom(MappedFile& other);
+
+    const char* m_p_Data;
+    size_t m_num_Size;
+    bool m_b_Open;
+
+#ifdef _WIN32
+    void* m_p_FileHandle;
+    void* m_p_MappingHandle;
+#endif
+};
+
+} // namespace Utils
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_UTILS_MAPPEDFILE_H
@@ -23,6 +23,9 @@ public:
     static void Shutdown();
     static void* Allocate(size_t size, MemoryTag tag = MemoryTag::GENERAL);
     static void Free(void* ptr, MemoryTag tag = MemoryTag::GENERAL);
+    // For SIMD data; alignment must be a power of two. Free with FreeAligned()
+    static void* AllocateAligned(size_t size, size_t alignment, MemoryTag tag = MemoryTag::GENERAL);
+    static void FreeAligned(void* ptr, size_t alignment, MemoryTag tag = MemoryTag::GENERAL);
     static size_t GetAllocatedMemory(MemoryTag tag);
     static void PrintStatistics();
 
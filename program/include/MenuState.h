@@ -2,6 +2,7 @@
 #define SCOTLANDYARD_STATES_MENUSTATE_H
 
 #include "IGameState.h"
+#include "TextBatch.h"
 #include <GL/glew.h>
 #include <string>
 
@@ -38,6 +39,7 @@ private:
     };
 
     Button m_Buttons[BUTTON_COUNT];
+    Core::TextBatch m_TextBatch;
 
     void RenderText(const std::string& s_Text, float f_X, float f_Y, float f_Scale, float f_R, float f_G, float f_B, Core::Application* p_App);
     void RenderTextBold(const std::string& s_Text, float f_X, float f_Y, float f_Scale, float f_R, float f_G, float f_B, Core::Application* p_App);
@@ -0,0 +1,191 @@
+#ifndef SCOTLANDYARD_AI_MLPMODEL_H
+#define SCOTLANDYARD_AI_MLPMODEL_H
+
+#include "Gemm.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace AI {
+
+// On-disk layout of a .synn model, little-endian:
+//
+//   ModelFileHeader
+//   ModelLayerHeader layers[u32_LayerCount]
+//   per Float32 layer, each 64-byte aligned:
+//     float weights[u32_Inputs][u32_Stride]     input-major, zero beyond u32_Outputs
+//     float bias[u32_Stride]
+//   per Int8 layer, each 64-byte aligned:
+//     int8 weights[PadInt8Inner(u32_Inputs) / 4][u32_Stride][4]
+//     float bias[u32_Stride]
+//     float scales[u32_Stride]                  input step * per-output weight step
+//     int32 column sums[u32_Stride]             sum of each output's int8 weights
+//
+// Weights are stored transposed relative to a PyTorch nn.Linear (input-major)
+// and padded to whole SIMD rows, so the file is already in the layout the
+// GEMM kernels read (see GemmInt8() for the int8 packing). The last layer's
+// outputs are u32_PolicySize policy logits followed by u32_ValueSize (0 or 1)
+// value logits.
+struct ModelFileHeader {
+    char arr_Magic[4];
+    uint32_t u32_Version;
+    uint32_t u32_LayerCount;
+    uint32_t u32_InputSize;
+    uint32_t u32_PolicySize;
+    uint32_t u32_ValueSize;
+    uint64_t u64_LayerTableOffset;
+    uint64_t u64_FileSize;
+    uint64_t u64_PayloadChecksum;   // FNV-1a over every byte after the header
+    uint64_t u64_HeaderChecksum;    // FNV-1a over the header up to this field
+};
+
+enum class LayerPrecision : uint32_t {
+    Float32 = 0,
+    Int8 = 1        // per-output weight scales, per-layer input scale
+};
+
+struct ModelLayerHeader {
+    uint32_t u32_Inputs;
+    uint32_t u32_Outputs;
+    uint32_t u32_Stride;            // PadColumns(u32_Outputs)
+    uint32_t u32_Activation;        // AI::Activation
+    uint32_t u32_Precision;         // AI::LayerPrecision
+    float f_InputScale;             // Int8: input value of one quantization step
+    uint64_t u64_WeightsOffset;
+    uint64_t u64_BiasOffset;
+    uint64_t u64_ScalesOffset;      // Int8 only
+    uint64_t u64_ColumnSumsOffset;  // Int8 only
+    uint64_t u64_Reserved;
+};
+
+static_assert(sizeof(ModelFileHeader) == 56, "ModelFileHeader layout is part of the file format");
+static_assert(sizeof(ModelLayerHeader) == 64, "ModelLayerHeader layout is part of the file format");
+
+// Activation scratch for MlpModel::Forward(). Buffers only ever grow, so a
+// workspace kept per thread stops allocating after its first few batches.
+class MlpWorkspace {
+public:
+    MlpWorkspace();
+    ~MlpWorkspace();
+
+    MlpWorkspace(const MlpWorkspace&) = delete;
+    MlpWorkspace& operator=(const MlpWorkspace&) = delete;
+
+    void Reserve(size_t num_Floats);
+    float* GetBuffer(int i_Index) { return m_arr_p_Buffers[i_Index]; }
+
+    // Quantized input rows for int8 layers
+    void ReserveQuantized(size_t num_Bytes);
+    uint8_t* GetQuantizedBuffer() { return m_p_Quantized; }
+
+private:
+    float* m_arr_p_Buffers[2];
+    size_t m_num_Capacity;
+    uint8_t* m_p_Quantized;
+    size_t m_num_QuantizedCapacity;
+};
+
+// Fully connected policy/value network evaluated on the CPU.
+//
+// The file is mapped read-only and the layers point straight into the
+// mapping: the tensors are already aligned and in kernel layout, so nothing
+// is copied, and processes loading the same file share one physical copy
+// through the page cache. The model is immutable after Load(), so any number
+// of threads can run Forward() at once, each with its own workspace.
+//
+// Int8 layers (written by `nnc quantize`) quantize their input rows and run
+// GemmInt8(); float and int8 layers can be mixed in one model.
+class MlpModel {
+public:
+    static constexpr uint32_t k_Version = 2;
+    static constexpr size_t k_TensorAlignment = 64;
+
+    // One layer as handed to Write(): weights input-major, u32_Inputs x u32_Outputs.
+    // Int8 layers fill vec_QuantizedWeights and vec_Scales instead of vec_Weights.
+    struct LayerData {
+        uint32_t u32_Inputs;
+        uint32_t u32_Outputs;
+        Activation e_Activation;
+        std::vector<float> vec_Weights;
+        std::vector<float> vec_Bias;
+        LayerPrecision e_Precision = LayerPrecision::Float32;
+        float f_InputScale = 0.0f;
+        std::vector<int8_t> vec_QuantizedWeights;
+        std::vector<float> vec_Scales;
+    };
+
+    // A loaded layer; the tensors point into the mapped file
+    struct Layer {
+        const float* p_Weights;             // Float32
+        const int8_t* p_QuantizedWeights;   // Int8
+        const float* p_Bias;
+        const float* p_Scales;              // Int8
+        const int32_t* p_ColumnSums;        // Int8
+        uint32_t u32_Inputs;
+        uint32_t u32_Outputs;
+        uint32_t u32_Stride;
+        uint32_t u32_QuantizedInputs;       // PadInt8Inner(u32_Inputs)
+        Activation e_Activation;
+        LayerPrecision e_Precision;
+        float f_InputScale;
+    };
+
+    MlpModel();
+    ~MlpModel();
+
+    MlpModel(const MlpModel&) = delete;
+    MlpModel& operator=(const MlpModel&) = delete;
+
+    // Rejects files with a bad magic, version, layout or checksum. The file
+    // must not be rewritten in place while loaded; write a new file and
+    // rename it over the old one instead (Write() does).
+    bool Load(const std::string& s_Path);
+
+    static bool Write(const std::string& s_Path, uint32_t u32_InputSize, uint32_t u32_PolicySize,
+                      uint32_t u32_ValueSize, const std::vector<LayerData>& vec_Layers);
+
+    uint32_t GetInputSize() const { return m_u32_InputSize; }
+    uint32_t GetPolicySize() const { return m_u32_PolicySize; }
+    bool HasValue() const { return m_u32_ValueSize > 0; }
+    size_t GetLayerCount() const { return m_vec_Layers.size(); }
+    const Layer& GetLayer(size_t i) const { return m_vec_Layers[i]; }
+    bool HasInt8Layers() const { return m_num_MaxQuantizedInputs > 0; }
+    // Row stride of the block Forward() returns
+    size_t GetOutputStride() const { return m_vec_Layers.empty() ? 0 : m_vec_Layers.back().u32_Stride; }
+    // Floats a workspace needs per input row
+    size_t GetWorkspaceFloatsPerRow() const { return m_num_MaxStride; }
+
+    // Chosen from the CPU at Load(); override to compare kernels
+    GemmKernel GetKernel() const { return m_e_Kernel; }
+    void SetKernel(GemmKernel e_Kernel) { m_e_Kernel = e_Kernel; }
+    Int8Kernel GetInt8Kernel() const { return m_e_Int8Kernel; }
+    void SetInt8Kernel(Int8Kernel e_Kernel) { m_e_Int8Kernel = e_Kernel; }
+
+    // Runs num_Rows inputs of GetInputSize() floats (row stride num_InputStride)
+    // through the network and returns the raw last-layer outputs, num_Rows rows
+    // of GetOutputStride() floats inside the workspace
+    const float* Forward(const float* p_Input, size_t num_InputStride, size_t num_Rows, MlpWorkspace& workspace) const;
+
+private:
+    bool Validate(const std::string& s_Path, size_t num_Size);
+    void Release();
+
+    Utils::MappedFile m_File;
+    const char* m_p_Data;
+    std::vector<Layer> m_vec_Layers;
+    uint32_t m_u32_InputSize;
+    uint32_t m_u32_PolicySize;
+    uint32_t m_u32_ValueSize;
+    size_t m_num_MaxStride;
+    size_t m_num_MaxQuantizedInputs;
+    GemmKernel m_e_Kernel;
+    Int8Kernel m_e_Int8Kernel;
+};
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_MLPMODEL_H
@@ -0,0 +1,108 @@
+#ifndef SCOTLANDYARD_THREADING_MPMCQUEUE_H
+#define SCOTLANDYARD_THREADING_MPMCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace ScotlandYard {
+namespace Threading {
+
+// Bounded lock-free queue for any number of producers and consumers.
+//
+// A ring of cells that each carry a sequence number (D. Vyukov's bounded
+// MPMC design): a thread claims a slot with one CAS on the head or tail and
+// then publishes it through the cell's sequence, so neither side ever waits
+// on a lock and a full or empty queue is reported instead of blocked on.
+// Meant for handing pointers and other small trivially copyable values
+// between threads. Capacity is rounded up to a power of two.
+template<typename T>
+class MpmcQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "MpmcQueue holds trivially copyable values");
+
+public:
+    explicit MpmcQueue(size_t num_Capacity)
+        : m_num_Mask(RoundUpPowerOfTwo(num_Capacity < 2 ? 2 : num_Capacity) - 1)
+        , m_p_Cells(new Cell[m_num_Mask + 1])
+        , m_num_Head(0)
+        , m_num_Tail(0)
+    {
+        for (size_t i = 0; i <= m_num_Mask; ++i) {
+            m_p_Cells[i].num_Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    size_t GetCapacity() const { return m_num_Mask + 1; }
+
+    // False when the queue is full
+    bool TryPush(const T& value) {
+        size_t num_Pos = m_num_Tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_p_Cells[num_Pos & m_num_Mask];
+            size_t num_Sequence = cell.num_Sequence.load(std::memory_order_acquire);
+            intptr_t i_Diff = static_cast<intptr_t>(num_Sequence) - static_cast<intptr_t>(num_Pos);
+            if (i_Diff == 0) {
+                if (m_num_Tail.compare_exchange_weak(num_Pos, num_Pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.num_Sequence.store(num_Pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (i_Diff < 0) {
+                return false;
+            } else {
+                num_Pos = m_num_Tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // False when the queue is empty
+    bool TryPop(T& value) {
+        size_t num_Pos = m_num_Head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_p_Cells[num_Pos & m_num_Mask];
+            size_t num_Sequence = cell.num_Sequence.load(std::memory_order_acquire);
+            intptr_t i_Diff = static_cast<intptr_t>(num_Sequence) - static_cast<intptr_t>(num_Pos + 1);
+            if (i_Diff == 0) {
+                if (m_num_Head.compare_exchange_weak(num_Pos, num_Pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.num_Sequence.store(num_Pos + m_num_Mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (i_Diff < 0) {
+                return false;
+            } else {
+                num_Pos = m_num_Head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    static size_t RoundUpPowerOfTwo(size_t num_Value) {
+        size_t num_Result = 1;
+        while (num_Result < num_Value) num_Result <<= 1;
+        return num_Result;
+    }
+
+    struct Cell {
+        std::atomic<size_t> num_Sequence;
+        T value;
+    };
+
+    // Producers and consumers each hammer one index; keep them on separate lines
+    static constexpr size_t k_CacheLine = 64;
+
+    const size_t m_num_Mask;
+    std::unique_ptr<Cell[]> m_p_Cells;
+    alignas(k_CacheLine) std::atomic<size_t> m_num_Head;
+    alignas(k_CacheLine) std::atomic<size_t> m_num_Tail;
+};
+
+} // namespace Threading
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_THREADING_MPMCQUEUE_H
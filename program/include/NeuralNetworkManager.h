@@ -1,42 +1,169 @@
 #ifndef SCOTLANDYARD_AI_NEURALNETWORKMANAGER_H
 #define SCOTLANDYARD_AI_NEURALNETWORKMANAGER_H
 
+#include "InferenceTelemetry.h"
+#include "Tensor.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <future>
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
 
 namespace ScotlandYard {
 namespace AI {
 
+// Both sides of an inference are views over memory the caller owns (a
+// TensorBuffer, an arena, a VecEnv observation row), so a prediction moves no
+// feature or probability data through the heap.
 struct NetworkInput {
-    std::vector<float> vec_Features;
+    ConstTensorView view_Features;          // GetInputSize() floats
 };
 
 struct NetworkOutput {
-    std::vector<float> vec_ActionProbabilities;
-    float f_Confidence;
+    TensorView view_ActionProbabilities;    // room for GetPolicySize() floats
+    float f_Confidence = 0.0f;
 };
 
+// Limits for coalescing PredictAsync() calls into shared forward passes
+struct BatchingOptions {
+    size_t num_MaxBatchSize = 64;               // rows per forward pass
+    uint32_t u32_MaxWaitMicroseconds = 200;     // how long the oldest request waits for others
+};
+
+class MlpModel;
+
+// Runs the loaded policy/value network (see MlpModel) for the AI players.
+//
+// Predict() softmaxes the policy logits into view_ActionProbabilities, trims
+// the view to GetPolicySize(), and sets
+// f_Confidence to the value head's win probability for the player to move,
+// or to the most likely action's probability when the model has no value
+// head. Every thread keeps its own activation workspace, so after warm-up
+// the forward pass itself allocates nothing.
+//
+// Models are swapped RCU-style: LoadModel() bumps a generation counter, and
+// a thread only takes the lock to copy the model pointer when it sees a new
+// generation, so the inference path itself never locks or touches a shared
+// reference count. A thread's copy counts as in use only during an inference
+// call; LoadModel() drops the copies of threads that are not inside one, so
+// a replaced model is freed by the LoadModel() that replaced it, or by the
+// next one (or Shutdown()) if an inference was still running on it. Never
+// in the middle of an inference.
+//
+// PredictAsync() does not evaluate on its own: requests are queued for a
+// batcher thread that runs whatever has arrived as one matrix batch once
+// num_MaxBatchSize requests are waiting or the oldest has waited
+// u32_MaxWaitMicroseconds, then fulfils all of the batch's futures. Many
+// search threads each asking for one position thus share one GEMM. Only the
+// views are queued: the input and output memory must stay alive until the
+// future is ready.
+//
+// Each loaded model gets its own InferenceTelemetry: rows, forward passes,
+// the batch-size distribution, and latency histograms for queue wait,
+// compute and end-to-end time. Recording is a handful of relaxed atomic
+// increments, cheap enough to stay on in production.
 class NeuralNetworkManager {
 public:
     static void Initialize();
     static void Shutdown();
+    // Maps the file and publishes it as the current model. Safe while other
+    // threads are predicting: each picks the new model up at its next call,
+    // and inferences already running finish on the old one.
     static bool LoadModel(const std::string& modelPath);
-    static NetworkOutput Predict(const NetworkInput& input);
-    static std::future<NetworkOutput> PredictAsync(const NetworkInput& input);
-    static std::vector<NetworkOutput> PredictBatch(const std::vector<NetworkInput>& vec_Inputs);
+    // False, leaving the output untouched, when no model is loaded or a view
+    // has the wrong size
+    static bool Predict(const NetworkInput& input, NetworkOutput& output);
+    static std::future<bool> PredictAsync(const NetworkInput& input, NetworkOutput& output);
+    static bool PredictBatch(const NetworkInput* p_Inputs, NetworkOutput* p_Outputs, size_t num_Count);
     static bool IsReady();
 
+    // Takes effect from the next batch
+    static void SetBatchingOptions(const BatchingOptions& options);
+    static BatchingOptions GetBatchingOptions();
+
+    // Batch path without per-row objects: num_Rows feature rows of
+    // GetInputSize() floats in, GetPolicySize() probabilities per row out, and
+    // one value per row into p_Values when it is not null. Returns false when
+    // no model is loaded.
+    static bool Evaluate(const float* p_Features, size_t num_Rows, float* p_Policy, float* p_Values);
+
+    // Shape of the loaded model, 0 when there is none
+    static size_t GetInputSize();
+    static size_t GetPolicySize();
+
+    // Throughput, batch sizes and latency percentiles of the current model
+    // since it was loaded (or ResetStats()); empty when there is none
+    static InferenceStats GetStats();
+    // The same for the last k_MaxModelStats models loaded, oldest first
+    static std::vector<InferenceStats> GetModelStats();
+    static void ResetStats();
+
+    static constexpr size_t k_MaxModelStats = 8;
+
 private:
     NeuralNetworkManager() = delete;
     ~NeuralNetworkManager() = delete;
 
+private:
+    // A model and the telemetry its inferences record into, published together
+    struct ActiveModel {
+        std::shared_ptr<const MlpModel> sp_Model;
+        std::shared_ptr<InferenceTelemetry> sp_Telemetry;
+    };
+
+    struct PendingRequest {
+        NetworkInput input;
+        NetworkOutput* p_Output;
+        std::promise<bool> promise;
+        std::chrono::steady_clock::time_point tp_Enqueued;
+    };
+
+    // A thread's copy of the published model; see ModelLease
+    struct ModelCache;
+
+    // Pins the calling thread's current model for as long as it is in scope.
+    // Outside a lease PublishModel() may drop a stale copy; leases nest.
+    class ModelLease {
+    public:
+        ModelLease();
+        ~ModelLease();
+
+        ModelLease(const ModelLease&) = delete;
+        ModelLease& operator=(const ModelLease&) = delete;
+
+        const ActiveModel& Get() const;
+
+    private:
+        ModelCache& m_Cache;
+    };
+
+    static ModelCache& GetModelCache();
+    static void PublishModel(ActiveModel active);
+    static void BatcherThread();
+    static void RunBatch(std::vector<PendingRequest>& vec_Batch);
+
 private:
     static bool s_b_Initialized;
-    static bool s_b_ModelLoaded;
-    static size_t s_num_Inferences;
-    static float s_f_AvgInferenceTime;
+    static std::atomic<bool> s_b_ModelLoaded;
+    static ActiveModel s_Active;
+    static std::vector<std::shared_ptr<const MlpModel>> s_vec_sp_RetiredModels;
+    static std::vector<ModelCache*> s_vec_p_ModelCaches;    // one per thread that ran inference
+    static std::deque<std::shared_ptr<InferenceTelemetry>> s_deque_sp_ModelTelemetry;   // newest last
+    static std::atomic<uint64_t> s_u64_ModelGeneration;
+    static std::mutex s_mtx_Model;
+
+    static BatchingOptions s_BatchingOptions;
+    static std::deque<PendingRequest> s_deque_Pending;
+    static std::mutex s_mtx_Pending;
+    static std::condition_variable s_cv_Pending;
+    static std::thread s_t_Batcher;
+    static bool s_b_Batching;     // guarded by s_mtx_Pending
 };
 
 } // namespace AI
@@ -0,0 +1,25 @@
+#ifndef SCOTLANDYARD_UTILS_PNGWRITER_H
+#define SCOTLANDYARD_UTILS_PNGWRITER_H
+
+#include <string>
+
+namespace ScotlandYard {
+namespace Utils {
+
+// Minimal PNG encoder for debug snapshots.
+//
+// Image data goes into stored (uncompressed) deflate blocks, so files are
+// about as large as the raw pixels but need no zlib; any viewer or image
+// diff tool reads them.
+class PngWriter {
+public:
+    // 8-bit pixels with 1-4 channels (grey, grey+alpha, RGB, RGBA), rows top to
+    // bottom unless b_FlipVertically is set, as for a glReadPixels result
+    static bool Write(const std::string& s_Path, const unsigned char* p_Pixels, int i_Width, int i_Height,
+                      int i_Channels, bool b_FlipVertically);
+};
+
+} // namespace Utils
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_UTILS_PNGWRITER_H
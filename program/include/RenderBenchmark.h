@@ -0,0 +1,69 @@
+#ifndef SCOTLANDYARD_CORE_RENDERBENCHMARK_H
+#define SCOTLANDYARD_CORE_RENDERBENCHMARK_H
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Settings for Application::RunBenchmark(), filled from the command line
+struct BenchmarkOptions {
+    int i_Frames = 600;
+    int i_WarmupFrames = 30;        // rendered after textures are resident, not measured
+    std::string s_CameraPath;       // empty: CameraPath::MakeDefault()
+    std::string s_FrameTimesPath;   // per-frame CSV, optional
+    std::string s_SnapshotDir;      // PNG every i_SnapshotEvery frames, optional; their times include the readback
+    int i_SnapshotEvery = 0;
+};
+
+// One pose of the 3D camera; GameState looks down -Z and only pitches
+struct CameraKey {
+    float f_Time;
+    glm::vec3 vec3_Position;
+    float f_Pitch;
+};
+
+// Keyframed camera flight the benchmark replays.
+//
+// The file is a CSV with a header row and "time,x,y,z,pitch" rows in
+// ascending time; pitch is in radians like GameState's camera angle. Poses
+// are interpolated linearly, and the benchmark spreads its frames evenly over
+// the whole path so runs of different length see the same flight.
+class CameraPath {
+public:
+    bool Load(const std::string& s_Path);
+
+    // Flies from the default viewpoint down over the board and back, so the
+    // run covers whole-board views as well as heavily culled close-ups
+    static CameraPath MakeDefault();
+
+    bool IsEmpty() const { return m_vec_Keys.empty(); }
+    // f_T runs 0..1 across the path
+    CameraKey Sample(float f_T) const;
+
+private:
+    std::vector<CameraKey> m_vec_Keys;
+};
+
+struct FrameTimeStats {
+    int i_Frames = 0;
+    double d_MeanMs = 0.0;
+    double d_StdDevMs = 0.0;
+    double d_MinMs = 0.0;
+    double d_MaxMs = 0.0;
+    double d_P50Ms = 0.0;
+    double d_P95Ms = 0.0;
+    double d_P99Ms = 0.0;
+
+    static FrameTimeStats Compute(const std::vector<double>& vec_FrameMs);
+    void Print() const;
+    // One row per frame, then the summary as comment lines
+    bool WriteCsv(const std::string& s_Path, const std::vector<double>& vec_FrameMs) const;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_RENDERBENCHMARK_H
@@ -0,0 +1,122 @@
+#ifndef SCOTLANDYARD_AI_REPLAYBUFFER_H
+#define SCOTLANDYARD_AI_REPLAYBUFFER_H
+
+#include "FeatureEncoder.h"
+#include "LinearArena.h"
+#include "TrajectoryFile.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ScotlandYard {
+namespace AI {
+
+struct ReplayBufferOptions {
+    uint32_t u32_Capacity = 1u << 20;   // transitions kept, rounded up to a power of two
+    float f_Alpha = 0.6f;               // priority = (|error| + f_Epsilon)^f_Alpha; 0 samples uniformly
+    float f_Beta = 0.4f;                // importance-sampling correction, 1 undoes the bias fully
+    float f_Epsilon = 1e-3f;            // keeps every transition sampleable
+};
+
+// A sampled minibatch and what the learner needs to feed its losses back
+struct ReplaySample {
+    TrajectoryBatch batch;
+    std::vector<uint64_t> vec_Ids;      // for UpdatePriorities()
+    std::vector<float> vec_Weights;     // importance-sampling weights, the largest in the batch 1
+};
+
+// In-memory prioritized experience replay for training within the process,
+// without the trip through trajectory shards on disk.
+//
+// A fixed-capacity ring of transitions that any number of self-play threads
+// Push() to while a learner Sample()s from it, none of them taking a lock.
+// A push claims the next slot with one fetch_add and, once the ring is full,
+// overwrites the oldest transition. Each slot has a sequence number that a
+// writer sets to busy while it copies the transition in and to the slot's
+// id when done; a reader copies a slot out and keeps the copy only if the
+// number was the same id before and after, so a transition overwritten
+// mid-read is drawn again rather than returned torn.
+//
+// Sampling is proportional to priority through a sum-tree of fixed-point
+// priorities: leaves per slot, each inner node the sum of its children.
+// Updates exchange the leaf and fetch_add the difference into every
+// ancestor, so concurrent updates commute and the tree stays exact once
+// they land; a sample descending through an update in flight at worst
+// lands on an empty leaf and draws again. New transitions get the largest
+// priority seen, so each is likely to be trained on at least once.
+//
+// Transitions are stored as in TrajectoryFile.h, but structure-of-arrays:
+// one array per field, all carved from a single LinearArena tagged
+// MemoryTag::AI. Sample() encodes them with a FeatureEncoder on the thread
+// pool.
+class ReplayBuffer {
+public:
+    // Throws std::invalid_argument for a layout that does not Fits()
+    ReplayBuffer(const TrajectoryLayout& layout, const ReplayBufferOptions& options = ReplayBufferOptions());
+
+    ReplayBuffer(const ReplayBuffer&) = delete;
+    ReplayBuffer& operator=(const ReplayBuffer&) = delete;
+
+    const TrajectoryLayout& GetLayout() const { return m_Layout; }
+    uint32_t GetCapacity() const { return m_u32_Capacity; }
+    uint64_t GetSize() const;
+    uint64_t GetPushed() const { return m_u64_Head.load(std::memory_order_relaxed); }
+    // Pushes that lost their slot to a producer a whole ring ahead
+    uint64_t GetDropped() const { return m_u64_Dropped.load(std::memory_order_relaxed); }
+    size_t GetMemoryBytes() const { return m_Arena.GetUsed(); }
+
+    // Any thread. The state the move was chosen in, the mask of where Mr X
+    // may be, the move, the distribution it was drawn from
+    // (GetLayout().GetActionCount() floats) and the value target from the
+    // side to move.
+    void Push(const Core::RulesState& state, const uint64_t* p_PossibleMisterX, uint32_t u32_Action,
+              const float* p_Policy, float f_Value);
+
+    // Draws num_Rows transitions, one from each of num_Rows equal slices of
+    // the total priority. False while the buffer is empty or when the
+    // encoder is for another map.
+    bool Sample(size_t num_Rows, std::mt19937_64& rng, const Core::FeatureEncoder& encoder,
+                ReplaySample& sample) const;
+
+    // Any thread. Ids whose slot has been overwritten since are skipped; a
+    // transition that replaces one while its update is in flight is reset to
+    // the largest priority, as if just pushed.
+    void UpdatePriorities(const uint64_t* p_Ids, const float* p_Errors, size_t num_Count);
+
+private:
+    static size_t GetArenaBytes(const TrajectoryLayout& layout, uint32_t u32_Capacity);
+
+    uint64_t ToFixedPriority(float f_Error) const;
+    void SetPriority(uint32_t u32_Slot, uint64_t u64_Priority);
+    // False when a concurrent write got in the way; the caller draws again
+    bool TrySampleRow(uint64_t u64_Target, const Core::FeatureEncoder& encoder, size_t i_Row,
+                      ReplaySample& sample) const;
+
+    TrajectoryLayout m_Layout;
+    ReplayBufferOptions m_Options;
+    uint32_t m_u32_Capacity;
+    Memory::LinearArena m_Arena;
+
+    // One entry (or row of entries) per slot
+    uint16_t* m_p_Positions;            // [slot][player]
+    uint8_t* m_p_Tickets;               // [slot][player][type]
+    uint8_t* m_p_Rounds;
+    uint8_t* m_p_Turns;
+    uint8_t* m_p_Actions;
+    float* m_p_Values;
+    uint64_t* m_p_PossibleMisterX;      // [slot][word]
+    uint16_t* m_p_Policy;               // [slot][action], probability * 65535
+    std::atomic<uint64_t>* m_p_Sequence; // 0 never written, k_Busy being written, else the slot's id
+    std::atomic<uint64_t>* m_p_Tree;     // [1] root .. [capacity + slot] leaves
+
+    alignas(64) std::atomic<uint64_t> m_u64_Head;
+    alignas(64) std::atomic<uint64_t> m_u64_MaxPriority;
+    std::atomic<uint64_t> m_u64_Dropped;
+};
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_REPLAYBUFFER_H
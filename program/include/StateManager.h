@@ -29,6 +29,8 @@ public:
     void HandleEvent(const SDL_Event& event, Application* p_App);
 
     bool IsEmpty() const { return m_StateStack.empty(); }
+    // Registered state by name, nullptr if unknown
+    IGameState* GetState(const std::string& s_Name) const;
 
 private:
     std::unordered_map<std::string, std::unique_ptr<IGameState>> m_map_States;
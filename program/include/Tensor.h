@@ -0,0 +1,61 @@
+#ifndef SCOTLANDYARD_AI_TENSOR_H
+#define SCOTLANDYARD_AI_TENSOR_H
+
+#include "LinearArena.h"
+#include <cstddef>
+#include <type_traits>
+
+namespace ScotlandYard {
+namespace AI {
+
+// Tensor storage starts on, and is carved in multiples of, a cache line
+static constexpr size_t k_TensorAlignment = 64;
+
+// Non-owning view of num_Size contiguous floats. Copying one copies two
+// words, never the data, so inputs and outputs can be handed between threads
+// without allocating; whoever owns the memory must keep it alive meanwhile.
+template<typename T>
+struct BasicTensorView {
+    T* p_Data = nullptr;
+    size_t num_Size = 0;
+
+    BasicTensorView() = default;
+    BasicTensorView(T* p_InData, size_t num_InSize) : p_Data(p_InData), num_Size(num_InSize) {}
+    // float view -> const float view
+    template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    BasicTensorView(const BasicTensorView<U>& other) : p_Data(other.p_Data), num_Size(other.num_Size) {}
+
+    T* data() const { return p_Data; }
+    size_t size() const { return num_Size; }
+    bool empty() const { return num_Size == 0; }
+    T* begin() const { return p_Data; }
+    T* end() const { return p_Data + num_Size; }
+    T& operator[](size_t i) const { return p_Data[i]; }
+};
+
+using TensorView = BasicTensorView<float>;
+using ConstTensorView = BasicTensorView<const float>;
+
+// Fixed-capacity, cache-line aligned storage for one tensor, for the stack or
+// as a member; View() hands out the first num_Size floats.
+template<size_t N>
+struct alignas(k_TensorAlignment) TensorBuffer {
+    float arr_Data[N];
+
+    static constexpr size_t GetCapacity() { return N; }
+    TensorView View(size_t num_Size = N) { return TensorView(arr_Data, num_Size <= N ? num_Size : N); }
+    ConstTensorView View(size_t num_Size = N) const { return ConstTensorView(arr_Data, num_Size <= N ? num_Size : N); }
+};
+
+// num_Size floats carved from an arena, cache-line aligned and padded to a
+// whole line; an empty view when the arena is full
+inline TensorView AllocateTensor(Memory::LinearArena& arena, size_t num_Size) {
+    const size_t num_Padded = (num_Size * sizeof(float) + k_TensorAlignment - 1) & ~(k_TensorAlignment - 1);
+    float* p_Data = static_cast<float*>(arena.Allocate(num_Padded, k_TensorAlignment));
+    return p_Data ? TensorView(p_Data, num_Size) : TensorView();
+}
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_TENSOR_H
@@ -0,0 +1,71 @@
+#ifndef SCOTLANDYARD_CORE_TEXTBATCH_H
+#define SCOTLANDYARD_CORE_TEXTBATCH_H
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+class Application;
+
+// Collects glyph quads that sample the shared glyph atlas and draws them
+// with a single glDrawArrays call on Flush().
+//
+// For text that rarely changes, Upload() moves the queued quads into a
+// buffer owned by the batch and DrawUploaded() redraws them without
+// touching the CPU-side vertices again.
+class TextBatch {
+public:
+    TextBatch();
+
+    TextBatch(const TextBatch&) = delete;
+    TextBatch& operator=(const TextBatch&) = delete;
+
+    // Appends a string with its baseline at f_BaselineY (bottom-left origin, pixels)
+    void AddText(const std::string& s_Text, float f_X, float f_BaselineY, float f_Scale,
+                 float f_R, float f_G, float f_B, float f_A, const Application* p_App);
+
+    // Appends one textured quad; UVs are in glyph atlas space
+    void AddQuad(float f_X0, float f_Y0, float f_X1, float f_Y1,
+                 float f_U0, float f_V0, float f_U1, float f_V1,
+                 float f_R, float f_G, float f_B, float f_A);
+
+    // Draws everything queued so far with an ortho projection of the given size and clears the batch
+    void Flush(int i_ViewportWidth, int i_ViewportHeight, const Application* p_App);
+
+    // Replaces the retained buffer contents with everything queued so far and clears the batch
+    void Upload();
+    // Redraws the last Upload() with an ortho projection of the given size
+    void DrawUploaded(int i_ViewportWidth, int i_ViewportHeight, const Application* p_App) const;
+    // Frees the retained buffer; needs a current GL context
+    void ReleaseUploaded();
+
+    void Clear() { m_vec_Vertices.clear(); }
+    bool IsEmpty() const { return m_vec_Vertices.empty(); }
+    int GetQuadCount() const { return static_cast<int>(m_vec_Vertices.size() / k_FloatsPerQuad); }
+
+    static float MeasureText(const std::string& s_Text, float f_Scale, const Application* p_App);
+
+    // Enables the text vertex layout on the currently bound VAO/VBO
+    static void SetupVertexAttributes();
+
+    // x, y, u, v, r, g, b, a
+    static constexpr int k_FloatsPerVertex = 8;
+    static constexpr int k_FloatsPerQuad = 6 * k_FloatsPerVertex;
+
+private:
+    void BindForDraw(int i_ViewportWidth, int i_ViewportHeight, const Application* p_App) const;
+
+    std::vector<float> m_vec_Vertices;
+
+    GLuint m_VAO_Uploaded;
+    GLuint m_VBO_Uploaded;
+    GLsizei m_i_UploadedVertexCount;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_TEXTBATCH_H
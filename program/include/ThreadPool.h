@@ -28,6 +28,12 @@ public:
     static auto Submit(F&& func, Args&&... args)
         -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+    // Runs fn_Body(i) for every i in [0, num_Count) on the pool and the calling
+    // thread, returning once all have finished. The caller works through the
+    // range itself, so this is safe to call from a worker or before Initialize()
+    // (it then just runs serially). The first exception thrown is rethrown here.
+    static void ParallelFor(size_t num_Count, const std::function<void(size_t)>& fn_Body);
+
     static size_t GetThreadCount();
     static size_t GetPendingTaskCount();
 
@@ -35,7 +41,7 @@ private:
     ThreadPool() = delete;
     ~ThreadPool() = delete;
 
-    static void WorkerThread();
+    static void WorkerThread(size_t i_WorkerIndex);
 
 private:
     static std::vector<std::thread> s_vec_WorkerThreads;
@@ -0,0 +1,107 @@
+#ifndef SCOTLANDYARD_CORE_TRACERECORDER_H
+#define SCOTLANDYARD_CORE_TRACERECORDER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+// Scoped CPU timeline events exported as Chrome trace-event JSON
+// (open the file in ui.perfetto.dev or chrome://tracing).
+//
+// Every thread records into its own fixed-size buffer, registered once on the
+// thread's first event. Only the owning thread writes to a buffer and it
+// publishes each event with a release store of the count, so recording takes
+// no lock and never allocates. A full buffer drops further events instead of
+// wrapping, which keeps ExportChromeTrace() safe to call while other threads
+// are still recording. Buffers outlive their threads so short-lived threads
+// still show up in the export.
+class TraceRecorder {
+public:
+    static constexpr uint32_t k_EventsPerThread = 1u << 16;
+    static constexpr size_t k_MaxThreadNameLength = 32;
+
+    static void SetEnabled(bool b_Enabled);
+    static bool IsEnabled() { return s_b_Enabled.load(std::memory_order_relaxed); }
+
+    // Label shown for the calling thread in the trace viewer; call after SetEnabled(true)
+    static void SetThreadName(const char* p_Name);
+
+    // Event names must outlive the recorder; string literals are expected
+    static void Record(const char* p_Name, int64_t i64_StartNs, int64_t i64_DurationNs);
+
+    // Nanoseconds since the recorder's origin, the time base for Record()
+    static int64_t NowNs();
+
+    static bool ExportChromeTrace(const std::string& s_Path);
+
+private:
+    TraceRecorder() = delete;
+    ~TraceRecorder() = delete;
+
+    struct Event {
+        const char* p_Name;
+        int64_t i64_StartNs;
+        int64_t i64_DurationNs;
+    };
+
+    struct ThreadBuffer {
+        std::array<Event, k_EventsPerThread> arr_Events;
+        std::atomic<uint32_t> u32_Count{0};
+        std::atomic<uint32_t> u32_Dropped{0};
+        uint32_t u32_ThreadId = 0;
+        char arr_Name[k_MaxThreadNameLength] = {};
+    };
+
+    static ThreadBuffer& GetThreadBuffer();
+
+    static std::atomic<bool> s_b_Enabled;
+    static std::mutex s_mtx_Buffers;
+    static std::vector<std::unique_ptr<ThreadBuffer>> s_vec_Buffers;
+    static const std::chrono::steady_clock::time_point s_tp_Origin;
+};
+
+// Records the lifetime of the enclosing scope as one complete ("X") event
+class TraceScope {
+public:
+    explicit TraceScope(const char* p_Name)
+        : m_p_Name(TraceRecorder::IsEnabled() ? p_Name : nullptr)
+        , m_i64_StartNs(m_p_Name ? TraceRecorder::NowNs() : 0)
+    {
+    }
+
+    ~TraceScope() {
+        if (m_p_Name) {
+            TraceRecorder::Record(m_p_Name, m_i64_StartNs, TraceRecorder::NowNs() - m_i64_StartNs);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_p_Name;
+    int64_t m_i64_StartNs;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#define SCOTLANDYARD_TRACE_CONCAT_INNER(a, b) a##b
+#define SCOTLANDYARD_TRACE_CONCAT(a, b) SCOTLANDYARD_TRACE_CONCAT_INNER(a, b)
+
+#ifdef SCOTLANDYARD_DISABLE_TRACING
+#define TRACE_SCOPE(name) ((void)0)
+#else
+#define TRACE_SCOPE(name) \
+    ::ScotlandYard::Core::TraceScope SCOTLANDYARD_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#endif
+
+#endif // SCOTLANDYARD_CORE_TRACERECORDER_H
@@ -0,0 +1,141 @@
+#ifndef SCOTLANDYARD_AI_TRAJECTORYFILE_H
+#define SCOTLANDYARD_AI_TRAJECTORYFILE_H
+
+#include "GameRules.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace AI {
+
+// Self-play shard layout, little-endian:
+//
+//   TrajectoryShardHeader
+//   chunk, repeated:
+//     TrajectoryChunkHeader
+//     uint8_t  payload[u32_CompressedBytes]     LZ4 block (see Lz4Block.h)
+//
+// A payload decompresses to u32_RawBytes:
+//
+//   TrajectoryRecord  records[u32_TrajectoryCount]   in step order
+//   uint8_t           steps[u32_StepCount][u32_StepBytes]
+//
+// and one step is:
+//
+//   TrajectoryStepHeader                            state before the move, and the move
+//   uint64_t  possibleMisterX[u32_MaskWords]        FeatureEncoder bitset
+//   uint16_t  policy[u32_ActionCount]               search distribution, probability * 65535
+//   zero padding to a multiple of 8 bytes
+//
+// Shards are only appended to, a whole chunk at a time, so a reader keeps
+// every chunk whose header and size check out and stops at the first that
+// does not: the tail of a file still being written, or one cut short by a
+// crash.
+struct TrajectoryShardHeader {
+    char arr_Magic[4];
+    uint32_t u32_Version;
+    uint32_t u32_PlayerCount;
+    uint32_t u32_NodeCount;
+    uint32_t u32_ActionCount;
+    uint32_t u32_MaskWords;
+    uint32_t u32_StepBytes;
+    uint32_t u32_Reserved;
+    uint64_t u64_HeaderChecksum;    // FNV-1a over the header up to this field
+};
+
+struct TrajectoryChunkHeader {
+    char arr_Magic[4];
+    uint32_t u32_RawBytes;
+    uint32_t u32_CompressedBytes;
+    uint32_t u32_TrajectoryCount;
+    uint32_t u32_StepCount;
+    uint32_t u32_Reserved;
+    uint64_t u64_PayloadChecksum;   // FNV-1a over the decompressed payload
+    uint64_t u64_HeaderChecksum;    // FNV-1a over the header up to this field
+};
+
+struct TrajectoryRecord {
+    uint32_t u32_FirstStep;         // within the chunk
+    uint16_t u16_StepCount;
+    int8_t i8_Outcome;              // +1 Mr X won, -1 the detectives did
+    uint8_t u8_Reserved;
+};
+
+struct TrajectoryStepHeader {
+    uint16_t arr_Positions[Core::k_PlayerCount];
+    uint8_t arr_Tickets[Core::k_PlayerCount][Core::k_TicketTypeCount];
+    uint8_t u8_Round;
+    uint8_t u8_Turn;
+    uint8_t u8_Action;              // edge slot taken, as in VecEnv
+    uint8_t arr_Reserved[7];
+};
+
+static_assert(sizeof(TrajectoryShardHeader) == 40, "TrajectoryShardHeader layout is part of the file format");
+static_assert(sizeof(TrajectoryChunkHeader) == 40, "TrajectoryChunkHeader layout is part of the file format");
+static_assert(sizeof(TrajectoryRecord) == 8, "TrajectoryRecord layout is part of the file format");
+static_assert(sizeof(TrajectoryStepHeader) == 40, "TrajectoryStepHeader layout is part of the file format");
+
+static constexpr char k_TrajectoryShardMagic[4] = {'S', 'Y', 'T', 'R'};
+static constexpr char k_TrajectoryChunkMagic[4] = {'C', 'H', 'N', 'K'};
+static constexpr uint32_t k_TrajectoryVersion = 1;
+static constexpr const char* k_TrajectoryExtension = ".sytr";
+
+// "<prefix>-00042.sytr", and back; false for names that are not shards of s_Prefix
+std::string MakeTrajectoryShardName(const std::string& s_Prefix, uint32_t u32_Index);
+bool ParseTrajectoryShardName(const std::string& s_FileName, const std::string& s_Prefix, uint32_t& u32_Index);
+
+// Every player moves at most once a round (passes are not recorded)
+static constexpr uint32_t k_MaxTrajectorySteps = Core::k_MaxRounds * Core::k_PlayerCount;
+
+// One minibatch of training rows, row-major, as TrajectoryReader and
+// ReplayBuffer sample them
+struct TrajectoryBatch {
+    size_t num_Rows = 0;
+    std::vector<float> vec_Features;        // num_Rows x FeatureEncoder::GetFeatureSize()
+    std::vector<float> vec_Policy;          // num_Rows x action count, the recorded distribution
+    std::vector<float> vec_Values;          // game outcome from the side to move: +1 won, -1 lost
+    std::vector<uint32_t> vec_Actions;      // edge slot actually taken
+};
+
+// Sizes of one step for a given map and action space, and packing to and
+// from RulesState. Writer and reader both check theirs against the shard
+// header, so files from another map are refused rather than misread.
+class TrajectoryLayout {
+public:
+    static constexpr uint32_t k_MaxNodeCount = 0xFFFF;     // TrajectoryStepHeader positions are uint16
+    static constexpr uint32_t k_MaxActionCount = 0xFF;     // and the action a uint8
+
+    TrajectoryLayout() = default;
+    TrajectoryLayout(uint32_t u32_NodeCount, uint32_t u32_ActionCount);
+
+    uint32_t GetNodeCount() const { return m_u32_NodeCount; }
+    uint32_t GetActionCount() const { return m_u32_ActionCount; }
+    uint32_t GetMaskWords() const { return m_u32_MaskWords; }
+    uint32_t GetStepBytes() const { return m_u32_StepBytes; }
+
+    // False for maps too big for the step format; such steps would be stored truncated
+    bool Fits() const { return m_u32_NodeCount <= k_MaxNodeCount && m_u32_ActionCount <= k_MaxActionCount; }
+
+    void FillHeader(TrajectoryShardHeader& header) const;
+    bool Matches(const TrajectoryShardHeader& header) const;
+
+    // p_Policy holds GetActionCount() probabilities
+    void PackStep(uint8_t* p_Step, const Core::RulesState& state, const uint64_t* p_PossibleMisterX,
+                  uint32_t u32_Action, const float* p_Policy) const;
+    // p_PossibleMisterX (GetMaskWords() words) and p_Policy may be null
+    void UnpackStep(const uint8_t* p_Step, Core::RulesState& state, uint64_t* p_PossibleMisterX,
+                    uint32_t& u32_Action, float* p_Policy) const;
+
+private:
+    uint32_t m_u32_NodeCount = 0;
+    uint32_t m_u32_ActionCount = 0;
+    uint32_t m_u32_MaskWords = 0;
+    uint32_t m_u32_StepBytes = 0;
+};
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_TRAJECTORYFILE_H
@@ -0,0 +1,76 @@
+#ifndef SCOTLANDYARD_AI_TRAJECTORYREADER_H
+#define SCOTLANDYARD_AI_TRAJECTORYREADER_H
+
+#include "FeatureEncoder.h"
+#include "MappedFile.h"
+#include "TrajectoryFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace AI {
+
+// Random access to every step in a directory of self-play shards.
+//
+// Open() maps the shards and builds an index from the chunk headers alone,
+// without decompressing anything: per chunk, where its payload is and the
+// number of the first step in it. Sample() draws steps uniformly over the
+// whole data set, sorts them so each chunk is decompressed once per batch,
+// and decodes the chunks on the thread pool, encoding each step with a
+// FeatureEncoder straight into the batch.
+//
+// Shards still being appended to are fine: the index ends at the last
+// complete chunk, a shard whose header is not written yet is skipped, and
+// Open() again picks up what was written since.
+class TrajectoryReader {
+public:
+    TrajectoryReader() = default;
+
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    bool Open(const std::string& s_Directory, const std::string& s_Prefix = "selfplay");
+    void Close();
+    bool IsOpen() const { return !m_vec_Shards.empty(); }
+
+    const TrajectoryLayout& GetLayout() const { return m_Layout; }
+    uint64_t GetStepCount() const { return m_u64_StepCount; }
+    uint64_t GetTrajectoryCount() const { return m_u64_TrajectoryCount; }
+    size_t GetChunkCount() const { return m_vec_Chunks.size(); }
+    size_t GetShardCount() const { return m_vec_Shards.size(); }
+
+    // Fills num_Rows rows; false when nothing is open, the encoder is for
+    // another map, or a chunk fails its checksum
+    bool Sample(size_t num_Rows, std::mt19937_64& rng, const Core::FeatureEncoder& encoder,
+                TrajectoryBatch& batch) const;
+
+private:
+    struct ChunkEntry {
+        uint64_t u64_FirstStep;             // over the whole data set
+        uint64_t u64_PayloadOffset;
+        uint64_t u64_PayloadChecksum;
+        uint32_t u32_Shard;
+        uint32_t u32_CompressedBytes;
+        uint32_t u32_RawBytes;
+        uint32_t u32_TrajectoryCount;
+        uint32_t u32_StepCount;
+    };
+
+    bool IndexShard(uint32_t u32_Shard, const std::string& s_Path);
+    bool DecodeSteps(const ChunkEntry& chunk, const uint64_t* p_Steps, size_t num_Steps, size_t i_FirstRow,
+                     const Core::FeatureEncoder& encoder, TrajectoryBatch& batch) const;
+
+    TrajectoryLayout m_Layout;
+    std::vector<Utils::MappedFile> m_vec_Shards;
+    std::vector<ChunkEntry> m_vec_Chunks;
+    uint64_t m_u64_StepCount = 0;
+    uint64_t m_u64_TrajectoryCount = 0;
+};
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_TRAJECTORYREADER_H
@@ -0,0 +1,127 @@
+#ifndef SCOTLANDYARD_AI_TRAJECTORYWRITER_H
+#define SCOTLANDYARD_AI_TRAJECTORYWRITER_H
+
+#include "MpmcQueue.h"
+#include "TrajectoryFile.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ScotlandYard {
+namespace AI {
+
+struct TrajectoryWriterOptions {
+    std::string s_Directory;
+    std::string s_Prefix = "selfplay";
+    uint32_t u32_ChunkSteps = 256;                  // steps per compressed chunk; smaller samples faster, compresses worse
+    uint64_t u64_ShardBytes = 256ull << 20;         // a new shard is started once a file passes this
+    uint32_t u32_Blocks = 128;                      // chunks in flight between producers and the I/O thread
+};
+
+// Whole trajectories collected by one producer, written out as one chunk
+class TrajectoryBlock {
+public:
+    // p_Steps holds u32_StepCount packed steps; false, leaving the block as
+    // it was, when they do not fit in the space left
+    bool Append(const uint8_t* p_Steps, uint32_t u32_StepCount, int8_t i8_Outcome);
+
+    uint32_t GetStepCount() const { return m_u32_StepCount; }
+    uint32_t GetTrajectoryCount() const { return static_cast<uint32_t>(m_vec_Records.size()); }
+    bool IsEmpty() const { return m_vec_Records.empty(); }
+
+private:
+    friend class TrajectoryWriter;
+
+    TrajectoryBlock(uint32_t u32_StepBytes, uint32_t u32_CapacitySteps);
+    void Clear();
+
+    std::vector<TrajectoryRecord> m_vec_Records;
+    std::vector<uint8_t> m_vec_Steps;
+    uint32_t m_u32_StepBytes;
+    uint32_t m_u32_CapacitySteps;
+    uint32_t m_u32_StepCount;
+};
+
+// Appends self-play trajectories to sharded, LZ4-compressed chunk files
+// (see TrajectoryFile.h) from a dedicated I/O thread.
+//
+// Producers never wait on it: they take an empty block from a lock-free
+// free list, fill it with finished games and push it onto a lock-free queue,
+// all without a mutex or a system call. The I/O thread compresses each block
+// into one chunk, appends it to the current shard and recycles the block. A
+// fixed number of blocks exists, so when the disk falls behind AcquireBlock()
+// returns null and the producer drops those games (counted in
+// GetDroppedTrajectories()) instead of stalling the simulation.
+//
+// Shards are named <prefix>-NNNNN.sytr; Open() starts after the highest
+// number already in the directory, so runs add to a data set rather than
+// overwrite it.
+class TrajectoryWriter {
+public:
+    TrajectoryWriter();
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    bool Open(const TrajectoryLayout& layout, const TrajectoryWriterOptions& options);
+    // Writes out every submitted block, then stops the I/O thread. Producers
+    // must be done submitting.
+    void Close();
+    bool IsOpen() const { return m_b_Open; }
+
+    const TrajectoryLayout& GetLayout() const { return m_Layout; }
+
+    // Any thread; null when every block is queued or being written
+    TrajectoryBlock* AcquireBlock();
+    // Any thread; the block belongs to the writer again afterwards
+    void SubmitBlock(TrajectoryBlock* p_Block);
+    // For producers that had no block to put games into
+    void RecordDropped(uint32_t u32_Trajectories) { m_u64_Dropped.fetch_add(u32_Trajectories, std::memory_order_relaxed); }
+
+    uint64_t GetWrittenTrajectories() const { return m_u64_Trajectories.load(std::memory_order_relaxed); }
+    uint64_t GetWrittenSteps() const { return m_u64_Steps.load(std::memory_order_relaxed); }
+    uint64_t GetDroppedTrajectories() const { return m_u64_Dropped.load(std::memory_order_relaxed); }
+    uint64_t GetRawBytes() const { return m_u64_RawBytes.load(std::memory_order_relaxed); }
+    uint64_t GetCompressedBytes() const { return m_u64_CompressedBytes.load(std::memory_order_relaxed); }
+    uint32_t GetShardCount() const { return m_u32_ShardsWritten.load(std::memory_order_relaxed); }
+
+private:
+    void IoThread();
+    void WriteBlock(TrajectoryBlock& block);
+    bool OpenNextShard();
+
+    TrajectoryLayout m_Layout;
+    TrajectoryWriterOptions m_Options;
+    bool m_b_Open;
+
+    std::vector<std::unique_ptr<TrajectoryBlock>> m_vec_p_Blocks;
+    std::unique_ptr<Threading::MpmcQueue<TrajectoryBlock*>> m_p_FreeBlocks;
+    std::unique_ptr<Threading::MpmcQueue<TrajectoryBlock*>> m_p_FullBlocks;
+    std::thread m_t_Io;
+    std::atomic<bool> m_b_Stopping;
+
+    // I/O thread only
+    std::ofstream m_File;
+    uint64_t m_u64_ShardSize;
+    uint32_t m_u32_NextShard;
+    bool m_b_Failed;
+    std::vector<uint8_t> m_vec_Raw;
+    std::vector<uint8_t> m_vec_Compressed;
+
+    std::atomic<uint64_t> m_u64_Trajectories;
+    std::atomic<uint64_t> m_u64_Steps;
+    std::atomic<uint64_t> m_u64_Dropped;
+    std::atomic<uint64_t> m_u64_RawBytes;
+    std::atomic<uint64_t> m_u64_CompressedBytes;
+    std::atomic<uint32_t> m_u32_ShardsWritten;
+};
+
+} // namespace AI
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_AI_TRAJECTORYWRITER_H
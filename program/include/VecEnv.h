@@ -0,0 +1,122 @@
+#ifndef SCOTLANDYARD_CORE_VECENV_H
+#define SCOTLANDYARD_CORE_VECENV_H
+
+#include "FeatureEncoder.h"
+#include "GameRules.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+class MapAsset;
+
+// Many games stepped in lockstep for reinforcement learning.
+//
+// State is kept as structure-of-arrays, one array per field with an entry
+// per environment (positions and tickets k_PlayerCount entries wide), so a
+// learner can read any field for the whole batch without gathering. Each
+// Step() takes one action per environment for whichever player is to move
+// there and writes every environment's next observation into a single
+// contiguous buffer.
+//
+// An action is a slot into the edge list of the mover's node, 0 up to
+// GetActionCount(); the observation's mask marks the usable ones. An unusable
+// action is replaced by the first usable slot and counted. Detectives left
+// without tickets are passed over automatically, so a returned observation
+// always has at least one usable action. A finished game is reset within the
+// same Step(): its done flag and reward describe the game that just ended,
+// its observation already shows the new one.
+//
+// Environments are processed on the thread pool in chunks of
+// k_EnvsPerChunk, each with its own RNG, so a seed reproduces the same
+// games however many threads there are.
+class VecEnv {
+public:
+    static constexpr size_t k_EnvsPerChunk = 256;
+    static constexpr uint32_t k_NotSeen = 0xFFFFFFFFu;
+
+    VecEnv(std::shared_ptr<const MapAsset> sp_Map, size_t num_Envs, uint64_t u64_Seed);
+
+    VecEnv(const VecEnv&) = delete;
+    VecEnv& operator=(const VecEnv&) = delete;
+
+    size_t GetEnvCount() const { return m_num_Envs; }
+    uint32_t GetActionCount() const { return m_Encoder.GetActionCount(); }
+    // Floats per environment in GetObservations(), laid out by FeatureEncoder
+    size_t GetObservationSize() const { return m_Encoder.GetFeatureSize(); }
+
+    // Both throw std::runtime_error if the map never deals Mr X a start he
+    // can move from
+    void ResetAll();
+    // p_Actions holds GetEnvCount() action slots
+    void Step(const uint32_t* p_Actions);
+
+    const float* GetObservations() const { return m_vec_Observations.data(); }
+    // Mask of one environment's observation, GetActionCount() floats of 0 or 1
+    const float* GetActionMask(size_t i_Env) const;
+    // +1 when Mr X won on the last step, -1 when the detectives did, else 0
+    const float* GetRewards() const { return m_vec_Rewards.data(); }
+    const uint8_t* GetDones() const { return m_vec_Dones.data(); }
+
+    const uint32_t* GetPositions() const { return m_vec_Positions.data(); }        // [env][player] node index
+    const uint8_t* GetTickets() const { return m_vec_Tickets.data(); }             // [env][player][type]
+    const uint8_t* GetRounds() const { return m_vec_Rounds.data(); }
+    const uint8_t* GetTurns() const { return m_vec_Turns.data(); }
+    const uint32_t* GetLastSeen() const { return m_vec_LastSeen.data(); }           // k_NotSeen before the first reveal
+    // [env][word] FeatureEncoder bitsets of the nodes Mr X may be on
+    const uint64_t* GetPossibleMisterX() const { return m_vec_PossibleMisterX.data(); }
+    size_t GetMaskWords() const { return m_Encoder.GetMaskWords(); }
+    // One environment's game gathered back into a RulesState
+    void LoadState(size_t i_Env, RulesState& state) const;
+
+    uint64_t GetCompletedGames() const { return m_u64_CompletedGames; }
+    uint64_t GetMisterXWins() const { return m_u64_MisterXWins; }
+    // Summed over completed games, for their average length
+    uint64_t GetCompletedRounds() const { return m_u64_CompletedRounds; }
+    uint64_t GetInvalidActions() const { return m_u64_InvalidActions; }
+
+private:
+    struct ChunkTally {
+        uint64_t u64_Games;
+        uint64_t u64_MisterXWins;
+        uint64_t u64_Rounds;
+        uint64_t u64_InvalidActions;
+    };
+
+    void StoreState(size_t i_Env, const RulesState& state);
+    void ResetEnv(size_t i_Env, std::mt19937& rng);
+    void StepEnv(size_t i_Env, uint32_t u32_Action, std::mt19937& rng, ChunkTally& tally);
+    void WriteObservation(size_t i_Env);
+    void RunChunks(bool b_Reset, const uint32_t* p_Actions);
+
+    std::shared_ptr<const MapAsset> m_sp_Map;
+    const RulesGraph& m_Graph;
+    FeatureEncoder m_Encoder;
+    size_t m_num_Envs;
+
+    std::vector<uint32_t> m_vec_Positions;
+    std::vector<uint8_t> m_vec_Tickets;
+    std::vector<uint8_t> m_vec_Rounds;
+    std::vector<uint8_t> m_vec_Turns;
+    std::vector<uint32_t> m_vec_LastSeen;
+    std::vector<uint64_t> m_vec_PossibleMisterX;
+    std::vector<uint8_t> m_vec_Dones;
+    std::vector<float> m_vec_Rewards;
+    std::vector<float> m_vec_Observations;
+
+    std::vector<std::mt19937> m_vec_ChunkRngs;
+    std::vector<ChunkTally> m_vec_ChunkTallies;
+    uint64_t m_u64_CompletedGames;
+    uint64_t m_u64_MisterXWins;
+    uint64_t m_u64_CompletedRounds;
+    uint64_t m_u64_InvalidActions;
+};
+
+} // namespace Core
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_CORE_VECENV_H
@@ -0,0 +1,66 @@
+#ifndef SCOTLANDYARD_UTILS_XMLSAXREADER_H
+#define SCOTLANDYARD_UTILS_XMLSAXREADER_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Utils {
+
+// Minimal event-driven XML reader for tool input such as OSM GraphML exports.
+//
+// The document is memory-mapped and scanned once; the handler gets start/end
+// element and text callbacks with string_views into the mapping, so nothing
+// is built up and memory stays flat however large the file is. Names,
+// attribute values and text are passed raw: call DecodeEntities() on the
+// values you keep. Comments, processing instructions and DOCTYPE are skipped,
+// CDATA is reported as text. Namespaces and DTD entities are not supported.
+class XmlSaxReader {
+public:
+    struct Attribute {
+        std::string_view sv_Name;
+        std::string_view sv_Value;      // without quotes, entities not decoded
+    };
+
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        // "<a/>" produces a start immediately followed by an end
+        virtual void OnStartElement(std::string_view /*sv_Name*/, const std::vector<Attribute>& /*vec_Attributes*/) {}
+        virtual void OnEndElement(std::string_view /*sv_Name*/) {}
+        // Whitespace-only runs between elements are not reported
+        virtual void OnText(std::string_view /*sv_Text*/) {}
+    };
+
+    XmlSaxReader();
+
+    bool ParseFile(const std::string& s_Path, Handler& handler);
+    // Parses memory the caller keeps alive; false on malformed markup
+    bool Parse(std::string_view sv_Document, Handler& handler);
+
+    // Line of the last error, 0 when the parse succeeded
+    size_t GetErrorLine() const { return m_num_ErrorLine; }
+    const std::string& GetError() const { return m_s_Error; }
+
+    // Replaces the predefined and numeric character references; out is reused
+    static void DecodeEntities(std::string_view sv_Raw, std::string& out_Text);
+
+    // Value of the named attribute, or an empty view when it is absent
+    static std::string_view FindAttribute(const std::vector<Attribute>& vec_Attributes, std::string_view sv_Name);
+
+private:
+    bool Fail(std::string_view sv_Document, const char* p_At, const char* p_Reason);
+
+    MappedFile m_File;
+    std::vector<Attribute> m_vec_Attributes;
+    std::string m_s_Error;
+    size_t m_num_ErrorLine;
+};
+
+} // namespace Utils
+} // namespace ScotlandYard
+
+#endif // SCOTLANDYARD_UTILS_XMLSAXREADER_H
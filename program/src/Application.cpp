@@ -2,12 +2,26 @@
 #include "StateManager.h"
 #include "MenuState.h"
 #include "GameState.h"
+#include "TextBatch.h"
+#include "TraceRecorder.h"
+#include "ThreadPool.h"
+#include "MapAsset.h"
+#include "GameConstants.h"
+#include "CompressedTexture.h"
+#include "RenderBenchmark.h"
+#include "PngWriter.h"
 #include <GL/glew.h>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <iostream>
 #include <filesystem>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <exception>
 
 #define STB_IMAGE_IMPLEMENTATION_APP
 #include "../external/stb_image.h"
@@ -20,6 +34,54 @@
 namespace ScotlandYard {
 namespace Core {
 
+namespace {
+    constexpr int k_GlyphAtlasWidth = 1024;
+    constexpr int k_GlyphAtlasPadding = 4;
+    constexpr int k_GlyphAtlasMaxMipLevel = 2;
+
+    // Pixel bytes copied towards the GPU per frame for async textures; a 4K RGBA
+    // board takes a handful of frames and no frame pays for more than ~1 ms of copying
+    constexpr size_t k_TextureUploadBytesPerFrame = 4u << 20;
+    constexpr unsigned char k_PlaceholderTexel[4] = {200, 192, 170, 255};
+
+    // Trilinear sampling for the bound mipmapped texture
+    void SetMipmappedSampling() {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    // Uploads level 0 from p_Pixels (an offset when a PBO is bound) and builds the mips
+    void UploadTextureImage(GLuint textureID, const void* p_Pixels, int i_Width, int i_Height, int i_Channels) {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        GLenum format = (i_Channels == 4) ? GL_RGBA : ((i_Channels == 3) ? GL_RGB : GL_RED);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, i_Width, i_Height, 0, format, GL_UNSIGNED_BYTE, p_Pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        SetMipmappedSampling();
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // S3TC is an extension in GL 3.3 core, though every desktop driver has it
+    bool CanUseCompressedCache() {
+        return GLEW_EXT_texture_compression_s3tc;
+    }
+
+    // Uploads one BC1/BC3 level of the texture to the bound texture as-is
+    void UploadCompressedLevel(const Utils::CompressedTexture& texture, uint32_t u32_Level) {
+        const Utils::CompressedTextureLevel& level = texture.GetLevel(u32_Level);
+        const GLenum format = texture.GetFormat() == Utils::CompressedTexture::k_FormatBC3
+            ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(u32_Level), format,
+                               static_cast<GLsizei>(level.u32_Width), static_cast<GLsizei>(level.u32_Height), 0,
+                               static_cast<GLsizei>(level.u64_Size), texture.GetLevelData(u32_Level));
+    }
+}
+
 Application::Application(const std::string& title, int width, int height, bool trainingMode)
     : m_s_Title(title)
     , m_i_Width(width)
@@ -29,11 +91,16 @@ Application::Application(const std::string& title, int width, int height, bool t
     , m_b_Running(false)
     , m_b_Initialized(false)
     , m_b_TrainingMode(trainingMode)
+    , m_b_Offscreen(false)
     , m_f_DeltaTime(0.0f)
     , m_u64_LastFrameTime(0)
+    , m_arr_Characters{}
+    , m_TextureID_GlyphAtlas(0)
     , m_ShaderProgram_Text(0)
     , m_VAO_Text(0)
     , m_VBO_Text(0)
+    , m_i_TextureDecodesInFlight(0)
+    , m_u64_NextTextureTicket(1)
     , m_ShaderProgram_HUDRounded(0)
     , m_ShaderProgram_HUDTexture(0)
     , m_VAO_HUDRounded(0)
@@ -56,6 +123,11 @@ bool Application::Initialize() {
         return true;
     }
 
+    // Headless boxes: SDL's offscreen driver renders into an EGL pbuffer, which Mesa's llvmpipe provides
+    if (m_b_Offscreen && !SDL_getenv("DISPLAY") && !SDL_getenv("WAYLAND_DISPLAY") && !SDL_getenv("SDL_VIDEODRIVER")) {
+        SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) < 0) {
         std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
         return false;
@@ -76,7 +148,7 @@ bool Application::Initialize() {
         SDL_WINDOWPOS_CENTERED,
         m_i_Width,
         m_i_Height,
-        SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN
+        SDL_WINDOW_OPENGL | (m_b_Offscreen ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
     );
 
     if (!m_p_Window) {
@@ -103,7 +175,8 @@ bool Application::Initialize() {
         return false;
     }
 
-    SDL_GL_SetSwapInterval(1);
+    // Benchmarks measure the renderer, not the display's refresh rate
+    SDL_GL_SetSwapInterval(m_b_Offscreen ? 0 : 1);
     glViewport(0, 0, m_i_Width, m_i_Height);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glEnable(GL_DEPTH_TEST);
@@ -138,6 +211,12 @@ void Application::LoadStates() {
     m_p_StateManager->RegisterState("menu", std::make_unique<States::MenuState>());
     m_p_StateManager->RegisterState("game", std::make_unique<States::GameState>());
     m_p_StateManager->ChangeState("menu");
+
+    // Get the game's heavy assets going while the menu is up
+    MapAsset::Preload();
+    if (!m_b_TrainingMode) {
+        LoadTextureAsync(GetAssetPath(k_BoardTextureRelativePath));
+    }
 }
 
 void Application::Run() {
@@ -153,19 +232,109 @@ void Application::Run() {
             m_f_DeltaTime = 0.1f;
         }
 
-        HandleEvents();
-        Update(m_f_DeltaTime);
-        Render();
+        TRACE_SCOPE("Frame");
+        {
+            TRACE_SCOPE("HandleEvents");
+            HandleEvents();
+        }
+        {
+            TRACE_SCOPE("Update");
+            Update(m_f_DeltaTime);
+        }
+        PumpTextureUploads();
+        {
+            TRACE_SCOPE("Render");
+            Render();
+        }
     }
 }
 
-void Application::RunTraining(int maxSteps) {
+int Application::RunBenchmark(const BenchmarkOptions& options) {
     const float k_FixedDt = 1.0f / 60.0f;
-    m_b_Running = true;
+    const int k_MaxResidencyFrames = 600;
+    const uint32_t k_BenchmarkSeed = 1;
+
+    CameraPath path = CameraPath::MakeDefault();
+    if (!options.s_CameraPath.empty() && !path.Load(options.s_CameraPath)) {
+        return 1;
+    }
+
+    auto* p_Game = dynamic_cast<States::GameState*>(m_p_StateManager->GetState("game"));
+    if (!p_Game || m_b_TrainingMode) {
+        std::cerr << "[Benchmark] ERROR: Needs the game state and a GL context" << std::endl;
+        return 1;
+    }
+    // Same starting positions every run, so runs render the same scene
+    p_Game->SetStartSeed(k_BenchmarkSeed);
+    m_p_StateManager->ChangeState("game");
 
-    for (int i = 0; i < maxSteps && m_b_Running && !m_p_StateManager->IsEmpty(); ++i) {
+    m_b_Running = true;
+    m_f_DeltaTime = k_FixedDt;
+    auto fn_Frame = [&](float f_T) {
+        TRACE_SCOPE("Frame");
+        HandleEvents();
         Update(k_FixedDt);
+        // After Update() so camera physics cannot nudge the scripted pose
+        CameraKey key = path.Sample(f_T);
+        p_Game->SetCameraPose(key.vec3_Position, key.f_Pitch);
+        PumpTextureUploads();
+        Render();
+        // Count the GPU's share too; the swap alone does not wait for it
+        glFinish();
+    };
+
+    // Async textures first, so no measured frame pays for an upload slice
+    int i_Warmup = 0;
+    while (m_b_Running && (i_Warmup < options.i_WarmupFrames ||
+                           !m_map_PendingTextures.empty() || m_i_TextureDecodesInFlight.load() > 0)) {
+        fn_Frame(0.0f);
+        if (++i_Warmup >= options.i_WarmupFrames + k_MaxResidencyFrames) {
+            std::cerr << "[Benchmark] Warning: Textures still loading after warm-up, measuring anyway" << std::endl;
+            break;
+        }
+    }
+
+    std::vector<double> vec_FrameMs;
+    vec_FrameMs.reserve(options.i_Frames);
+    std::vector<unsigned char> vec_Snapshot;
+    if (options.i_SnapshotEvery > 0 && !options.s_SnapshotDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(options.s_SnapshotDir, ec);
     }
+
+    for (int i = 0; i < options.i_Frames && m_b_Running; ++i) {
+        float f_T = options.i_Frames > 1 ? static_cast<float>(i) / (options.i_Frames - 1) : 0.0f;
+        const bool b_Snapshot = options.i_SnapshotEvery > 0 && !options.s_SnapshotDir.empty() &&
+                                i % options.i_SnapshotEvery == 0;
+        // Read from the back buffer before the swap: the front buffer of a
+        // hidden window or pbuffer need not hold the frame
+        if (b_Snapshot) {
+            vec_Snapshot.clear();
+            p_Game->CaptureNextFrame(&vec_Snapshot, m_i_Width, m_i_Height);
+        }
+
+        auto t_Start = std::chrono::steady_clock::now();
+        fn_Frame(f_T);
+        auto t_End = std::chrono::steady_clock::now();
+        vec_FrameMs.push_back(std::chrono::duration<double, std::milli>(t_End - t_Start).count());
+        if (b_Snapshot) {
+            p_Game->CaptureNextFrame(nullptr, 0, 0);
+        }
+
+        if (b_Snapshot && !vec_Snapshot.empty()) {
+            char arr_Name[32];
+            std::snprintf(arr_Name, sizeof(arr_Name), "frame_%05d.png", i);
+            std::filesystem::path snapshotPath = std::filesystem::path(options.s_SnapshotDir) / arr_Name;
+            Utils::PngWriter::Write(snapshotPath.string(), vec_Snapshot.data(), m_i_Width, m_i_Height, 3, true);
+        }
+    }
+
+    FrameTimeStats stats = FrameTimeStats::Compute(vec_FrameMs);
+    stats.Print();
+    if (!options.s_FrameTimesPath.empty() && !stats.WriteCsv(options.s_FrameTimesPath, vec_FrameMs)) {
+        return 1;
+    }
+    return vec_FrameMs.empty() ? 1 : 0;
 }
 
 void Application::HandleEvents() {
@@ -192,23 +361,26 @@ bool Application::InitializeFreeType() {
     const char* p_VertexShaderSrc = R"(
         #version 330 core
         layout (location = 0) in vec4 vertex;
+        layout (location = 1) in vec4 aColor;
         out vec2 TexCoords;
+        out vec4 TextColor;
         uniform mat4 projection;
         void main() {
             gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
             TexCoords = vertex.zw;
+            TextColor = aColor;
         }
     )";
 
     const char* p_FragmentShaderSrc = R"(
         #version 330 core
         in vec2 TexCoords;
+        in vec4 TextColor;
         out vec4 color;
         uniform sampler2D text;
-        uniform vec3 textColor;
         void main() {
             vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-            color = vec4(textColor, 1.0) * sampled;
+            color = TextColor * sampled;
         }
     )";
 
@@ -256,14 +428,13 @@ bool Application::InitializeFreeType() {
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 
-    // Create VAO and VBO for text rendering
+    // Create VAO and VBO for batched text quads (x, y, u, v, r, g, b, a)
     glGenVertexArrays(1, &m_VAO_Text);
     glGenBuffers(1, &m_VBO_Text);
     glBindVertexArray(m_VAO_Text);
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Text);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+    TextBatch::SetupVertexAttributes();
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
@@ -299,46 +470,82 @@ bool Application::InitializeFreeType() {
 
     // Use larger glyphs for better quality when scaling up in UI
     FT_Set_Pixel_Sizes(face, 0, 48);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    // Load ASCII character set
-    for (unsigned char c = 0; c < 128; c++) {
+    // Rasterize the ASCII set into CPU bitmaps and shelf-pack them into one atlas
+    std::vector<std::vector<unsigned char>> vec_Bitmaps(k_GlyphCount);
+    std::vector<int> vec_AtlasX(k_GlyphCount, 0);
+    std::vector<int> vec_AtlasY(k_GlyphCount, 0);
+    int i_PenX = k_GlyphAtlasPadding;
+    int i_PenY = k_GlyphAtlasPadding;
+    int i_RowHeight = 0;
+
+    for (unsigned char c = 0; c < k_GlyphCount; c++) {
         if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
             std::cerr << "Failed to load Glyph: " << c << std::endl;
             continue;
         }
 
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        int i_W = static_cast<int>(bitmap.width);
+        int i_H = static_cast<int>(bitmap.rows);
+
+        if (i_PenX + i_W + k_GlyphAtlasPadding > k_GlyphAtlasWidth) {
+            i_PenX = k_GlyphAtlasPadding;
+            i_PenY += i_RowHeight + k_GlyphAtlasPadding;
+            i_RowHeight = 0;
+        }
+
+        vec_AtlasX[c] = i_PenX;
+        vec_AtlasY[c] = i_PenY;
+        vec_Bitmaps[c].resize(static_cast<size_t>(i_W) * i_H);
+        for (int row = 0; row < i_H; ++row) {
+            const unsigned char* p_Src = bitmap.buffer + row * bitmap.pitch;
+            std::copy(p_Src, p_Src + i_W, vec_Bitmaps[c].begin() + static_cast<size_t>(row) * i_W);
+        }
+
+        Character& ch = m_arr_Characters[c];
+        ch.m_b_Loaded = true;
+        ch.m_i_Width = i_W;
+        ch.m_i_Height = i_H;
+        ch.m_i_BearingX = face->glyph->bitmap_left;
+        ch.m_i_BearingY = face->glyph->bitmap_top;
+        ch.m_i_Advance = static_cast<int>(face->glyph->advance.x);
+
+        i_PenX += i_W + k_GlyphAtlasPadding;
+        i_RowHeight = std::max(i_RowHeight, i_H);
+    }
+
+    int i_AtlasHeight = 1;
+    while (i_AtlasHeight < i_PenY + i_RowHeight + k_GlyphAtlasPadding) i_AtlasHeight <<= 1;
+
+    std::vector<unsigned char> vec_Atlas(static_cast<size_t>(k_GlyphAtlasWidth) * i_AtlasHeight, 0);
+    for (int c = 0; c < k_GlyphCount; ++c) {
+        Character& ch = m_arr_Characters[c];
+        if (!ch.m_b_Loaded) continue;
+
+        for (int row = 0; row < ch.m_i_Height; ++row) {
+            std::copy(vec_Bitmaps[c].begin() + static_cast<size_t>(row) * ch.m_i_Width,
+                      vec_Bitmaps[c].begin() + static_cast<size_t>(row + 1) * ch.m_i_Width,
+                      vec_Atlas.begin() + static_cast<size_t>(vec_AtlasY[c] + row) * k_GlyphAtlasWidth + vec_AtlasX[c]);
+        }
+
+        ch.m_f_U0 = float(vec_AtlasX[c]) / float(k_GlyphAtlasWidth);
+        ch.m_f_V0 = float(vec_AtlasY[c]) / float(i_AtlasHeight);
+        ch.m_f_U1 = float(vec_AtlasX[c] + ch.m_i_Width) / float(k_GlyphAtlasWidth);
+        ch.m_f_V1 = float(vec_AtlasY[c] + ch.m_i_Height) / float(i_AtlasHeight);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &m_TextureID_GlyphAtlas);
+    glBindTexture(GL_TEXTURE_2D, m_TextureID_GlyphAtlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, k_GlyphAtlasWidth, i_AtlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, vec_Atlas.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // Cap the mip chain so downsampled texels never reach across the padding into a neighbour glyph
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, k_GlyphAtlasMaxMipLevel);
     glGenerateMipmap(GL_TEXTURE_2D);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        Character character = {
-            texture,
-            static_cast<int>(face->glyph->bitmap.width),
-            static_cast<int>(face->glyph->bitmap.rows),
-            face->glyph->bitmap_left,
-            face->glyph->bitmap_top,
-            static_cast<int>(face->glyph->advance.x)
-        };
-        m_map_Characters.insert(std::pair<char, Character>(c, character));
-    }
     glBindTexture(GL_TEXTURE_2D, 0);
 
     FT_Done_Face(face);
@@ -348,10 +555,11 @@ bool Application::InitializeFreeType() {
 }
 
 void Application::ShutdownFreeType() {
-    for (auto& pair : m_map_Characters) {
-        glDeleteTextures(1, &pair.second.m_TextureID);
+    if (m_TextureID_GlyphAtlas) {
+        glDeleteTextures(1, &m_TextureID_GlyphAtlas);
+        m_TextureID_GlyphAtlas = 0;
     }
-    m_map_Characters.clear();
+    m_arr_Characters = CharacterTable{};
 
     if (m_VAO_Text) {
         glDeleteVertexArrays(1, &m_VAO_Text);
@@ -370,16 +578,23 @@ void Application::ShutdownFreeType() {
 
 bool Application::InitializeHUDResources() {
     // HUD Rounded Rectangle Shader
+    // Rect, radius and color are per-vertex so many rects can share one draw call
     const char* VS_R = R"(#version 330 core
         layout(location=0) in vec2 aPos;
+        layout(location=1) in vec4 aRect;
+        layout(location=2) in float aRadius;
+        layout(location=3) in vec4 aColor;
         out vec2 vPos;
-        void main(){ vPos=aPos; gl_Position=vec4(aPos,0.0,1.0); })";
+        out vec4 uRect;
+        out float uRadius;
+        out vec4 uColor;
+        void main(){ vPos=aPos; uRect=aRect; uRadius=aRadius; uColor=aColor; gl_Position=vec4(aPos,0.0,1.0); })";
 
     const char* FS_R = R"(#version 330 core
         in vec2 vPos;
-        uniform vec4 uRect;
-        uniform float uRadius;
-        uniform vec4 uColor;
+        in vec4 uRect;
+        in float uRadius;
+        in vec4 uColor;
         out vec4 FragColor;
         float sdRoundBox(in vec2 p, in vec2 b, in float r){
             vec2 d = abs(p) - b + vec2(r);
@@ -502,8 +717,7 @@ bool Application::InitializeHUDResources() {
     glBindVertexArray(m_VAO_HUDRounded);
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO_HUDRounded);
     glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    SetupHUDRoundedAttributes();
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
@@ -523,6 +737,18 @@ bool Application::InitializeHUDResources() {
     return true;
 }
 
+void Application::SetupHUDRoundedAttributes() {
+    const GLsizei i_Stride = k_HUDRoundedFloatsPerVertex * sizeof(float);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, i_Stride, (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, i_Stride, (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, i_Stride, (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, i_Stride, (void*)(7 * sizeof(float)));
+}
+
 void Application::ShutdownHUDResources() {
     if (m_VBO_HUDRounded) {
         glDeleteBuffers(1, &m_VBO_HUDRounded);
@@ -557,6 +783,25 @@ GLuint Application::LoadTexture(const std::string& s_Path) {
         return it->second;
     }
 
+    // A precompressed mip chain skips both decoding and mipmap generation
+    const std::string s_CachePath = Utils::CompressedTexture::CachePathFor(s_Path);
+    Utils::CompressedTexture compressed;
+    if (CanUseCompressedCache() && Utils::CompressedTexture::IsCacheFresh(s_CachePath, s_Path) &&
+        compressed.Open(s_CachePath)) {
+        GLuint textureID;
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        for (uint32_t i = 0; i < compressed.GetLevelCount(); ++i) {
+            UploadCompressedLevel(compressed, i);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(compressed.GetLevelCount() - 1));
+        SetMipmappedSampling();
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        m_map_TextureCache[s_Path] = textureID;
+        return textureID;
+    }
+
     // Load using stbi_load
     int i_Width, i_Height, i_Channels;
     unsigned char* p_Data = stbi_load(s_Path.c_str(), &i_Width, &i_Height, &i_Channels, 0);
@@ -567,24 +812,219 @@ GLuint Application::LoadTexture(const std::string& s_Path) {
 
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    UploadTextureImage(textureID, p_Data, i_Width, i_Height, i_Channels);
+    stbi_image_free(p_Data);
 
-    GLenum format = (i_Channels == 4) ? GL_RGBA : ((i_Channels == 3) ? GL_RGB : GL_RED);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, i_Width, i_Height, 0, format, GL_UNSIGNED_BYTE, p_Data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    m_map_TextureCache[s_Path] = textureID;
+    return textureID;
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+GLuint Application::LoadTextureAsync(const std::string& s_Path) {
+    auto it = m_map_TextureCache.find(s_Path);
+    if (it != m_map_TextureCache.end()) {
+        return it->second;
+    }
 
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, k_PlaceholderTexel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glBindTexture(GL_TEXTURE_2D, 0);
-    stbi_image_free(p_Data);
-
     m_map_TextureCache[s_Path] = textureID;
+
+    const uint64_t u64_Ticket = m_u64_NextTextureTicket++;
+    PendingTexture pending{};
+    pending.s_Path = s_Path;
+    pending.u64_Ticket = u64_Ticket;
+    m_map_PendingTextures[textureID] = std::move(pending);
+
+    // Shutdown() waits for m_i_TextureDecodesInFlight to drain, so capturing this is safe
+    const bool b_AllowCompressed = CanUseCompressedCache();
+    auto fn_Decode = [this, s_Path, textureID, u64_Ticket, b_AllowCompressed]() {
+        TRACE_SCOPE("Application::DecodeTexture");
+        // Released however this returns, or Shutdown() would wait forever
+        struct InFlightRelease {
+            std::atomic<int>& i_Count;
+            ~InFlightRelease() { i_Count.fetch_sub(1, std::memory_order_release); }
+        } release{m_i_TextureDecodesInFlight};
+
+        DecodedTexture decoded{textureID, u64_Ticket, nullptr, 0, 0, 0, nullptr};
+        try {
+            const std::string s_CachePath = Utils::CompressedTexture::CachePathFor(s_Path);
+            if (b_AllowCompressed && Utils::CompressedTexture::IsCacheFresh(s_CachePath, s_Path)) {
+                auto sp_Compressed = std::make_shared<Utils::CompressedTexture>();
+                if (sp_Compressed->Open(s_CachePath)) {
+                    decoded.sp_Compressed = std::move(sp_Compressed);
+                }
+            }
+            if (!decoded.sp_Compressed) {
+                decoded.p_Pixels = stbi_load(s_Path.c_str(), &decoded.i_Width, &decoded.i_Height, &decoded.i_Channels, 0);
+            }
+        } catch (const std::exception& e) {
+            // Handed over empty, so the texture keeps its placeholder
+            std::cerr << "[Application] ERROR: Decoding " << s_Path << " threw: " << e.what() << std::endl;
+            decoded.sp_Compressed.reset();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mtx_DecodedTextures);
+            m_vec_DecodedTextures.push_back(decoded);
+        }
+    };
+
+    m_i_TextureDecodesInFlight.fetch_add(1, std::memory_order_relaxed);
+    if (Threading::ThreadPool::GetThreadCount() > 0) {
+        Threading::ThreadPool::Submit(fn_Decode);
+    } else {
+        fn_Decode();
+    }
     return textureID;
 }
 
+void Application::PumpTextureUploads() {
+    if (m_map_PendingTextures.empty()) return;
+    TRACE_SCOPE("Application::PumpTextureUploads");
+
+    std::vector<DecodedTexture> vec_Decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx_DecodedTextures);
+        vec_Decoded.swap(m_vec_DecodedTextures);
+    }
+
+    for (const DecodedTexture& decoded : vec_Decoded) {
+        auto it = m_map_PendingTextures.find(decoded.textureID);
+        if (it == m_map_PendingTextures.end() || it->second.u64_Ticket != decoded.u64_Ticket) {
+            // Unloaded while decoding
+            stbi_image_free(decoded.p_Pixels);
+            continue;
+        }
+        if (!decoded.p_Pixels && !decoded.sp_Compressed) {
+            // Keeps the placeholder
+            std::cerr << "[Application] Failed to load texture: " << it->second.s_Path << std::endl;
+            m_map_PendingTextures.erase(it);
+            continue;
+        }
+
+        it->second.decoded = decoded;
+        if (decoded.sp_Compressed) {
+            it->second.i_NextLevel = static_cast<int>(decoded.sp_Compressed->GetLevelCount()) - 1;
+        } else {
+            it->second.num_Bytes = static_cast<size_t>(decoded.i_Width) * decoded.i_Height * decoded.i_Channels;
+        }
+    }
+
+    // Copy into a mapped PBO a slice at a time; the final glTexImage2D then
+    // sources from GPU-visible memory and the driver DMAs it without stalling
+    size_t num_Budget = k_TextureUploadBytesPerFrame;
+    for (auto it = m_map_PendingTextures.begin(); it != m_map_PendingTextures.end() && num_Budget > 0;) {
+        PendingTexture& pending = it->second;
+        const DecodedTexture& decoded = pending.decoded;
+        if (!decoded.p_Pixels && !decoded.sp_Compressed) {
+            ++it;
+            continue;
+        }
+
+        if (decoded.sp_Compressed) {
+            // Coarsest mip first, lowering GL_TEXTURE_BASE_LEVEL as finer ones land,
+            // so the texture is complete after every step and sharpens over a few frames
+            const Utils::CompressedTexture& compressed = *decoded.sp_Compressed;
+            glBindTexture(GL_TEXTURE_2D, it->first);
+            if (pending.i_NextLevel == static_cast<int>(compressed.GetLevelCount()) - 1) {
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pending.i_NextLevel);
+                SetMipmappedSampling();
+            }
+            while (pending.i_NextLevel >= 0 && num_Budget > 0) {
+                const uint32_t u32_Level = static_cast<uint32_t>(pending.i_NextLevel--);
+                UploadCompressedLevel(compressed, u32_Level);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(u32_Level));
+                num_Budget -= std::min<size_t>(num_Budget, static_cast<size_t>(compressed.GetLevel(u32_Level).u64_Size));
+            }
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            if (pending.i_NextLevel >= 0) {
+                ++it;
+                continue;
+            }
+            DiscardPendingTexture(pending);
+            it = m_map_PendingTextures.erase(it);
+            continue;
+        }
+
+        if (!pending.u_PixelBuffer) {
+            glGenBuffers(1, &pending.u_PixelBuffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pending.u_PixelBuffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(pending.num_Bytes), nullptr, GL_STREAM_DRAW);
+            pending.p_Mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                static_cast<GLsizeiptr>(pending.num_Bytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        bool b_FromPixelBuffer = false;
+        if (pending.p_Mapped) {
+            const size_t num_Slice = std::min(num_Budget, pending.num_Bytes - pending.num_Copied);
+            std::memcpy(pending.p_Mapped + pending.num_Copied, decoded.p_Pixels + pending.num_Copied, num_Slice);
+            pending.num_Copied += num_Slice;
+            num_Budget -= num_Slice;
+            if (pending.num_Copied < pending.num_Bytes) {
+                ++it;
+                continue;
+            }
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pending.u_PixelBuffer);
+            // GL_FALSE means the store was lost (e.g. display mode change); use client memory
+            b_FromPixelBuffer = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+            pending.p_Mapped = nullptr;
+            if (!b_FromPixelBuffer) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+        } else {
+            // Mapping failed; upload straight from client memory this frame
+            num_Budget = 0;
+        }
+
+        UploadTextureImage(it->first, b_FromPixelBuffer ? nullptr : decoded.p_Pixels,
+                           decoded.i_Width, decoded.i_Height, decoded.i_Channels);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        DiscardPendingTexture(pending);
+        it = m_map_PendingTextures.erase(it);
+    }
+}
+
+void Application::DiscardPendingTexture(PendingTexture& pending) {
+    if (pending.p_Mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pending.u_PixelBuffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pending.p_Mapped = nullptr;
+    }
+    if (pending.u_PixelBuffer) {
+        glDeleteBuffers(1, &pending.u_PixelBuffer);
+        pending.u_PixelBuffer = 0;
+    }
+    stbi_image_free(pending.decoded.p_Pixels);
+    pending.decoded.p_Pixels = nullptr;
+    pending.decoded.sp_Compressed.reset();
+}
+
+void Application::ReleasePendingTextures() {
+    // Decode tasks write into this object; let the in-flight ones land first
+    while (m_i_TextureDecodesInFlight.load(std::memory_order_acquire) > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (const DecodedTexture& decoded : m_vec_DecodedTextures) {
+        stbi_image_free(decoded.p_Pixels);
+    }
+    m_vec_DecodedTextures.clear();
+
+    for (auto& pair : m_map_PendingTextures) {
+        DiscardPendingTexture(pair.second);
+    }
+    m_map_PendingTextures.clear();
+}
+
 void Application::UnloadTexture(GLuint textureID) {
     if (textureID == 0) return;
 
@@ -596,6 +1036,12 @@ void Application::UnloadTexture(GLuint textureID) {
         }
     }
 
+    auto itPending = m_map_PendingTextures.find(textureID);
+    if (itPending != m_map_PendingTextures.end()) {
+        DiscardPendingTexture(itPending->second);
+        m_map_PendingTextures.erase(itPending);
+    }
+
     glDeleteTextures(1, &textureID);
 }
 
@@ -613,6 +1059,8 @@ void Application::Shutdown() {
     m_p_StateManager.reset();
 
     if (!m_b_TrainingMode) {
+        ReleasePendingTextures();
+
         // Clean up texture cache
         for (auto& pair : m_map_TextureCache) {
             glDeleteTextures(1, &pair.second);
@@ -0,0 +1,329 @@
+#include "BinaryMap.h"
+#include "CsvReader.h"
+#include "GameConstants.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Utils {
+
+namespace {
+    constexpr char k_Magic[4] = {'S', 'Y', 'M', 'B'};
+    constexpr uint64_t k_SectionAlignment = 8;
+
+    uint64_t AlignUp(uint64_t u64_Value) {
+        return (u64_Value + k_SectionAlignment - 1) & ~(k_SectionAlignment - 1);
+    }
+
+    int TransportTypeFromName(std::string_view sv_Name) {
+        sv_Name = CsvReader::Trim(sv_Name);
+        if (sv_Name == "taxi") return Core::k_TransportTypeTaxi;
+        if (sv_Name == "bus") return Core::k_TransportTypeBus;
+        if (sv_Name == "metro") return Core::k_TransportTypeMetro;
+        if (sv_Name == "water") return Core::k_TransportTypeWater;
+        return 0;
+    }
+
+    // "metro_bus_taxi" -> bit per transport type
+    uint32_t StationMaskFromField(std::string_view sv_Field) {
+        uint32_t u32_Mask = 0;
+        while (!sv_Field.empty()) {
+            size_t pos = sv_Field.find('_');
+            int i_Type = TransportTypeFromName(sv_Field.substr(0, pos));
+            if (i_Type > 0) u32_Mask |= BinaryMap::StationBit(i_Type);
+            if (pos == std::string_view::npos) break;
+            sv_Field.remove_prefix(pos + 1);
+        }
+        return u32_Mask;
+    }
+}
+
+BinaryMap::BinaryMap()
+    : m_p_Header(nullptr)
+    , m_p_Nodes(nullptr)
+    , m_p_EdgeOffsets(nullptr)
+    , m_p_EdgeTargets(nullptr)
+    , m_p_EdgeTypes(nullptr)
+{
+}
+
+uint64_t BinaryMap::Checksum(const void* p_Data, size_t num_Bytes) {
+    const unsigned char* p_Bytes = static_cast<const unsigned char*>(p_Data);
+    uint64_t u64_Hash = 14695981039346656037ull;
+    for (size_t i = 0; i < num_Bytes; ++i) {
+        u64_Hash ^= p_Bytes[i];
+        u64_Hash *= 1099511628211ull;
+    }
+    return u64_Hash;
+}
+
+BinaryMapSource BinaryMap::StampSource(const std::string& s_Path) {
+    BinaryMapSource source{};
+    std::error_code ec;
+    const uintmax_t u64_Size = std::filesystem::file_size(s_Path, ec);
+    if (ec) return source;
+    const std::filesystem::file_time_type t_Modified = std::filesystem::last_write_time(s_Path, ec);
+    if (ec) return source;
+
+    source.u64_Size = static_cast<uint64_t>(u64_Size);
+    source.i64_ModifiedTime = static_cast<int64_t>(t_Modified.time_since_epoch().count());
+    return source;
+}
+
+bool BinaryMap::IsUpToDate(const std::string& s_NodesPath, const std::string& s_ConnectionsPath) const {
+    if (!m_p_Header) return false;
+
+    const BinaryMapSource* p_Sources = m_p_Header->arr_Sources;
+    auto isUnset = [](const BinaryMapSource& source) {
+        return source.u64_Size == 0 && source.i64_ModifiedTime == 0;
+    };
+    if (isUnset(p_Sources[0]) && isUnset(p_Sources[1])) return true;
+
+    auto matches = [](const BinaryMapSource& recorded, const std::string& s_Path) {
+        const BinaryMapSource current = StampSource(s_Path);
+        return current.u64_Size == recorded.u64_Size && current.i64_ModifiedTime == recorded.i64_ModifiedTime;
+    };
+    return matches(p_Sources[0], s_NodesPath) && matches(p_Sources[1], s_ConnectionsPath);
+}
+
+bool BinaryMap::Open(const std::string& s_Path) {
+    Close();
+
+    if (!m_File.Open(s_Path)) {
+        return false;
+    }
+
+    if (!Validate(s_Path)) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void BinaryMap::Close() {
+    m_File.Close();
+    m_p_Header = nullptr;
+    m_p_Nodes = nullptr;
+    m_p_EdgeOffsets = nullptr;
+    m_p_EdgeTargets = nullptr;
+    m_p_EdgeTypes = nullptr;
+}
+
+bool BinaryMap::Validate(const std::string& s_Path) {
+    const char* p_Data = m_File.GetData();
+    const uint64_t u64_Size = m_File.GetSize();
+
+    auto fail = [&](const char* p_Reason) {
+        std::cerr << "[BinaryMap] ERROR: " << s_Path << ": " << p_Reason << std::endl;
+        return false;
+    };
+
+    if (u64_Size < sizeof(BinaryMapHeader)) return fail("file too small");
+
+    const BinaryMapHeader* p_Header = reinterpret_cast<const BinaryMapHeader*>(p_Data);
+    if (std::memcmp(p_Header->arr_Magic, k_Magic, sizeof(k_Magic)) != 0) return fail("not a binary map");
+    if (p_Header->u32_Version != k_Version) return fail("unsupported version, recompile with mapc");
+    if (p_Header->u64_HeaderChecksum != Checksum(p_Header, offsetof(BinaryMapHeader, u64_HeaderChecksum))) {
+        return fail("header checksum mismatch");
+    }
+    if (p_Header->u64_FileSize != u64_Size) return fail("truncated file");
+
+    const uint64_t u64_NodeCount = p_Header->u32_NodeCount;
+    const uint64_t u64_EdgeCount = p_Header->u32_EdgeCount;
+
+    auto sectionFits = [&](uint64_t u64_Offset, uint64_t u64_Bytes) {
+        return u64_Offset % k_SectionAlignment == 0
+            && u64_Offset >= sizeof(BinaryMapHeader)
+            && u64_Offset <= u64_Size
+            && u64_Bytes <= u64_Size - u64_Offset;
+    };
+
+    if (!sectionFits(p_Header->u64_NodeTableOffset, u64_NodeCount * sizeof(BinaryMapNode)) ||
+        !sectionFits(p_Header->u64_EdgeOffsetsOffset, (u64_NodeCount + 1) * sizeof(uint32_t)) ||
+        !sectionFits(p_Header->u64_EdgeTargetsOffset, u64_EdgeCount * sizeof(uint32_t)) ||
+        !sectionFits(p_Header->u64_EdgeTypesOffset, u64_EdgeCount * sizeof(uint8_t))) {
+        return fail("section out of bounds");
+    }
+
+    const size_t num_PayloadBytes = static_cast<size_t>(u64_Size - sizeof(BinaryMapHeader));
+    if (p_Header->u64_PayloadChecksum != Checksum(p_Data + sizeof(BinaryMapHeader), num_PayloadBytes)) {
+        return fail("payload checksum mismatch");
+    }
+
+    const uint32_t* p_Offsets = reinterpret_cast<const uint32_t*>(p_Data + p_Header->u64_EdgeOffsetsOffset);
+    const uint32_t* p_Targets = reinterpret_cast<const uint32_t*>(p_Data + p_Header->u64_EdgeTargetsOffset);
+
+    // Cheap structural checks so callers can index without bounds tests
+    if (p_Offsets[0] != 0 || p_Offsets[u64_NodeCount] != u64_EdgeCount) return fail("bad edge offsets");
+    for (uint64_t i = 0; i < u64_NodeCount; ++i) {
+        if (p_Offsets[i] > p_Offsets[i + 1]) return fail("bad edge offsets");
+    }
+    for (uint64_t e = 0; e < u64_EdgeCount; ++e) {
+        if (p_Targets[e] >= u64_NodeCount) return fail("edge target out of range");
+    }
+
+    m_p_Header = p_Header;
+    m_p_Nodes = reinterpret_cast<const BinaryMapNode*>(p_Data + p_Header->u64_NodeTableOffset);
+    m_p_EdgeOffsets = p_Offsets;
+    m_p_EdgeTargets = p_Targets;
+    m_p_EdgeTypes = reinterpret_cast<const uint8_t*>(p_Data + p_Header->u64_EdgeTypesOffset);
+    return true;
+}
+
+bool BinaryMap::Compile(const std::string& s_NodesPath, const std::string& s_ConnectionsPath,
+                        const std::string& s_OutputPath) {
+    // Stamped before reading, so an edit made while compiling still reads as newer
+    const BinaryMapSource arr_Sources[2] = {StampSource(s_NodesPath), StampSource(s_ConnectionsPath)};
+
+    // Nodes: id,pos_x,pos_y,station_type
+    CsvReader nodesReader;
+    if (!nodesReader.Open(s_NodesPath)) {
+        return false;
+    }
+
+    std::vector<BinaryMapNode> vec_Nodes;
+    vec_Nodes.reserve(nodesReader.EstimateRowCount());
+    std::unordered_map<int, uint32_t> map_IndexById;
+    map_IndexById.reserve(nodesReader.EstimateRowCount());
+    size_t num_SkippedNodes = 0;
+
+    nodesReader.NextRow(); // header
+    while (nodesReader.NextRow()) {
+        BinaryMapNode node{};
+        int i_Id = 0;
+        if (!CsvReader::ParseInt(nodesReader.GetField(0), i_Id) ||
+            !CsvReader::ParseFloat(nodesReader.GetField(1), node.f_X) ||
+            !CsvReader::ParseFloat(nodesReader.GetField(2), node.f_Y) ||
+            map_IndexById.count(i_Id) != 0) {
+            ++num_SkippedNodes;
+            continue;
+        }
+
+        node.i32_Id = i_Id;
+        node.u32_StationMask = StationMaskFromField(nodesReader.GetField(3));
+        map_IndexById.emplace(i_Id, static_cast<uint32_t>(vec_Nodes.size()));
+        vec_Nodes.push_back(node);
+    }
+
+    // Connections: source,destination,connection_type
+    CsvReader connectionsReader;
+    if (!connectionsReader.Open(s_ConnectionsPath)) {
+        return false;
+    }
+
+    std::vector<BinaryMapConnection> vec_Connections;
+    vec_Connections.reserve(connectionsReader.EstimateRowCount());
+    size_t num_SkippedConnections = 0;
+
+    connectionsReader.NextRow(); // header
+    while (connectionsReader.NextRow()) {
+        int i_Source = 0, i_Target = 0;
+        int i_Type = TransportTypeFromName(connectionsReader.GetField(2));
+        if (!CsvReader::ParseInt(connectionsReader.GetField(0), i_Source) ||
+            !CsvReader::ParseInt(connectionsReader.GetField(1), i_Target) ||
+            i_Type == 0 || i_Source == i_Target) {
+            ++num_SkippedConnections;
+            continue;
+        }
+
+        auto itSource = map_IndexById.find(i_Source);
+        auto itTarget = map_IndexById.find(i_Target);
+        if (itSource == map_IndexById.end() || itTarget == map_IndexById.end()) {
+            ++num_SkippedConnections;
+            continue;
+        }
+
+        vec_Connections.push_back({itSource->second, itTarget->second, static_cast<uint8_t>(i_Type)});
+    }
+
+    if (num_SkippedNodes > 0 || num_SkippedConnections > 0) {
+        std::cout << "[BinaryMap] Skipped " << num_SkippedNodes << " node rows and "
+                  << num_SkippedConnections << " connection rows" << std::endl;
+    }
+
+    return Write(s_OutputPath, vec_Nodes, vec_Connections, arr_Sources);
+}
+
+bool BinaryMap::Write(const std::string& s_OutputPath, const std::vector<BinaryMapNode>& vec_Nodes,
+                      const std::vector<BinaryMapConnection>& vec_Connections,
+                      const BinaryMapSource* p_Sources) {
+    // CSR: count degrees, prefix-sum, then scatter both directions in file order
+    const uint32_t u32_NodeCount = static_cast<uint32_t>(vec_Nodes.size());
+    const uint32_t u32_EdgeCount = static_cast<uint32_t>(vec_Connections.size() * 2);
+
+    std::vector<uint32_t> vec_Offsets(u32_NodeCount + 1, 0);
+    for (const BinaryMapConnection& edge : vec_Connections) {
+        ++vec_Offsets[edge.u32_Source + 1];
+        ++vec_Offsets[edge.u32_Target + 1];
+    }
+    for (uint32_t i = 0; i < u32_NodeCount; ++i) {
+        vec_Offsets[i + 1] += vec_Offsets[i];
+    }
+
+    std::vector<uint32_t> vec_Targets(u32_EdgeCount);
+    std::vector<uint8_t> vec_Types(u32_EdgeCount);
+    std::vector<uint32_t> vec_Cursor(vec_Offsets.begin(), vec_Offsets.end() - 1);
+    for (const BinaryMapConnection& edge : vec_Connections) {
+        uint32_t u32_A = vec_Cursor[edge.u32_Source]++;
+        vec_Targets[u32_A] = edge.u32_Target;
+        vec_Types[u32_A] = edge.u8_Type;
+
+        uint32_t u32_B = vec_Cursor[edge.u32_Target]++;
+        vec_Targets[u32_B] = edge.u32_Source;
+        vec_Types[u32_B] = edge.u8_Type;
+    }
+
+    // Lay out sections and assemble the payload in memory so it can be checksummed
+    BinaryMapHeader header{};
+    std::memcpy(header.arr_Magic, k_Magic, sizeof(k_Magic));
+    header.u32_Version = k_Version;
+    header.u32_NodeCount = u32_NodeCount;
+    header.u32_EdgeCount = u32_EdgeCount;
+    header.u64_NodeTableOffset = AlignUp(sizeof(BinaryMapHeader));
+    header.u64_EdgeOffsetsOffset = AlignUp(header.u64_NodeTableOffset + vec_Nodes.size() * sizeof(BinaryMapNode));
+    header.u64_EdgeTargetsOffset = AlignUp(header.u64_EdgeOffsetsOffset + vec_Offsets.size() * sizeof(uint32_t));
+    header.u64_EdgeTypesOffset = AlignUp(header.u64_EdgeTargetsOffset + vec_Targets.size() * sizeof(uint32_t));
+    header.u64_FileSize = AlignUp(header.u64_EdgeTypesOffset + vec_Types.size() * sizeof(uint8_t));
+    if (p_Sources) {
+        header.arr_Sources[0] = p_Sources[0];
+        header.arr_Sources[1] = p_Sources[1];
+    }
+
+    std::vector<char> vec_Payload(static_cast<size_t>(header.u64_FileSize - sizeof(BinaryMapHeader)), 0);
+    auto place = [&](uint64_t u64_Offset, const void* p_Src, size_t num_Bytes) {
+        if (num_Bytes > 0) {
+            std::memcpy(vec_Payload.data() + (u64_Offset - sizeof(BinaryMapHeader)), p_Src, num_Bytes);
+        }
+    };
+    place(header.u64_NodeTableOffset, vec_Nodes.data(), vec_Nodes.size() * sizeof(BinaryMapNode));
+    place(header.u64_EdgeOffsetsOffset, vec_Offsets.data(), vec_Offsets.size() * sizeof(uint32_t));
+    place(header.u64_EdgeTargetsOffset, vec_Targets.data(), vec_Targets.size() * sizeof(uint32_t));
+    place(header.u64_EdgeTypesOffset, vec_Types.data(), vec_Types.size() * sizeof(uint8_t));
+
+    header.u64_PayloadChecksum = Checksum(vec_Payload.data(), vec_Payload.size());
+    header.u64_HeaderChecksum = Checksum(&header, offsetof(BinaryMapHeader, u64_HeaderChecksum));
+
+    std::ofstream file(s_OutputPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[BinaryMap] ERROR: Could not open " << s_OutputPath << " for writing" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(vec_Payload.data(), static_cast<std::streamsize>(vec_Payload.size()));
+    if (!file.good()) {
+        std::cerr << "[BinaryMap] ERROR: Failed writing " << s_OutputPath << std::endl;
+        return false;
+    }
+
+    std::cout << "[BinaryMap] Wrote " << s_OutputPath << ": " << u32_NodeCount << " nodes, "
+              << vec_Connections.size() << " connections, " << header.u64_FileSize << " bytes" << std::endl;
+    return true;
+}
+} // namespace Utils
+} // namespace ScotlandYard
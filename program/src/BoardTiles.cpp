@@ -0,0 +1,257 @@
+#include "BoardTiles.h"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+namespace ScotlandYard {
+namespace Core {
+
+namespace {
+
+constexpr int k_FloatsPerVertex = 8;    // position, colour, UV; matches the plane shader
+constexpr int k_VerticesPerTile = 6;
+
+void AppendVertex(std::vector<float>& vec_Vertices, float f_X, float f_Z, float f_U, float f_V) {
+    const float arr_Vertex[k_FloatsPerVertex] = { f_X, 0.0f, f_Z, 0.0f, 1.0f, 0.0f, f_U, f_V };
+    vec_Vertices.insert(vec_Vertices.end(), arr_Vertex, arr_Vertex + k_FloatsPerVertex);
+}
+
+} // namespace
+
+BoardTiles::BoardTiles()
+    : m_vec2_BoardMin(0.0f)
+    , m_vec2_BoardSize(0.0f)
+    , m_VAO_Board(0)
+    , m_VBO_Board(0)
+    , m_VAO_Stations(0)
+    , m_VBO_StationInstances(0)
+{
+}
+
+bool BoardTiles::Initialize(const glm::vec2& vec2_BoardMin, const glm::vec2& vec2_BoardMax,
+                            const std::vector<StationInstance>& vec_Instances, const std::vector<uint32_t>& vec_StationOffsets,
+                            GLuint u_CircleVBO, float f_CircleRadius) {
+    Shutdown();
+
+    if (!(vec2_BoardMax.x > vec2_BoardMin.x && vec2_BoardMax.y > vec2_BoardMin.y)) {
+        std::cerr << "[BoardTiles] ERROR: Empty board extent" << std::endl;
+        return false;
+    }
+    if (vec_StationOffsets.empty() || vec_StationOffsets.back() != vec_Instances.size()) {
+        std::cerr << "[BoardTiles] ERROR: Station offsets do not cover the ring instances" << std::endl;
+        return false;
+    }
+
+    m_vec2_BoardMin = vec2_BoardMin;
+    m_vec2_BoardSize = vec2_BoardMax - vec2_BoardMin;
+
+    // Board: every node of the full tree gets a quad, so any cut through it is drawable
+    std::vector<float> vec_Vertices;
+    BuildBoardNode(vec2_BoardMin, vec2_BoardMax, 0, vec_Vertices);
+
+    glGenVertexArrays(1, &m_VAO_Board);
+    glGenBuffers(1, &m_VBO_Board);
+    glBindVertexArray(m_VAO_Board);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Board);
+    glBufferData(GL_ARRAY_BUFFER, vec_Vertices.size() * sizeof(float), vec_Vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, k_FloatsPerVertex * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, k_FloatsPerVertex * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, k_FloatsPerVertex * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // Stations: one box per station around all of its rings
+    size_t num_Stations = vec_StationOffsets.size() - 1;
+    std::vector<glm::vec3> vec_Min(num_Stations);
+    std::vector<glm::vec3> vec_Max(num_Stations);
+    for (size_t i = 0; i < num_Stations; ++i) {
+        vec_Min[i] = glm::vec3(0.0f);
+        vec_Max[i] = glm::vec3(0.0f);
+        for (uint32_t j = vec_StationOffsets[i]; j < vec_StationOffsets[i + 1]; ++j) {
+            const glm::vec4& vec4_Ring = vec_Instances[j].vec4_PositionScale;
+            float f_Radius = f_CircleRadius * vec4_Ring.w;
+            glm::vec3 vec3_RingMin(vec4_Ring.x - f_Radius, vec4_Ring.y, vec4_Ring.z - f_Radius);
+            glm::vec3 vec3_RingMax(vec4_Ring.x + f_Radius, vec4_Ring.y + f_Radius, vec4_Ring.z + f_Radius);
+            bool b_First = j == vec_StationOffsets[i];
+            vec_Min[i] = b_First ? vec3_RingMin : glm::min(vec_Min[i], vec3_RingMin);
+            vec_Max[i] = b_First ? vec3_RingMax : glm::max(vec_Max[i], vec3_RingMax);
+        }
+    }
+    m_StationBvh.Build(vec_Min, vec_Max);
+
+    // Rings in BVH order, so every node is one contiguous run of instances
+    std::vector<StationInstance> vec_Ordered;
+    vec_Ordered.reserve(vec_Instances.size());
+    m_vec_InstanceOffsets.reserve(num_Stations + 1);
+    for (uint32_t u32_Station : m_StationBvh.GetItemOrder()) {
+        m_vec_InstanceOffsets.push_back(static_cast<uint32_t>(vec_Ordered.size()));
+        vec_Ordered.insert(vec_Ordered.end(), vec_Instances.begin() + vec_StationOffsets[u32_Station],
+                           vec_Instances.begin() + vec_StationOffsets[u32_Station + 1]);
+    }
+    m_vec_InstanceOffsets.push_back(static_cast<uint32_t>(vec_Ordered.size()));
+
+    glGenVertexArrays(1, &m_VAO_Stations);
+    glGenBuffers(1, &m_VBO_StationInstances);
+    glBindVertexArray(m_VAO_Stations);
+    glBindBuffer(GL_ARRAY_BUFFER, u_CircleVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Instance pointers are re-aimed at each range in DrawStations()
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_StationInstances);
+    glBufferData(GL_ARRAY_BUFFER, vec_Ordered.size() * sizeof(StationInstance), vec_Ordered.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void BoardTiles::Shutdown() {
+    if (m_VAO_Board) {
+        glDeleteVertexArrays(1, &m_VAO_Board);
+        m_VAO_Board = 0;
+    }
+    if (m_VBO_Board) {
+        glDeleteBuffers(1, &m_VBO_Board);
+        m_VBO_Board = 0;
+    }
+    if (m_VAO_Stations) {
+        glDeleteVertexArrays(1, &m_VAO_Stations);
+        m_VAO_Stations = 0;
+    }
+    if (m_VBO_StationInstances) {
+        glDeleteBuffers(1, &m_VBO_StationInstances);
+        m_VBO_StationInstances = 0;
+    }
+
+    m_vec_BoardNodes.clear();
+    m_vec_BoardFirsts.clear();
+    m_vec_BoardCounts.clear();
+    m_StationBvh.Clear();
+    m_vec_InstanceOffsets.clear();
+    m_vec_VisibleStations.clear();
+    m_vec_InstanceRanges.clear();
+}
+
+int BoardTiles::BuildBoardNode(const glm::vec2& vec2_Min, const glm::vec2& vec2_Max, int i_Depth,
+                               std::vector<float>& vec_Vertices) {
+    int i_Index = static_cast<int>(m_vec_BoardNodes.size());
+
+    Node node;
+    node.vec3_Min = glm::vec3(vec2_Min.x, 0.0f, vec2_Min.y);
+    node.vec3_Max = glm::vec3(vec2_Max.x, 0.0f, vec2_Max.y);
+    std::fill(node.arr_Children, node.arr_Children + 4, -1);
+    node.u32_First = static_cast<uint32_t>(vec_Vertices.size() / k_FloatsPerVertex);
+    node.u32_Count = k_VerticesPerTile;
+    m_vec_BoardNodes.push_back(node);
+
+    glm::vec2 vec2_UV0 = (vec2_Min - m_vec2_BoardMin) / m_vec2_BoardSize;
+    glm::vec2 vec2_UV1 = (vec2_Max - m_vec2_BoardMin) / m_vec2_BoardSize;
+    AppendVertex(vec_Vertices, vec2_Min.x, vec2_Min.y, vec2_UV0.x, vec2_UV0.y);
+    AppendVertex(vec_Vertices, vec2_Max.x, vec2_Min.y, vec2_UV1.x, vec2_UV0.y);
+    AppendVertex(vec_Vertices, vec2_Max.x, vec2_Max.y, vec2_UV1.x, vec2_UV1.y);
+    AppendVertex(vec_Vertices, vec2_Min.x, vec2_Min.y, vec2_UV0.x, vec2_UV0.y);
+    AppendVertex(vec_Vertices, vec2_Max.x, vec2_Max.y, vec2_UV1.x, vec2_UV1.y);
+    AppendVertex(vec_Vertices, vec2_Min.x, vec2_Max.y, vec2_UV0.x, vec2_UV1.y);
+
+    if (i_Depth < k_BoardDepth) {
+        glm::vec2 vec2_Mid = (vec2_Min + vec2_Max) * 0.5f;
+        int arr_Children[4] = {
+            BuildBoardNode(vec2_Min, vec2_Mid, i_Depth + 1, vec_Vertices),
+            BuildBoardNode(glm::vec2(vec2_Mid.x, vec2_Min.y), glm::vec2(vec2_Max.x, vec2_Mid.y), i_Depth + 1, vec_Vertices),
+            BuildBoardNode(glm::vec2(vec2_Min.x, vec2_Mid.y), glm::vec2(vec2_Mid.x, vec2_Max.y), i_Depth + 1, vec_Vertices),
+            BuildBoardNode(vec2_Mid, vec2_Max, i_Depth + 1, vec_Vertices)
+        };
+        std::copy(arr_Children, arr_Children + 4, m_vec_BoardNodes[i_Index].arr_Children);
+    }
+
+    return i_Index;
+}
+
+void BoardTiles::SelectBoardTiles(const Frustum& frustum, const glm::vec3& vec3_CameraPosition) {
+    m_vec_BoardFirsts.clear();
+    m_vec_BoardCounts.clear();
+    if (!m_vec_BoardNodes.empty()) {
+        SelectBoardNode(0, frustum, vec3_CameraPosition);
+    }
+}
+
+void BoardTiles::SelectBoardNode(int i_Node, const Frustum& frustum, const glm::vec3& vec3_CameraPosition) {
+    const Node& node = m_vec_BoardNodes[i_Node];
+
+    Frustum::Result result = frustum.TestBox(node.vec3_Min, node.vec3_Max);
+    if (result == Frustum::Result::Outside) return;
+
+    bool b_Leaf = node.arr_Children[0] < 0;
+    if (result == Frustum::Result::Intersects && !b_Leaf) {
+        glm::vec3 vec3_Centre = (node.vec3_Min + node.vec3_Max) * 0.5f;
+        float f_Edge = node.vec3_Max.x - node.vec3_Min.x;
+        float f_Distance = glm::length(vec3_Centre - vec3_CameraPosition);
+
+        if (f_Edge > f_Distance * k_BoardSplitRatio) {
+            for (int i_Child : node.arr_Children) {
+                SelectBoardNode(i_Child, frustum, vec3_CameraPosition);
+            }
+            return;
+        }
+    }
+
+    m_vec_BoardFirsts.push_back(static_cast<GLint>(node.u32_First));
+    m_vec_BoardCounts.push_back(static_cast<GLsizei>(node.u32_Count));
+}
+
+void BoardTiles::DrawBoard() const {
+    if (m_vec_BoardFirsts.empty()) return;
+
+    glBindVertexArray(m_VAO_Board);
+    glMultiDrawArrays(GL_TRIANGLES, m_vec_BoardFirsts.data(), m_vec_BoardCounts.data(),
+                      static_cast<GLsizei>(m_vec_BoardFirsts.size()));
+    glBindVertexArray(0);
+}
+
+void BoardTiles::SelectStations(const Frustum& frustum) {
+    m_StationBvh.Cull(frustum, m_vec_VisibleStations);
+
+    m_vec_InstanceRanges.clear();
+    for (const Bvh::Range& stations : m_vec_VisibleStations) {
+        uint32_t u32_First = m_vec_InstanceOffsets[stations.u32_First];
+        uint32_t u32_End = m_vec_InstanceOffsets[stations.u32_First + stations.u32_Count];
+        m_vec_InstanceRanges.push_back({ u32_First, u32_End - u32_First });
+    }
+}
+
+void BoardTiles::DrawStations(int i_CircleVertexCount) const {
+    if (m_vec_InstanceRanges.empty()) return;
+
+    glBindVertexArray(m_VAO_Stations);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_StationInstances);
+
+    // GL 3.3 has no base instance, so the instance attributes are offset per range instead
+    for (const Bvh::Range& range : m_vec_InstanceRanges) {
+        size_t num_Offset = static_cast<size_t>(range.u32_First) * sizeof(StationInstance);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(StationInstance),
+                              (void*)(num_Offset + offsetof(StationInstance, vec4_PositionScale)));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(StationInstance),
+                              (void*)(num_Offset + offsetof(StationInstance, vec4_Color)));
+        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, i_CircleVertexCount, static_cast<GLsizei>(range.u32_Count));
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+uint32_t BoardTiles::GetDrawnStationInstanceCount() const {
+    uint32_t u32_Count = 0;
+    for (const Bvh::Range& range : m_vec_InstanceRanges) {
+        u32_Count += range.u32_Count;
+    }
+    return u32_Count;
+}
+
+} // namespace Core
+} // namespace ScotlandYard
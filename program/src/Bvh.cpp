@@ -0,0 +1,103 @@
+#include "Bvh.h"
+#include <algorithm>
+
+namespace ScotlandYard {
+namespace Core {
+
+void Bvh::Build(const std::vector<glm::vec3>& vec_Min, const std::vector<glm::vec3>& vec_Max) {
+    Clear();
+    if (vec_Min.empty() || vec_Min.size() != vec_Max.size()) return;
+
+    uint32_t u32_Count = static_cast<uint32_t>(vec_Min.size());
+    std::vector<glm::vec3> vec_Centroids(u32_Count);
+    m_vec_ItemOrder.resize(u32_Count);
+    for (uint32_t i = 0; i < u32_Count; ++i) {
+        vec_Centroids[i] = (vec_Min[i] + vec_Max[i]) * 0.5f;
+        m_vec_ItemOrder[i] = i;
+    }
+
+    m_vec_Nodes.reserve(2 * (u32_Count / k_MaxLeafItems + 1));
+    BuildNode(0, u32_Count, vec_Min, vec_Max, vec_Centroids);
+}
+
+void Bvh::Clear() {
+    m_vec_Nodes.clear();
+    m_vec_ItemOrder.clear();
+}
+
+int Bvh::BuildNode(uint32_t u32_First, uint32_t u32_Count, const std::vector<glm::vec3>& vec_Min,
+                   const std::vector<glm::vec3>& vec_Max, const std::vector<glm::vec3>& vec_Centroids) {
+    auto it_Begin = m_vec_ItemOrder.begin() + u32_First;
+    auto it_End = it_Begin + u32_Count;
+
+    Node node;
+    node.vec3_Min = vec_Min[*it_Begin];
+    node.vec3_Max = vec_Max[*it_Begin];
+    glm::vec3 vec3_CentroidMin = vec_Centroids[*it_Begin];
+    glm::vec3 vec3_CentroidMax = vec3_CentroidMin;
+    for (auto it = it_Begin; it != it_End; ++it) {
+        node.vec3_Min = glm::min(node.vec3_Min, vec_Min[*it]);
+        node.vec3_Max = glm::max(node.vec3_Max, vec_Max[*it]);
+        vec3_CentroidMin = glm::min(vec3_CentroidMin, vec_Centroids[*it]);
+        vec3_CentroidMax = glm::max(vec3_CentroidMax, vec_Centroids[*it]);
+    }
+    node.u32_First = u32_First;
+    node.u32_Count = u32_Count;
+    node.i_Right = -1;
+
+    int i_Index = static_cast<int>(m_vec_Nodes.size());
+    m_vec_Nodes.push_back(node);
+
+    glm::vec3 vec3_Extent = vec3_CentroidMax - vec3_CentroidMin;
+    int i_Axis = 0;
+    if (vec3_Extent.y > vec3_Extent[i_Axis]) i_Axis = 1;
+    if (vec3_Extent.z > vec3_Extent[i_Axis]) i_Axis = 2;
+
+    // Coincident centroids cannot be told apart; keep them in one leaf
+    if (u32_Count <= k_MaxLeafItems || vec3_Extent[i_Axis] <= 0.0f) {
+        return i_Index;
+    }
+
+    uint32_t u32_LeftCount = u32_Count / 2;
+    std::nth_element(it_Begin, it_Begin + u32_LeftCount, it_End,
+        [&](uint32_t u32_A, uint32_t u32_B) { return vec_Centroids[u32_A][i_Axis] < vec_Centroids[u32_B][i_Axis]; });
+
+    BuildNode(u32_First, u32_LeftCount, vec_Min, vec_Max, vec_Centroids);
+    int i_Right = BuildNode(u32_First + u32_LeftCount, u32_Count - u32_LeftCount, vec_Min, vec_Max, vec_Centroids);
+    m_vec_Nodes[i_Index].i_Right = i_Right;
+
+    return i_Index;
+}
+
+void Bvh::Cull(const Frustum& frustum, std::vector<Range>& vec_Ranges) const {
+    vec_Ranges.clear();
+    if (!m_vec_Nodes.empty()) {
+        CullNode(0, frustum, vec_Ranges);
+    }
+}
+
+void Bvh::CullNode(int i_Node, const Frustum& frustum, std::vector<Range>& vec_Ranges) const {
+    const Node& node = m_vec_Nodes[i_Node];
+
+    Frustum::Result result = frustum.TestBox(node.vec3_Min, node.vec3_Max);
+    if (result == Frustum::Result::Outside) return;
+
+    if (result == Frustum::Result::Inside || node.i_Right < 0) {
+        AppendRange(vec_Ranges, node.u32_First, node.u32_Count);
+        return;
+    }
+
+    CullNode(i_Node + 1, frustum, vec_Ranges);
+    CullNode(node.i_Right, frustum, vec_Ranges);
+}
+
+void Bvh::AppendRange(std::vector<Range>& vec_Ranges, uint32_t u32_First, uint32_t u32_Count) {
+    if (!vec_Ranges.empty() && vec_Ranges.back().u32_First + vec_Ranges.back().u32_Count == u32_First) {
+        vec_Ranges.back().u32_Count += u32_Count;
+    } else {
+        vec_Ranges.push_back({ u32_First, u32_Count });
+    }
+}
+
+} // namespace Core
+} // namespace ScotlandYard
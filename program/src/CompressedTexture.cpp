@@ -0,0 +1,464 @@
+#include "CompressedTexture.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Utils {
+
+namespace {
+    constexpr char k_Magic[4] = {'S', 'Y', 'T', 'X'};
+    constexpr uint64_t k_LevelAlignment = 8;
+    constexpr uint32_t k_MaxLevels = 32;
+
+    uint64_t AlignUp(uint64_t u64_Value) {
+        return (u64_Value + k_LevelAlignment - 1) & ~(k_LevelAlignment - 1);
+    }
+
+    uint32_t LevelExtent(uint32_t u32_Extent, uint32_t u32_Level) {
+        return std::max<uint32_t>(1, u32_Extent >> u32_Level);
+    }
+
+    uint64_t LevelBytes(uint32_t u32_Width, uint32_t u32_Height, uint32_t u32_Format) {
+        return static_cast<uint64_t>((u32_Width + 3) / 4) * ((u32_Height + 3) / 4) *
+               CompressedTexture::GetBytesPerBlock(u32_Format);
+    }
+
+    uint16_t Pack565(const float* p_Color) {
+        auto quantize = [](float f_Value, int i_Max) {
+            return static_cast<uint16_t>(std::clamp(static_cast<int>(std::lround(f_Value * i_Max / 255.0f)), 0, i_Max));
+        };
+        return static_cast<uint16_t>((quantize(p_Color[0], 31) << 11) | (quantize(p_Color[1], 63) << 5) | quantize(p_Color[2], 31));
+    }
+
+    // Expands with bit replication, as the hardware decoder does
+    void Unpack565(uint16_t u16_Color, int* p_Out) {
+        const int i_R = (u16_Color >> 11) & 31;
+        const int i_G = (u16_Color >> 5) & 63;
+        const int i_B = u16_Color & 31;
+        p_Out[0] = (i_R << 3) | (i_R >> 2);
+        p_Out[1] = (i_G << 2) | (i_G >> 4);
+        p_Out[2] = (i_B << 3) | (i_B >> 2);
+    }
+
+    // Share of endpoint 0 in each palette entry of four-colour mode
+    constexpr float k_Weight0[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+    // Picks the nearest four-colour palette entry per texel, ignoring the
+    // endpoint order (fixed up by the caller); returns the summed squared error
+    int SelectIndices(const uint8_t (*p_Texels)[3], uint16_t u16_Color0, uint16_t u16_Color1, uint32_t& out_Indices) {
+        int arr_Palette[4][3];
+        Unpack565(u16_Color0, arr_Palette[0]);
+        Unpack565(u16_Color1, arr_Palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            arr_Palette[2][c] = (2 * arr_Palette[0][c] + arr_Palette[1][c]) / 3;
+            arr_Palette[3][c] = (arr_Palette[0][c] + 2 * arr_Palette[1][c]) / 3;
+        }
+
+        int i_Total = 0;
+        out_Indices = 0;
+        for (int i = 0; i < 16; ++i) {
+            int i_Best = 0;
+            int i_BestDistance = INT32_MAX;
+            for (int p = 0; p < 4; ++p) {
+                int i_Distance = 0;
+                for (int c = 0; c < 3; ++c) {
+                    const int i_D = p_Texels[i][c] - arr_Palette[p][c];
+                    i_Distance += i_D * i_D;
+                }
+                if (i_Distance < i_BestDistance) {
+                    i_BestDistance = i_Distance;
+                    i_Best = p;
+                }
+            }
+            out_Indices |= static_cast<uint32_t>(i_Best) << (2 * i);
+            i_Total += i_BestDistance;
+        }
+        return i_Total;
+    }
+
+    // Nearest palette entry per alpha value; returns the summed squared error
+    int SelectAlphaIndices(const uint8_t* p_Alpha, uint8_t u8_Alpha0, uint8_t u8_Alpha1, uint64_t& out_Indices) {
+        // alpha0 > alpha1 interpolates six values between them, otherwise four plus 0 and 255
+        int arr_Palette[8] = {u8_Alpha0, u8_Alpha1};
+        if (u8_Alpha0 > u8_Alpha1) {
+            for (int p = 1; p < 7; ++p) arr_Palette[p + 1] = ((7 - p) * u8_Alpha0 + p * u8_Alpha1) / 7;
+        } else {
+            for (int p = 1; p < 5; ++p) arr_Palette[p + 1] = ((5 - p) * u8_Alpha0 + p * u8_Alpha1) / 5;
+            arr_Palette[6] = 0;
+            arr_Palette[7] = 255;
+        }
+
+        int i_Total = 0;
+        out_Indices = 0;
+        for (int i = 0; i < 16; ++i) {
+            int i_Best = 0;
+            int i_BestDistance = INT32_MAX;
+            for (int p = 0; p < 8; ++p) {
+                const int i_D = p_Alpha[i] - arr_Palette[p];
+                if (i_D * i_D < i_BestDistance) {
+                    i_BestDistance = i_D * i_D;
+                    i_Best = p;
+                }
+            }
+            out_Indices |= static_cast<uint64_t>(i_Best) << (3 * i);
+            i_Total += i_BestDistance;
+        }
+        return i_Total;
+    }
+
+    // Half-size level with a 2x2 box filter; odd edges reuse the last row/column
+    std::vector<uint8_t> Downsample(const std::vector<uint8_t>& vec_Source, uint32_t u32_Width, uint32_t u32_Height) {
+        const uint32_t u32_OutWidth = std::max<uint32_t>(1, u32_Width / 2);
+        const uint32_t u32_OutHeight = std::max<uint32_t>(1, u32_Height / 2);
+        std::vector<uint8_t> vec_Out(static_cast<size_t>(u32_OutWidth) * u32_OutHeight * 4);
+
+        for (uint32_t y = 0; y < u32_OutHeight; ++y) {
+            const uint32_t y0 = std::min(y * 2, u32_Height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, u32_Height - 1);
+            for (uint32_t x = 0; x < u32_OutWidth; ++x) {
+                const uint32_t x0 = std::min(x * 2, u32_Width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, u32_Width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    const int i_Sum = vec_Source[(static_cast<size_t>(y0) * u32_Width + x0) * 4 + c]
+                                    + vec_Source[(static_cast<size_t>(y0) * u32_Width + x1) * 4 + c]
+                                    + vec_Source[(static_cast<size_t>(y1) * u32_Width + x0) * 4 + c]
+                                    + vec_Source[(static_cast<size_t>(y1) * u32_Width + x1) * 4 + c];
+                    vec_Out[(static_cast<size_t>(y) * u32_OutWidth + x) * 4 + c] = static_cast<uint8_t>((i_Sum + 2) / 4);
+                }
+            }
+        }
+        return vec_Out;
+    }
+}
+
+CompressedTexture::CompressedTexture()
+    : m_p_Header(nullptr)
+    , m_p_Levels(nullptr)
+{
+}
+
+bool CompressedTexture::Open(const std::string& s_Path) {
+    Close();
+
+    if (!m_File.Open(s_Path)) {
+        return false;
+    }
+
+    if (!Validate(s_Path)) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void CompressedTexture::Close() {
+    m_File.Close();
+    m_p_Header = nullptr;
+    m_p_Levels = nullptr;
+}
+
+bool CompressedTexture::Validate(const std::string& s_Path) {
+    const char* p_Data = m_File.GetData();
+    const uint64_t u64_Size = m_File.GetSize();
+
+    auto fail = [&](const char* p_Reason) {
+        std::cerr << "[CompressedTexture] ERROR: " << s_Path << ": " << p_Reason << std::endl;
+        return false;
+    };
+
+    if (u64_Size < sizeof(CompressedTextureHeader)) return fail("file too small");
+
+    const CompressedTextureHeader* p_Header = reinterpret_cast<const CompressedTextureHeader*>(p_Data);
+    if (std::memcmp(p_Header->arr_Magic, k_Magic, sizeof(k_Magic)) != 0) return fail("not a compressed texture");
+    if (p_Header->u32_Version != k_Version) return fail("unsupported version, rebuild with texc");
+    if (p_Header->u32_Format != k_FormatBC1 && p_Header->u32_Format != k_FormatBC3) {
+        return fail("unsupported block format");
+    }
+    if (p_Header->u32_Width == 0 || p_Header->u32_Height == 0) return fail("empty image");
+    if (p_Header->u32_LevelCount == 0 || p_Header->u32_LevelCount > k_MaxLevels) return fail("bad level count");
+
+    const uint64_t u64_TableEnd = sizeof(CompressedTextureHeader) +
+                                  static_cast<uint64_t>(p_Header->u32_LevelCount) * sizeof(CompressedTextureLevel);
+    if (u64_TableEnd > u64_Size) return fail("truncated level table");
+
+    const CompressedTextureLevel* p_Levels =
+        reinterpret_cast<const CompressedTextureLevel*>(p_Data + sizeof(CompressedTextureHeader));
+    for (uint32_t i = 0; i < p_Header->u32_LevelCount; ++i) {
+        const CompressedTextureLevel& level = p_Levels[i];
+        if (level.u32_Width != LevelExtent(p_Header->u32_Width, i) ||
+            level.u32_Height != LevelExtent(p_Header->u32_Height, i) ||
+            level.u64_Size != LevelBytes(level.u32_Width, level.u32_Height, p_Header->u32_Format)) {
+            return fail("bad level dimensions");
+        }
+        if (level.u64_Offset % k_LevelAlignment != 0 || level.u64_Offset < u64_TableEnd ||
+            level.u64_Offset > u64_Size || level.u64_Size > u64_Size - level.u64_Offset) {
+            return fail("level out of bounds");
+        }
+    }
+
+    m_p_Header = p_Header;
+    m_p_Levels = p_Levels;
+    return true;
+}
+
+void CompressedTexture::EncodeBlockBC1(const uint8_t (*p_Texels)[3], uint8_t* p_Out) {
+    float arr_Mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) arr_Mean[c] += p_Texels[i][c];
+    }
+    for (int c = 0; c < 3; ++c) arr_Mean[c] /= 16.0f;
+
+    // Covariance, then its principal axis by power iteration; the endpoints are
+    // the extreme projections onto that axis
+    float arr_Cov[3][3] = {};
+    for (int i = 0; i < 16; ++i) {
+        const float arr_D[3] = {p_Texels[i][0] - arr_Mean[0], p_Texels[i][1] - arr_Mean[1], p_Texels[i][2] - arr_Mean[2]};
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) arr_Cov[r][c] += arr_D[r] * arr_D[c];
+        }
+    }
+
+    float arr_Axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iter = 0; iter < 8; ++iter) {
+        float arr_Next[3];
+        for (int r = 0; r < 3; ++r) {
+            arr_Next[r] = arr_Cov[r][0] * arr_Axis[0] + arr_Cov[r][1] * arr_Axis[1] + arr_Cov[r][2] * arr_Axis[2];
+        }
+        const float f_Max = std::max({std::fabs(arr_Next[0]), std::fabs(arr_Next[1]), std::fabs(arr_Next[2])});
+        if (f_Max < 1e-6f) break;
+        for (int c = 0; c < 3; ++c) arr_Axis[c] = arr_Next[c] / f_Max;
+    }
+    const float f_Length = std::sqrt(arr_Axis[0] * arr_Axis[0] + arr_Axis[1] * arr_Axis[1] + arr_Axis[2] * arr_Axis[2]);
+    for (int c = 0; c < 3; ++c) arr_Axis[c] /= f_Length;
+
+    float f_Min = 0.0f, f_Max = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        const float f_T = (p_Texels[i][0] - arr_Mean[0]) * arr_Axis[0]
+                        + (p_Texels[i][1] - arr_Mean[1]) * arr_Axis[1]
+                        + (p_Texels[i][2] - arr_Mean[2]) * arr_Axis[2];
+        f_Min = std::min(f_Min, f_T);
+        f_Max = std::max(f_Max, f_T);
+    }
+
+    float arr_End0[3], arr_End1[3];
+    for (int c = 0; c < 3; ++c) {
+        arr_End0[c] = arr_Mean[c] + arr_Axis[c] * f_Max;
+        arr_End1[c] = arr_Mean[c] + arr_Axis[c] * f_Min;
+    }
+
+    uint16_t u16_Color0 = Pack565(arr_End0);
+    uint16_t u16_Color1 = Pack565(arr_End1);
+    uint32_t u32_Indices = 0;
+    int i_Error = SelectIndices(p_Texels, u16_Color0, u16_Color1, u32_Indices);
+
+    // Least-squares refit of the endpoints to the chosen indices, kept when it helps
+    for (int iter = 0; iter < 2 && i_Error > 0; ++iter) {
+        float f_AA = 0.0f, f_AB = 0.0f, f_BB = 0.0f;
+        float arr_AX[3] = {0.0f, 0.0f, 0.0f}, arr_BX[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; ++i) {
+            const float f_A = k_Weight0[(u32_Indices >> (2 * i)) & 3];
+            const float f_B = 1.0f - f_A;
+            f_AA += f_A * f_A;
+            f_AB += f_A * f_B;
+            f_BB += f_B * f_B;
+            for (int c = 0; c < 3; ++c) {
+                arr_AX[c] += f_A * p_Texels[i][c];
+                arr_BX[c] += f_B * p_Texels[i][c];
+            }
+        }
+        const float f_Det = f_AA * f_BB - f_AB * f_AB;
+        if (std::fabs(f_Det) < 1e-6f) break;
+
+        for (int c = 0; c < 3; ++c) {
+            arr_End0[c] = (arr_AX[c] * f_BB - arr_BX[c] * f_AB) / f_Det;
+            arr_End1[c] = (arr_BX[c] * f_AA - arr_AX[c] * f_AB) / f_Det;
+        }
+        const uint16_t u16_Refit0 = Pack565(arr_End0);
+        const uint16_t u16_Refit1 = Pack565(arr_End1);
+        uint32_t u32_RefitIndices = 0;
+        const int i_RefitError = SelectIndices(p_Texels, u16_Refit0, u16_Refit1, u32_RefitIndices);
+        if (i_RefitError >= i_Error) break;
+
+        u16_Color0 = u16_Refit0;
+        u16_Color1 = u16_Refit1;
+        u32_Indices = u32_RefitIndices;
+        i_Error = i_RefitError;
+    }
+
+    // color0 > color1 selects the opaque four-colour mode; swapping the endpoints
+    // swaps index 0<->1 and 2<->3, which is flipping the low bit of each index
+    if (u16_Color0 < u16_Color1) {
+        std::swap(u16_Color0, u16_Color1);
+        u32_Indices ^= 0x55555555u;
+    } else if (u16_Color0 == u16_Color1) {
+        u32_Indices = 0;
+    }
+
+    p_Out[0] = static_cast<uint8_t>(u16_Color0 & 0xFF);
+    p_Out[1] = static_cast<uint8_t>(u16_Color0 >> 8);
+    p_Out[2] = static_cast<uint8_t>(u16_Color1 & 0xFF);
+    p_Out[3] = static_cast<uint8_t>(u16_Color1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        p_Out[4 + i] = static_cast<uint8_t>(u32_Indices >> (8 * i));
+    }
+}
+
+void CompressedTexture::EncodeBlockAlpha(const uint8_t* p_Alpha, uint8_t* p_Out) {
+    // Eight-value mode spans the whole range; six-value mode spans what lies
+    // strictly between 0 and 255 and gets both extremes exactly. Keep the better.
+    uint8_t u8_Min = 255, u8_Max = 0, u8_InnerMin = 255, u8_InnerMax = 0;
+    for (int i = 0; i < 16; ++i) {
+        u8_Min = std::min(u8_Min, p_Alpha[i]);
+        u8_Max = std::max(u8_Max, p_Alpha[i]);
+        if (p_Alpha[i] != 0 && p_Alpha[i] != 255) {
+            u8_InnerMin = std::min(u8_InnerMin, p_Alpha[i]);
+            u8_InnerMax = std::max(u8_InnerMax, p_Alpha[i]);
+        }
+    }
+    if (u8_InnerMin > u8_InnerMax) {
+        u8_InnerMin = u8_InnerMax = 0;
+    }
+
+    uint8_t u8_Alpha0 = u8_Max, u8_Alpha1 = u8_Min;
+    uint64_t u64_Indices = 0;
+    const int i_Error = SelectAlphaIndices(p_Alpha, u8_Alpha0, u8_Alpha1, u64_Indices);
+    if (i_Error > 0) {
+        uint64_t u64_InnerIndices = 0;
+        if (SelectAlphaIndices(p_Alpha, u8_InnerMin, u8_InnerMax, u64_InnerIndices) < i_Error) {
+            u8_Alpha0 = u8_InnerMin;
+            u8_Alpha1 = u8_InnerMax;
+            u64_Indices = u64_InnerIndices;
+        }
+    }
+
+    p_Out[0] = u8_Alpha0;
+    p_Out[1] = u8_Alpha1;
+    for (int i = 0; i < 6; ++i) {
+        p_Out[2 + i] = static_cast<uint8_t>(u64_Indices >> (8 * i));
+    }
+}
+
+bool CompressedTexture::Build(const unsigned char* p_Pixels, int i_Width, int i_Height, int i_Channels,
+                              const std::string& s_OutputPath) {
+    if (!p_Pixels || i_Width <= 0 || i_Height <= 0 || i_Channels < 1 || i_Channels > 4) {
+        std::cerr << "[CompressedTexture] ERROR: Invalid source image for " << s_OutputPath << std::endl;
+        return false;
+    }
+
+    const uint32_t u32_Width = static_cast<uint32_t>(i_Width);
+    const uint32_t u32_Height = static_cast<uint32_t>(i_Height);
+
+    // Level 0 as tightly packed RGBA; grey sources are expanded, ones without alpha made opaque
+    const bool b_Grey = i_Channels < 3;
+    const bool b_HasAlphaChannel = i_Channels == 2 || i_Channels == 4;
+    bool b_Translucent = false;
+    std::vector<uint8_t> vec_Level(static_cast<size_t>(u32_Width) * u32_Height * 4);
+    for (size_t i = 0; i < static_cast<size_t>(u32_Width) * u32_Height; ++i) {
+        const unsigned char* p_Texel = p_Pixels + i * i_Channels;
+        vec_Level[i * 4 + 0] = p_Texel[0];
+        vec_Level[i * 4 + 1] = b_Grey ? p_Texel[0] : p_Texel[1];
+        vec_Level[i * 4 + 2] = b_Grey ? p_Texel[0] : p_Texel[2];
+        vec_Level[i * 4 + 3] = b_HasAlphaChannel ? p_Texel[i_Channels - 1] : 255;
+        b_Translucent |= vec_Level[i * 4 + 3] != 255;
+    }
+    const uint32_t u32_Format = b_Translucent ? k_FormatBC3 : k_FormatBC1;
+    const size_t num_BytesPerBlock = GetBytesPerBlock(u32_Format);
+
+    uint32_t u32_LevelCount = 1;
+    while ((std::max(u32_Width, u32_Height) >> u32_LevelCount) > 0) ++u32_LevelCount;
+
+    CompressedTextureHeader header{};
+    std::memcpy(header.arr_Magic, k_Magic, sizeof(k_Magic));
+    header.u32_Version = k_Version;
+    header.u32_Format = u32_Format;
+    header.u32_Width = u32_Width;
+    header.u32_Height = u32_Height;
+    header.u32_LevelCount = u32_LevelCount;
+
+    std::vector<CompressedTextureLevel> vec_Levels(u32_LevelCount);
+    uint64_t u64_Offset = AlignUp(sizeof(CompressedTextureHeader) + u32_LevelCount * sizeof(CompressedTextureLevel));
+    for (uint32_t i = 0; i < u32_LevelCount; ++i) {
+        CompressedTextureLevel& level = vec_Levels[i];
+        level.u32_Width = LevelExtent(u32_Width, i);
+        level.u32_Height = LevelExtent(u32_Height, i);
+        level.u64_Offset = u64_Offset;
+        level.u64_Size = LevelBytes(level.u32_Width, level.u32_Height, u32_Format);
+        u64_Offset = AlignUp(u64_Offset + level.u64_Size);
+    }
+
+    std::vector<uint8_t> vec_File(static_cast<size_t>(u64_Offset), 0);
+    std::memcpy(vec_File.data(), &header, sizeof(header));
+    std::memcpy(vec_File.data() + sizeof(header), vec_Levels.data(), vec_Levels.size() * sizeof(CompressedTextureLevel));
+
+    for (uint32_t i = 0; i < u32_LevelCount; ++i) {
+        const CompressedTextureLevel& level = vec_Levels[i];
+        if (i > 0) {
+            vec_Level = Downsample(vec_Level, vec_Levels[i - 1].u32_Width, vec_Levels[i - 1].u32_Height);
+        }
+
+        const uint32_t u32_BlocksX = (level.u32_Width + 3) / 4;
+        const uint32_t u32_BlocksY = (level.u32_Height + 3) / 4;
+        uint8_t* p_Blocks = vec_File.data() + level.u64_Offset;
+
+        // Block rows are independent
+        Threading::ThreadPool::ParallelFor(u32_BlocksY, [&](size_t by) {
+            uint8_t arr_Texels[16][3];
+            uint8_t arr_Alpha[16];
+            for (uint32_t bx = 0; bx < u32_BlocksX; ++bx) {
+                for (uint32_t t = 0; t < 16; ++t) {
+                    const uint32_t x = std::min<uint32_t>(bx * 4 + t % 4, level.u32_Width - 1);
+                    const uint32_t y = std::min<uint32_t>(static_cast<uint32_t>(by) * 4 + t / 4, level.u32_Height - 1);
+                    const uint8_t* p_Texel = &vec_Level[(static_cast<size_t>(y) * level.u32_Width + x) * 4];
+                    std::memcpy(arr_Texels[t], p_Texel, 3);
+                    arr_Alpha[t] = p_Texel[3];
+                }
+
+                uint8_t* p_Block = p_Blocks + (by * u32_BlocksX + bx) * num_BytesPerBlock;
+                if (u32_Format == k_FormatBC3) {
+                    EncodeBlockAlpha(arr_Alpha, p_Block);
+                    p_Block += 8;
+                }
+                EncodeBlockBC1(arr_Texels, p_Block);
+            }
+        });
+    }
+
+    std::ofstream file(s_OutputPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[CompressedTexture] ERROR: Could not open " << s_OutputPath << " for writing" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(vec_File.data()), static_cast<std::streamsize>(vec_File.size()));
+    if (!file.good()) {
+        std::cerr << "[CompressedTexture] ERROR: Failed writing " << s_OutputPath << std::endl;
+        return false;
+    }
+
+    std::cout << "[CompressedTexture] Wrote " << s_OutputPath << ": " << u32_Width << "x" << u32_Height << ", "
+              << (u32_Format == k_FormatBC3 ? "BC3, " : "BC1, ") << u32_LevelCount << " levels, "
+              << vec_File.size() << " bytes" << std::endl;
+    return true;
+}
+
+std::string CompressedTexture::CachePathFor(const std::string& s_SourcePath) {
+    return std::filesystem::path(s_SourcePath).replace_extension(".sytex").string();
+}
+
+bool CompressedTexture::IsCacheFresh(const std::string& s_CachePath, const std::string& s_SourcePath) {
+    std::error_code ec;
+    const auto t_Cache = std::filesystem::last_write_time(s_CachePath, ec);
+    if (ec) return false;
+    const auto t_Source = std::filesystem::last_write_time(s_SourcePath, ec);
+    // A cache shipped without its source is still usable
+    return ec || t_Cache >= t_Source;
+}
+
+} // namespace Utils
+} // namespace ScotlandYard
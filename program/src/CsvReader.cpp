@@ -0,0 +1,190 @@
+#include "CsvReader.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+namespace ScotlandYard {
+namespace Utils {
+
+namespace {
+    template<typename T>
+    bool ParseFloatingPoint(std::string_view sv_Field, T& out_Value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        const char* p_End = sv_Field.data() + sv_Field.size();
+        auto result = std::from_chars(sv_Field.data(), p_End, out_Value);
+        return result.ec == std::errc() && result.ptr == p_End;
+#else
+        // Apple libc++ before LLVM 20 and libstdc++ before 11 only have the
+        // integer from_chars. strtod wants a terminated string, and a
+        // coordinate never needs more than this.
+        char arr_Buffer[64];
+        if (sv_Field.empty() || sv_Field.size() >= sizeof(arr_Buffer) ||
+            std::isspace(static_cast<unsigned char>(sv_Field.front()))) {
+            return false;
+        }
+        std::memcpy(arr_Buffer, sv_Field.data(), sv_Field.size());
+        arr_Buffer[sv_Field.size()] = '\0';
+
+        char* p_End = nullptr;
+        errno = 0;
+        T value;
+        if constexpr (std::is_same_v<T, float>) {
+            value = std::strtof(arr_Buffer, &p_End);
+        } else {
+            value = std::strtod(arr_Buffer, &p_End);
+        }
+        if (p_End != arr_Buffer + sv_Field.size() || errno == ERANGE) {
+            return false;
+        }
+        out_Value = value;
+        return true;
+#endif
+    }
+}
+
+CsvReader::CsvReader()
+    : m_p_Cursor(nullptr)
+    , m_p_End(nullptr)
+    , m_num_Fields(0)
+    , m_num_Line(0)
+{
+}
+
+CsvReader::CsvReader(std::string_view sv_Data)
+    : m_p_Cursor(sv_Data.data())
+    , m_p_End(sv_Data.data() + sv_Data.size())
+    , m_num_Fields(0)
+    , m_num_Line(0)
+{
+}
+
+bool CsvReader::Open(const std::string& s_Path) {
+    m_num_Fields = 0;
+    m_num_Line = 0;
+    m_sv_Row = std::string_view();
+
+    if (!m_File.Open(s_Path)) {
+        m_p_Cursor = m_p_End = nullptr;
+        return false;
+    }
+
+    m_p_Cursor = m_File.GetData();
+    m_p_End = m_p_Cursor + m_File.GetSize();
+    return true;
+}
+
+bool CsvReader::NextRow() {
+    while (m_p_Cursor < m_p_End) {
+        const char* p_LineStart = m_p_Cursor;
+        const char* p_NewLine = static_cast<const char*>(
+            std::memchr(p_LineStart, '\n', static_cast<size_t>(m_p_End - p_LineStart)));
+        const char* p_LineEnd = p_NewLine ? p_NewLine : m_p_End;
+
+        m_p_Cursor = p_NewLine ? p_NewLine + 1 : m_p_End;
+        ++m_num_Line;
+
+        if (p_LineEnd > p_LineStart && p_LineEnd[-1] == '\r') {
+            --p_LineEnd;
+        }
+        if (p_LineEnd == p_LineStart) {
+            continue;
+        }
+
+        m_sv_Row = std::string_view(p_LineStart, static_cast<size_t>(p_LineEnd - p_LineStart));
+
+        // Split on commas; anything past k_MaxFields stays attached to the last field
+        m_num_Fields = 0;
+        const char* p_FieldStart = p_LineStart;
+        while (m_num_Fields + 1 < k_MaxFields) {
+            const char* p_Comma = static_cast<const char*>(
+                std::memchr(p_FieldStart, ',', static_cast<size_t>(p_LineEnd - p_FieldStart)));
+            if (!p_Comma) break;
+            m_arr_Fields[m_num_Fields++] = std::string_view(p_FieldStart, static_cast<size_t>(p_Comma - p_FieldStart));
+            p_FieldStart = p_Comma + 1;
+        }
+        m_arr_Fields[m_num_Fields++] = std::string_view(p_FieldStart, static_cast<size_t>(p_LineEnd - p_FieldStart));
+
+        return true;
+    }
+
+    m_num_Fields = 0;
+    m_sv_Row = std::string_view();
+    return false;
+}
+
+size_t CsvReader::EstimateRowCount() const {
+    return m_p_Cursor ? static_cast<size_t>(std::count(m_p_Cursor, m_p_End, '\n')) + 1 : 0;
+}
+
+std::string_view CsvReader::GetRemaining() const {
+    return m_p_Cursor ? std::string_view(m_p_Cursor, static_cast<size_t>(m_p_End - m_p_Cursor)) : std::string_view();
+}
+
+std::vector<std::string_view> CsvReader::SplitLines(std::string_view sv_Data, size_t num_Chunks) {
+    std::vector<std::string_view> vec_Chunks;
+    if (sv_Data.empty()) return vec_Chunks;
+
+    num_Chunks = std::max<size_t>(num_Chunks, 1);
+    const size_t num_Target = sv_Data.size() / num_Chunks + 1;
+    vec_Chunks.reserve(num_Chunks);
+
+    size_t start = 0;
+    while (start < sv_Data.size()) {
+        size_t end = start + num_Target;
+        if (end >= sv_Data.size()) {
+            end = sv_Data.size();
+        } else {
+            size_t newLine = sv_Data.find('\n', end);
+            end = newLine == std::string_view::npos ? sv_Data.size() : newLine + 1;
+        }
+        vec_Chunks.push_back(sv_Data.substr(start, end - start));
+        start = end;
+    }
+
+    return vec_Chunks;
+}
+
+std::string_view CsvReader::Trim(std::string_view sv_Text) {
+    const char* k_Blanks = " \t\r\n\f\v";
+    size_t first = sv_Text.find_first_not_of(k_Blanks);
+    if (first == std::string_view::npos) return std::string_view();
+    size_t last = sv_Text.find_last_not_of(k_Blanks);
+    return sv_Text.substr(first, last - first + 1);
+}
+
+bool CsvReader::ParseInt(std::string_view sv_Field, int& out_Value) {
+    sv_Field = Trim(sv_Field);
+    if (sv_Field.empty()) return false;
+
+    // from_chars rejects a leading '+', which hand-edited files sometimes have
+    if (sv_Field.front() == '+') sv_Field.remove_prefix(1);
+
+    const char* p_End = sv_Field.data() + sv_Field.size();
+    auto result = std::from_chars(sv_Field.data(), p_End, out_Value);
+    return result.ec == std::errc() && result.ptr == p_End;
+}
+
+bool CsvReader::ParseFloat(std::string_view sv_Field, float& out_Value) {
+    sv_Field = Trim(sv_Field);
+    if (sv_Field.empty()) return false;
+
+    if (sv_Field.front() == '+') sv_Field.remove_prefix(1);
+
+    return ParseFloatingPoint(sv_Field, out_Value);
+}
+
+bool CsvReader::ParseDouble(std::string_view sv_Field, double& out_Value) {
+    sv_Field = Trim(sv_Field);
+    if (sv_Field.empty()) return false;
+
+    if (sv_Field.front() == '+') sv_Field.remove_prefix(1);
+
+    return ParseFloatingPoint(sv_Field, out_Value);
+}
+
+} // namespace Utils
+} // namespace ScotlandYard
@@ -0,0 +1,130 @@
+#include "FeatureEncoder.h"
+#include <algorithm>
+#include <vector>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace ScotlandYard {
+namespace Core {
+
+namespace {
+    constexpr float k_TicketScale = 1.0f / k_MrXTaxiTickets;
+
+    inline void SetBit(uint64_t* p_Mask, uint32_t u32_Node) {
+        p_Mask[u32_Node >> 6] |= uint64_t{1} << (u32_Node & 63);
+    }
+
+    inline void ClearBit(uint64_t* p_Mask, uint32_t u32_Node) {
+        p_Mask[u32_Node >> 6] &= ~(uint64_t{1} << (u32_Node & 63));
+    }
+
+    inline int LowestBit(uint64_t u64_Word) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long u_Index;
+        _BitScanForward64(&u_Index, u64_Word);
+        return static_cast<int>(u_Index);
+#else
+        return __builtin_ctzll(u64_Word);
+#endif
+    }
+}
+
+FeatureEncoder::FeatureEncoder(const RulesGraph& graph)
+    : m_Graph(graph)
+    , m_num_MaskWords((static_cast<size_t>(graph.GetNodeCount()) + 63) / 64)
+    , m_num_FeatureSize(static_cast<size_t>(graph.GetNodeCount()) * (k_PlayerCount + 1)
+                        + k_PlayerCount * k_TicketTypeCount + 1 + k_PlayerCount + graph.GetMaxDegree())
+{
+}
+
+void FeatureEncoder::ResetPossibleLocations(uint64_t* p_Mask, const RulesState& state) const {
+    const uint32_t u32_NodeCount = m_Graph.GetNodeCount();
+    std::fill(p_Mask, p_Mask + m_num_MaskWords, ~uint64_t{0});
+    if (u32_NodeCount & 63) {
+        p_Mask[m_num_MaskWords - 1] = (uint64_t{1} << (u32_NodeCount & 63)) - 1;
+    }
+    ClearDetectiveNodes(p_Mask, state);
+}
+
+void FeatureEncoder::UpdateAfterMisterXMove(uint64_t* p_Mask, const RulesState& state, uint32_t u32_Edge,
+                                            int i_Round) const {
+    if (IsRevealRound(i_Round)) {
+        std::fill(p_Mask, p_Mask + m_num_MaskWords, 0);
+        SetBit(p_Mask, state.arr_Positions[0]);
+        return;
+    }
+
+    // Spread from a copy so nodes reached this move are not spread again;
+    // one buffer per thread, sized on first use
+    thread_local std::vector<uint64_t> t_vec_From;
+    t_vec_From.assign(p_Mask, p_Mask + m_num_MaskWords);
+    std::fill(p_Mask, p_Mask + m_num_MaskWords, 0);
+
+    const int i_Transport = m_Graph.GetTransport(u32_Edge);
+    for (size_t w = 0; w < m_num_MaskWords; ++w) {
+        for (uint64_t u64_Bits = t_vec_From[w]; u64_Bits; u64_Bits &= u64_Bits - 1) {
+            uint32_t u32_Node = static_cast<uint32_t>(w * 64 + LowestBit(u64_Bits));
+            for (uint32_t e = m_Graph.GetEdgeBegin(u32_Node); e < m_Graph.GetEdgeEnd(u32_Node); ++e) {
+                if (m_Graph.GetTransport(e) == i_Transport) {
+                    SetBit(p_Mask, m_Graph.GetTarget(e));
+                }
+            }
+        }
+    }
+    ClearDetectiveNodes(p_Mask, state);
+    // The true node is always reachable; this only guards a mask that was
+    // never reset for this game
+    SetBit(p_Mask, state.arr_Positions[0]);
+}
+
+void FeatureEncoder::UpdateAfterDetectiveMove(uint64_t* p_Mask, uint32_t u32_Node) const {
+    ClearBit(p_Mask, u32_Node);
+}
+
+void FeatureEncoder::ClearDetectiveNodes(uint64_t* p_Mask, const RulesState& state) const {
+    for (int i = 1; i < k_PlayerCount; ++i) {
+        ClearBit(p_Mask, state.arr_Positions[i]);
+    }
+}
+
+void FeatureEncoder::Encode(const RulesState& state, const uint64_t* p_Mask, float* p_Features) const {
+    const uint32_t u32_NodeCount = m_Graph.GetNodeCount();
+    float* p_Out = p_Features;
+    std::fill(p_Out, p_Out + m_num_FeatureSize, 0.0f);
+
+    // Mr X's true position only goes to Mr X himself
+    if (state.u8_Turn == 0) p_Out[state.arr_Positions[0]] = 1.0f;
+    for (int i = 1; i < k_PlayerCount; ++i) {
+        p_Out[static_cast<size_t>(i) * u32_NodeCount + state.arr_Positions[i]] = 1.0f;
+    }
+    p_Out += static_cast<size_t>(u32_NodeCount) * k_PlayerCount;
+
+    for (uint32_t n = 0; n < u32_NodeCount; ++n) {
+        p_Out[n] = static_cast<float>((p_Mask[n >> 6] >> (n & 63)) & 1);
+    }
+    p_Out += u32_NodeCount;
+
+    const uint8_t* p_Tickets = &state.arr_Tickets[0][0];
+    for (int i = 0; i < k_PlayerCount * k_TicketTypeCount; ++i) {
+        p_Out[i] = p_Tickets[i] * k_TicketScale;
+    }
+    p_Out += k_PlayerCount * k_TicketTypeCount;
+
+    *p_Out++ = static_cast<float>(state.u8_Round) / k_MaxRounds;
+    p_Out[state.u8_Turn] = 1.0f;
+    p_Out += k_PlayerCount;
+
+    uint32_t u32_Node = state.arr_Positions[state.u8_Turn];
+    uint32_t u32_Begin = m_Graph.GetEdgeBegin(u32_Node);
+    uint32_t u32_End = m_Graph.GetEdgeEnd(u32_Node);
+    for (uint32_t e = u32_Begin; e < u32_End; ++e) {
+        int i_Ticket = GameRules::TicketIndex(m_Graph.GetTransport(e));
+        if (i_Ticket >= 0 && state.arr_Tickets[state.u8_Turn][i_Ticket] > 0) {
+            p_Out[e - u32_Begin] = 1.0f;
+        }
+    }
+}
+
+} // namespace Core
+} // namespace ScotlandYard
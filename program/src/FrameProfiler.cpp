@@ -0,0 +1,228 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace ScotlandYard {
+namespace Core {
+
+FrameProfiler::FrameProfiler()
+    : m_b_Initialized(false)
+    , m_b_Enabled(false)
+    , m_b_InFrame(false)
+    , m_i_CurrentSlot(0)
+    , m_u64_FrameIndex(0)
+    , m_i_OpenPass(-1)
+    , m_i_HistoryHead(0)
+    , m_i_HistoryCount(0)
+{
+    m_vec_PassNames.reserve(k_MaxPasses);
+}
+
+bool FrameProfiler::Initialize() {
+    if (m_b_Initialized) return true;
+
+    for (FrameSlot& slot : m_arr_Slots) {
+        glGenQueries(k_MaxPasses, slot.arr_Queries.data());
+        slot.arr_Issued.fill(false);
+        slot.b_Pending = false;
+    }
+
+    m_vec_History.assign(k_HistoryFrames, FrameSample{});
+    m_i_HistoryHead = 0;
+    m_i_HistoryCount = 0;
+    m_u64_FrameIndex = 0;
+    m_b_Initialized = true;
+    return true;
+}
+
+void FrameProfiler::Shutdown() {
+    if (!m_b_Initialized) return;
+
+    for (FrameSlot& slot : m_arr_Slots) {
+        glDeleteQueries(k_MaxPasses, slot.arr_Queries.data());
+        slot.arr_Queries.fill(0);
+        slot.b_Pending = false;
+    }
+
+    m_vec_History.clear();
+    m_i_HistoryCount = 0;
+    m_b_InFrame = false;
+    m_i_OpenPass = -1;
+    m_b_Initialized = false;
+}
+
+void FrameProfiler::BeginFrame() {
+    if (!IsEnabled()) return;
+
+    m_i_CurrentSlot = static_cast<int>(m_u64_FrameIndex % k_FrameLatency);
+    FrameSlot& slot = m_arr_Slots[m_i_CurrentSlot];
+
+    // The slot was last written k_FrameLatency frames ago; its queries are almost always done by now
+    if (slot.b_Pending) {
+        ResolveSlot(slot);
+    }
+
+    slot.arr_Issued.fill(false);
+    slot.arr_CpuMs.fill(0.0f);
+    slot.f_FrameCpuMs = 0.0f;
+    slot.u64_Frame = m_u64_FrameIndex;
+
+    m_tp_FrameStart = Clock::now();
+    m_b_InFrame = true;
+}
+
+void FrameProfiler::EndFrame() {
+    if (!m_b_InFrame) return;
+
+    EndPass();
+
+    FrameSlot& slot = m_arr_Slots[m_i_CurrentSlot];
+    slot.f_FrameCpuMs = std::chrono::duration<float, std::milli>(Clock::now() - m_tp_FrameStart).count();
+    slot.b_Pending = true;
+
+    ++m_u64_FrameIndex;
+    m_b_InFrame = false;
+}
+
+void FrameProfiler::BeginPass(const char* p_Name) {
+    if (!m_b_InFrame) return;
+
+    EndPass();
+
+    int i_Pass = FindOrRegisterPass(p_Name);
+    if (i_Pass < 0) return;
+
+    FrameSlot& slot = m_arr_Slots[m_i_CurrentSlot];
+    glBeginQuery(GL_TIME_ELAPSED, slot.arr_Queries[i_Pass]);
+    slot.arr_Issued[i_Pass] = true;
+
+    m_i_OpenPass = i_Pass;
+    m_tp_PassStart = Clock::now();
+}
+
+void FrameProfiler::EndPass() {
+    if (m_i_OpenPass < 0) return;
+
+    FrameSlot& slot = m_arr_Slots[m_i_CurrentSlot];
+    glEndQuery(GL_TIME_ELAPSED);
+    slot.arr_CpuMs[m_i_OpenPass] += std::chrono::duration<float, std::milli>(Clock::now() - m_tp_PassStart).count();
+
+    m_i_OpenPass = -1;
+}
+
+int FrameProfiler::FindOrRegisterPass(const char* p_Name) {
+    for (size_t i = 0; i < m_vec_PassNames.size(); ++i) {
+        if (m_vec_PassNames[i] == p_Name || std::strcmp(m_vec_PassNames[i], p_Name) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+
+    if (static_cast<int>(m_vec_PassNames.size()) >= k_MaxPasses) {
+        std::cerr << "[FrameProfiler] Too many passes, ignoring \"" << p_Name << "\"\n";
+        return -1;
+    }
+
+    m_vec_PassNames.push_back(p_Name);
+    return static_cast<int>(m_vec_PassNames.size()) - 1;
+}
+
+void FrameProfiler::ResolveSlot(FrameSlot& slot) {
+    FrameSample& sample = m_vec_History[m_i_HistoryHead];
+    sample.u64_Frame = slot.u64_Frame;
+    sample.f_FrameCpuMs = slot.f_FrameCpuMs;
+    sample.arr_CpuMs = slot.arr_CpuMs;
+
+    for (int i = 0; i < k_MaxPasses; ++i) {
+        sample.arr_GpuMs[i] = -1.0f;
+        if (!slot.arr_Issued[i]) {
+            sample.arr_CpuMs[i] = -1.0f;
+            continue;
+        }
+
+        GLint i_Available = 0;
+        glGetQueryObjectiv(slot.arr_Queries[i], GL_QUERY_RESULT_AVAILABLE, &i_Available);
+        if (!i_Available) continue;
+
+        GLuint64 u64_Ns = 0;
+        glGetQueryObjectui64v(slot.arr_Queries[i], GL_QUERY_RESULT, &u64_Ns);
+        sample.arr_GpuMs[i] = static_cast<float>(u64_Ns) / 1.0e6f;
+    }
+
+    m_i_HistoryHead = (m_i_HistoryHead + 1) % k_HistoryFrames;
+    m_i_HistoryCount = std::min(m_i_HistoryCount + 1, k_HistoryFrames);
+    slot.b_Pending = false;
+}
+
+std::vector<FrameProfiler::PassSummary> FrameProfiler::GetSummary() const {
+    std::vector<PassSummary> vec_Summary;
+    vec_Summary.reserve(m_vec_PassNames.size());
+
+    for (size_t i = 0; i < m_vec_PassNames.size(); ++i) {
+        float f_CpuSum = 0.0f;
+        float f_GpuSum = 0.0f;
+        float f_GpuMax = 0.0f;
+        int i_CpuSamples = 0;
+        int i_GpuSamples = 0;
+
+        // Frames that skipped the pass don't count towards its averages
+        for (int f = 0; f < m_i_HistoryCount; ++f) {
+            const FrameSample& sample = m_vec_History[f];
+            if (sample.arr_CpuMs[i] >= 0.0f) {
+                f_CpuSum += sample.arr_CpuMs[i];
+                ++i_CpuSamples;
+            }
+            if (sample.arr_GpuMs[i] >= 0.0f) {
+                f_GpuSum += sample.arr_GpuMs[i];
+                f_GpuMax = std::max(f_GpuMax, sample.arr_GpuMs[i]);
+                ++i_GpuSamples;
+            }
+        }
+
+        PassSummary summary;
+        summary.s_Name = m_vec_PassNames[i];
+        summary.f_AvgCpuMs = i_CpuSamples > 0 ? f_CpuSum / i_CpuSamples : 0.0f;
+        summary.f_AvgGpuMs = i_GpuSamples > 0 ? f_GpuSum / i_GpuSamples : -1.0f;
+        summary.f_MaxGpuMs = f_GpuMax;
+        vec_Summary.push_back(summary);
+    }
+
+    return vec_Summary;
+}
+
+float FrameProfiler::GetAvgFrameCpuMs() const {
+    if (m_i_HistoryCount == 0) return 0.0f;
+
+    float f_Sum = 0.0f;
+    for (int f = 0; f < m_i_HistoryCount; ++f) {
+        f_Sum += m_vec_History[f].f_FrameCpuMs;
+    }
+    return f_Sum / m_i_HistoryCount;
+}
+
+bool FrameProfiler::DumpToFile(const std::string& s_Path) const {
+    std::ofstream file(s_Path);
+    if (!file.is_open()) {
+        std::cerr << "[FrameProfiler] Could not open " << s_Path << " for writing\n";
+        return false;
+    }
+
+    file << "frame,pass,cpu_ms,gpu_ms\n";
+
+    // Oldest resolved frame first
+    int i_Start = (m_i_HistoryHead - m_i_HistoryCount + k_HistoryFrames) % k_HistoryFrames;
+    for (int n = 0; n < m_i_HistoryCount; ++n) {
+        const FrameSample& sample = m_vec_History[(i_Start + n) % k_HistoryFrames];
+        for (size_t i = 0; i < m_vec_PassNames.size(); ++i) {
+            file << sample.u64_Frame << ',' << m_vec_PassNames[i] << ','
+                 << sample.arr_CpuMs[i] << ',' << sample.arr_GpuMs[i] << '\n';
+        }
+        file << sample.u64_Frame << ",frame," << sample.f_FrameCpuMs << ",-1\n";
+    }
+
+    return file.good();
+}
+
+} // namespace Core
+} // namespace ScotlandYard
@@ -0,0 +1,60 @@
+#include "Frustum.h"
+
+namespace ScotlandYard {
+namespace Core {
+
+Frustum::Frustum() {
+    // Accepts everything until built from a matrix
+    for (glm::vec4& plane : m_arr_Planes) {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const glm::mat4& mat4_ViewProjection) {
+    // Gribb/Hartmann: each plane is row 3 plus or minus row 0..2 (glm is column-major)
+    glm::vec4 arr_Rows[4];
+    for (int i = 0; i < 4; ++i) {
+        arr_Rows[i] = glm::vec4(mat4_ViewProjection[0][i], mat4_ViewProjection[1][i],
+                                mat4_ViewProjection[2][i], mat4_ViewProjection[3][i]);
+    }
+
+    m_arr_Planes[0] = arr_Rows[3] + arr_Rows[0];    // left
+    m_arr_Planes[1] = arr_Rows[3] - arr_Rows[0];    // right
+    m_arr_Planes[2] = arr_Rows[3] + arr_Rows[1];    // bottom
+    m_arr_Planes[3] = arr_Rows[3] - arr_Rows[1];    // top
+    m_arr_Planes[4] = arr_Rows[3] + arr_Rows[2];    // near
+    m_arr_Planes[5] = arr_Rows[3] - arr_Rows[2];    // far
+
+    for (glm::vec4& plane : m_arr_Planes) {
+        float f_Length = glm::length(glm::vec3(plane));
+        if (f_Length > 0.0f) {
+            plane /= f_Length;
+        }
+    }
+}
+
+Frustum::Result Frustum::TestBox(const glm::vec3& vec3_Min, const glm::vec3& vec3_Max) const {
+    Result result = Result::Inside;
+
+    for (const glm::vec4& plane : m_arr_Planes) {
+        // Corner furthest along the plane normal, and the one furthest against it
+        glm::vec3 vec3_Positive(plane.x >= 0.0f ? vec3_Max.x : vec3_Min.x,
+                                plane.y >= 0.0f ? vec3_Max.y : vec3_Min.y,
+                                plane.z >= 0.0f ? vec3_Max.z : vec3_Min.z);
+        if (glm::dot(glm::vec3(plane), vec3_Positive) + plane.w < 0.0f) {
+            return Result::Outside;
+        }
+
+        glm::vec3 vec3_Negative(plane.x >= 0.0f ? vec3_Min.x : vec3_Max.x,
+                                plane.y >= 0.0f ? vec3_Min.y : vec3_Max.y,
+                                plane.z >= 0.0f ? vec3_Min.z : vec3_Max.z);
+        if (glm::dot(glm::vec3(plane), vec3_Negative) + plane.w < 0.0f) {
+            result = Result::Intersects;
+        }
+    }
+
+    return result;
+}
+
+} // namespace Core
+} // namespace ScotlandYard
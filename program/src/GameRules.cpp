@@ -0,0 +1,126 @@
+#include "GameRules.h"
+#include "../../Graphs/graph_manage.h"
+#include <algorithm>
+
+namespace ScotlandYard {
+namespace Core {
+
+namespace {
+    bool IsCaptured(const RulesState& state) {
+        for (int i = 1; i < k_PlayerCount; ++i) {
+            if (state.arr_Positions[i] == state.arr_Positions[0]) return true;
+        }
+        return false;
+    }
+}
+
+void RulesGraph::Build(const GraphManager& graph) {
+    uint32_t u32_NodeCount = static_cast<uint32_t>(graph.GetNodeCount());
+    m_vec_Offsets.assign(u32_NodeCount + 1, 0);
+    m_vec_Targets.clear();
+    m_vec_Transports.clear();
+    m_vec_NodeIds.resize(u32_NodeCount);
+    m_u32_MaxDegree = 0;
+
+    for (uint32_t n = 0; n < u32_NodeCount; ++n) {
+        const Node* p_Node = graph.GetNodeByIndex(n);
+        m_vec_NodeIds[n] = p_Node->id;
+        for (int s = 0; s < p_Node->GetSlotCount(); ++s) {
+            const Node* p_Other = p_Node->otherNode(s);
+            if (!p_Other) continue;
+            m_vec_Targets.push_back(graph.GetIndex(p_Other->id));
+            m_vec_Transports.push_back(static_cast<uint8_t>(p_Node->GetSlotType(s)));
+        }
+        m_vec_Offsets[n + 1] = static_cast<uint32_t>(m_vec_Targets.size());
+        m_u32_MaxDegree = std::max(m_u32_MaxDegree, m_vec_Offsets[n + 1] - m_vec_Offsets[n]);
+    }
+}
+
+void GameRules::Reset(RulesState& state, const RulesGraph& graph, std::mt19937& rng) {
+    // Losujemy indeksy bez powtórzeń, jak GameState przy starcie gry
+    std::uniform_int_distribution<uint32_t> dist(0, graph.GetNodeCount() - 1);
+    for (int i = 0; i < k_PlayerCount; ++i) {
+        uint32_t u32_Node;
+        do {
+            u32_Node = dist(rng);
+        } while (std::find(state.arr_Positions, state.arr_Positions + i, u32_Node) != state.arr_Positions + i);
+        state.arr_Positions[i] = u32_Node;
+    }
+
+    state.arr_Tickets[0][0] = k_MrXTaxiTickets;
+    state.arr_Tickets[0][1] = k_MrXBusTickets;
+    state.arr_Tickets[0][2] = k_MrXMetroTickets;
+    state.arr_Tickets[0][3] = k_MrXWaterTickets;
+    for (int i = 1; i < k_PlayerCount; ++i) {
+        state.arr_Tickets[i][0] = k_DetectiveTaxiTickets;
+        state.arr_Tickets[i][1] = k_DetectiveBusTickets;
+        state.arr_Tickets[i][2] = k_DetectiveMetroTickets;
+        state.arr_Tickets[i][3] = k_DetectiveWaterTickets;
+    }
+
+    state.u8_Round = 1;
+    state.u8_Turn = 0;
+    state.e_Outcome = GameOutcome::None;
+}
+
+bool GameRules::CanUseEdge(const RulesState& state, const RulesGraph& graph, uint32_t u32_Edge) {
+    int i_Ticket = TicketIndex(graph.GetTransport(u32_Edge));
+    return i_Ticket >= 0 && state.arr_Tickets[state.u8_Turn][i_Ticket] > 0;
+}
+
+uint32_t GameRules::GenerateMoves(const RulesState& state, const RulesGraph& graph, uint32_t* p_Edges) {
+    uint32_t u32_Node = state.arr_Positions[state.u8_Turn];
+    uint32_t u32_Count = 0;
+    for (uint32_t e = graph.GetEdgeBegin(u32_Node); e < graph.GetEdgeEnd(u32_Node); ++e) {
+        if (CanUseEdge(state, graph, e)) p_Edges[u32_Count++] = e;
+    }
+    return u32_Count;
+}
+
+void GameRules::ApplyMove(RulesState& state, const RulesGraph& graph, uint32_t u32_Edge) {
+    if (state.e_Outcome != GameOutcome::None) return;
+
+    if (u32_Edge == k_Pass) {
+        if (state.u8_Turn == 0) {
+            state.e_Outcome = GameOutcome::Detectives;
+            return;
+        }
+        EndTurn(state);
+        return;
+    }
+
+    --state.arr_Tickets[state.u8_Turn][TicketIndex(graph.GetTransport(u32_Edge))];
+    state.arr_Positions[state.u8_Turn] = graph.GetTarget(u32_Edge);
+
+    if (IsCaptured(state)) {
+        state.e_Outcome = GameOutcome::Detectives;
+        return;
+    }
+    EndTurn(state);
+}
+
+uint32_t GameRules::PlayRandomMove(RulesState& state, const RulesGraph& graph, std::mt19937& rng,
+                                   uint32_t* p_Scratch) {
+    uint32_t u32_Count = GenerateMoves(state, graph, p_Scratch);
+    uint32_t u32_Edge = k_Pass;
+    if (u32_Count > 0) {
+        u32_Edge = p_Scratch[std::uniform_int_distribution<uint32_t>(0, u32_Count - 1)(rng)];
+    }
+    ApplyMove(state, graph, u32_Edge);
+    return u32_Edge;
+}
+
+void GameRules::EndTurn(RulesState& state) {
+    if (++state.u8_Turn < k_PlayerCount) return;
+
+    // Everyone has moved: the round is over
+    if (state.u8_Round >= k_MaxRounds) {
+        state.e_Outcome = GameOutcome::MisterX;
+        return;
+    }
+    ++state.u8_Round;
+    state.u8_Turn = 0;
+}
+
+} // namespace Core
+} // namespace ScotlandYard
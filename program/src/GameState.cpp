@@ -5,12 +5,16 @@
 
 #include <random>
 #include <algorithm>
+#include <cstddef>
+#include <cstdio>
 #include "../../Graphs/graph_manage.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "../external/stb_image.h"
 
 #include "HUDOverlay.h"
+#include "TraceRecorder.h"
+#include "NeuralNetworkManager.h"
 
 namespace ScotlandYard {
 namespace States {
@@ -19,10 +23,9 @@ GameState::GameState()
     : m_b_GameActive(false)
     , m_b_Camera3D(true)
     , m_b_TexturesLoaded(false)
-    , m_VAO_Plane(0)
-    , m_VBO_Plane(0)
     , m_ShaderProgram_Plane(0)
     , m_ShaderProgram_Circle(0)
+    , m_ShaderProgram_Station(0)
     , m_VAO_Circle(0)
     , m_VBO_Circle(0)
     , m_i_CircleVertexCount(0)
@@ -38,7 +41,6 @@ GameState::GameState()
     , m_f_CameraAngle(k_MaxCameraAngle)
     , m_f_CameraAngleVelocity(0.0f)
     , m_vec3_Saved3DCameraPosition(0.0f, 1.5f, 4.0f)
-    , m_graph(200)
     , m_FBO_Picking(0)
     , m_TextureID_Picking(0)
     , m_RBO_PickingDepth(0)
@@ -59,22 +61,15 @@ GameState::GameState()
 GameState::~GameState() {}
 
 void GameState::OnEnter() {
+    TRACE_SCOPE("GameState::OnEnter");
     m_b_GameActive = true;
 
-    // Dane wierzchołków planszy (pozycja, kolor, UV)
-    float size = 1.0f;
-    float planeVertices[] = {
-        -size, 0.0f, -size,   0.0f, 1.0f, 0.0f,   0.0f, 0.0f,
-         size, 0.0f, -size,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-         size, 0.0f,  size,   0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
+    // Mapa wczytywana raz na proces; kolejne gry korzystają z tej samej instancji
+    m_sp_Map = Core::MapAsset::Acquire();
 
-        -size, 0.0f, -size,   0.0f, 1.0f, 0.0f,   0.0f, 0.0f,
-         size, 0.0f,  size,   0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
-        -size, 0.0f,  size,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f
-    };
-
-    // Pozycje kółek z pliku CSV
-    auto vec_StationData = Utils::MapDataLoader::LoadStations(Core::GetMapPath(Core::k_NodeDataRelativePath));
+    // Pozycje kółek z mapy
+    const auto& vec_StationData = m_sp_Map->GetStations();
+    m_vec_CircleStations.clear();
 
     if (vec_StationData.empty()) {
         std::cerr << "[GameState] Warning: No positions loaded from CSV, using defaults.\n";
@@ -97,25 +92,6 @@ void GameState::OnEnter() {
         }
     }
 
-    // VAO/VBO planszy
-    glGenVertexArrays(1, &m_VAO_Plane);
-    glGenBuffers(1, &m_VBO_Plane);
-
-    glBindVertexArray(m_VAO_Plane);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Plane);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), planeVertices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
-
     // VAO/VBO kółek
     float f_Radius = 0.05f;
     int i_Segments = 30;
@@ -135,28 +111,58 @@ void GameState::OnEnter() {
 
     glBindVertexArray(0);
 
-    // VAO/VBO cylindra i półkuli pionka
-    std::vector<float> cylVerts = generateCylinderVertices(0.05f, 0.1f, 20); // radius, height, segments
-    m_i_CylinderVertexCount = static_cast<int>(cylVerts.size() / 3);
-    glGenVertexArrays(1, &m_VAO_Cylinder);
-    glGenBuffers(1, &m_VBO_Cylinder);
-    glBindVertexArray(m_VAO_Cylinder);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Cylinder);
-    glBufferData(GL_ARRAY_BUFFER, cylVerts.size() * sizeof(float), cylVerts.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    // Kafelki planszy (-1..1 w XZ) i pierścienie stacji, wspólny VBO kółka
+    float f_BoardHalfSize = 1.0f;
+    std::vector<Core::BoardTiles::StationInstance> vec_StationInstances;
+    std::vector<uint32_t> vec_StationOffsets;
+    BuildStationInstances(vec_StationInstances, vec_StationOffsets);
+    m_BoardTiles.Initialize(glm::vec2(-f_BoardHalfSize), glm::vec2(f_BoardHalfSize),
+                            vec_StationInstances, vec_StationOffsets, m_VBO_Circle, f_Radius);
+
+    // Siatka pionka: cylinder + półkula w jednym VBO/EBO, rysowana instancyjnie
+    std::vector<float> vec_TokenVertices;
+    std::vector<GLuint> vec_TokenIndices;
+    float f_CylinderHeight = k_TokenMeshHeight - k_TokenMeshRadius;
+    generateCylinderMesh(k_TokenMeshRadius, f_CylinderHeight, 20, vec_TokenVertices, vec_TokenIndices); // radius, height, segments
+    generateHemisphereMesh(k_TokenMeshRadius, f_CylinderHeight, 30, vec_TokenVertices, vec_TokenIndices); // radius, offset, segments
+    m_i_TokenIndexCount = static_cast<int>(vec_TokenIndices.size());
+
+    glGenVertexArrays(1, &m_VAO_Token);
+    glGenBuffers(1, &m_VBO_Token);
+    glGenBuffers(1, &m_EBO_Token);
+    glGenBuffers(1, &m_VBO_TokenInstances);
+    glBindVertexArray(m_VAO_Token);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Token);
+    glBufferData(GL_ARRAY_BUFFER, vec_TokenVertices.size() * sizeof(float), vec_TokenVertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO_Token);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, vec_TokenIndices.size() * sizeof(GLuint), vec_TokenIndices.data(), GL_STATIC_DRAW);
+
+    // Per-instance: model matrix (4 columns), color, picking color
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_TokenInstances);
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+    for (int i_Col = 0; i_Col < 4; ++i_Col) {
+        GLuint ui_Loc = 2 + i_Col;
+        glVertexAttribPointer(ui_Loc, 4, GL_FLOAT, GL_FALSE, sizeof(TokenInstance),
+                              (void*)(offsetof(TokenInstance, mat4_Model) + i_Col * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(ui_Loc);
+        glVertexAttribDivisor(ui_Loc, 1);
+    }
+    glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, sizeof(TokenInstance), (void*)offsetof(TokenInstance, vec3_Color));
+    glEnableVertexAttribArray(6);
+    glVertexAttribDivisor(6, 1);
+    glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(TokenInstance), (void*)offsetof(TokenInstance, vec3_PickingColor));
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, 1);
 
-    std::vector<float> hemiVerts = generateHemisphereVertices(0.05f, 30); // radius, segments
-    m_i_HemisphereVertexCount = static_cast<int>(hemiVerts.size() / 3);
-    glGenVertexArrays(1, &m_VAO_Hemisphere);
-    glGenBuffers(1, &m_VBO_Hemisphere);
-    glBindVertexArray(m_VAO_Hemisphere);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Hemisphere);
-    glBufferData(GL_ARRAY_BUFFER, hemiVerts.size() * sizeof(float), hemiVerts.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     // Shadery planszy
     const char* vertexShaderSrc = R"(
@@ -236,6 +242,45 @@ void GameState::OnEnter() {
     glDeleteShader(cVertexShader);
     glDeleteShader(cFragmentShader);
 
+    // Stations: one instance per ring, offset and scale per instance
+    const char* stationVertexShaderSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec3 aPos;
+        layout(location = 1) in vec4 aPositionScale;
+        layout(location = 2) in vec4 aColor;
+        uniform mat4 viewProjection;
+        out vec3 ringColor;
+        void main() {
+            ringColor = aColor.rgb;
+            gl_Position = viewProjection * vec4(aPositionScale.xyz + aPos * aPositionScale.w, 1.0);
+        }
+    )";
+
+    const char* stationFragmentShaderSrc = R"(
+        #version 330 core
+        in vec3 ringColor;
+        out vec4 FragColor;
+        void main() {
+            FragColor = vec4(ringColor, 1.0);
+        }
+    )";
+
+    GLuint stationVS = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(stationVS, 1, &stationVertexShaderSrc, nullptr);
+    glCompileShader(stationVS);
+
+    GLuint stationFS = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(stationFS, 1, &stationFragmentShaderSrc, nullptr);
+    glCompileShader(stationFS);
+
+    m_ShaderProgram_Station = glCreateProgram();
+    glAttachShader(m_ShaderProgram_Station, stationVS);
+    glAttachShader(m_ShaderProgram_Station, stationFS);
+    glLinkProgram(m_ShaderProgram_Station);
+
+    glDeleteShader(stationVS);
+    glDeleteShader(stationFS);
+
     // Shader for color picking
     const char* pickingVertexShaderSrc = R"(
         #version 330 core
@@ -271,6 +316,59 @@ void GameState::OnEnter() {
     glDeleteShader(pickingVS);
     glDeleteShader(pickingFS);
 
+    // Shader for instanced player tokens; the picking pass reuses it with flat picking colors
+    const char* tokenVertexShaderSrc = R"(
+        #version 330 core
+        layout(location = 0) in vec3 aPos;
+        layout(location = 1) in vec3 aNormal;
+        layout(location = 2) in mat4 aModel;
+        layout(location = 6) in vec3 aColor;
+        layout(location = 7) in vec3 aPickingColor;
+        uniform mat4 viewProjection;
+        uniform bool picking;
+        out vec3 vNormal;
+        flat out vec3 vColor;
+        void main() {
+            vNormal = mat3(aModel) * aNormal;
+            vColor = picking ? aPickingColor : aColor;
+            gl_Position = viewProjection * aModel * vec4(aPos, 1.0);
+        }
+    )";
+
+    const char* tokenFragmentShaderSrc = R"(
+        #version 330 core
+        in vec3 vNormal;
+        flat in vec3 vColor;
+        uniform bool picking;
+        out vec4 FragColor;
+        void main() {
+            if (picking) {
+                FragColor = vec4(vColor, 1.0);
+                return;
+            }
+            float diffuse = max(dot(normalize(vNormal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+            FragColor = vec4(vColor * (0.6 + 0.4 * diffuse) + vec3(0.08) * diffuse, 1.0);
+        }
+    )";
+
+    GLuint tokenVS = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(tokenVS, 1, &tokenVertexShaderSrc, nullptr);
+    glCompileShader(tokenVS);
+
+    GLuint tokenFS = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(tokenFS, 1, &tokenFragmentShaderSrc, nullptr);
+    glCompileShader(tokenFS);
+
+    m_ShaderProgram_Token = glCreateProgram();
+    glAttachShader(m_ShaderProgram_Token, tokenVS);
+    glAttachShader(m_ShaderProgram_Token, tokenFS);
+    glLinkProgram(m_ShaderProgram_Token);
+
+    glDeleteShader(tokenVS);
+    glDeleteShader(tokenFS);
+
+    m_FrameProfiler.Initialize();
+
     // Framebuffer for color picking
     glGenFramebuffers(1, &m_FBO_Picking);
     glBindFramebuffer(GL_FRAMEBUFFER, m_FBO_Picking);
@@ -447,10 +545,7 @@ void GameState::OnEnter() {
     // Initialize players from graph data (random distinct nodes)
     m_vec_Players.clear();
 
-    GraphManager gm(Core::k_MaxNodes);
-    gm.LoadData(Core::GetMapPath(Core::k_NodeDataRelativePath), Core::GetMapPath(Core::k_ConnectionsRelativePath), false);
-
-    int i_NodeCount = gm.GetNodeCount();
+    int i_NodeCount = m_sp_Map->GetNodeCount();
     if (i_NodeCount <= 0) {
         // fallback to simple hardcoded values if graph failed to load
         m_vec_Players.emplace_back(Core::PlayerType::MisterX, 10);
@@ -462,14 +557,16 @@ void GameState::OnEnter() {
     else
     {
         std::random_device rd;
-        std::mt19937 rng(rd());
-        std::uniform_int_distribution<int> dist(1, i_NodeCount);
+        std::mt19937 rng(m_u32_StartSeed != 0 ? m_u32_StartSeed : rd());
+        // Losujemy indeksy, nie ID - ID w mapach z OSM nie są ciągłe
+        std::uniform_int_distribution<int> dist(0, i_NodeCount - 1);
+        const GraphManager& graph = m_sp_Map->GetGraph();
 
         auto pick_unique = [&](std::vector<int>& vec_Used) {
             int i_V;
             do { i_V = dist(rng); } while (std::find(vec_Used.begin(), vec_Used.end(), i_V) != vec_Used.end());
             vec_Used.push_back(i_V);
-            return i_V;
+            return graph.GetNodeByIndex(static_cast<uint32_t>(i_V))->id;
         };
 
         std::vector<int> vec_Used;
@@ -515,11 +612,11 @@ void GameState::OnEnter() {
     }
 
     // --- Console interaction in background thread: allow moving a player to a connected node ---
-    m_graph.LoadData(Core::GetMapPath(Core::k_NodeDataRelativePath), Core::GetMapPath(Core::k_ConnectionsRelativePath), false);
-
-    // Launch console input loop as a dedicated joinable thread so we don't occupy a ThreadPool worker
+    // Launch console input loop as a dedicated joinable thread so we don't occupy a ThreadPool worker.
+    // It holds its own map reference because OnExit may have to detach it while it blocks on stdin.
     m_b_ConsoleThreadRunning.store(true);
-    m_t_ConsoleThread = std::thread([this]() {
+    m_t_ConsoleThread = std::thread([this, sp_Map = m_sp_Map]() {
+        Core::TraceRecorder::SetThreadName("Console");
         while (m_b_ConsoleThreadRunning.load()) {
             // Print snapshot once and then block waiting for user input (no spamming)
             {
@@ -583,7 +680,7 @@ void GameState::OnEnter() {
             }
 
             std::cout << "[Console] Player " << idx << " is at node " << curNode << "\n";
-            auto conns = m_graph.GetConnections(curNode);
+            auto conns = sp_Map->GetGraph().GetConnections(curNode);
             if (conns.empty()) { std::cout << "[Console] No connections from this node.\n"; continue; }
 
             std::cout << "[Console] Available moves:\n";
@@ -606,6 +703,8 @@ void GameState::OnEnter() {
             catch (...) { std::cout << "[Console] Invalid move index\n"; continue; }
             if (i_MoveIndex < 0 || i_MoveIndex >= static_cast<int>(conns.size())) { std::cout << "[Console] Move index out of range\n"; continue; }
 
+            // Everything above waits on stdin; only the move itself is worth tracing
+            TRACE_SCOPE("Console::ApplyMove");
 
             int i_DestinationNode = conns[i_MoveIndex].i_NodeId;
             int i_TransportType = conns[i_MoveIndex].i_TransportType;
@@ -734,8 +833,9 @@ void GameState::OnEnter() {
 void GameState::LoadTextures(Core::Application* p_App) {
     if (m_b_TexturesLoaded) return;
 
-    std::string s_TexturePath = p_App->GetAssetPath("textures/Scotland_Yard_schematic.png");
-    m_TextureID = p_App->LoadTexture(s_TexturePath);
+    // Usually already decoding since the menu; shows a placeholder until uploaded
+    std::string s_TexturePath = p_App->GetAssetPath(Core::k_BoardTextureRelativePath);
+    m_TextureID = p_App->LoadTextureAsync(s_TexturePath);
     if (m_TextureID == 0) {
         printf("Failed to load board texture\n");
     }
@@ -747,14 +847,7 @@ void GameState::LoadTextures(Core::Application* p_App) {
 }
 
 void GameState::OnExit() {
-    if (m_VAO_Plane) {
-        glDeleteVertexArrays(1, &m_VAO_Plane);
-        m_VAO_Plane = 0;
-    }
-    if (m_VBO_Plane) {
-        glDeleteBuffers(1, &m_VBO_Plane);
-        m_VBO_Plane = 0;
-    }
+    m_BoardTiles.Shutdown();
     if (m_VAO_Circle) {
         glDeleteVertexArrays(1, &m_VAO_Circle);
         m_VAO_Circle = 0;
@@ -763,22 +856,25 @@ void GameState::OnExit() {
         glDeleteBuffers(1, &m_VBO_Circle);
         m_VBO_Circle = 0;
     }
-    if (m_VAO_Cylinder) {
-        glDeleteVertexArrays(1, &m_VAO_Cylinder);
-        m_VAO_Cylinder = 0;
+    if (m_VAO_Token) {
+        glDeleteVertexArrays(1, &m_VAO_Token);
+        m_VAO_Token = 0;
     }
-    if (m_VBO_Cylinder) {
-        glDeleteBuffers(1, &m_VBO_Cylinder);
-        m_VBO_Cylinder = 0;
+    if (m_VBO_Token) {
+        glDeleteBuffers(1, &m_VBO_Token);
+        m_VBO_Token = 0;
     }
-
-    if (m_VAO_Hemisphere) {
-        glDeleteVertexArrays(1, &m_VAO_Hemisphere);
-        m_VAO_Hemisphere = 0;
+    if (m_EBO_Token) {
+        glDeleteBuffers(1, &m_EBO_Token);
+        m_EBO_Token = 0;
+    }
+    if (m_VBO_TokenInstances) {
+        glDeleteBuffers(1, &m_VBO_TokenInstances);
+        m_VBO_TokenInstances = 0;
     }
-    if (m_VBO_Hemisphere) {
-        glDeleteBuffers(1, &m_VBO_Hemisphere);
-        m_VBO_Hemisphere = 0;
+    if (m_ShaderProgram_Token) {
+        glDeleteProgram(m_ShaderProgram_Token);
+        m_ShaderProgram_Token = 0;
     }
     if (m_ShaderProgram_Plane) {
         glDeleteProgram(m_ShaderProgram_Plane);
@@ -788,6 +884,10 @@ void GameState::OnExit() {
         glDeleteProgram(m_ShaderProgram_Circle);
         m_ShaderProgram_Circle = 0;
     }
+    if (m_ShaderProgram_Station) {
+        glDeleteProgram(m_ShaderProgram_Station);
+        m_ShaderProgram_Station = 0;
+    }
     if (m_FBO_Picking) {
         glDeleteFramebuffers(1, &m_FBO_Picking);
         m_FBO_Picking = 0;
@@ -832,6 +932,9 @@ void GameState::OnExit() {
         glDeleteBuffers(1, &m_VBO_FullscreenQuad);
         m_VBO_FullscreenQuad = 0;
     }
+    ScotlandYard::UI::ShutdownHUD();
+    m_FrameProfiler.Shutdown();
+
     // Note: do not delete m_TextureID here -- textures are managed by Application's cache.
     // ResetToInitial() will set m_TextureID to 0 so LoadTextures() can re-acquire or reload it.
     m_b_GameActive = false;
@@ -850,6 +953,7 @@ void GameState::OnExit() {
 
     // Ensure game data is reset when exiting so re-entering GameState starts fresh
     ResetToInitial();
+    m_sp_Map.reset();
 }
 
 void GameState::ResetToInitial() {
@@ -932,31 +1036,71 @@ void GameState::Update(float f_DeltaTime) {
     UpdateCameraPhysics(f_DeltaTime);
 }
 
-void GameState::RenderMrXToken(const glm::vec2& vec2_Position, const glm::mat4& mat4_Projection, const glm::mat4& mat4_View, GLint i_MvpLoc, GLint i_ColorLoc) {
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(vec2_Position.x, 0.01f, vec2_Position.y));
-    model = glm::scale(model, glm::vec3(0.45f));
+bool GameState::IsTokenVisible(const Core::Player& player) const {
+    if (player.GetType() != Core::PlayerType::MisterX) return true;
 
-    // MisterX colour (black)
-    glm::vec3 color = glm::vec3(0.0f, 0.0f, 0.0f);
-    glUniform3fv(i_ColorLoc, 1, glm::value_ptr(color));
+    if (m_b_DebuggingMode.load()) {
+        return m_b_ShowMrXInDebug.load();
+    }
+    return Core::IsRevealRound(m_i_Round.load()) && player.IsActive();
+}
 
-    // Body (cylinder)
-    glm::mat4 cylModel = glm::scale(model, glm::vec3(1.0f));
-    glm::mat4 MVP = mat4_Projection * mat4_View * cylModel;
-    glUniformMatrix4fv(i_MvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
+void GameState::BuildTokenInstances(const Core::Frustum& frustum) {
+    // Visible tokens first so Render() can draw a prefix; hidden ones stay pickable as before
+    m_vec_TokenInstances.clear();
+    m_vec_TokenClickables.clear();
+    m_i_VisibleTokenCount = 0;
 
-    glBindVertexArray(m_VAO_Cylinder);
-    glDrawArrays(GL_TRIANGLES, 0, m_i_CylinderVertexCount);
-    glBindVertexArray(0);
+    std::lock_guard<std::mutex> lock(m_mtx_Players);
+    for (int i_Pass = 0; i_Pass < 2; ++i_Pass) {
+        bool b_WantVisible = (i_Pass == 0);
 
-    // Top (hemisphere)
-    glm::mat4 hemiModel = glm::translate(model, glm::vec3(0.0f, 0.1f, 0.0f));
-    MVP = mat4_Projection * mat4_View * hemiModel;
-    glUniformMatrix4fv(i_MvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
+        for (size_t i = 0; i < m_vec_Players.size(); ++i) {
+            const auto& player = m_vec_Players[i];
+            if (IsTokenVisible(player) != b_WantVisible) continue;
+
+            int nodeId = player.GetOccupiedNode();
+            auto it = std::find_if(m_vec_CircleStations.begin(), m_vec_CircleStations.end(),
+                                [nodeId](const StationCircle& sc){ return sc.stationID == nodeId; });
+            if (it == m_vec_CircleStations.end()) continue;
 
-    glBindVertexArray(m_VAO_Hemisphere);
-    glDrawArrays(GL_TRIANGLES, 0, m_i_HemisphereVertexCount);
+            bool b_MrX = (player.GetType() == Core::PlayerType::MisterX);
+            float f_Scale = b_MrX ? 0.45f : 0.4f;
+
+            glm::vec3 vec3_Base(it->position.x, 0.01f, it->position.y);
+            glm::vec3 vec3_Reach(k_TokenMeshRadius * f_Scale, k_TokenMeshHeight * f_Scale, k_TokenMeshRadius * f_Scale);
+            if (!frustum.IsBoxVisible(vec3_Base - glm::vec3(vec3_Reach.x, 0.0f, vec3_Reach.z), vec3_Base + vec3_Reach)) continue;
+
+            TokenInstance instance;
+            instance.mat4_Model = glm::translate(glm::mat4(1.0f), vec3_Base);
+            instance.mat4_Model = glm::scale(instance.mat4_Model, glm::vec3(f_Scale));
+            // Mr X czarny, detektywi niebiescy
+            instance.vec3_Color = b_MrX ? glm::vec3(0.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+            instance.vec3_PickingColor = glm::vec3(0.0f);
+
+            m_vec_TokenInstances.push_back(instance);
+            m_vec_TokenClickables.push_back({ b_MrX ? ClickableType::MisterX : ClickableType::Detective, static_cast<int>(i), 0 });
+            if (b_WantVisible) ++m_i_VisibleTokenCount;
+        }
+    }
+}
+
+void GameState::UploadTokenInstances() {
+    // Orphan and refill; the buffer is shared by the visible and picking passes
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO_TokenInstances);
+    glBufferData(GL_ARRAY_BUFFER, m_vec_TokenInstances.size() * sizeof(TokenInstance), m_vec_TokenInstances.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GameState::DrawTokenInstances(const glm::mat4& mat4_ViewProjection, int i_Count, bool b_Picking) {
+    if (i_Count <= 0) return;
+
+    glUseProgram(m_ShaderProgram_Token);
+    glUniformMatrix4fv(glGetUniformLocation(m_ShaderProgram_Token, "viewProjection"), 1, GL_FALSE, glm::value_ptr(mat4_ViewProjection));
+    glUniform1i(glGetUniformLocation(m_ShaderProgram_Token, "picking"), b_Picking ? 1 : 0);
+
+    glBindVertexArray(m_VAO_Token);
+    glDrawElementsInstanced(GL_TRIANGLES, m_i_TokenIndexCount, GL_UNSIGNED_INT, nullptr, i_Count);
     glBindVertexArray(0);
 }
 
@@ -983,6 +1127,10 @@ void GameState::Render(Core::Application* p_App) {
         glBindRenderbuffer(GL_RENDERBUFFER, 0);
     }
 
+    m_FrameProfiler.SetEnabled(m_b_DebuggingMode.load());
+    m_FrameProfiler.BeginFrame();
+    m_FrameProfiler.BeginPass("Plane");
+
     glEnable(GL_DEPTH_TEST);
     glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1031,142 +1179,35 @@ void GameState::Render(Core::Application* p_App) {
     GLuint texLoc = glGetUniformLocation(m_ShaderProgram_Plane, "ourTexture");
     glUniform1i(texLoc, 0);
 
-    // Rysowanie planszy
-    glBindVertexArray(m_VAO_Plane);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-
-    // Rysowanie wielokolorowych kółek
+    // Rysowanie planszy: tylko kafelki w polu widzenia, w przestrzeni modelu planszy
+    glm::vec3 vec3_EyePosition = m_b_Camera3D ? m_vec3_CameraPosition : glm::vec3(0.0f, 10.0f, 0.0f);
+    glm::vec3 vec3_BoardEye = glm::vec3(glm::inverse(model) * glm::vec4(vec3_EyePosition, 1.0f));
+    m_BoardTiles.SelectBoardTiles(Core::Frustum(MVP), vec3_BoardEye);
+    m_BoardTiles.DrawBoard();
+
+    // Rysowanie wielokolorowych kółek: jedno wywołanie na ciągły zakres widocznych kafelków
+    m_FrameProfiler.BeginPass("Stations");
+    glm::mat4 mat4_ViewProjection = projection * view;
+    glUseProgram(m_ShaderProgram_Station);
+    glUniformMatrix4fv(glGetUniformLocation(m_ShaderProgram_Station, "viewProjection"), 1, GL_FALSE,
+                       glm::value_ptr(mat4_ViewProjection));
+    m_BoardTiles.SelectStations(Core::Frustum(mat4_ViewProjection));
+    m_BoardTiles.DrawStations(m_i_CircleVertexCount);
+
+    // Pionki graczy: jedno wywołanie instancyjne dla wszystkich widocznych
+    m_FrameProfiler.BeginPass("Tokens");
+    Core::Frustum frustum(mat4_ViewProjection);
+    BuildTokenInstances(frustum);
+    UploadTokenInstances();
+    DrawTokenInstances(mat4_ViewProjection, m_i_VisibleTokenCount, false);
+
+    m_FrameProfiler.BeginPass("Arrows");
     glUseProgram(m_ShaderProgram_Circle);
     GLuint mvpLoc = glGetUniformLocation(m_ShaderProgram_Circle, "MVP");
     GLuint colorLoc = glGetUniformLocation(m_ShaderProgram_Circle, "circleColor");
-
-    float baseScale = 0.5f;      // White circle base scale
-    float ringStep = 0.1f;       // Step increase for each transport type
-    float yStep = 0.005f;         // Vertical offset step to prevent z-fighting
-
-    for (const auto& station : m_vec_CircleStations)
-    {
-        glm::mat4 modelBase = glm::mat4(1.0f);
-        modelBase = glm::translate(modelBase, glm::vec3(station.position.x, 0.0f, station.position.y));
-
-        // Twarda kolejność typów transportu od dołu do góry
-        std::vector<std::string> order = { "metro", "bus", "taxi", "water" };
-
-        // Filtrujemy tylko typy, które są w stacji
-        std::vector<std::string> typesPresent;
-        for (const auto& t : order)
-            if (std::find(station.transportTypes.begin(), station.transportTypes.end(), t) != station.transportTypes.end())
-                typesPresent.push_back(t);
-
-        int count = static_cast<int>(typesPresent.size());
-        for (int i = 0; i < count; ++i)
-        {
-            const std::string& type = typesPresent[i];
-            glm::vec3 color;
-
-            if (type == "metro") color = glm::vec3(1.0f, 0.0f, 0.0f);      // czerwony
-            else if (type == "bus") color = glm::vec3(0.0f, 1.0f, 0.0f);   // zielony
-            else if (type == "taxi") color = glm::vec3(1.0f, 1.0f, 0.0f);  // żółty
-            else color = glm::vec3(0.0f, 0.4f, 1.0f);                      // woda/łódź
-
-            // Odwrócone skalowanie: największe na dole
-            float scale = baseScale + (count - i) * ringStep;
-            float yOffset = 0.01f + i * yStep;
-
-            glm::mat4 model = glm::translate(modelBase, glm::vec3(0.0f, yOffset, 0.0f));
-            model = glm::scale(model, glm::vec3(scale));
-            glm::mat4 MVP = projection * view * model;
-
-            glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
-            glUniform3fv(colorLoc, 1, glm::value_ptr(color));
-
-            glBindVertexArray(m_VAO_Circle);
-            glDrawArrays(GL_TRIANGLE_FAN, 0, m_i_CircleVertexCount);
-            glBindVertexArray(0);
-        }
-
-        glm::mat4 model = glm::translate(modelBase, glm::vec3(0.0f, 0.01f + count * yStep, 0.0f));
-        model = glm::scale(model, glm::vec3(baseScale));
-        glm::mat4 MVP = projection * view * model;
-
-        glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
-        glUniform3fv(colorLoc, 1, glm::value_ptr(glm::vec3(1.0f, 1.0f, 1.0f)));
-
-        glBindVertexArray(m_VAO_Circle);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, m_i_CircleVertexCount);
-        glBindVertexArray(0);
-    }
-
-    for (const auto& player : m_vec_Players)
-    {
-        if (player.GetType() != Core::PlayerType::Detective) continue;
-
-        int nodeId = player.GetOccupiedNode();
-        auto it = std::find_if(m_vec_CircleStations.begin(), m_vec_CircleStations.end(),
-                            [nodeId](const StationCircle& sc){ return sc.stationID == nodeId; });
-        if (it == m_vec_CircleStations.end()) continue;
-
-        glm::vec2 pos = it->position;
-
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(pos.x, 0.01f, pos.y));
-        model = glm::scale(model, glm::vec3(0.4f));
-        
-        // Kolor detektywa (np. niebieski)
-        glm::vec3 color = glm::vec3(0.0f, 0.0f, 1.0f);
-        glUniform3fv(colorLoc, 1, glm::value_ptr(color));
-        
-        // Body
-        glm::mat4 cylModel = glm::scale(model,glm::vec3(1.0f));
-        glm::mat4 MVP = projection * view * cylModel;
-        glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
-
-        glBindVertexArray(m_VAO_Cylinder);
-        glDrawArrays(GL_TRIANGLES, 0, m_i_CylinderVertexCount);
-        glBindVertexArray(0);
-
-        // Top
-        glm::mat4 hemiModel = glm::translate(model, glm::vec3(0.0f, 0.1f, 0.0f)); // przesunięcie na górę cylindra
-        MVP = projection * view * hemiModel;
-        glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
-
-        glBindVertexArray(m_VAO_Hemisphere);
-        glDrawArrays(GL_TRIANGLES, 0, m_i_HemisphereVertexCount);
-        glBindVertexArray(0);
-    }
-
-    int i_CurrentRoundForRender = m_i_Round.load();
-
-    if (m_b_DebuggingMode.load() && m_b_ShowMrXInDebug.load()) {
-        for (const auto& player : m_vec_Players) {
-            if (player.GetType() != Core::PlayerType::MisterX) continue;
-
-            int nodeId = player.GetOccupiedNode();
-            auto it = std::find_if(m_vec_CircleStations.begin(), m_vec_CircleStations.end(),
-                            [nodeId](const StationCircle& sc){ return sc.stationID == nodeId; });
-            if (it == m_vec_CircleStations.end()) continue;
-
-            RenderMrXToken(it->position, projection, view, mvpLoc, colorLoc);
-        }
-    } else if (!m_b_DebuggingMode.load()) {
-        if (Core::IsRevealRound(i_CurrentRoundForRender)) {
-            for (const auto& player : m_vec_Players) {
-                if (player.GetType() != Core::PlayerType::MisterX) continue;
-                if (!player.IsActive()) continue;
-
-                int nodeId = player.GetOccupiedNode();
-                auto it = std::find_if(m_vec_CircleStations.begin(), m_vec_CircleStations.end(),
-                                [nodeId](const StationCircle& sc){ return sc.stationID == nodeId; });
-                if (it == m_vec_CircleStations.end()) continue;
-
-                RenderMrXToken(it->position, projection, view, mvpLoc, colorLoc);
-            }
-        }
-    }
-
-    glUseProgram(m_ShaderProgram_Circle);
     for (const auto& arrow : m_vec_CurrentArrows) {
+        if (!IsArrowInFrustum(arrow, frustum)) continue;
+
         glm::vec3 vec3_ArrowColor;
         if (arrow.i_TransportType == Core::k_TransportTypeTaxi) {
             vec3_ArrowColor = glm::vec3(1.0f, 1.0f, 0.0f);
@@ -1193,7 +1234,7 @@ void GameState::Render(Core::Application* p_App) {
         glBindVertexArray(0);
     }
 
-    std::vector<std::string> labels = { "Runda ...", "Black", "2x", "TAXI", "Metro", "Bus" };
+    static const std::vector<std::string> labels = { "Runda ...", "Black", "2x", "TAXI", "Metro", "Bus" };
 
     // counters for Black and 2x tickets for Mr X
     int black = -1, dbl = -1;
@@ -1206,12 +1247,16 @@ void GameState::Render(Core::Application* p_App) {
     }
     std::vector<int> counts = { -1, black, dbl, -1, -1, -1 };
 
-    // to HUD
+    m_FrameProfiler.BeginPass("HUD");
+
+    // to HUD; the overlay only re-lays itself out when one of these actually changed
+    ScotlandYard::UI::SetViewport(m_i_Width, m_i_Height);
     ScotlandYard::UI::SetTopBar(labels, {}, counts);
     ScotlandYard::UI::SetRound(m_i_Round.load());
     ScotlandYard::UI::RenderHUD(p_App);
 
     if (m_b_DebuggingMode.load()) {
+        m_FrameProfiler.BeginPass("Debug overlay");
         GLboolean b_DepthWasDebug = glIsEnabled(GL_DEPTH_TEST);
         GLboolean b_BlendWasDebug = glIsEnabled(GL_BLEND);
         if (b_DepthWasDebug) glDisable(GL_DEPTH_TEST);
@@ -1219,11 +1264,12 @@ void GameState::Render(Core::Application* p_App) {
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         std::string s_DebugText1 = "DEBUG MODE - Press P: Color Picking View";
-        std::string s_DebugText2 = "Press M: Toggle Mr X Visibility";
+        std::string s_DebugText2 = "Press M: Toggle Mr X Visibility   F: Dump Frame Profile";
 
         UI::Color white{1.0f, 1.0f, 1.0f, 1.0f};
         UI::DrawTextCenteredPx(s_DebugText1, 10, m_i_Height - 60, m_i_Width - 10, m_i_Height - 40, white, p_App, 0.0f);
         UI::DrawTextCenteredPx(s_DebugText2, 10, m_i_Height - 40, m_i_Width - 10, m_i_Height - 20, white, p_App, 0.0f);
+        RenderProfilerOverlay(p_App);
 
         if (b_BlendWasDebug == GL_FALSE) glDisable(GL_BLEND);
         if (b_DepthWasDebug) glEnable(GL_DEPTH_TEST);
@@ -1233,7 +1279,9 @@ void GameState::Render(Core::Application* p_App) {
         m_map_PickingIDToClickable.clear();
         m_ui_NextPickingID = 0;
 
+        m_FrameProfiler.BeginPass("Picking");
         RenderPickingPass(projection, view);
+        m_FrameProfiler.BeginPass("Dilation");
         ApplyDilationPass();
 
         int i_WindowWidth = p_App->GetWidth();
@@ -1249,6 +1297,7 @@ void GameState::Render(Core::Application* p_App) {
 
     // Draw end-of-game modal on top of HUD if requested (before buffer swap)
     if (m_b_ShowEndGameModal.load()) {
+        m_FrameProfiler.BeginPass("End modal");
         // ensure UI-friendly state
         GLboolean b_DepthWas = glIsEnabled(GL_DEPTH_TEST);
         GLboolean b_BlendWas = glIsEnabled(GL_BLEND);
@@ -1310,6 +1359,19 @@ void GameState::Render(Core::Application* p_App) {
         if (b_DepthWas) glEnable(GL_DEPTH_TEST);
     }
 
+    m_FrameProfiler.EndFrame();
+
+    // The back buffer's contents are undefined once swapped, so read before
+    if (m_p_vec_CapturePixels) {
+        m_p_vec_CapturePixels->resize(static_cast<size_t>(m_i_CaptureWidth) * m_i_CaptureHeight * 3);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glReadBuffer(GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, m_i_CaptureWidth, m_i_CaptureHeight, GL_RGB, GL_UNSIGNED_BYTE,
+                     m_p_vec_CapturePixels->data());
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        m_p_vec_CapturePixels = nullptr;
+    }
 
     SDL_GL_SwapWindow(SDL_GL_GetCurrentWindow());
     if (m_b_RequestMenuChange.load() && p_App) {
@@ -1322,6 +1384,50 @@ void GameState::Render(Core::Application* p_App) {
     }
 }
 
+void GameState::RenderProfilerOverlay(Core::Application* p_App) {
+    // Rolling averages over the last resolved frames, one line per pass, under the debug hints
+    UI::Color grey{0.85f, 0.85f, 0.85f, 1.0f};
+    const float f_LineH = 20.0f;
+    const float f_X0 = 10.0f;
+    const float f_X1 = 360.0f;
+    float f_Y1 = m_i_Height - 80.0f;
+
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "Frame CPU %.2f ms (avg of %d)", m_FrameProfiler.GetAvgFrameCpuMs(), m_FrameProfiler.GetResolvedFrameCount());
+    UI::DrawTextCenteredPx(buf, f_X0, f_Y1 - f_LineH, f_X1, f_Y1, grey, p_App, 0.0f);
+    f_Y1 -= f_LineH;
+
+    for (const auto& pass : m_FrameProfiler.GetSummary()) {
+        if (pass.f_AvgGpuMs >= 0.0f) {
+            std::snprintf(buf, sizeof(buf), "%s  cpu %.2f  gpu %.2f (max %.2f)", pass.s_Name.c_str(), pass.f_AvgCpuMs, pass.f_AvgGpuMs, pass.f_MaxGpuMs);
+        } else {
+            std::snprintf(buf, sizeof(buf), "%s  cpu %.2f  gpu -", pass.s_Name.c_str(), pass.f_AvgCpuMs);
+        }
+        UI::DrawTextCenteredPx(buf, f_X0, f_Y1 - f_LineH, f_X1, f_Y1, grey, p_App, 0.0f);
+        f_Y1 -= f_LineH;
+    }
+
+    // Inference telemetry of the loaded model, when there is one
+    if (AI::NeuralNetworkManager::IsReady()) {
+        AI::InferenceStats stats = AI::NeuralNetworkManager::GetStats();
+        std::snprintf(buf, sizeof(buf), "NN %llu inferences (%.0f/s)  avg batch %.1f",
+                      static_cast<unsigned long long>(stats.u64_Requests), stats.GetRequestsPerSecond(),
+                      stats.GetAverageBatchSize());
+        UI::DrawTextCenteredPx(buf, f_X0, f_Y1 - f_LineH, f_X1, f_Y1, grey, p_App, 0.0f);
+        f_Y1 -= f_LineH;
+
+        std::snprintf(buf, sizeof(buf), "NN latency us  p50 %.0f  p95 %.0f  p99 %.0f",
+                      stats.latency.d_P50Us, stats.latency.d_P95Us, stats.latency.d_P99Us);
+        UI::DrawTextCenteredPx(buf, f_X0, f_Y1 - f_LineH, f_X1, f_Y1, grey, p_App, 0.0f);
+        f_Y1 -= f_LineH;
+
+        std::snprintf(buf, sizeof(buf), "NN wait p99 %.0f  compute p50 %.0f  p99 %.0f",
+                      stats.queueWait.d_P99Us, stats.compute.d_P50Us, stats.compute.d_P99Us);
+        UI::DrawTextCenteredPx(buf, f_X0, f_Y1 - f_LineH, f_X1, f_Y1, grey, p_App, 0.0f);
+        f_Y1 -= f_LineH;
+    }
+}
+
 void GameState::CheckEndOfGame(Winner winner) {
     if (winner == Winner::None) {
         if (m_i_Round.load() >= Core::k_MaxRounds) {
@@ -1378,6 +1484,14 @@ void GameState::HandleEvent(const SDL_Event& event, Core::Application* p_App) {
                     std::cout << "[GameState] Mr X visibility: " << (m_b_ShowMrXInDebug.load() ? "ON" : "OFF") << "\n";
                 }
                 break;
+            case SDLK_f:
+                if (m_b_DebuggingMode.load()) {
+                    if (m_FrameProfiler.DumpToFile(k_FrameProfileDumpPath)) {
+                        std::cout << "[GameState] Frame profile (" << m_FrameProfiler.GetResolvedFrameCount()
+                                  << " frames) written to " << k_FrameProfileDumpPath << "\n";
+                    }
+                }
+                break;
         }
     }
 
@@ -1428,6 +1542,49 @@ void GameState::HandleEvent(const SDL_Event& event, Core::Application* p_App) {
 }
 
 
+void GameState::BuildStationInstances(std::vector<Core::BoardTiles::StationInstance>& vec_Instances,
+                                      std::vector<uint32_t>& vec_StationOffsets) const {
+    float baseScale = 0.5f;      // White circle base scale
+    float ringStep = 0.1f;       // Step increase for each transport type
+    float yStep = 0.005f;         // Vertical offset step to prevent z-fighting
+
+    // Twarda kolejność typów transportu od dołu do góry
+    static const char* const arr_Order[] = { "metro", "bus", "taxi", "water" };
+    static const glm::vec3 arr_Colors[] = {
+        glm::vec3(1.0f, 0.0f, 0.0f),    // czerwony
+        glm::vec3(0.0f, 1.0f, 0.0f),    // zielony
+        glm::vec3(1.0f, 1.0f, 0.0f),    // żółty
+        glm::vec3(0.0f, 0.4f, 1.0f)     // woda/łódź
+    };
+
+    vec_Instances.clear();
+    vec_Instances.reserve(m_vec_CircleStations.size() * 3);
+    vec_StationOffsets.assign(1, 0);
+
+    for (const auto& station : m_vec_CircleStations)
+    {
+        // Filtrujemy tylko typy, które są w stacji
+        int arr_Present[4];
+        int count = 0;
+        for (int t = 0; t < 4; ++t)
+            if (std::find(station.transportTypes.begin(), station.transportTypes.end(), arr_Order[t]) != station.transportTypes.end())
+                arr_Present[count++] = t;
+
+        for (int i = 0; i < count; ++i)
+        {
+            // Odwrócone skalowanie: największe na dole
+            float scale = baseScale + (count - i) * ringStep;
+            float yOffset = 0.01f + i * yStep;
+            vec_Instances.push_back({ glm::vec4(station.position.x, yOffset, station.position.y, scale),
+                                      glm::vec4(arr_Colors[arr_Present[i]], 1.0f) });
+        }
+
+        vec_Instances.push_back({ glm::vec4(station.position.x, 0.01f + count * yStep, station.position.y, baseScale),
+                                  glm::vec4(1.0f) });
+        vec_StationOffsets.push_back(static_cast<uint32_t>(vec_Instances.size()));
+    }
+}
+
 std::vector<float> GameState::generateCircleVertices(float f_Radius, int i_Segments) {
     std::vector<float> vec_Vertices;
 
@@ -1447,90 +1604,103 @@ std::vector<float> GameState::generateCircleVertices(float f_Radius, int i_Segme
     return vec_Vertices;
 }
 
-std::vector<float> GameState::generateCylinderVertices(float radius, float height, int segments)
+void GameState::generateCylinderMesh(float radius, float height, int segments,
+                                     std::vector<float>& vec_Vertices, std::vector<GLuint>& vec_Indices)
 {
-    std::vector<float> verts;
     const float k_TwoPi = 2.0f * glm::pi<float>();
+    auto pushVertex = [&vec_Vertices](float x, float y, float z, float nx, float ny, float nz) {
+        vec_Vertices.insert(vec_Vertices.end(), { x, y, z, nx, ny, nz });
+        return static_cast<GLuint>(vec_Vertices.size() / 6 - 1);
+    };
 
+    // boczna ściana: pierścień dolny i górny, normalne promieniowe
+    GLuint ui_SideBase = static_cast<GLuint>(vec_Vertices.size() / 6);
+    for (int i = 0; i <= segments; ++i)
+    {
+        float theta = (float)i / segments * k_TwoPi;
+        float c = cos(theta);
+        float sn = sin(theta);
+        pushVertex(radius * c, 0.0f, radius * sn, c, 0.0f, sn);
+        pushVertex(radius * c, height, radius * sn, c, 0.0f, sn);
+    }
     for (int i = 0; i < segments; ++i)
     {
-        float theta1 = (float)i / segments * k_TwoPi;
-        float theta2 = (float)(i+1) / segments * k_TwoPi;
-
-        float x1 = radius * cos(theta1);
-        float z1 = radius * sin(theta1);
-        float x2 = radius * cos(theta2);
-        float z2 = radius * sin(theta2);
-
-        // boczna ściana
-        verts.push_back(x1); verts.push_back(0.0f); verts.push_back(z1);
-        verts.push_back(x2); verts.push_back(0.0f); verts.push_back(z2);
-        verts.push_back(x2); verts.push_back(height); verts.push_back(z2);
-
-        verts.push_back(x1); verts.push_back(0.0f); verts.push_back(z1);
-        verts.push_back(x2); verts.push_back(height); verts.push_back(z2);
-        verts.push_back(x1); verts.push_back(height); verts.push_back(z1);
-
-        // dolna podstawa
-        verts.push_back(0.0f); verts.push_back(0.0f); verts.push_back(0.0f);
-        verts.push_back(x2); verts.push_back(0.0f); verts.push_back(z2);
-        verts.push_back(x1); verts.push_back(0.0f); verts.push_back(z1);
-
-        // górna podstawa
-        verts.push_back(0.0f); verts.push_back(height); verts.push_back(0.0f);
-        verts.push_back(x1); verts.push_back(height); verts.push_back(z1);
-        verts.push_back(x2); verts.push_back(height); verts.push_back(z2);
+        GLuint b1 = ui_SideBase + 2 * i, t1 = b1 + 1;
+        GLuint b2 = b1 + 2, t2 = b1 + 3;
+        vec_Indices.insert(vec_Indices.end(), { b1, b2, t2,  b1, t2, t1 });
     }
 
-    return verts;
+    // podstawy: dolna (normalna w dół) i górna (w górę)
+    for (int i_Cap = 0; i_Cap < 2; ++i_Cap)
+    {
+        float y = (i_Cap == 0) ? 0.0f : height;
+        float ny = (i_Cap == 0) ? -1.0f : 1.0f;
+        GLuint ui_Center = pushVertex(0.0f, y, 0.0f, 0.0f, ny, 0.0f);
+        for (int i = 0; i <= segments; ++i)
+        {
+            float theta = (float)i / segments * k_TwoPi;
+            pushVertex(radius * cos(theta), y, radius * sin(theta), 0.0f, ny, 0.0f);
+        }
+        for (int i = 0; i < segments; ++i)
+        {
+            GLuint r1 = ui_Center + 1 + i, r2 = r1 + 1;
+            if (i_Cap == 0) vec_Indices.insert(vec_Indices.end(), { ui_Center, r2, r1 });
+            else            vec_Indices.insert(vec_Indices.end(), { ui_Center, r1, r2 });
+        }
+    }
 }
 
-std::vector<float> GameState::generateHemisphereVertices(float radius, int segments)
+void GameState::generateHemisphereMesh(float radius, float f_OffsetY, int segments,
+                                       std::vector<float>& vec_Vertices, std::vector<GLuint>& vec_Indices)
 {
-    std::vector<float> verts;
     const float k_Pi = glm::pi<float>();
     const float k_TwoPi = 2.0f * k_Pi;
+    const int i_Rings = segments / 2;
 
-    for(int i = 0; i < segments / 2; ++i)
+    // siatka szerokość/długość od bieguna (theta = 0) do równika; normalna = kierunek od środka
+    GLuint ui_Base = static_cast<GLuint>(vec_Vertices.size() / 6);
+    for (int i = 0; i <= i_Rings; ++i)
     {
-        float theta1 = k_Pi * i / segments;       // dolny pierścień
-        float theta2 = k_Pi * (i + 1) / segments; // górny pierścień
+        float theta = k_Pi * i / segments;
+        for (int j = 0; j <= segments; ++j)
+        {
+            float phi = k_TwoPi * j / segments;
+            float nx = sin(theta) * cos(phi);
+            float ny = cos(theta);
+            float nz = sin(theta) * sin(phi);
+            vec_Vertices.insert(vec_Vertices.end(), { radius * nx, f_OffsetY + radius * ny, radius * nz, nx, ny, nz });
+        }
+    }
 
-        for(int j = 0; j < segments; ++j)
+    const GLuint ui_Stride = static_cast<GLuint>(segments + 1);
+    for (int i = 0; i < i_Rings; ++i)
+    {
+        for (int j = 0; j < segments; ++j)
         {
-            float phi1 = k_TwoPi * j / segments;
-            float phi2 = k_TwoPi * (j + 1) / segments;
-
-            // cztery wierzchołki kwadratu -> dwa trójkąty
-            float x1 = radius * sin(theta1) * cos(phi1);
-            float y1 = radius * cos(theta1);
-            float z1 = radius * sin(theta1) * sin(phi1);
-
-            float x2 = radius * sin(theta2) * cos(phi1);
-            float y2 = radius * cos(theta2);
-            float z2 = radius * sin(theta2) * sin(phi1);
-
-            float x3 = radius * sin(theta2) * cos(phi2);
-            float y3 = radius * cos(theta2);
-            float z3 = radius * sin(theta2) * sin(phi2);
-
-            float x4 = radius * sin(theta1) * cos(phi2);
-            float y4 = radius * cos(theta1);
-            float z4 = radius * sin(theta1) * sin(phi2);
-
-            // trójkąt 1
-            verts.push_back(x1); verts.push_back(y1); verts.push_back(z1);
-            verts.push_back(x2); verts.push_back(y2); verts.push_back(z2);
-            verts.push_back(x3); verts.push_back(y3); verts.push_back(z3);
-
-            // trójkąt 2
-            verts.push_back(x1); verts.push_back(y1); verts.push_back(z1);
-            verts.push_back(x3); verts.push_back(y3); verts.push_back(z3);
-            verts.push_back(x4); verts.push_back(y4); verts.push_back(z4);
+            GLuint v1 = ui_Base + i * ui_Stride + j;  // dolny pierścień
+            GLuint v2 = v1 + ui_Stride;              // górny pierścień
+            GLuint v3 = v2 + 1;
+            GLuint v4 = v1 + 1;
+            vec_Indices.insert(vec_Indices.end(), { v1, v2, v3,  v1, v3, v4 });
         }
     }
+}
 
-    return verts;
+void GameState::SetCameraPose(const glm::vec3& vec3_Position, float f_Pitch) {
+    m_b_Camera3D = true;
+    m_vec3_Saved3DCameraPosition = vec3_Position;
+    m_vec3_CameraPosition = vec3_Position;
+    m_vec3_CameraVelocity = glm::vec3(0.0f);
+    m_f_CameraAngle = f_Pitch;
+    m_f_CameraAngleVelocity = 0.0f;
+
+    m_vec3_CameraFront = glm::normalize(glm::vec3(0.0f, sin(f_Pitch), -cos(f_Pitch)));
+}
+
+void GameState::CaptureNextFrame(std::vector<unsigned char>* p_vec_Pixels, int i_Width, int i_Height) {
+    m_p_vec_CapturePixels = p_vec_Pixels;
+    m_i_CaptureWidth = i_Width;
+    m_i_CaptureHeight = i_Height;
 }
 
 void GameState::AccelerateCameraForward(float f_DeltaTime) {
@@ -1616,7 +1786,7 @@ void GameState::UpdateArrowsForSelectedPlayer() {
 
     glm::vec2 vec2_CurrentPos = it->position;
 
-    auto connections = m_graph.GetConnections(i_CurrentNode);
+    auto connections = m_sp_Map->GetGraph().GetConnections(i_CurrentNode);
 
     for (const auto& conn : connections) {
         auto destIt = std::find_if(m_vec_CircleStations.begin(), m_vec_CircleStations.end(),
@@ -1679,6 +1849,13 @@ std::vector<float> GameState::generateArrowVertices() {
     return verts;
 }
 
+bool GameState::IsArrowInFrustum(const DirectionArrow& arrow, const Core::Frustum& frustum) const {
+    // The arrow turns about its base, so its reach covers every rotation
+    float f_Reach = std::max(UI::k_ArrowLength, UI::k_ArrowWidth);
+    glm::vec3 vec3_Base(arrow.vec2_Position.x, 0.02f, arrow.vec2_Position.y);
+    return frustum.IsBoxVisible(vec3_Base - glm::vec3(f_Reach, 0.0f, f_Reach), vec3_Base + glm::vec3(f_Reach, 0.0f, f_Reach));
+}
+
 void GameState::HandlePlayerClick(int i_PlayerIndex) {
     if (i_PlayerIndex < 0 || i_PlayerIndex >= static_cast<int>(m_vec_Players.size())) {
         return;
@@ -1912,45 +2089,23 @@ void GameState::RenderPickingPass(const glm::mat4& mat4_Projection, const glm::m
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // Same instance buffer as the visible pass, with every token's picking color filled in
+    Core::Frustum frustum(mat4_Projection * mat4_View);
+    BuildTokenInstances(frustum);
+    for (size_t i = 0; i < m_vec_TokenInstances.size(); ++i) {
+        const ClickableID& clickable = m_vec_TokenClickables[i];
+        uint32_t ui_ID = RegisterClickable(clickable.e_Type, clickable.i_Index, clickable.i_Data);
+        m_vec_TokenInstances[i].vec3_PickingColor = IDToColor(ui_ID);
+    }
+    UploadTokenInstances();
+    DrawTokenInstances(mat4_Projection * mat4_View, static_cast<int>(m_vec_TokenInstances.size()), true);
+
     glUseProgram(m_ShaderProgram_Picking);
     GLint i_MvpLoc = glGetUniformLocation(m_ShaderProgram_Picking, "MVP");
     GLint i_ColorLoc = glGetUniformLocation(m_ShaderProgram_Picking, "pickingColor");
-
-    {
-        std::lock_guard<std::mutex> lock(m_mtx_Players);
-        for (size_t i = 0; i < m_vec_Players.size(); ++i) {
-            const auto& player = m_vec_Players[i];
-            int i_NodeId = player.GetOccupiedNode();
-
-            auto it = std::find_if(m_vec_CircleStations.begin(), m_vec_CircleStations.end(),
-                                  [i_NodeId](const StationCircle& sc){ return sc.stationID == i_NodeId; });
-            if (it == m_vec_CircleStations.end()) continue;
-
-            ClickableType e_Type = (player.GetType() == Core::PlayerType::MisterX)
-                                   ? ClickableType::MisterX : ClickableType::Detective;
-            uint32_t ui_ID = RegisterClickable(e_Type, static_cast<int>(i), 0);
-            glm::vec3 vec3_PickingColor = IDToColor(ui_ID);
-
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(it->position.x, 0.01f, it->position.y));
-            model = glm::scale(model, glm::vec3(0.4f));
-
-            glUniform3fv(i_ColorLoc, 1, glm::value_ptr(vec3_PickingColor));
-
-            glm::mat4 MVP = mat4_Projection * mat4_View * model;
-            glUniformMatrix4fv(i_MvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
-            glBindVertexArray(m_VAO_Cylinder);
-            glDrawArrays(GL_TRIANGLES, 0, m_i_CylinderVertexCount);
-
-            glm::mat4 hemiModel = glm::translate(model, glm::vec3(0.0f, 0.1f, 0.0f));
-            MVP = mat4_Projection * mat4_View * hemiModel;
-            glUniformMatrix4fv(i_MvpLoc, 1, GL_FALSE, glm::value_ptr(MVP));
-            glBindVertexArray(m_VAO_Hemisphere);
-            glDrawArrays(GL_TRIANGLES, 0, m_i_HemisphereVertexCount);
-        }
-    }
-
     for (const auto& arrow : m_vec_CurrentArrows) {
+        if (!IsArrowInFrustum(arrow, frustum)) continue;
+
         uint32_t ui_ID = RegisterClickable(ClickableType::Arrow, m_i_SelectedPlayerIndex, arrow.i_DestinationNode);
         glm::vec3 vec3_PickingColor = IDToColor(ui_ID);
 
@@ -0,0 +1,533 @@
+#include "Gemm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SCOTLANDYARD_GEMM_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        // MSVC accepts any intrinsic in any function
+        #define SCOTLANDYARD_TARGET(isa)
+    #else
+        // GCC and Clang compile the wide kernels alone for their ISA; dispatch keeps them off older CPUs
+        #define SCOTLANDYARD_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+namespace ScotlandYard {
+namespace AI {
+
+namespace {
+
+// Inner dimension per pass: a 256 x 16 float panel of B is 16 KB and stays in L1
+constexpr size_t k_BlockInner = 256;
+constexpr size_t k_TileColumns = k_GemmColumnAlignment;
+
+using MicroKernel = void (*)(const float* p_A, size_t num_Lda, const float* p_B, size_t num_Ldb, float* p_C,
+                             size_t num_Ldc, size_t num_Rows, size_t num_Inner, bool b_First, bool b_Last,
+                             const float* p_Bias, Activation e_Activation);
+
+// Tanh has no cheap vector form; the tile is still in L1 when this runs
+void ApplyTanh(float* p_C, size_t num_Ldc, size_t num_Rows) {
+    for (size_t r = 0; r < num_Rows; ++r) {
+        for (size_t j = 0; j < k_TileColumns; ++j) {
+            p_C[r * num_Ldc + j] = std::tanh(p_C[r * num_Ldc + j]);
+        }
+    }
+}
+
+// 4 x 16 tile
+constexpr size_t k_ScalarRows = 4;
+
+void MicroKernelScalar(const float* p_A, size_t num_Lda, const float* p_B, size_t num_Ldb, float* p_C,
+                       size_t num_Ldc, size_t num_Rows, size_t num_Inner, bool b_First, bool b_Last,
+                       const float* p_Bias, Activation e_Activation) {
+    float arr_Acc[k_ScalarRows][k_TileColumns];
+    for (size_t r = 0; r < num_Rows; ++r) {
+        for (size_t j = 0; j < k_TileColumns; ++j) {
+            arr_Acc[r][j] = b_First ? 0.0f : p_C[r * num_Ldc + j];
+        }
+    }
+
+    for (size_t k = 0; k < num_Inner; ++k) {
+        const float* p_BRow = p_B + k * num_Ldb;
+        for (size_t r = 0; r < num_Rows; ++r) {
+            float f_A = p_A[r * num_Lda + k];
+            for (size_t j = 0; j < k_TileColumns; ++j) {
+                arr_Acc[r][j] += f_A * p_BRow[j];
+            }
+        }
+    }
+
+    for (size_t r = 0; r < num_Rows; ++r) {
+        for (size_t j = 0; j < k_TileColumns; ++j) {
+            float f_Value = arr_Acc[r][j];
+            if (b_Last) {
+                f_Value += p_Bias[j];
+                if (e_Activation == Activation::Relu) f_Value = std::max(f_Value, 0.0f);
+            }
+            p_C[r * num_Ldc + j] = f_Value;
+        }
+    }
+    if (b_Last && e_Activation == Activation::Tanh) ApplyTanh(p_C, num_Ldc, num_Rows);
+}
+
+#ifdef SCOTLANDYARD_GEMM_X86
+
+// 4 x 16 tile in eight ymm accumulators. Missing rows of a partial tile read
+// row 0 again and are not stored, so the loop itself has no row branches.
+constexpr size_t k_Avx2Rows = 4;
+
+SCOTLANDYARD_TARGET("avx2,fma")
+void MicroKernelAvx2(const float* p_A, size_t num_Lda, const float* p_B, size_t num_Ldb, float* p_C,
+                     size_t num_Ldc, size_t num_Rows, size_t num_Inner, bool b_First, bool b_Last,
+                     const float* p_Bias, Activation e_Activation) {
+    const float* p_A0 = p_A;
+    const float* p_A1 = p_A + (num_Rows > 1 ? num_Lda : 0);
+    const float* p_A2 = p_A + (num_Rows > 2 ? 2 * num_Lda : 0);
+    const float* p_A3 = p_A + (num_Rows > 3 ? 3 * num_Lda : 0);
+
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+
+    for (size_t k = 0; k < num_Inner; ++k) {
+        const float* p_BRow = p_B + k * num_Ldb;
+        __m256 b0 = _mm256_loadu_ps(p_BRow);
+        __m256 b1 = _mm256_loadu_ps(p_BRow + 8);
+        __m256 a = _mm256_broadcast_ss(p_A0 + k);
+        c00 = _mm256_fmadd_ps(a, b0, c00);
+        c01 = _mm256_fmadd_ps(a, b1, c01);
+        a = _mm256_broadcast_ss(p_A1 + k);
+        c10 = _mm256_fmadd_ps(a, b0, c10);
+        c11 = _mm256_fmadd_ps(a, b1, c11);
+        a = _mm256_broadcast_ss(p_A2 + k);
+        c20 = _mm256_fmadd_ps(a, b0, c20);
+        c21 = _mm256_fmadd_ps(a, b1, c21);
+        a = _mm256_broadcast_ss(p_A3 + k);
+        c30 = _mm256_fmadd_ps(a, b0, c30);
+        c31 = _mm256_fmadd_ps(a, b1, c31);
+    }
+
+    __m256 arr_Lo[k_Avx2Rows] = { c00, c10, c20, c30 };
+    __m256 arr_Hi[k_Avx2Rows] = { c01, c11, c21, c31 };
+    const __m256 bias0 = _mm256_loadu_ps(p_Bias);
+    const __m256 bias1 = _mm256_loadu_ps(p_Bias + 8);
+    const __m256 zero = _mm256_setzero_ps();
+    for (size_t r = 0; r < num_Rows; ++r) {
+        float* p_Row = p_C + r * num_Ldc;
+        __m256 lo = arr_Lo[r];
+        __m256 hi = arr_Hi[r];
+        if (!b_First) {
+            lo = _mm256_add_ps(lo, _mm256_loadu_ps(p_Row));
+            hi = _mm256_add_ps(hi, _mm256_loadu_ps(p_Row + 8));
+        }
+        if (b_Last) {
+            lo = _mm256_add_ps(lo, bias0);
+            hi = _mm256_add_ps(hi, bias1);
+            if (e_Activation == Activation::Relu) {
+                lo = _mm256_max_ps(lo, zero);
+                hi = _mm256_max_ps(hi, zero);
+            }
+        }
+        _mm256_storeu_ps(p_Row, lo);
+        _mm256_storeu_ps(p_Row + 8, hi);
+    }
+    if (b_Last && e_Activation == Activation::Tanh) ApplyTanh(p_C, num_Ldc, num_Rows);
+}
+
+// 8 x 16 tile, one zmm accumulator per row
+constexpr size_t k_Avx512Rows = 8;
+
+SCOTLANDYARD_TARGET("avx512f")
+void MicroKernelAvx512(const float* p_A, size_t num_Lda, const float* p_B, size_t num_Ldb, float* p_C,
+                       size_t num_Ldc, size_t num_Rows, size_t num_Inner, bool b_First, bool b_Last,
+                       const float* p_Bias, Activation e_Activation) {
+    const float* arr_ARows[k_Avx512Rows];
+    for (size_t r = 0; r < k_Avx512Rows; ++r) {
+        arr_ARows[r] = p_A + (r < num_Rows ? r * num_Lda : 0);
+    }
+
+    __m512 c0 = _mm512_setzero_ps(), c1 = _mm512_setzero_ps(), c2 = _mm512_setzero_ps(), c3 = _mm512_setzero_ps();
+    __m512 c4 = _mm512_setzero_ps(), c5 = _mm512_setzero_ps(), c6 = _mm512_setzero_ps(), c7 = _mm512_setzero_ps();
+
+    for (size_t k = 0; k < num_Inner; ++k) {
+        __m512 b = _mm512_loadu_ps(p_B + k * num_Ldb);
+        c0 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[0][k]), b, c0);
+        c1 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[1][k]), b, c1);
+        c2 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[2][k]), b, c2);
+        c3 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[3][k]), b, c3);
+        c4 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[4][k]), b, c4);
+        c5 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[5][k]), b, c5);
+        c6 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[6][k]), b, c6);
+        c7 = _mm512_fmadd_ps(_mm512_set1_ps(arr_ARows[7][k]), b, c7);
+    }
+
+    __m512 arr_Acc[k_Avx512Rows] = { c0, c1, c2, c3, c4, c5, c6, c7 };
+    const __m512 bias = _mm512_loadu_ps(p_Bias);
+    const __m512 zero = _mm512_setzero_ps();
+    for (size_t r = 0; r < num_Rows; ++r) {
+        float* p_Row = p_C + r * num_Ldc;
+        __m512 acc = arr_Acc[r];
+        if (!b_First) acc = _mm512_add_ps(acc, _mm512_loadu_ps(p_Row));
+        if (b_Last) {
+            acc = _mm512_add_ps(acc, bias);
+            // maskz_ rather than _mm512_max_ps: GCC 12 builds that one on _mm512_undefined_ps()
+            // and then warns -Wmaybe-uninitialized about its own header
+            if (e_Activation == Activation::Relu) acc = _mm512_maskz_max_ps(static_cast<__mmask16>(0xFFFF), acc, zero);
+        }
+        _mm512_storeu_ps(p_Row, acc);
+    }
+    if (b_Last && e_Activation == Activation::Tanh) ApplyTanh(p_C, num_Ldc, num_Rows);
+}
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int arr_Regs[4];
+    __cpuid(arr_Regs, 1);
+    bool b_Fma = (arr_Regs[2] & (1 << 12)) != 0;
+    bool b_OsSaves = (arr_Regs[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(arr_Regs, 7, 0);
+    return b_Fma && b_OsSaves && (arr_Regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+bool CpuHasAvx512() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int arr_Regs[4];
+    __cpuid(arr_Regs, 1);
+    bool b_OsSaves = (arr_Regs[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0xE6) == 0xE6;
+    __cpuidex(arr_Regs, 7, 0);
+    return b_OsSaves && (arr_Regs[1] & (1 << 16)) != 0;
+#else
+    return __builtin_cpu_supports("avx512f");
+#endif
+}
+
+bool CpuHasAvx512Vnni() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int arr_Regs[4];
+    __cpuidex(arr_Regs, 7, 0);
+    return CpuHasAvx512() && (arr_Regs[2] & (1 << 11)) != 0;
+#else
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vnni");
+#endif
+}
+
+#endif // SCOTLANDYARD_GEMM_X86
+
+} // namespace
+
+bool IsGemmKernelSupported(GemmKernel e_Kernel) {
+    switch (e_Kernel) {
+        case GemmKernel::Scalar: return true;
+#ifdef SCOTLANDYARD_GEMM_X86
+        case GemmKernel::Avx2: {
+            static const bool s_b_Supported = CpuHasAvx2();
+            return s_b_Supported;
+        }
+        case GemmKernel::Avx512: {
+            static const bool s_b_Supported = CpuHasAvx512();
+            return s_b_Supported;
+        }
+#endif
+        default: return false;
+    }
+}
+
+GemmKernel GetBestGemmKernel() {
+    if (IsGemmKernelSupported(GemmKernel::Avx512)) return GemmKernel::Avx512;
+    if (IsGemmKernelSupported(GemmKernel::Avx2)) return GemmKernel::Avx2;
+    return GemmKernel::Scalar;
+}
+
+const char* GetGemmKernelName(GemmKernel e_Kernel) {
+    switch (e_Kernel) {
+        case GemmKernel::Avx2: return "AVX2";
+        case GemmKernel::Avx512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+void Gemm(GemmKernel e_Kernel, const float* p_A, size_t num_Lda, const float* p_B, size_t num_Ldb,
+          const float* p_Bias, float* p_C, size_t num_Ldc, size_t num_Rows, size_t num_Inner,
+          size_t num_Columns, Activation e_Activation) {
+    MicroKernel fn_Kernel = MicroKernelScalar;
+    size_t num_TileRows = k_ScalarRows;
+#ifdef SCOTLANDYARD_GEMM_X86
+    if (e_Kernel == GemmKernel::Avx512 && IsGemmKernelSupported(GemmKernel::Avx512)) {
+        fn_Kernel = MicroKernelAvx512;
+        num_TileRows = k_Avx512Rows;
+    } else if (e_Kernel == GemmKernel::Avx2 && IsGemmKernelSupported(GemmKernel::Avx2)) {
+        fn_Kernel = MicroKernelAvx2;
+        num_TileRows = k_Avx2Rows;
+    }
+#else
+    (void)e_Kernel;
+#endif
+
+    for (size_t k0 = 0; k0 < num_Inner; k0 += k_BlockInner) {
+        size_t num_Block = std::min(k_BlockInner, num_Inner - k0);
+        bool b_First = k0 == 0;
+        bool b_Last = k0 + num_Block == num_Inner;
+        for (size_t n0 = 0; n0 < num_Columns; n0 += k_TileColumns) {
+            for (size_t m0 = 0; m0 < num_Rows; m0 += num_TileRows) {
+                fn_Kernel(p_A + m0 * num_Lda + k0, num_Lda, p_B + k0 * num_Ldb + n0, num_Ldb,
+                          p_C + m0 * num_Ldc + n0, num_Ldc, std::min(num_TileRows, num_Rows - m0), num_Block,
+                          b_First, b_Last, p_Bias + n0, e_Activation);
+            }
+        }
+    }
+}
+
+// ---- int8 ----
+
+namespace {
+
+// Int8 kernels only accumulate; FinishInt8Tile() does the float part for all
+// of them, which keeps the results identical across ISAs
+using Int8MicroKernel = void (*)(const uint8_t* p_A, size_t num_Lda, const int8_t* p_B, size_t num_GroupStride,
+                                 size_t num_Rows, size_t num_Groups, int32_t (*arr_Tile)[k_TileColumns]);
+
+constexpr size_t k_Int8MaxTileRows = 8;
+
+inline int32_t LoadGroup(const uint8_t* p_Bytes) {
+    int32_t i_Group;
+    std::memcpy(&i_Group, p_Bytes, sizeof(i_Group));
+    return i_Group;
+}
+
+void FinishInt8Tile(const int32_t (*arr_Tile)[k_TileColumns], size_t num_Rows, const int32_t* p_ColumnSums,
+                    const float* p_Scales, const float* p_Bias, float* p_C, size_t num_Ldc,
+                    Activation e_Activation) {
+    for (size_t r = 0; r < num_Rows; ++r) {
+        float* p_Row = p_C + r * num_Ldc;
+        for (size_t j = 0; j < k_TileColumns; ++j) {
+            int32_t i_Sum = arr_Tile[r][j] - k_Int8ZeroPoint * p_ColumnSums[j];
+            float f_Value = static_cast<float>(i_Sum) * p_Scales[j];
+            f_Value += p_Bias[j];
+            if (e_Activation == Activation::Relu) f_Value = std::max(f_Value, 0.0f);
+            p_Row[j] = f_Value;
+        }
+    }
+    if (e_Activation == Activation::Tanh) ApplyTanh(p_C, num_Ldc, num_Rows);
+}
+
+// 4 x 16 tile
+constexpr size_t k_Int8ScalarRows = 4;
+
+void Int8KernelScalar(const uint8_t* p_A, size_t num_Lda, const int8_t* p_B, size_t num_GroupStride,
+                      size_t num_Rows, size_t num_Groups, int32_t (*arr_Tile)[k_TileColumns]) {
+    for (size_t r = 0; r < num_Rows; ++r) {
+        for (size_t j = 0; j < k_TileColumns; ++j) arr_Tile[r][j] = 0;
+    }
+
+    for (size_t g = 0; g < num_Groups; ++g) {
+        const int8_t* p_BGroup = p_B + g * num_GroupStride;
+        for (size_t r = 0; r < num_Rows; ++r) {
+            const uint8_t* p_AGroup = p_A + r * num_Lda + g * k_Int8InnerGroup;
+            for (size_t j = 0; j < k_TileColumns; ++j) {
+                const int8_t* p_W = p_BGroup + j * k_Int8InnerGroup;
+                arr_Tile[r][j] += p_AGroup[0] * p_W[0] + p_AGroup[1] * p_W[1]
+                                + p_AGroup[2] * p_W[2] + p_AGroup[3] * p_W[3];
+            }
+        }
+    }
+}
+
+#ifdef SCOTLANDYARD_GEMM_X86
+
+// 4 x 16 tile, done as two 8-column halves. Plain AVX2 has no exact u8 x s8
+// dot product (vpmaddubsw saturates), so weights are widened to int16 and
+// multiplied with vpmaddwd: each int32 lane holds one column's sum over two
+// of a group's four inputs, and the pairs are folded with a horizontal add.
+constexpr size_t k_Int8Avx2Rows = 4;
+
+// A group's four activations as int16, repeated for each of four columns
+SCOTLANDYARD_TARGET("avx2")
+inline __m256i BroadcastGroupAvx2(const uint8_t* p_Group) {
+    return _mm256_broadcastq_epi64(_mm_cvtepu8_epi16(_mm_cvtsi32_si128(LoadGroup(p_Group))));
+}
+
+SCOTLANDYARD_TARGET("avx2")
+void Int8KernelAvx2(const uint8_t* p_A, size_t num_Lda, const int8_t* p_B, size_t num_GroupStride,
+                    size_t num_Rows, size_t num_Groups, int32_t (*arr_Tile)[k_TileColumns]) {
+    const uint8_t* p_A0 = p_A;
+    const uint8_t* p_A1 = p_A + (num_Rows > 1 ? num_Lda : 0);
+    const uint8_t* p_A2 = p_A + (num_Rows > 2 ? 2 * num_Lda : 0);
+    const uint8_t* p_A3 = p_A + (num_Rows > 3 ? 3 * num_Lda : 0);
+
+    for (size_t h = 0; h < k_TileColumns; h += 8) {
+        __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+        __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+        __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+        __m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+
+        for (size_t g = 0; g < num_Groups; ++g) {
+            const int8_t* p_BGroup = p_B + g * num_GroupStride + h * k_Int8InnerGroup;
+            const size_t num_Offset = g * k_Int8InnerGroup;
+            __m256i b0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_BGroup)));
+            __m256i b1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_BGroup + 16)));
+            __m256i a = BroadcastGroupAvx2(p_A0 + num_Offset);
+            c00 = _mm256_add_epi32(c00, _mm256_madd_epi16(a, b0));
+            c01 = _mm256_add_epi32(c01, _mm256_madd_epi16(a, b1));
+            a = BroadcastGroupAvx2(p_A1 + num_Offset);
+            c10 = _mm256_add_epi32(c10, _mm256_madd_epi16(a, b0));
+            c11 = _mm256_add_epi32(c11, _mm256_madd_epi16(a, b1));
+            a = BroadcastGroupAvx2(p_A2 + num_Offset);
+            c20 = _mm256_add_epi32(c20, _mm256_madd_epi16(a, b0));
+            c21 = _mm256_add_epi32(c21, _mm256_madd_epi16(a, b1));
+            a = BroadcastGroupAvx2(p_A3 + num_Offset);
+            c30 = _mm256_add_epi32(c30, _mm256_madd_epi16(a, b0));
+            c31 = _mm256_add_epi32(c31, _mm256_madd_epi16(a, b1));
+        }
+
+        // hadd leaves columns 0 1 4 5 | 2 3 6 7; the permute restores their order
+        __m256i arr_Lo[k_Int8Avx2Rows] = { c00, c10, c20, c30 };
+        __m256i arr_Hi[k_Int8Avx2Rows] = { c01, c11, c21, c31 };
+        for (size_t r = 0; r < num_Rows; ++r) {
+            __m256i sum = _mm256_permute4x64_epi64(_mm256_hadd_epi32(arr_Lo[r], arr_Hi[r]), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(arr_Tile[r] + h), sum);
+        }
+    }
+}
+
+// 8 x 16 tile: vpdpbusd multiplies a broadcast group of four uint8
+// activations with each column's four int8 weights and adds all four products
+constexpr size_t k_Int8VnniRows = 8;
+
+SCOTLANDYARD_TARGET("avx512f,avx512vnni")
+void Int8KernelAvx512Vnni(const uint8_t* p_A, size_t num_Lda, const int8_t* p_B, size_t num_GroupStride,
+                          size_t num_Rows, size_t num_Groups, int32_t (*arr_Tile)[k_TileColumns]) {
+    const uint8_t* arr_ARows[k_Int8VnniRows];
+    for (size_t r = 0; r < k_Int8VnniRows; ++r) {
+        arr_ARows[r] = p_A + (r < num_Rows ? r * num_Lda : 0);
+    }
+
+    __m512i c0 = _mm512_setzero_si512(), c1 = _mm512_setzero_si512();
+    __m512i c2 = _mm512_setzero_si512(), c3 = _mm512_setzero_si512();
+    __m512i c4 = _mm512_setzero_si512(), c5 = _mm512_setzero_si512();
+    __m512i c6 = _mm512_setzero_si512(), c7 = _mm512_setzero_si512();
+
+    for (size_t g = 0; g < num_Groups; ++g) {
+        __m512i b = _mm512_loadu_si512(p_B + g * num_GroupStride);
+        const size_t num_Offset = g * k_Int8InnerGroup;
+        c0 = _mm512_dpbusd_epi32(c0, _mm512_set1_epi32(LoadGroup(arr_ARows[0] + num_Offset)), b);
+        c1 = _mm512_dpbusd_epi32(c1, _mm512_set1_epi32(LoadGroup(arr_ARows[1] + num_Offset)), b);
+        c2 = _mm512_dpbusd_epi32(c2, _mm512_set1_epi32(LoadGroup(arr_ARows[2] + num_Offset)), b);
+        c3 = _mm512_dpbusd_epi32(c3, _mm512_set1_epi32(LoadGroup(arr_ARows[3] + num_Offset)), b);
+        c4 = _mm512_dpbusd_epi32(c4, _mm512_set1_epi32(LoadGroup(arr_ARows[4] + num_Offset)), b);
+        c5 = _mm512_dpbusd_epi32(c5, _mm512_set1_epi32(LoadGroup(arr_ARows[5] + num_Offset)), b);
+        c6 = _mm512_dpbusd_epi32(c6, _mm512_set1_epi32(LoadGroup(arr_ARows[6] + num_Offset)), b);
+        c7 = _mm512_dpbusd_epi32(c7, _mm512_set1_epi32(LoadGroup(arr_ARows[7] + num_Offset)), b);
+    }
+
+    __m512i arr_Acc[k_Int8VnniRows] = { c0, c1, c2, c3, c4, c5, c6, c7 };
+    for (size_t r = 0; r < num_Rows; ++r) {
+        _mm512_storeu_si512(arr_Tile[r], arr_Acc[r]);
+    }
+}
+
+#endif // SCOTLANDYARD_GEMM_X86
+
+} // namespace
+
+bool IsInt8KernelSupported(Int8Kernel e_Kernel) {
+    switch (e_Kernel) {
+        case Int8Kernel::Scalar: return true;
+#ifdef SCOTLANDYARD_GEMM_X86
+        case Int8Kernel::Avx2: return IsGemmKernelSupported(GemmKernel::Avx2);
+        case Int8Kernel::Avx512Vnni: {
+            static const bool s_b_Supported = CpuHasAvx512Vnni();
+            return s_b_Supported;
+        }
+#endif
+        default: return false;
+    }
+}
+
+Int8Kernel GetBestInt8Kernel() {
+    if (IsInt8KernelSupported(Int8Kernel::Avx512Vnni)) return Int8Kernel::Avx512Vnni;
+    if (IsInt8KernelSupported(Int8Kernel::Avx2)) return Int8Kernel::Avx2;
+    return Int8Kernel::Scalar;
+}
+
+const char* GetInt8KernelName(Int8Kernel e_Kernel) {
+    switch (e_Kernel) {
+        case Int8Kernel::Avx2: return "AVX2 int8";
+        case Int8Kernel::Avx512Vnni: return "AVX-512 VNNI";
+        default: return "scalar int8";
+    }
+}
+
+void QuantizeActivations(const float* p_Input, size_t num_Ldi, size_t num_Rows, size_t num_Columns,
+                         float f_InverseScale, uint8_t* p_Output, size_t num_Ldo) {
+    for (size_t r = 0; r < num_Rows; ++r) {
+        const float* p_Row = p_Input + r * num_Ldi;
+        uint8_t* p_Quantized = p_Output + r * num_Ldo;
+        // Adding the zero point and a half before truncating rounds without a
+        // call to lrint; the SSE2 loop does exactly the same per element
+        size_t c = 0;
+#ifdef SCOTLANDYARD_GEMM_X86
+        const __m128 scale = _mm_set1_ps(f_InverseScale);
+        const __m128 low = _mm_set1_ps(-127.0f);
+        const __m128 high = _mm_set1_ps(127.0f);
+        const __m128 offset = _mm_set1_ps(k_Int8ZeroPoint + 0.5f);
+        auto quantize4 = [&](const float* p_Values) {
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(p_Values), scale), low), high);
+            return _mm_cvttps_epi32(_mm_add_ps(v, offset));
+        };
+        for (; c + 16 <= num_Columns; c += 16) {
+            __m128i lo = _mm_packs_epi32(quantize4(p_Row + c), quantize4(p_Row + c + 4));
+            __m128i hi = _mm_packs_epi32(quantize4(p_Row + c + 8), quantize4(p_Row + c + 12));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p_Quantized + c), _mm_packus_epi16(lo, hi));
+        }
+#endif
+        for (; c < num_Columns; ++c) {
+            float f_Value = std::min(std::max(p_Row[c] * f_InverseScale, -127.0f), 127.0f);
+            p_Quantized[c] = static_cast<uint8_t>(static_cast<int32_t>(f_Value + (k_Int8ZeroPoint + 0.5f)));
+        }
+        std::memset(p_Quantized + num_Columns, k_Int8ZeroPoint, num_Ldo - num_Columns);
+    }
+}
+
+void GemmInt8(Int8Kernel e_Kernel, const uint8_t* p_A, size_t num_Lda, const int8_t* p_B,
+              const int32_t* p_ColumnSums, const float* p_Scales, const float* p_Bias, float* p_C,
+              size_t num_Ldc, size_t num_Rows, size_t num_Inner, size_t num_Columns, Activation e_Activation) {
+    Int8MicroKernel fn_Kernel = Int8KernelScalar;
+    size_t num_TileRows = k_Int8ScalarRows;
+#ifdef SCOTLANDYARD_GEMM_X86
+    if (e_Kernel == Int8Kernel::Avx512Vnni && IsInt8KernelSupported(Int8Kernel::Avx512Vnni)) {
+        fn_Kernel = Int8KernelAvx512Vnni;
+        num_TileRows = k_Int8VnniRows;
+    } else if (e_Kernel == Int8Kernel::Avx2 && IsInt8KernelSupported(Int8Kernel::Avx2)) {
+        fn_Kernel = Int8KernelAvx2;
+        num_TileRows = k_Int8Avx2Rows;
+    }
+#else
+    (void)e_Kernel;
+#endif
+
+    // No inner blocking: a 16-column int8 panel is a quarter of the float one,
+    // and whole-K accumulation keeps the sums in registers
+    const size_t num_Groups = num_Inner / k_Int8InnerGroup;
+    const size_t num_GroupStride = num_Columns * k_Int8InnerGroup;
+    alignas(64) int32_t arr_Tile[k_Int8MaxTileRows][k_TileColumns];
+    for (size_t n0 = 0; n0 < num_Columns; n0 += k_TileColumns) {
+        for (size_t m0 = 0; m0 < num_Rows; m0 += num_TileRows) {
+            size_t num_TileRowCount = std::min(num_TileRows, num_Rows - m0);
+            fn_Kernel(p_A + m0 * num_Lda, num_Lda, p_B + n0 * k_Int8InnerGroup, num_GroupStride,
+                      num_TileRowCount, num_Groups, arr_Tile);
+            FinishInt8Tile(arr_Tile, num_TileRowCount, p_ColumnSums + n0, p_Scales + n0, p_Bias + n0,
+                           p_C + m0 * num_Ldc + n0, num_Ldc, e_Activation);
+        }
+    }
+}
+
+} // namespace AI
+} // namespace ScotlandYard
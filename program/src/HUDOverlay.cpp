@@ -2,6 +2,7 @@
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 #include "Application.h"
+#include "TextBatch.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -104,84 +105,159 @@ namespace UI {
             glUseProgram(0);
         }
 
+        void appendRoundedRect(std::vector<float>& vec_Out, float f_X0, float f_Y0, float f_X1, float f_Y1, Color c, float f_RadiusNDC) {
+            const float f_Corners[6][2] = { {f_X0, f_Y0}, {f_X1, f_Y0}, {f_X0, f_Y1}, {f_X1, f_Y0}, {f_X1, f_Y1}, {f_X0, f_Y1} };
+            for (const auto& corner : f_Corners) {
+                const float f_Vertex[Core::Application::k_HUDRoundedFloatsPerVertex] = {
+                    corner[0], corner[1], f_X0, f_Y0, f_X1, f_Y1, f_RadiusNDC, c.r, c.g, c.b, c.a
+                };
+                vec_Out.insert(vec_Out.end(), f_Vertex, f_Vertex + Core::Application::k_HUDRoundedFloatsPerVertex);
+            }
+        }
+
         void drawRoundedRect(float f_X0, float f_Y0, float f_X1, float f_Y1, Color c, float f_RadiusNDC, Core::Application* p_App) {
-            const float f_Verts[] = { f_X0, f_Y0,  f_X1, f_Y0,  f_X0, f_Y1,  f_X1, f_Y0,  f_X1, f_Y1,  f_X0, f_Y1 };
+            static std::vector<float> s_vec_Verts;
+            s_vec_Verts.clear();
+            appendRoundedRect(s_vec_Verts, f_X0, f_Y0, f_X1, f_Y1, c, f_RadiusNDC);
 
             glUseProgram(p_App->GetHUDRoundedShader());
-            glUniform4f(glGetUniformLocation(p_App->GetHUDRoundedShader(), "uRect"), f_X0, f_Y0, f_X1, f_Y1);
-            glUniform1f(glGetUniformLocation(p_App->GetHUDRoundedShader(), "uRadius"), f_RadiusNDC);
-            glUniform4f(glGetUniformLocation(p_App->GetHUDRoundedShader(), "uColor"), c.r, c.g, c.b, c.a);
             glBindVertexArray(p_App->GetHUDRoundedVAO());
             glBindBuffer(GL_ARRAY_BUFFER, p_App->GetHUDRoundedVBO());
-            glBufferData(GL_ARRAY_BUFFER, sizeof(f_Verts), f_Verts, GL_DYNAMIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, s_vec_Verts.size() * sizeof(float), s_vec_Verts.data(), GL_DYNAMIC_DRAW);
             glDrawArrays(GL_TRIANGLES, 0, 6);
             glBindVertexArray(0);
             glUseProgram(0);
         }
 
-        float textWidthPx(const std::string& s_Text, float f_Scale, Core::Application* p_App) {
-            const auto& chars = p_App->GetCharacterMap();
-            float f_W = 0.0f;
-            for (char c : s_Text) {
-                auto it = chars.find(c);
-                if (it == chars.end()) continue;
-                f_W += float(it->second.m_i_Advance >> 6) * f_Scale;
+        // Glyph quads queued by the immediate-mode helpers; drawn in one call by flushText()
+        Core::TextBatch g_TextBatch;
+
+        // One HUD layer recorded into GPU buffers. It is rebuilt only when one of
+        // its inputs changes and otherwise redrawn as-is: all rects in one draw,
+        // then icons, then all text in one draw.
+        struct IconQuad {
+            GLuint m_Texture;
+            float m_f_X0, m_f_Y0, m_f_X1, m_f_Y1;
+        };
+
+        struct RetainedLayer {
+            std::vector<float> m_vec_RectVertices;
+            std::vector<IconQuad> m_vec_Icons;
+            Core::TextBatch m_Text;
+            GLuint m_VAO_Rects = 0;
+            GLuint m_VBO_Rects = 0;
+            GLsizei m_i_RectVertexCount = 0;
+        };
+
+        RetainedLayer g_BarsLayer;
+        RetainedLayer g_ModalLayer;
+        std::atomic_bool g_b_BarsDirty{true};
+        std::atomic_bool g_b_ModalDirty{true};
+        int g_i_ModalBuiltWidth = 0;
+        int g_i_ModalBuiltHeight = 0;
+
+        bool sameColors(const std::vector<Color>& vec_A, const std::vector<Color>& vec_B) {
+            if (vec_A.size() != vec_B.size()) return false;
+            for (size_t i = 0; i < vec_A.size(); ++i) {
+                if (vec_A[i].r != vec_B[i].r || vec_A[i].g != vec_B[i].g ||
+                    vec_A[i].b != vec_B[i].b || vec_A[i].a != vec_B[i].a) return false;
             }
-            return f_W;
+            return true;
         }
 
+        void markAllDirty() {
+            g_b_BarsDirty.store(true);
+            g_b_ModalDirty.store(true);
+        }
 
-        void drawTextPx(const std::string& s_Text, float f_XPx, float f_BaselineYPx, float f_Scale,
-            float f_R, float f_G, float f_B, Core::Application* p_App)
-        {
-            const auto& chars = p_App->GetCharacterMap();
-            GLuint prog = p_App->GetTextShaderProgram();
-            GLuint vao = p_App->GetTextVAO();
-            GLuint vbo = p_App->GetTextVBO();
+        void beginLayer(RetainedLayer& layer) {
+            layer.m_vec_RectVertices.clear();
+            layer.m_vec_Icons.clear();
+            layer.m_Text.Clear();
+        }
 
-            glUseProgram(prog);
-            glUniform3f(glGetUniformLocation(prog, "textColor"), f_R, f_G, f_B);
-            glm::mat4 P = glm::ortho(0.0f, (float)g_i_ViewportWidth, 0.0f, (float)g_i_ViewportHeight);
-            glUniformMatrix4fv(glGetUniformLocation(prog, "projection"), 1, GL_FALSE, glm::value_ptr(P));
+        void pushRoundedRect(RetainedLayer& layer, float f_X0, float f_Y0, float f_X1, float f_Y1, Color c, float f_RadiusNDC) {
+            appendRoundedRect(layer.m_vec_RectVertices, f_X0, f_Y0, f_X1, f_Y1, c, f_RadiusNDC);
+        }
 
-            glActiveTexture(GL_TEXTURE0);
-            glUniform1i(glGetUniformLocation(prog, "text"), 0);
-            glBindVertexArray(vao);
-
-            float f_PenX = f_XPx;
-            for (char c : s_Text) {
-                auto it = chars.find(c);
-                if (it == chars.end()) continue;
-                const ScotlandYard::Core::Character& ch = it->second;
-
-                float f_Xpos = f_PenX + ch.m_i_BearingX * f_Scale;
-                float f_Ypos = f_BaselineYPx - (ch.m_i_Height - ch.m_i_BearingY) * f_Scale;
-                float f_W = ch.m_i_Width * f_Scale;
-                float f_H = ch.m_i_Height * f_Scale;
-
-                float f_Verts[6][4] = {
-                    { f_Xpos,       f_Ypos,       0.0f, 1.0f },
-                    { f_Xpos,       f_Ypos + f_H, 0.0f, 0.0f },
-                    { f_Xpos + f_W, f_Ypos + f_H, 1.0f, 0.0f },
-                    { f_Xpos,       f_Ypos,       0.0f, 1.0f },
-                    { f_Xpos + f_W, f_Ypos + f_H, 1.0f, 0.0f },
-                    { f_Xpos + f_W, f_Ypos,       1.0f, 1.0f },
-                };
+        void pushRoundedRectPx(RetainedLayer& layer, float f_X0, float f_Y0, float f_X1, float f_Y1, Color c, int i_RadiusPx) {
+            auto pxToNdcX = [&](float f_Px) { return (f_Px / float(g_i_ViewportWidth)) * 2.0f - 1.0f; };
+            auto pxToNdcY = [&](float f_Py) { return (f_Py / float(g_i_ViewportHeight)) * 2.0f - 1.0f; };
+            pushRoundedRect(layer, pxToNdcX(f_X0), pxToNdcY(f_Y0), pxToNdcX(f_X1), pxToNdcY(f_Y1), c, pxToNDC(float(i_RadiusPx)));
+        }
 
-                glBindTexture(GL_TEXTURE_2D, ch.m_TextureID);
-                glBindBuffer(GL_ARRAY_BUFFER, vbo);
-                glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(f_Verts), f_Verts);
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
-                glDrawArrays(GL_TRIANGLES, 0, 6);
+        void pushIcon(RetainedLayer& layer, GLuint tex, float f_X0, float f_Y0, float f_X1, float f_Y1) {
+            if (!tex) return;
+            layer.m_vec_Icons.push_back({ tex, f_X0, f_Y0, f_X1, f_Y1 });
+        }
 
-                f_PenX += (ch.m_i_Advance >> 6) * f_Scale;
+        void uploadLayer(RetainedLayer& layer) {
+            if (!layer.m_VAO_Rects) {
+                glGenVertexArrays(1, &layer.m_VAO_Rects);
+                glGenBuffers(1, &layer.m_VBO_Rects);
+                glBindVertexArray(layer.m_VAO_Rects);
+                glBindBuffer(GL_ARRAY_BUFFER, layer.m_VBO_Rects);
+                Core::Application::SetupHUDRoundedAttributes();
+            } else {
+                glBindVertexArray(layer.m_VAO_Rects);
+                glBindBuffer(GL_ARRAY_BUFFER, layer.m_VBO_Rects);
             }
+
+            glBufferData(GL_ARRAY_BUFFER, layer.m_vec_RectVertices.size() * sizeof(float), layer.m_vec_RectVertices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
             glBindVertexArray(0);
-            glBindTexture(GL_TEXTURE_2D, 0);
-            glUseProgram(0);
+
+            layer.m_i_RectVertexCount = static_cast<GLsizei>(layer.m_vec_RectVertices.size() / Core::Application::k_HUDRoundedFloatsPerVertex);
+            layer.m_vec_RectVertices.clear();
+            layer.m_Text.Upload();
         }
 
-        void drawTextCentered(const std::string& s_Text, float f_X0, float f_Y0, float f_X1, float f_Y1, Color col, Core::Application* p_App, float f_DeltaYPx = 0.0f) {
+        void drawLayer(const RetainedLayer& layer, Core::Application* p_App) {
+            if (layer.m_i_RectVertexCount > 0) {
+                glUseProgram(p_App->GetHUDRoundedShader());
+                glBindVertexArray(layer.m_VAO_Rects);
+                glDrawArrays(GL_TRIANGLES, 0, layer.m_i_RectVertexCount);
+                glBindVertexArray(0);
+                glUseProgram(0);
+            }
+
+            for (const IconQuad& icon : layer.m_vec_Icons) {
+                drawIcon(icon.m_Texture, icon.m_f_X0, icon.m_f_Y0, icon.m_f_X1, icon.m_f_Y1, p_App);
+            }
+
+            layer.m_Text.DrawUploaded(g_i_ViewportWidth, g_i_ViewportHeight, p_App);
+        }
+
+        void releaseLayer(RetainedLayer& layer) {
+            if (layer.m_VBO_Rects) {
+                glDeleteBuffers(1, &layer.m_VBO_Rects);
+                layer.m_VBO_Rects = 0;
+            }
+            if (layer.m_VAO_Rects) {
+                glDeleteVertexArrays(1, &layer.m_VAO_Rects);
+                layer.m_VAO_Rects = 0;
+            }
+            layer.m_i_RectVertexCount = 0;
+            layer.m_vec_Icons.clear();
+            layer.m_Text.ReleaseUploaded();
+        }
+
+        float textWidthPx(const std::string& s_Text, float f_Scale, Core::Application* p_App) {
+            return Core::TextBatch::MeasureText(s_Text, f_Scale, p_App);
+        }
+
+
+        void drawTextPx(Core::TextBatch& batch, const std::string& s_Text, float f_XPx, float f_BaselineYPx, float f_Scale,
+            float f_R, float f_G, float f_B, Core::Application* p_App)
+        {
+            batch.AddText(s_Text, f_XPx, f_BaselineYPx, f_Scale, f_R, f_G, f_B, 1.0f, p_App);
+        }
+
+        void flushText(Core::Application* p_App) {
+            g_TextBatch.Flush(g_i_ViewportWidth, g_i_ViewportHeight, p_App);
+        }
+
+        void drawTextCentered(Core::TextBatch& batch, const std::string& s_Text, float f_X0, float f_Y0, float f_X1, float f_Y1, Color col, Core::Application* p_App, float f_DeltaYPx = 0.0f) {
             float f_LeftPx = ndcX_to_px(f_X0);
             float f_RightPx = ndcX_to_px(f_X1);
             float f_BottomPx = ndcY_to_px(f_Y0);
@@ -196,10 +272,18 @@ namespace UI {
             float f_TW = textWidthPx(s_Text, f_Scale, p_App);
             float f_TX = (f_LeftPx + f_RightPx) * 0.5f - f_TW * 0.5f;
 
-            drawTextPx(s_Text, f_TX, f_Baseline, f_Scale, col.r, col.g, col.b, p_App);
+            drawTextPx(batch, s_Text, f_TX, f_Baseline, f_Scale, col.r, col.g, col.b, p_App);
+        }
+
+        void drawTextCenteredPx(Core::TextBatch& batch, const std::string& s_Text, float f_X0_px, float f_Y0_px, float f_X1_px, float f_Y1_px, Color col, Core::Application* p_App, float f_DeltaYPx) {
+            // Convert pixel rect to NDC using bottom-left origin mapping (to match DrawRoundedRectScreen)
+            float nx0 = (f_X0_px / float(g_i_ViewportWidth)) * 2.0f - 1.0f;
+            float nx1 = (f_X1_px / float(g_i_ViewportWidth)) * 2.0f - 1.0f;
+            float ny0 = (f_Y0_px / float(g_i_ViewportHeight)) * 2.0f - 1.0f;
+            float ny1 = (f_Y1_px / float(g_i_ViewportHeight)) * 2.0f - 1.0f;
+            drawTextCentered(batch, s_Text, nx0, ny0, nx1, ny1, col, p_App, f_DeltaYPx);
         }
 
-        
         void computeBars(float& f_TX0, float& f_TX1, float& f_TY0, float& f_TY1,
             float& f_BX0, float& f_BX1, float& f_BY0, float& f_BY1)
         {
@@ -215,8 +299,8 @@ namespace UI {
         }
 
 
-        void drawTopBar(float f_X0, float f_Y0, float f_X1, float f_Y1, Core::Application* p_App) {
-            drawRoundedRect(f_X0, f_Y0, f_X1, f_Y1, g_HUDStyle.barColor, pxToNDC(g_HUDStyle.barRadiusPx), p_App);
+        void buildTopBar(RetainedLayer& layer, float f_X0, float f_Y0, float f_X1, float f_Y1, Core::Application* p_App) {
+            pushRoundedRect(layer, f_X0, f_Y0, f_X1, f_Y1, g_HUDStyle.barColor, pxToNDC(g_HUDStyle.barRadiusPx));
 
             const float f_PadY = pxToNDC(g_HUDStyle.pillsPadYPx);
             const float f_PadX = pxToNDC(g_HUDStyle.pillsPadXPx);
@@ -239,7 +323,7 @@ namespace UI {
             float f_CYPx = 0.5f * (ndcY_to_px(f_InnerY0) + ndcY_to_px(f_InnerY1));
             float f_Baseline = f_CYPx + f_TopHPx * 0.38f - 20.0f;
 
-            drawTextPx(s_Round, f_LeftPx, f_Baseline, f_Scale,
+            drawTextPx(layer.m_Text, s_Round, f_LeftPx, f_Baseline, f_Scale,
                 g_HUDStyle.textColor.r, g_HUDStyle.textColor.g, g_HUDStyle.textColor.b, p_App);
 
             // Camera icon
@@ -260,7 +344,7 @@ namespace UI {
                 g_f_CamBtnNdcY0 = f_InnerY0;
                 g_f_CamBtnNdcY1 = f_InnerY1;
 
-                drawIcon(g_GLuint_TexCamera, f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1, p_App);
+                pushIcon(layer, g_GLuint_TexCamera, f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1);
 
                 f_CapAreaRight = f_BtnX0 - f_Gap;
             }
@@ -281,10 +365,10 @@ namespace UI {
                 g_f_PauseBtnNdcY1 = f_BtnY1;
 
                 if (g_GLuint_TexPause) {
-                    drawIcon(g_GLuint_TexPause, f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1, p_App);
+                    pushIcon(layer, g_GLuint_TexPause, f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1);
                 } else {
-                    drawRoundedRect(f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1, {0.12f, 0.12f, 0.12f, 0.85f}, pxToNDC(g_HUDStyle.slotRadiusPx), p_App);
-                    drawTextCentered(std::string("||"), f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1, {1,1,1,1}, p_App);
+                    pushRoundedRect(layer, f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1, {0.12f, 0.12f, 0.12f, 0.85f}, pxToNDC(g_HUDStyle.slotRadiusPx));
+                    drawTextCentered(layer.m_Text, std::string("||"), f_BtnX0, f_BtnY0, f_BtnX1, f_BtnY1, {1,1,1,1}, p_App);
                 }
 
                 f_CapAreaRight = f_BtnX0 - f_Gap;
@@ -307,8 +391,8 @@ namespace UI {
                 float f_CapX0 = f_CapX1 - f_CapWNdc;
                 if (f_CapX0 < f_InnerX0) f_CapX0 = f_InnerX0;
 
-                drawRoundedRect(f_CapX0, f_InnerY0, f_CapX1, f_InnerY1, pillColor, pxToNDC(g_HUDStyle.slotRadiusPx), p_App);
-                drawTextCentered(s_Label, f_CapX0, f_InnerY0, f_CapX1, f_InnerY1, { 1, 1, 1, 1 }, p_App);
+                pushRoundedRect(layer, f_CapX0, f_InnerY0, f_CapX1, f_InnerY1, pillColor, pxToNDC(g_HUDStyle.slotRadiusPx));
+                drawTextCentered(layer.m_Text, s_Label, f_CapX0, f_InnerY0, f_CapX1, f_InnerY1, { 1, 1, 1, 1 }, p_App);
 
                 f_CurRight = f_CapX0 - f_Gap;
                 if (f_CurRight <= f_InnerX0) break;
@@ -333,7 +417,7 @@ namespace UI {
                     float by1 = by0 + s;
 
                     
-                    drawTextCentered(
+                    drawTextCentered(layer.m_Text,
                         std::to_string(std::max(0, std::min(99, count))),
                         bx0, by0, bx1, by1,
                         { 1, 1, 1, 1 },
@@ -349,8 +433,8 @@ namespace UI {
         constexpr float k_BottomBarGapPx = 10.0f;
         constexpr float k_BottomBarMarginPx = 6.0f;
 
-        void drawBottomBar(float f_X0, float f_Y0, float f_X1, float f_Y1, Core::Application* p_App) {
-            drawRoundedRect(f_X0, f_Y0, f_X1, f_Y1, g_HUDStyle.barColor, pxToNDC(g_HUDStyle.barRadiusPx), p_App);
+        void buildBottomBar(RetainedLayer& layer, float f_X0, float f_Y0, float f_X1, float f_Y1, Core::Application* p_App) {
+            pushRoundedRect(layer, f_X0, f_Y0, f_X1, f_Y1, g_HUDStyle.barColor, pxToNDC(g_HUDStyle.barRadiusPx));
 
             const float f_Gap = pxToNDC(k_BottomBarGapPx);
             const float f_Margin = pxToNDC(k_BottomBarMarginPx);
@@ -368,7 +452,7 @@ namespace UI {
                 Color c = g_vec_TicketSlots[i].color;
                 if (c.a < 0.0f) c = g_HUDStyle.slotColor;
 
-                drawRoundedRect(f_X, f_SY0, f_X + f_SlotW, f_SY1, c, pxToNDC(g_HUDStyle.slotRadiusPx), p_App);
+                pushRoundedRect(layer, f_X, f_SY0, f_X + f_SlotW, f_SY1, c, pxToNDC(g_HUDStyle.slotRadiusPx));
 
                 const TicketSlot& ts = g_vec_TicketSlots[i];
                 bool replaced = false;
@@ -382,7 +466,7 @@ namespace UI {
                     float iy1 = f_SY1 - padY;
 
                     Color bg = { 1.f, 1.f, 1.f, 0.10f };
-                    drawRoundedRect(ix0, iy0, ix1, iy1, bg, pxToNDC(g_HUDStyle.slotRadiusPx), p_App);
+                    pushRoundedRect(layer, ix0, iy0, ix1, iy1, bg, pxToNDC(g_HUDStyle.slotRadiusPx));
 
                     const char* label = "";
                     switch (ts.mark) {
@@ -395,7 +479,7 @@ namespace UI {
                     default: break;
                     }
 
-                    drawTextCentered(
+                    drawTextCentered(layer.m_Text,
                         label,
                         f_X, f_SY0, f_X + f_SlotW, f_SY1,
                         g_HUDStyle.textColor, p_App, g_HUDStyle.slotNumberDYPx
@@ -406,7 +490,7 @@ namespace UI {
                 if (!replaced) {
                     char buf[4];
                     std::snprintf(buf, sizeof(buf), "%d", i + 1);
-                    drawTextCentered(
+                    drawTextCentered(layer.m_Text,
                         buf,
                         f_X, f_SY0, f_X + f_SlotW, f_SY1,
                         g_HUDStyle.textColor, p_App, g_HUDStyle.slotNumberDYPx
@@ -417,6 +501,97 @@ namespace UI {
             }
         }
 
+        void buildPausedModal(RetainedLayer& layer, int i_W, int i_H, Core::Application* p_App) {
+            float f_ModalWpx = std::min(640.0f, float(i_W) * 0.5f);
+            float f_ModalHpx = std::min(240.0f, float(i_H) * 0.35f);
+            float f_Left = (i_W - f_ModalWpx) * 0.5f;
+            float f_Bottom = (i_H - f_ModalHpx) * 0.5f;
+            float f_Right = f_Left + f_ModalWpx;
+            float f_Top = f_Bottom + f_ModalHpx;
+
+            pushRoundedRectPx(layer, f_Left, f_Bottom, f_Right, f_Top, {0.08f, 0.08f, 0.12f, 0.95f}, 12);
+
+            ScotlandYard::UI::Color white{1.0f,1.0f,1.0f,1.0f};
+            float f_TitleH = f_ModalHpx * 0.22f;
+            float f_MsgH = f_ModalHpx * 0.36f;
+
+            float f_TitleBottom = f_Bottom + f_ModalHpx * 0.74f;
+            float f_TitleTop = f_TitleBottom + f_TitleH;
+
+            float f_MsgBottom = f_Bottom + f_ModalHpx * 0.25f;
+            float f_MsgTop = f_MsgBottom + f_MsgH;
+
+            drawTextCenteredPx(layer.m_Text, "PAUSED", f_Left + 20.0f, f_TitleBottom, f_Right - 20.0f, f_TitleTop, white, p_App, -17.0f);
+            drawTextCenteredPx(layer.m_Text, "", f_Left + 20.0f, f_MsgBottom, f_Right - 20.0f, f_MsgTop, white, p_App, -6.0f);
+
+            std::string s_DebugLabel = g_b_DebugEnabled.load() ? "TURN OFF DEBUGGING MODE" : "TURN ON DEBUGGING MODE";
+            std::string s_ResumeLabel = "RESUME";
+            std::string s_MenuLabel = "MENU";
+
+            float f_ResumeW = textWidthPx(s_ResumeLabel, 1.0f, p_App);
+            float f_DebugW = textWidthPx(s_DebugLabel, 1.0f, p_App);
+            float f_MenuW = textWidthPx(s_MenuLabel, 1.0f, p_App);
+            float f_MaxTextW = std::max({ f_ResumeW, f_DebugW, f_MenuW });
+            float f_PadXPx = std::max(12.0f, g_HUDStyle.pillsPadXPx * 0.8f);
+            float f_BtnW = std::min({ (float)i_W * 0.4f, f_ModalWpx * 0.6f, f_MaxTextW + 2.0f * f_PadXPx });
+            float f_BtnH = 36.0f;
+            float f_Spacing = 12.0f;
+            float f_StartX = f_Left + (f_ModalWpx - f_BtnW) * 0.5f;
+            float f_StartY = f_Bottom + 28.0f; 
+
+            // RESUME button
+            float f_ResumeX0 = f_StartX;
+            float f_ResumeY0 = f_StartY;
+            float f_ResumeX1 = f_ResumeX0 + f_BtnW;
+            float f_ResumeY1 = f_ResumeY0 + f_BtnH;
+            if (g_b_PausedResumeBtnHover.load()) {
+                float pad = 6.0f;
+                pushRoundedRectPx(layer, f_ResumeX0 - pad, f_ResumeY0 - pad, f_ResumeX1 + pad, f_ResumeY1 + pad, {1.0f,1.0f,1.0f,0.08f}, 14);
+            }
+            pushRoundedRectPx(layer, f_ResumeX0, f_ResumeY0, f_ResumeX1, f_ResumeY1, {0.0f,0.6f,0.2f,1.0f}, 10);
+            drawTextCenteredPx(layer.m_Text, s_ResumeLabel, f_ResumeX0, f_ResumeY0, f_ResumeX1, f_ResumeY1, white, p_App, -4.0f);
+
+            // DEBUGGING MODE button
+            float f_DebugX0 = f_StartX;
+            float f_DebugY0 = f_ResumeY1 + f_Spacing;
+            float f_DebugX1 = f_DebugX0 + f_BtnW;
+            float f_DebugY1 = f_DebugY0 + f_BtnH;
+            if (g_b_PausedDebugBtnHover.load()) {
+                float pad = 6.0f;
+                pushRoundedRectPx(layer, f_DebugX0 - pad, f_DebugY0 - pad, f_DebugX1 + pad, f_DebugY1 + pad, {1.0f,1.0f,1.0f,0.08f}, 14);
+            }
+            pushRoundedRectPx(layer, f_DebugX0, f_DebugY0, f_DebugX1, f_DebugY1, {0.0f,0.6f,0.2f,1.0f}, 10);
+            drawTextCenteredPx(layer.m_Text, s_DebugLabel, f_DebugX0, f_DebugY0, f_DebugX1, f_DebugY1, white, p_App, -4.0f);
+
+            // MENU button
+            float f_MenuX0 = f_StartX;
+            float f_MenuY0 = f_DebugY1 + f_Spacing;
+            float f_MenuX1 = f_MenuX0 + f_BtnW;
+            float f_MenuY1 = f_MenuY0 + f_BtnH;
+            if (g_b_PausedModalBtnHover.load()) {
+                float pad = 6.0f;
+                pushRoundedRectPx(layer, f_MenuX0 - pad, f_MenuY0 - pad, f_MenuX1 + pad, f_MenuY1 + pad, {1.0f,1.0f,1.0f,0.08f}, 14);
+            }
+            pushRoundedRectPx(layer, f_MenuX0, f_MenuY0, f_MenuX1, f_MenuY1, {0.0f,0.6f,0.2f,1.0f}, 10);
+            drawTextCenteredPx(layer.m_Text, s_MenuLabel, f_MenuX0, f_MenuY0, f_MenuX1, f_MenuY1, white, p_App, -4.0f);
+
+            // store pixel rects for mouse handling
+            g_i_PausedResumeBtnX0 = static_cast<int>(f_ResumeX0);
+            g_i_PausedResumeBtnY0 = static_cast<int>(f_ResumeY0);
+            g_i_PausedResumeBtnX1 = static_cast<int>(f_ResumeX1);
+            g_i_PausedResumeBtnY1 = static_cast<int>(f_ResumeY1);
+
+            g_i_PausedDebugBtnX0 = static_cast<int>(f_DebugX0);
+            g_i_PausedDebugBtnY0 = static_cast<int>(f_DebugY0);
+            g_i_PausedDebugBtnX1 = static_cast<int>(f_DebugX1);
+            g_i_PausedDebugBtnY1 = static_cast<int>(f_DebugY1);
+
+            g_i_PausedModalBtnX0 = static_cast<int>(f_MenuX0);
+            g_i_PausedModalBtnY0 = static_cast<int>(f_MenuY0);
+            g_i_PausedModalBtnX1 = static_cast<int>(f_MenuX1);
+            g_i_PausedModalBtnY1 = static_cast<int>(f_MenuY1);
+        }
+
     } // namespace
 
     // API
@@ -431,6 +606,7 @@ namespace UI {
         if (g_GLuint_TexCamera == 0) {
             std::fprintf(stderr, "[HUD] Camera icon load FAILED: %s\n", p_Path);
         }
+        g_b_BarsDirty.store(true);
     }
 
     void LoadPauseIconPNG(const char* p_Path, Core::Application* p_App) {
@@ -443,6 +619,7 @@ namespace UI {
         if (g_GLuint_TexPause == 0) {
             std::fprintf(stderr, "[HUD] Pause icon load FAILED: %s\n", p_Path);
         }
+        g_b_BarsDirty.store(true);
     }
 
     void SetCameraToggleCallback(std::function<void()> fn_Callback) {
@@ -479,13 +656,15 @@ namespace UI {
                         i_FlippedY >= g_i_PausedDebugBtnY0 && i_FlippedY <= g_i_PausedDebugBtnY1);
         bool b_Menu = (i_XPx >= g_i_PausedModalBtnX0 && i_XPx <= g_i_PausedModalBtnX1 &&
                        i_FlippedY >= g_i_PausedModalBtnY0 && i_FlippedY <= g_i_PausedModalBtnY1);
-        g_b_PausedResumeBtnHover.store(b_Resume);
-        g_b_PausedDebugBtnHover.store(b_Debug);
-        g_b_PausedModalBtnHover.store(b_Menu);
+        // Motion events arrive far more often than the hover state flips
+        bool b_Changed = g_b_PausedResumeBtnHover.exchange(b_Resume) != b_Resume;
+        b_Changed |= g_b_PausedDebugBtnHover.exchange(b_Debug) != b_Debug;
+        b_Changed |= g_b_PausedModalBtnHover.exchange(b_Menu) != b_Menu;
+        if (b_Changed) g_b_ModalDirty.store(true);
     }
 
     void SetPausedDebugState(bool enabled) {
-        g_b_DebugEnabled.store(enabled);
+        if (g_b_DebugEnabled.exchange(enabled) != enabled) g_b_ModalDirty.store(true);
     }
 
     void HandleMouseClick(int i_XPx, int i_YPx) {
@@ -502,6 +681,7 @@ namespace UI {
                 if (g_fn_OnPausedResume) g_fn_OnPausedResume();
                 else g_b_ShowPausedModal.store(false);
                 g_b_PausedResumeBtnHover.store(false);
+                g_b_ModalDirty.store(true);
                 return;
             }
 
@@ -518,6 +698,7 @@ namespace UI {
                 if (g_fn_OnPausedMenu) g_fn_OnPausedMenu();
                 else g_b_ShowPausedModal.store(false);
                 g_b_PausedModalBtnHover.store(false);
+                g_b_ModalDirty.store(true);
                 return;
             }
             return;
@@ -551,24 +732,28 @@ namespace UI {
     }
 
     void DrawTextCenteredPx(const std::string& s_Text, float f_X0_px, float f_Y0_px, float f_X1_px, float f_Y1_px, Color col, Core::Application* p_App, float f_DeltaYPx) {
-        // Convert pixel rect to NDC using bottom-left origin mapping (to match DrawRoundedRectScreen)
-        float nx0 = (f_X0_px / float(g_i_ViewportWidth)) * 2.0f - 1.0f;
-        float nx1 = (f_X1_px / float(g_i_ViewportWidth)) * 2.0f - 1.0f;
-        float ny0 = (f_Y0_px / float(g_i_ViewportHeight)) * 2.0f - 1.0f;
-        float ny1 = (f_Y1_px / float(g_i_ViewportHeight)) * 2.0f - 1.0f;
-        drawTextCentered(s_Text, nx0, ny0, nx1, ny1, col, p_App, f_DeltaYPx);
+        drawTextCenteredPx(g_TextBatch, s_Text, f_X0_px, f_Y0_px, f_X1_px, f_Y1_px, col, p_App, f_DeltaYPx);
+        flushText(p_App);
     }
 
     void ShutdownHUD() {
+        releaseLayer(g_BarsLayer);
+        releaseLayer(g_ModalLayer);
+        markAllDirty();
     }
 
     void SetViewport(int i_W, int i_H) {
-        g_i_ViewportWidth = std::max(1, i_W);
-        g_i_ViewportHeight = std::max(1, i_H);
+        i_W = std::max(1, i_W);
+        i_H = std::max(1, i_H);
+        if (i_W == g_i_ViewportWidth && i_H == g_i_ViewportHeight) return;
+        g_i_ViewportWidth = i_W;
+        g_i_ViewportHeight = i_H;
+        markAllDirty();
     }
 
     void SetHUDStyle(const HUDStyle& style) {
         g_HUDStyle = style;
+        markAllDirty();
     }
 
     void SetSlotMark(int round_1_to_24, TicketMark mark, bool markUsed) {
@@ -589,28 +774,41 @@ namespace UI {
         }
 
         g_vec_TicketSlots[idx].color = c;
+        g_b_BarsDirty.store(true);
     }
 
     void SetTicketStates(const std::vector<TicketSlot>& slots) {
         g_vec_TicketSlots = slots;
         if (g_vec_TicketSlots.size() < k_TicketSlotCount) g_vec_TicketSlots.resize(k_TicketSlotCount);
         if (g_vec_TicketSlots.size() > k_TicketSlotCount) g_vec_TicketSlots.resize(k_TicketSlotCount);
+        g_b_BarsDirty.store(true);
     }
 
     void SetTopBar(const std::vector<std::string>& vec_Labels,
         const std::vector<Color>& vec_PillColors,
         const std::vector<int>& vec_Counts) {
-        if (!vec_Labels.empty()) g_vec_PillLabels = vec_Labels;
-        if (!vec_PillColors.empty()) g_vec_PillColors = vec_PillColors;
-        if (!vec_Counts.empty()) {
+        // Called every frame with the same values; only a real change invalidates the layout
+        bool b_Changed = false;
+        if (!vec_Labels.empty() && vec_Labels != g_vec_PillLabels) {
+            g_vec_PillLabels = vec_Labels;
+            b_Changed = true;
+        }
+        if (!vec_PillColors.empty() && !sameColors(vec_PillColors, g_vec_PillColors)) {
+            g_vec_PillColors = vec_PillColors;
+            b_Changed = true;
+        }
+        if (vec_Counts != g_vec_PillCounts) {
             g_vec_PillCounts = vec_Counts;
-        } else {
-            g_vec_PillCounts.clear();
+            b_Changed = true;
         }
+        if (b_Changed) g_b_BarsDirty.store(true);
     }
 
     void SetRound(int i_Round) {
-        g_i_Round = std::clamp(i_Round, 1, 24);
+        i_Round = std::clamp(i_Round, 1, 24);
+        if (i_Round == g_i_Round) return;
+        g_i_Round = i_Round;
+        g_b_BarsDirty.store(true);
     }
 
     void RenderHUD(Core::Application* p_App) {
@@ -624,114 +822,36 @@ namespace UI {
 
         if (b_SRGBWas) glDisable(GL_FRAMEBUFFER_SRGB);
 
-        float f_TX0, f_TX1, f_TY0, f_TY1, f_BX0, f_BX1, f_BY0, f_BY1;
-        computeBars(f_TX0, f_TX1, f_TY0, f_TY1, f_BX0, f_BX1, f_BY0, f_BY1);
+        // Layout only reruns when round, tickets, labels or viewport changed since the last frame
+        if (g_b_BarsDirty.exchange(false)) {
+            float f_TX0, f_TX1, f_TY0, f_TY1, f_BX0, f_BX1, f_BY0, f_BY1;
+            computeBars(f_TX0, f_TX1, f_TY0, f_TY1, f_BX0, f_BX1, f_BY0, f_BY1);
 
-        drawTopBar(f_TX0, f_TY0, f_TX1, f_TY1, p_App);
-        drawBottomBar(f_BX0, f_BY0, f_BX1, f_BY1, p_App);
+            beginLayer(g_BarsLayer);
+            buildTopBar(g_BarsLayer, f_TX0, f_TY0, f_TX1, f_TY1, p_App);
+            buildBottomBar(g_BarsLayer, f_BX0, f_BY0, f_BX1, f_BY1, p_App);
+            uploadLayer(g_BarsLayer);
+        }
+
+        drawLayer(g_BarsLayer, p_App);
 
         // Draw paused modal on top of HUD if requested
         if (g_b_ShowPausedModal.load()) {
-            GLboolean b_DepthWas = glIsEnabled(GL_DEPTH_TEST);
-            GLboolean b_BlendWas = glIsEnabled(GL_BLEND);
-            if (b_DepthWas) glDisable(GL_DEPTH_TEST);
-            if (!b_BlendWas) glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
             int i_W = p_App->GetWidth();
             int i_H = p_App->GetHeight();
-            float f_ModalWpx = std::min(640.0f, float(i_W) * 0.5f);
-            float f_ModalHpx = std::min(240.0f, float(i_H) * 0.35f);
-            float f_Left = (i_W - f_ModalWpx) * 0.5f;
-            float f_Bottom = (i_H - f_ModalHpx) * 0.5f;
-            float f_Right = f_Left + f_ModalWpx;
-            float f_Top = f_Bottom + f_ModalHpx;
-
-            DrawRoundedRectScreen(f_Left, f_Bottom, f_Right, f_Top, {0.08f, 0.08f, 0.12f, 0.95f}, 12, p_App);
-
-            ScotlandYard::UI::Color white{1.0f,1.0f,1.0f,1.0f};
-            float f_TitleH = f_ModalHpx * 0.22f;
-            float f_MsgH = f_ModalHpx * 0.36f;
-
-            float f_TitleBottom = f_Bottom + f_ModalHpx * 0.74f;
-            float f_TitleTop = f_TitleBottom + f_TitleH;
-
-            float f_MsgBottom = f_Bottom + f_ModalHpx * 0.25f;
-            float f_MsgTop = f_MsgBottom + f_MsgH;
-
-            DrawTextCenteredPx("PAUSED", f_Left + 20.0f, f_TitleBottom, f_Right - 20.0f, f_TitleTop, white, p_App, -17.0f);
-            DrawTextCenteredPx("", f_Left + 20.0f, f_MsgBottom, f_Right - 20.0f, f_MsgTop, white, p_App, -6.0f);
-
-            std::string s_DebugLabel = g_b_DebugEnabled.load() ? "TURN OFF DEBUGGING MODE" : "TURN ON DEBUGGING MODE";
-            std::string s_ResumeLabel = "RESUME";
-            std::string s_MenuLabel = "MENU";
-
-            float f_TargetScale = 1.0f; 
-            float f_ResumeW = textWidthPx(s_ResumeLabel, 1.0f, p_App);
-            float f_DebugW = textWidthPx(s_DebugLabel, 1.0f, p_App);
-            float f_MenuW = textWidthPx(s_MenuLabel, 1.0f, p_App);
-            float f_MaxTextW = std::max({ f_ResumeW, f_DebugW, f_MenuW });
-            float f_PadXPx = std::max(12.0f, g_HUDStyle.pillsPadXPx * 0.8f);
-            float f_BtnW = std::min({ (float)i_W * 0.4f, f_ModalWpx * 0.6f, f_MaxTextW + 2.0f * f_PadXPx });
-            float f_BtnH = 36.0f;
-            float f_Spacing = 12.0f;
-            float f_StartX = f_Left + (f_ModalWpx - f_BtnW) * 0.5f;
-            float f_StartY = f_Bottom + 28.0f; 
-
-            // RESUME button
-            float f_ResumeX0 = f_StartX;
-            float f_ResumeY0 = f_StartY;
-            float f_ResumeX1 = f_ResumeX0 + f_BtnW;
-            float f_ResumeY1 = f_ResumeY0 + f_BtnH;
-            if (g_b_PausedResumeBtnHover.load()) {
-                float pad = 6.0f;
-                DrawRoundedRectScreen(f_ResumeX0 - pad, f_ResumeY0 - pad, f_ResumeX1 + pad, f_ResumeY1 + pad, {1.0f,1.0f,1.0f,0.08f}, 14, p_App);
-            }
-            DrawRoundedRectScreen(f_ResumeX0, f_ResumeY0, f_ResumeX1, f_ResumeY1, {0.0f,0.6f,0.2f,1.0f}, 10, p_App);
-            DrawTextCenteredPx(s_ResumeLabel, f_ResumeX0, f_ResumeY0, f_ResumeX1, f_ResumeY1, white, p_App, -4.0f);
-
-            // DEBUGGING MODE button
-            float f_DebugX0 = f_StartX;
-            float f_DebugY0 = f_ResumeY1 + f_Spacing;
-            float f_DebugX1 = f_DebugX0 + f_BtnW;
-            float f_DebugY1 = f_DebugY0 + f_BtnH;
-            if (g_b_PausedDebugBtnHover.load()) {
-                float pad = 6.0f;
-                DrawRoundedRectScreen(f_DebugX0 - pad, f_DebugY0 - pad, f_DebugX1 + pad, f_DebugY1 + pad, {1.0f,1.0f,1.0f,0.08f}, 14, p_App);
+            if (i_W != g_i_ModalBuiltWidth || i_H != g_i_ModalBuiltHeight) {
+                g_b_ModalDirty.store(true);
             }
-            DrawRoundedRectScreen(f_DebugX0, f_DebugY0, f_DebugX1, f_DebugY1, {0.0f,0.6f,0.2f,1.0f}, 10, p_App);
-            DrawTextCenteredPx(s_DebugLabel, f_DebugX0, f_DebugY0, f_DebugX1, f_DebugY1, white, p_App, -4.0f);
 
-            // MENU button
-            float f_MenuX0 = f_StartX;
-            float f_MenuY0 = f_DebugY1 + f_Spacing;
-            float f_MenuX1 = f_MenuX0 + f_BtnW;
-            float f_MenuY1 = f_MenuY0 + f_BtnH;
-            if (g_b_PausedModalBtnHover.load()) {
-                float pad = 6.0f;
-                DrawRoundedRectScreen(f_MenuX0 - pad, f_MenuY0 - pad, f_MenuX1 + pad, f_MenuY1 + pad, {1.0f,1.0f,1.0f,0.08f}, 14, p_App);
+            if (g_b_ModalDirty.exchange(false)) {
+                beginLayer(g_ModalLayer);
+                buildPausedModal(g_ModalLayer, i_W, i_H, p_App);
+                uploadLayer(g_ModalLayer);
+                g_i_ModalBuiltWidth = i_W;
+                g_i_ModalBuiltHeight = i_H;
             }
-            DrawRoundedRectScreen(f_MenuX0, f_MenuY0, f_MenuX1, f_MenuY1, {0.0f,0.6f,0.2f,1.0f}, 10, p_App);
-            DrawTextCenteredPx(s_MenuLabel, f_MenuX0, f_MenuY0, f_MenuX1, f_MenuY1, white, p_App, -4.0f);
-
-            // store pixel rects for mouse handling
-            g_i_PausedResumeBtnX0 = static_cast<int>(f_ResumeX0);
-            g_i_PausedResumeBtnY0 = static_cast<int>(f_ResumeY0);
-            g_i_PausedResumeBtnX1 = static_cast<int>(f_ResumeX1);
-            g_i_PausedResumeBtnY1 = static_cast<int>(f_ResumeY1);
-
-            g_i_PausedDebugBtnX0 = static_cast<int>(f_DebugX0);
-            g_i_PausedDebugBtnY0 = static_cast<int>(f_DebugY0);
-            g_i_PausedDebugBtnX1 = static_cast<int>(f_DebugX1);
-            g_i_PausedDebugBtnY1 = static_cast<int>(f_DebugY1);
-
-            g_i_PausedModalBtnX0 = static_cast<int>(f_MenuX0);
-            g_i_PausedModalBtnY0 = static_cast<int>(f_MenuY0);
-            g_i_PausedModalBtnX1 = static_cast<int>(f_MenuX1);
-            g_i_PausedModalBtnY1 = static_cast<int>(f_MenuY1);
 
-            if (b_BlendWas == GL_FALSE) glDisable(GL_BLEND);
-            if (b_DepthWas) glEnable(GL_DEPTH_TEST);
+            drawLayer(g_ModalLayer, p_App);
         }
 
         if (b_SRGBWas) glEnable(GL_FRAMEBUFFER_SRGB);
@@ -0,0 +1,415 @@
+#include "HeadlessTraining.h"
+#include "GameRules.h"
+#include "MapAsset.h"
+#include "NeuralNetworkManager.h"
+#include "ReplayBuffer.h"
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include "TrajectoryWriter.h"
+#include "VecEnv.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Core {
+
+namespace {
+    // Games per RunGames chunk. Fixed rather than derived from the thread count,
+    // since each chunk has its own generator: the same seed must split into the
+    // same chunks on every machine. Small enough to balance across many cores.
+    constexpr int64_t k_GamesPerChunk = 256;
+    // Rows the stand-in learner draws from the replay buffer per VecEnv step,
+    // fewer when the buffer cannot hold that many
+    constexpr size_t k_ReplayBatchRows = 256;
+
+    // Finished VecEnv games on their way to a TrajectoryWriter and/or a
+    // ReplayBuffer. Each environment's moves collect in its own staging slot
+    // and are handed over when its game ends, once the outcome is known.
+    class GameRecorder {
+    public:
+        GameRecorder(const AI::TrajectoryLayout& layout, size_t num_Envs, AI::TrajectoryWriter* p_Writer,
+                     AI::ReplayBuffer* p_Replay)
+            : m_Layout(layout)
+            , m_p_Writer(p_Writer)
+            , m_p_Replay(p_Replay)
+            , m_num_SlotBytes(static_cast<size_t>(AI::k_MaxTrajectorySteps) * layout.GetStepBytes())
+            , m_vec_Staging(num_Envs * m_num_SlotBytes)
+            , m_vec_StepCounts(num_Envs, 0)
+            , m_vec_Policy(layout.GetActionCount())
+            , m_vec_Mask(layout.GetMaskWords())
+            , m_p_Block(p_Writer ? p_Writer->AcquireBlock() : nullptr)
+        {
+        }
+
+        // Before env.Step(): the state the move was chosen in, and how it was chosen
+        void RecordMove(const VecEnv& env, size_t i_Env, uint32_t u32_Action, const float* p_Mask,
+                        const float* p_Policy, float f_Total) {
+            uint32_t& u32_Steps = m_vec_StepCounts[i_Env];
+            if (u32_Steps >= AI::k_MaxTrajectorySteps) {
+                return;
+            }
+            for (size_t a = 0; a < m_vec_Policy.size(); ++a) {
+                m_vec_Policy[a] = p_Mask[a] * (p_Policy ? p_Policy[a] : 1.0f) / f_Total;
+            }
+
+            RulesState state;
+            env.LoadState(i_Env, state);
+            uint8_t* p_Step = m_vec_Staging.data() + i_Env * m_num_SlotBytes
+                              + static_cast<size_t>(u32_Steps) * m_Layout.GetStepBytes();
+            m_Layout.PackStep(p_Step, state, env.GetPossibleMisterX() + i_Env * env.GetMaskWords(), u32_Action,
+                            m_vec_Policy.data());
+            ++u32_Steps;
+        }
+
+        // After env.Step(): hand over every game that just ended
+        void FinishGames(const VecEnv& env) {
+            const uint8_t* p_Dones = env.GetDones();
+            const float* p_Rewards = env.GetRewards();
+            for (size_t i = 0; i < m_vec_StepCounts.size(); ++i) {
+                if (!p_Dones[i]) continue;
+                const uint8_t* p_Steps = m_vec_Staging.data() + i * m_num_SlotBytes;
+                int8_t i8_Outcome = p_Rewards[i] > 0.0f ? 1 : -1;
+                if (m_p_Writer) WriteGame(p_Steps, m_vec_StepCounts[i], i8_Outcome);
+                if (m_p_Replay) PushGame(p_Steps, m_vec_StepCounts[i], i8_Outcome);
+                m_vec_StepCounts[i] = 0;
+            }
+        }
+
+        // Games still running are not recorded
+        void Finish() {
+            if (m_p_Writer) m_p_Writer->SubmitBlock(m_p_Block);
+            m_p_Block = nullptr;
+        }
+
+    private:
+        void WriteGame(const uint8_t* p_Steps, uint32_t u32_Steps, int8_t i8_Outcome) {
+            if (!m_p_Block || !m_p_Block->Append(p_Steps, u32_Steps, i8_Outcome)) {
+                m_p_Writer->SubmitBlock(m_p_Block);
+                m_p_Block = m_p_Writer->AcquireBlock();
+                if (!m_p_Block || !m_p_Block->Append(p_Steps, u32_Steps, i8_Outcome)) {
+                    m_p_Writer->RecordDropped(1);
+                }
+            }
+        }
+
+        // Value targets from the side to move, as TrajectoryReader::Sample() gives them
+        void PushGame(const uint8_t* p_Steps, uint32_t u32_Steps, int8_t i8_Outcome) {
+            RulesState state;
+            uint32_t u32_Action = 0;
+            for (uint32_t s = 0; s < u32_Steps; ++s) {
+                m_Layout.UnpackStep(p_Steps + static_cast<size_t>(s) * m_Layout.GetStepBytes(), state,
+                                    m_vec_Mask.data(), u32_Action, m_vec_Policy.data());
+                float f_Value = state.u8_Turn == 0 ? i8_Outcome : -i8_Outcome;
+                m_p_Replay->Push(state, m_vec_Mask.data(), u32_Action, m_vec_Policy.data(), f_Value);
+            }
+        }
+
+        AI::TrajectoryLayout m_Layout;
+        AI::TrajectoryWriter* m_p_Writer;
+        AI::ReplayBuffer* m_p_Replay;
+        size_t m_num_SlotBytes;
+        std::vector<uint8_t> m_vec_Staging;
+        std::vector<uint32_t> m_vec_StepCounts;
+        std::vector<float> m_vec_Policy;
+        std::vector<uint64_t> m_vec_Mask;
+        AI::TrajectoryBlock* m_p_Block;
+    };
+
+    // Plays the learner's part against a ReplayBuffer: draws a minibatch,
+    // takes the loaded network's value error on it (the target itself without
+    // a network) and feeds that back as the new priorities
+    class ReplayLearner {
+    public:
+        ReplayLearner(AI::ReplayBuffer& replay, const RulesGraph& graph, uint64_t u64_Seed, bool b_UseModel)
+            : m_Replay(replay)
+            , m_num_BatchRows(std::min<size_t>(k_ReplayBatchRows, replay.GetCapacity()))
+            , m_Encoder(graph)
+            , m_Rng(u64_Seed)
+            , m_b_UseModel(b_UseModel)
+            , m_num_Batches(0)
+            , m_d_ErrorSum(0.0)
+            , m_d_Seconds(0.0)
+        {
+        }
+
+        void Step() {
+            if (m_Replay.GetSize() < m_num_BatchRows) return;
+            auto t_Start = std::chrono::steady_clock::now();
+            if (!m_Replay.Sample(m_num_BatchRows, m_Rng, m_Encoder, m_Sample)) return;
+
+            const AI::TrajectoryBatch& batch = m_Sample.batch;
+            m_vec_Errors.assign(batch.num_Rows, 0.0f);
+            m_vec_Predicted.assign(batch.num_Rows, 0.5f);
+            if (m_b_UseModel) {
+                m_vec_Policy.resize(batch.num_Rows * m_Encoder.GetActionCount());
+                AI::NeuralNetworkManager::Evaluate(batch.vec_Features.data(), batch.num_Rows, m_vec_Policy.data(),
+                                                   m_vec_Predicted.data());
+            }
+            for (size_t i = 0; i < batch.num_Rows; ++i) {
+                // The network predicts a win probability, the target is +1/-1
+                m_vec_Errors[i] = batch.vec_Values[i] - (2.0f * m_vec_Predicted[i] - 1.0f);
+                m_d_ErrorSum += std::fabs(m_vec_Errors[i]) * m_Sample.vec_Weights[i];
+            }
+            m_Replay.UpdatePriorities(m_Sample.vec_Ids.data(), m_vec_Errors.data(), batch.num_Rows);
+
+            ++m_num_Batches;
+            m_d_Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+        }
+
+        void Print() const {
+            const double d_Rows = static_cast<double>(m_num_Batches * m_num_BatchRows);
+            std::cout << "[Training] Replay buffer: " << m_Replay.GetSize() << " of " << m_Replay.GetCapacity()
+                      << " transitions (" << m_Replay.GetMemoryBytes() / (1024.0 * 1024.0) << " MB), "
+                      << m_Replay.GetPushed() << " pushed, " << m_Replay.GetDropped() << " dropped; sampled "
+                      << m_num_Batches << " batches of " << m_num_BatchRows << " ("
+                      << (m_d_Seconds > 0.0 ? d_Rows / m_d_Seconds : 0.0) << " rows/s), weighted mean |error| "
+                      << (d_Rows > 0.0 ? m_d_ErrorSum / d_Rows : 0.0) << std::endl;
+        }
+
+    private:
+        AI::ReplayBuffer& m_Replay;
+        size_t m_num_BatchRows;
+        FeatureEncoder m_Encoder;
+        std::mt19937_64 m_Rng;
+        bool m_b_UseModel;
+        AI::ReplaySample m_Sample;
+        std::vector<float> m_vec_Errors;
+        std::vector<float> m_vec_Predicted;
+        std::vector<float> m_vec_Policy;
+        size_t m_num_Batches;
+        double m_d_ErrorSum;
+        double m_d_Seconds;
+    };
+
+    void PrintRecording(const AI::TrajectoryWriter& writer, const std::string& s_Directory) {
+        std::cout << "[Training] Recorded " << writer.GetWrittenTrajectories() << " games, "
+                  << writer.GetWrittenSteps() << " steps to " << writer.GetShardCount() << " shard(s) in "
+                  << s_Directory << ": " << writer.GetCompressedBytes() / (1024.0 * 1024.0) << " MB";
+        if (writer.GetCompressedBytes() > 0) {
+            std::cout << " (" << static_cast<double>(writer.GetRawBytes()) / writer.GetCompressedBytes()
+                      << "x compressed)";
+        }
+        if (writer.GetDroppedTrajectories() > 0) {
+            std::cout << ", " << writer.GetDroppedTrajectories() << " dropped";
+        }
+        std::cout << std::endl;
+    }
+
+    // Samples every game's action from the loaded network, restricted to the
+    // usable slots; uniform over them when there is no model that fits
+    void RunVecEnv(std::shared_ptr<const MapAsset> sp_Map, const TrainingOptions& options, uint64_t u64_Seed,
+                   TrainingReport& report) {
+        const uint32_t u32_NodeCount = sp_Map->GetRulesGraph().GetNodeCount();
+        const std::shared_ptr<const MapAsset> sp_ReplayMap = sp_Map;
+        VecEnv env(std::move(sp_Map), static_cast<size_t>(options.i_Envs), u64_Seed);
+        const size_t num_Envs = env.GetEnvCount();
+        const uint32_t u32_ActionCount = env.GetActionCount();
+        std::vector<uint32_t> vec_Actions(num_Envs);
+        std::mt19937 rng(static_cast<uint32_t>(u64_Seed));
+
+        const AI::TrajectoryLayout layout(u32_NodeCount, u32_ActionCount);
+        AI::TrajectoryWriter writer;
+        bool b_Recording = false;
+        if (!options.s_RecordDirectory.empty()) {
+            AI::TrajectoryWriterOptions writerOptions;
+            writerOptions.s_Directory = options.s_RecordDirectory;
+            b_Recording = writer.Open(layout, writerOptions);
+            if (!b_Recording) {
+                std::cerr << "[Training] ERROR: Not recording games" << std::endl;
+            }
+        }
+
+        std::unique_ptr<AI::ReplayBuffer> p_Replay;
+        if (options.u32_ReplayCapacity > 0 && !layout.Fits()) {
+            std::cerr << "[Training] ERROR: " << u32_NodeCount << " nodes and " << u32_ActionCount
+                      << " actions do not fit the replay buffer; not replaying games" << std::endl;
+        } else if (options.u32_ReplayCapacity > 0) {
+            AI::ReplayBufferOptions replayOptions;
+            replayOptions.u32_Capacity = options.u32_ReplayCapacity;
+            p_Replay = std::make_unique<AI::ReplayBuffer>(layout, replayOptions);
+        }
+
+        std::unique_ptr<GameRecorder> p_Recorder;
+        if (b_Recording || p_Replay) {
+            p_Recorder = std::make_unique<GameRecorder>(layout, num_Envs, b_Recording ? &writer : nullptr,
+                                                        p_Replay.get());
+        }
+
+        bool b_UseModel = AI::NeuralNetworkManager::IsReady();
+        if (b_UseModel && (AI::NeuralNetworkManager::GetInputSize() != env.GetObservationSize() ||
+                           AI::NeuralNetworkManager::GetPolicySize() != u32_ActionCount)) {
+            std::cerr << "[Training] ERROR: Model takes " << AI::NeuralNetworkManager::GetInputSize() << " inputs and "
+                      << AI::NeuralNetworkManager::GetPolicySize() << " actions, the environment has "
+                      << env.GetObservationSize() << " and " << u32_ActionCount << "; playing randomly" << std::endl;
+            b_UseModel = false;
+        }
+        std::vector<float> vec_Policy(b_UseModel ? num_Envs * u32_ActionCount : 0);
+        std::unique_ptr<ReplayLearner> p_Learner;
+        if (p_Replay) {
+            p_Learner = std::make_unique<ReplayLearner>(*p_Replay, sp_ReplayMap->GetRulesGraph(), u64_Seed, b_UseModel);
+        }
+        size_t num_Chunks = (num_Envs + VecEnv::k_EnvsPerChunk - 1) / VecEnv::k_EnvsPerChunk;
+
+        while (static_cast<int64_t>(env.GetCompletedGames()) < options.i64_Games) {
+            if (b_UseModel) {
+                Threading::ThreadPool::ParallelFor(num_Chunks, [&](size_t i_Chunk) {
+                    size_t i_First = i_Chunk * VecEnv::k_EnvsPerChunk;
+                    size_t num_Rows = std::min(VecEnv::k_EnvsPerChunk, num_Envs - i_First);
+                    AI::NeuralNetworkManager::Evaluate(env.GetObservations() + i_First * env.GetObservationSize(),
+                                                       num_Rows, vec_Policy.data() + i_First * u32_ActionCount, nullptr);
+                });
+            }
+
+            for (size_t i = 0; i < num_Envs; ++i) {
+                const float* p_Mask = env.GetActionMask(i);
+                const float* p_Policy = b_UseModel ? vec_Policy.data() + i * u32_ActionCount : nullptr;
+                float f_Total = 0.0f;
+                for (uint32_t a = 0; a < u32_ActionCount; ++a) {
+                    f_Total += p_Mask[a] * (p_Policy ? p_Policy[a] : 1.0f);
+                }
+                // The network may put all its mass on unusable slots (or underflow
+                // to nothing); pick and record uniformly over the usable ones then
+                if (p_Policy && !(f_Total > 0.0f)) {
+                    p_Policy = nullptr;
+                    f_Total = 0.0f;
+                    for (uint32_t a = 0; a < u32_ActionCount; ++a) f_Total += p_Mask[a];
+                }
+                float f_Pick = std::uniform_real_distribution<float>(0.0f, f_Total)(rng);
+                uint32_t u32_Action = 0;
+                for (uint32_t a = 0; a < u32_ActionCount; ++a) {
+                    if (p_Mask[a] <= 0.0f) continue;
+                    u32_Action = a;
+                    f_Pick -= p_Policy ? p_Policy[a] : 1.0f;
+                    if (f_Pick <= 0.0f) break;
+                }
+                vec_Actions[i] = u32_Action;
+                if (p_Recorder) p_Recorder->RecordMove(env, i, u32_Action, p_Mask, p_Policy, f_Total);
+            }
+            env.Step(vec_Actions.data());
+            report.i64_Moves += static_cast<int64_t>(num_Envs);
+            if (p_Recorder) p_Recorder->FinishGames(env);
+            if (p_Learner) p_Learner->Step();
+        }
+
+        if (p_Recorder) {
+            p_Recorder->Finish();
+        }
+        if (b_Recording) {
+            writer.Close();
+            PrintRecording(writer, options.s_RecordDirectory);
+        }
+        if (p_Learner) {
+            p_Learner->Print();
+        }
+
+        report.i64_Games = static_cast<int64_t>(env.GetCompletedGames());
+        report.i64_MisterXWins = static_cast<int64_t>(env.GetMisterXWins());
+        report.i64_DetectiveWins = report.i64_Games - report.i64_MisterXWins;
+        report.i64_Rounds = static_cast<int64_t>(env.GetCompletedRounds());
+    }
+
+    void RunGames(const RulesGraph& graph, int64_t i64_Games, uint64_t u64_Seed, TrainingReport& report) {
+        const size_t num_Chunks = static_cast<size_t>(std::max<int64_t>((i64_Games + k_GamesPerChunk - 1) / k_GamesPerChunk, 1));
+        std::vector<TrainingReport> vec_ChunkReports(num_Chunks);
+
+        Threading::ThreadPool::ParallelFor(num_Chunks, [&](size_t i_Chunk) {
+            TRACE_SCOPE("TrainingChunk");
+
+            // Seeded from the chunk index and chunks cover fixed game ranges, so a fixed seed
+            // replays the same games however many threads run them
+            std::seed_seq seq{ static_cast<uint32_t>(u64_Seed), static_cast<uint32_t>(u64_Seed >> 32),
+                               static_cast<uint32_t>(i_Chunk) };
+            std::mt19937 rng(seq);
+            std::vector<uint32_t> vec_Moves(graph.GetMaxDegree());
+
+            int64_t i64_First = static_cast<int64_t>(i_Chunk) * k_GamesPerChunk;
+            int64_t i64_Last = std::min(i64_First + k_GamesPerChunk, i64_Games);
+
+            TrainingReport local;
+            RulesState state;
+            for (int64_t g = i64_First; g < i64_Last; ++g) {
+                GameRules::Reset(state, graph, rng);
+                while (state.e_Outcome == GameOutcome::None) {
+                    if (GameRules::PlayRandomMove(state, graph, rng, vec_Moves.data()) != GameRules::k_Pass) {
+                        ++local.i64_Moves;
+                    }
+                }
+                ++local.i64_Games;
+                local.i64_Rounds += state.u8_Round;
+                if (state.e_Outcome == GameOutcome::MisterX) ++local.i64_MisterXWins;
+                else ++local.i64_DetectiveWins;
+            }
+            vec_ChunkReports[i_Chunk] = local;
+        });
+
+        for (const TrainingReport& chunk : vec_ChunkReports) {
+            report.i64_Games += chunk.i64_Games;
+            report.i64_Moves += chunk.i64_Moves;
+            report.i64_MisterXWins += chunk.i64_MisterXWins;
+            report.i64_DetectiveWins += chunk.i64_DetectiveWins;
+            report.i64_Rounds += chunk.i64_Rounds;
+        }
+    }
+}
+
+void TrainingReport::Print() const {
+    std::cout << "[Training] " << i64_Games << " games, " << i64_Moves << " moves in " << d_Seconds << " s";
+    if (d_Seconds > 0.0) {
+        std::cout << " (" << i64_Games / d_Seconds << " games/s, " << i64_Moves / d_Seconds << " moves/s)";
+    }
+    std::cout << std::endl;
+    if (i64_Games > 0) {
+        std::cout << "[Training] Mr X won " << 100.0 * i64_MisterXWins / i64_Games << "%, detectives "
+                  << 100.0 * i64_DetectiveWins / i64_Games << "%, average "
+                  << static_cast<double>(i64_Rounds) / i64_Games << " rounds" << std::endl;
+    }
+}
+
+bool RunHeadlessTraining(const TrainingOptions& options, TrainingReport& report) {
+    TRACE_SCOPE("RunHeadlessTraining");
+
+    // Only VecEnv games are recorded; refuse rather than play them unrecorded
+    if (options.i_Envs <= 0 && (!options.s_RecordDirectory.empty() || options.u32_ReplayCapacity > 0)) {
+        std::cerr << "[Training] ERROR: Recording and the replay buffer only work with --envs" << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<const MapAsset> sp_Map = MapAsset::Acquire();
+    const RulesGraph& graph = sp_Map->GetRulesGraph();
+    if (graph.GetNodeCount() < static_cast<uint32_t>(k_PlayerCount)) {
+        std::cerr << "[Training] ERROR: Map has " << graph.GetNodeCount() << " nodes, need at least "
+                  << k_PlayerCount << std::endl;
+        return false;
+    }
+
+    uint64_t u64_Seed = options.u64_Seed;
+    if (u64_Seed == 0) {
+        std::random_device rd;
+        u64_Seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
+
+    int64_t i64_Games = std::max<int64_t>(options.i64_Games, 0);
+    std::cout << "[Training] Playing " << i64_Games << " games on " << Threading::ThreadPool::GetThreadCount() + 1
+              << " threads (seed " << u64_Seed;
+    if (options.i_Envs > 0) std::cout << ", " << options.i_Envs << " environments";
+    std::cout << ")" << std::endl;
+
+    report = TrainingReport();
+    auto t_Start = std::chrono::steady_clock::now();
+    if (options.i_Envs > 0) {
+        RunVecEnv(std::move(sp_Map), options, u64_Seed, report);
+    } else {
+        RunGames(graph, i64_Games, u64_Seed, report);
+    }
+    report.d_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+    return true;
+}
+
+} // namespace Core
+} // namespace ScotlandYard
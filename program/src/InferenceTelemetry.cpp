@@ -0,0 +1,193 @@
+#include "InferenceTelemetry.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace ScotlandYard {
+namespace AI {
+
+namespace {
+    constexpr int k_SubBucketBits = 3;   // log2(LatencyHistogram::k_SubBuckets)
+
+    inline int HighestBit(uint64_t u64_Value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int i_Bit = 63;
+        while (!(u64_Value >> i_Bit)) --i_Bit;
+        return i_Bit;
+#else
+        return 63 - __builtin_clzll(u64_Value);
+#endif
+    }
+
+    // Values below k_SubBuckets get a bucket each; above that, the top four
+    // bits of the value (leading one plus three) pick the bucket
+    inline int BucketIndex(uint64_t u64_Value) {
+        if (u64_Value < static_cast<uint64_t>(LatencyHistogram::k_SubBuckets)) {
+            return static_cast<int>(u64_Value);
+        }
+        int i_Bit = HighestBit(u64_Value);
+        int i_Sub = static_cast<int>((u64_Value >> (i_Bit - k_SubBucketBits)) & (LatencyHistogram::k_SubBuckets - 1));
+        return (i_Bit - k_SubBucketBits + 1) * LatencyHistogram::k_SubBuckets + i_Sub;
+    }
+
+    inline double BucketUpperEdge(int i_Bucket) {
+        if (i_Bucket < LatencyHistogram::k_SubBuckets) {
+            return i_Bucket + 1.0;
+        }
+        int i_Shift = i_Bucket / LatencyHistogram::k_SubBuckets - 1;
+        int i_Sub = i_Bucket % LatencyHistogram::k_SubBuckets;
+        return static_cast<double>(LatencyHistogram::k_SubBuckets + i_Sub + 1) * static_cast<double>(uint64_t{1} << i_Shift);
+    }
+
+    inline int BatchBucket(size_t num_Rows) {
+        if (num_Rows <= 1) {
+            return 0;
+        }
+        return std::min(k_BatchSizeBuckets - 1, HighestBit(static_cast<uint64_t>(num_Rows - 1)) + 1);
+    }
+
+    LatencySummary Summarize(const LatencyHistogram& histogram) {
+        LatencySummary summary;
+        summary.u64_Count = histogram.GetCount();
+        summary.d_MeanUs = histogram.GetMeanMicroseconds();
+        summary.d_P50Us = histogram.GetPercentileMicroseconds(0.50);
+        summary.d_P95Us = histogram.GetPercentileMicroseconds(0.95);
+        summary.d_P99Us = histogram.GetPercentileMicroseconds(0.99);
+        summary.d_MaxUs = histogram.GetMaxMicroseconds();
+        return summary;
+    }
+
+    void PrintLatency(const char* p_Label, const LatencySummary& summary) {
+        if (summary.u64_Count == 0) {
+            return;
+        }
+        std::cout << "[NeuralNetwork]   " << p_Label << " us: mean " << summary.d_MeanUs << ", p50 " << summary.d_P50Us
+                  << ", p95 " << summary.d_P95Us << ", p99 " << summary.d_P99Us << ", max " << summary.d_MaxUs
+                  << " (" << summary.u64_Count << " samples)" << std::endl;
+    }
+}
+
+void LatencyHistogram::Record(uint64_t u64_Nanoseconds, uint64_t u64_Samples) {
+    m_arr_Buckets[BucketIndex(u64_Nanoseconds)].fetch_add(u64_Samples, std::memory_order_relaxed);
+    m_u64_Count.fetch_add(u64_Samples, std::memory_order_relaxed);
+    m_u64_SumNanoseconds.fetch_add(u64_Nanoseconds * u64_Samples, std::memory_order_relaxed);
+
+    uint64_t u64_Max = m_u64_MaxNanoseconds.load(std::memory_order_relaxed);
+    while (u64_Nanoseconds > u64_Max &&
+           !m_u64_MaxNanoseconds.compare_exchange_weak(u64_Max, u64_Nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::Reset() {
+    for (std::atomic<uint64_t>& bucket : m_arr_Buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_u64_Count.store(0, std::memory_order_relaxed);
+    m_u64_SumNanoseconds.store(0, std::memory_order_relaxed);
+    m_u64_MaxNanoseconds.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::GetMeanMicroseconds() const {
+    uint64_t u64_Count = GetCount();
+    return u64_Count ? m_u64_SumNanoseconds.load(std::memory_order_relaxed) * 1e-3 / u64_Count : 0.0;
+}
+
+double LatencyHistogram::GetPercentileMicroseconds(double d_Quantile) const {
+    // Sum the buckets rather than trusting m_u64_Count, which may be a record ahead
+    uint64_t u64_Total = 0;
+    for (const std::atomic<uint64_t>& bucket : m_arr_Buckets) {
+        u64_Total += bucket.load(std::memory_order_relaxed);
+    }
+    if (u64_Total == 0) {
+        return 0.0;
+    }
+
+    uint64_t u64_Rank = std::max<uint64_t>(1, static_cast<uint64_t>(d_Quantile * u64_Total + 0.5));
+    uint64_t u64_Seen = 0;
+    for (int i = 0; i < k_BucketCount; ++i) {
+        u64_Seen += m_arr_Buckets[i].load(std::memory_order_relaxed);
+        if (u64_Seen >= u64_Rank) {
+            // Never report past the largest sample actually seen
+            return std::min(BucketUpperEdge(i), static_cast<double>(m_u64_MaxNanoseconds.load(std::memory_order_relaxed)))
+                   * 1e-3;
+        }
+    }
+    return GetMaxMicroseconds();
+}
+
+InferenceTelemetry::InferenceTelemetry(std::string s_ModelPath, uint64_t u64_Generation)
+    : m_s_ModelPath(std::move(s_ModelPath))
+    , m_u64_Generation(u64_Generation)
+{
+    Reset();
+}
+
+void InferenceTelemetry::RecordBatch(size_t num_Rows, uint64_t u64_ComputeNanoseconds) {
+    m_u64_Requests.fetch_add(num_Rows, std::memory_order_relaxed);
+    m_u64_Batches.fetch_add(1, std::memory_order_relaxed);
+    m_arr_BatchSizes[BatchBucket(num_Rows)].fetch_add(1, std::memory_order_relaxed);
+    m_Compute.Record(u64_ComputeNanoseconds);
+}
+
+void InferenceTelemetry::Reset() {
+    m_i64_StartTicks.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    m_u64_Requests.store(0, std::memory_order_relaxed);
+    m_u64_Rejected.store(0, std::memory_order_relaxed);
+    m_u64_Batches.store(0, std::memory_order_relaxed);
+    for (std::atomic<uint64_t>& bucket : m_arr_BatchSizes) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_QueueWait.Reset();
+    m_Compute.Reset();
+    m_Latency.Reset();
+}
+
+InferenceStats InferenceTelemetry::GetStats() const {
+    InferenceStats stats;
+    stats.s_ModelPath = m_s_ModelPath;
+    stats.u64_Generation = m_u64_Generation;
+    Clock::time_point tp_Start{Clock::duration{m_i64_StartTicks.load(std::memory_order_relaxed)}};
+    stats.d_Seconds = std::chrono::duration<double>(Clock::now() - tp_Start).count();
+    stats.u64_Requests = m_u64_Requests.load(std::memory_order_relaxed);
+    stats.u64_Rejected = m_u64_Rejected.load(std::memory_order_relaxed);
+    stats.u64_Batches = m_u64_Batches.load(std::memory_order_relaxed);
+    for (int i = 0; i < k_BatchSizeBuckets; ++i) {
+        stats.arr_BatchSizes[i] = m_arr_BatchSizes[i].load(std::memory_order_relaxed);
+    }
+    stats.queueWait = Summarize(m_QueueWait);
+    stats.compute = Summarize(m_Compute);
+    stats.latency = Summarize(m_Latency);
+    return stats;
+}
+
+void InferenceStats::Print() const {
+    std::cout << "[NeuralNetwork] " << s_ModelPath << ": " << u64_Requests << " inferences in " << u64_Batches
+              << " batches over " << d_Seconds << " s (" << GetRequestsPerSecond() << "/s, average batch "
+              << GetAverageBatchSize() << ")";
+    if (u64_Rejected) {
+        std::cout << ", " << u64_Rejected << " rejected";
+    }
+    std::cout << std::endl;
+
+    std::cout << "[NeuralNetwork]   batch sizes:";
+    for (int i = 0; i < k_BatchSizeBuckets; ++i) {
+        if (arr_BatchSizes[i] == 0) {
+            continue;
+        }
+        std::cout << " " << GetBatchBucketFloor(i);
+        if (i == k_BatchSizeBuckets - 1) {
+            std::cout << "+";
+        } else if (GetBatchBucketFloor(i) != GetBatchBucketFloor(i + 1) - 1) {
+            std::cout << "-" << GetBatchBucketFloor(i + 1) - 1;
+        }
+        std::cout << ":" << arr_BatchSizes[i];
+    }
+    std::cout << std::endl;
+
+    PrintLatency("latency", latency);
+    PrintLatency("queue wait", queueWait);
+    PrintLatency("compute", compute);
+}
+
+} // namespace AI
+} // namespace ScotlandYard
@@ -0,0 +1,34 @@
+#include "LinearArena.h"
+#include <cstdint>
+
+namespace ScotlandYard {
+namespace Memory {
+
+LinearArena::LinearArena(size_t num_Capacity, MemoryTag e_Tag)
+    : m_p_Base(static_cast<char*>(MemoryManager::AllocateAligned(num_Capacity ? num_Capacity : 1,
+                                                                 k_DefaultAlignment, e_Tag)))
+    , m_num_Capacity(num_Capacity)
+    , m_num_Used(0)
+    , m_e_Tag(e_Tag)
+{
+}
+
+LinearArena::~LinearArena() {
+    MemoryManager::FreeAligned(m_p_Base, k_DefaultAlignment, m_e_Tag);
+}
+
+void* LinearArena::Allocate(size_t num_Bytes, size_t num_Alignment) {
+    // The base is only k_DefaultAlignment aligned, so align the address, not the offset
+    uintptr_t u_Base = reinterpret_cast<uintptr_t>(m_p_Base);
+    uintptr_t u_Start = (u_Base + m_num_Used + num_Alignment - 1) & ~static_cast<uintptr_t>(num_Alignment - 1);
+    size_t num_Offset = static_cast<size_t>(u_Start - u_Base);
+    if (num_Offset > m_num_Capacity || num_Bytes > m_num_Capacity - num_Offset) {
+        return nullptr;
+    }
+
+    m_num_Used = num_Offset + num_Bytes;
+    return m_p_Base + num_Offset;
+}
+
+} // namespace Memory
+} // namespace ScotlandYard
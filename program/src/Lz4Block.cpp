@@ -0,0 +1,168 @@
+#include "Lz4Block.h"
+#include <cstring>
+
+namespace ScotlandYard {
+namespace Utils {
+
+namespace {
+    constexpr size_t k_MinMatch = 4;
+    // The format ends every block with at least this many literals...
+    constexpr size_t k_LastLiterals = 5;
+    // ...and starts no match within this many bytes of the end
+    constexpr size_t k_MatchStartLimit = 12;
+    constexpr size_t k_MaxOffset = 65535;
+    constexpr int k_HashBits = 12;
+
+    inline uint32_t Read32(const uint8_t* p) {
+        uint32_t u32_Value;
+        std::memcpy(&u32_Value, p, sizeof(u32_Value));
+        return u32_Value;
+    }
+
+    inline uint32_t Hash(uint32_t u32_Sequence) {
+        return (u32_Sequence * 2654435761u) >> (32 - k_HashBits);
+    }
+
+    // Writes a length's 255-continuation bytes after the token nibble is full
+    inline uint8_t* WriteLengthTail(uint8_t* p_Out, size_t num_Length) {
+        for (; num_Length >= 255; num_Length -= 255) {
+            *p_Out++ = 255;
+        }
+        *p_Out++ = static_cast<uint8_t>(num_Length);
+        return p_Out;
+    }
+
+    // Token, literal run and, when num_MatchLength is not 0, the match; null
+    // when the sequence would pass p_End
+    uint8_t* WriteSequence(uint8_t* p_Out, uint8_t* p_End, const uint8_t* p_Literals, size_t num_Literals,
+                           size_t num_Offset, size_t num_MatchLength) {
+        size_t num_Worst = 1 + num_Literals / 255 + 1 + num_Literals + 2 + num_MatchLength / 255 + 1;
+        if (num_Worst > static_cast<size_t>(p_End - p_Out)) {
+            return nullptr;
+        }
+
+        uint8_t* p_Token = p_Out++;
+        *p_Token = static_cast<uint8_t>((num_Literals < 15 ? num_Literals : 15) << 4);
+        if (num_Literals >= 15) {
+            p_Out = WriteLengthTail(p_Out, num_Literals - 15);
+        }
+        if (num_Literals > 0) {
+            std::memcpy(p_Out, p_Literals, num_Literals);
+            p_Out += num_Literals;
+        }
+
+        if (num_MatchLength > 0) {
+            *p_Out++ = static_cast<uint8_t>(num_Offset);
+            *p_Out++ = static_cast<uint8_t>(num_Offset >> 8);
+            size_t num_Code = num_MatchLength - k_MinMatch;
+            *p_Token |= static_cast<uint8_t>(num_Code < 15 ? num_Code : 15);
+            if (num_Code >= 15) {
+                p_Out = WriteLengthTail(p_Out, num_Code - 15);
+            }
+        }
+        return p_Out;
+    }
+
+    // Reads a length's continuation bytes; false when the input runs out
+    inline bool ReadLengthTail(const uint8_t*& p_In, const uint8_t* p_End, size_t& num_Length) {
+        uint8_t u8_Byte;
+        do {
+            if (p_In >= p_End) return false;
+            u8_Byte = *p_In++;
+            num_Length += u8_Byte;
+        } while (u8_Byte == 255);
+        return true;
+    }
+}
+
+size_t Lz4Compress(const uint8_t* p_Source, size_t num_SourceBytes, uint8_t* p_Destination, size_t num_Capacity) {
+    uint8_t* p_Out = p_Destination;
+    uint8_t* p_OutEnd = p_Destination + num_Capacity;
+    size_t i_Anchor = 0;
+
+    if (num_SourceBytes > k_MatchStartLimit) {
+        // Positions + 1, so zero means empty
+        uint32_t arr_Table[1u << k_HashBits] = {};
+        const size_t i_MatchStartEnd = num_SourceBytes - k_MatchStartLimit;
+        const size_t i_MatchEnd = num_SourceBytes - k_LastLiterals;
+
+        size_t i_Pos = 0;
+        while (i_Pos < i_MatchStartEnd) {
+            uint32_t u32_Sequence = Read32(p_Source + i_Pos);
+            uint32_t& u32_Slot = arr_Table[Hash(u32_Sequence)];
+            size_t i_Candidate = u32_Slot;
+            u32_Slot = static_cast<uint32_t>(i_Pos + 1);
+
+            if (i_Candidate == 0 || i_Pos - (i_Candidate - 1) > k_MaxOffset ||
+                Read32(p_Source + i_Candidate - 1) != u32_Sequence) {
+                ++i_Pos;
+                continue;
+            }
+            --i_Candidate;
+
+            size_t num_Length = k_MinMatch;
+            while (i_Pos + num_Length < i_MatchEnd && p_Source[i_Candidate + num_Length] == p_Source[i_Pos + num_Length]) {
+                ++num_Length;
+            }
+
+            p_Out = WriteSequence(p_Out, p_OutEnd, p_Source + i_Anchor, i_Pos - i_Anchor, i_Pos - i_Candidate,
+                                  num_Length);
+            if (!p_Out) {
+                return 0;
+            }
+            i_Pos += num_Length;
+            i_Anchor = i_Pos;
+        }
+    }
+
+    p_Out = WriteSequence(p_Out, p_OutEnd, p_Source + i_Anchor, num_SourceBytes - i_Anchor, 0, 0);
+    return p_Out ? static_cast<size_t>(p_Out - p_Destination) : 0;
+}
+
+bool Lz4Decompress(const uint8_t* p_Source, size_t num_SourceBytes, uint8_t* p_Destination,
+                   size_t num_DestinationBytes) {
+    const uint8_t* p_In = p_Source;
+    const uint8_t* p_InEnd = p_Source + num_SourceBytes;
+    uint8_t* p_Out = p_Destination;
+    uint8_t* p_OutEnd = p_Destination + num_DestinationBytes;
+
+    while (p_In < p_InEnd) {
+        uint8_t u8_Token = *p_In++;
+
+        size_t num_Literals = u8_Token >> 4;
+        if (num_Literals == 15 && !ReadLengthTail(p_In, p_InEnd, num_Literals)) return false;
+        if (num_Literals > static_cast<size_t>(p_InEnd - p_In) ||
+            num_Literals > static_cast<size_t>(p_OutEnd - p_Out)) {
+            return false;
+        }
+        if (num_Literals > 0) {
+            std::memcpy(p_Out, p_In, num_Literals);
+            p_In += num_Literals;
+            p_Out += num_Literals;
+        }
+
+        // The last sequence is literals only
+        if (p_In == p_InEnd) break;
+
+        if (p_InEnd - p_In < 2) return false;
+        size_t num_Offset = p_In[0] | (static_cast<size_t>(p_In[1]) << 8);
+        p_In += 2;
+        if (num_Offset == 0 || num_Offset > static_cast<size_t>(p_Out - p_Destination)) return false;
+
+        size_t num_Length = u8_Token & 15;
+        if (num_Length == 15 && !ReadLengthTail(p_In, p_InEnd, num_Length)) return false;
+        num_Length += k_MinMatch;
+        if (num_Length > static_cast<size_t>(p_OutEnd - p_Out)) return false;
+
+        // Byte by byte: a match may overlap the bytes it is producing
+        const uint8_t* p_Match = p_Out - num_Offset;
+        for (size_t i = 0; i < num_Length; ++i) {
+            p_Out[i] = p_Match[i];
+        }
+        p_Out += num_Length;
+    }
+    return p_Out == p_OutEnd;
+}
+
+} // namespace Utils
+} // namespace ScotlandYard
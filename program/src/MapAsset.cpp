@@ -0,0 +1,73 @@
+#include "MapAsset.h"
+#include "BinaryMap.h"
+#include "GameConstants.h"
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include <filesystem>
+#include <iostream>
+
+namespace ScotlandYard {
+namespace Core {
+
+std::mutex MapAsset::s_mtx_Cache;
+std::shared_ptr<const MapAsset> MapAsset::s_sp_Cached;
+
+MapAsset::MapAsset()
+    : m_b_FromBinary(false)
+{
+}
+
+std::shared_ptr<const MapAsset> MapAsset::Acquire() {
+    std::lock_guard<std::mutex> lock(s_mtx_Cache);
+    if (!s_sp_Cached) {
+        // Constructor is private, so no make_shared
+        std::shared_ptr<MapAsset> sp_Asset(new MapAsset());
+        sp_Asset->Load();
+        s_sp_Cached = std::move(sp_Asset);
+    }
+    return s_sp_Cached;
+}
+
+void MapAsset::Preload() {
+    if (Threading::ThreadPool::GetThreadCount() == 0) return;
+    Threading::ThreadPool::Submit([]() { Acquire(); });
+}
+
+void MapAsset::ReleaseCache() {
+    std::lock_guard<std::mutex> lock(s_mtx_Cache);
+    s_sp_Cached.reset();
+}
+
+void MapAsset::Load() {
+    TRACE_SCOPE("MapAsset::Load");
+
+    // A map compiled by mapc wins over the CSVs; a missing or corrupt file falls back to them.
+    // One compiled from CSVs that have changed since is rebuilt first, so edits are not shadowed.
+    Utils::BinaryMap binaryMap;
+    const std::string s_BinaryMapPath = GetMapPath(k_BinaryMapRelativePath);
+    const std::string s_NodesPath = GetMapPath(k_NodeDataRelativePath);
+    const std::string s_ConnectionsPath = GetMapPath(k_ConnectionsRelativePath);
+    if (std::filesystem::exists(s_BinaryMapPath) && binaryMap.Open(s_BinaryMapPath) &&
+        !binaryMap.IsUpToDate(s_NodesPath, s_ConnectionsPath)) {
+        std::cout << "[MapAsset] " << s_BinaryMapPath << " is older than the map CSVs, recompiling" << std::endl;
+        binaryMap.Close();
+        if (Utils::BinaryMap::Compile(s_NodesPath, s_ConnectionsPath, s_BinaryMapPath)) {
+            binaryMap.Open(s_BinaryMapPath);
+        }
+    }
+    m_b_FromBinary = binaryMap.IsOpen();
+
+    if (m_b_FromBinary) {
+        std::cout << "[MapAsset] Using compiled map " << s_BinaryMapPath << std::endl;
+        m_vec_Stations = Utils::MapDataLoader::LoadStations(binaryMap);
+        m_Graph.LoadFromBinary(binaryMap);
+    } else {
+        m_vec_Stations = Utils::MapDataLoader::LoadStations(s_NodesPath);
+        m_Graph.LoadData(s_NodesPath, s_ConnectionsPath, false);
+    }
+
+    m_RulesGraph.Build(m_Graph);
+}
+
+} // namespace Core
+} // namespace ScotlandYard
@@ -1,77 +1,94 @@
 #include "MapDataLoader.h"
-#include <fstream>
-#include <sstream>
+#include "BinaryMap.h"
+#include "GameConstants.h"
+#include "CsvReader.h"
+#include "TraceRecorder.h"
 #include <iostream>
+#include <utility>
 
 namespace ScotlandYard {
 namespace Utils {
 
 std::vector<StationData> MapDataLoader::LoadStations(const std::string& s_FilePath) {
+    TRACE_SCOPE("MapDataLoader::LoadStations");
     std::vector<StationData> vec_Stations;
-    std::ifstream file(s_FilePath);
+    CsvReader reader;
 
-    if (!file.is_open()) {
+    if (!reader.Open(s_FilePath)) {
         std::cerr << "[MapDataLoader] ERROR: Could not open file: " << s_FilePath << std::endl;
         return vec_Stations;
     }
 
-    std::string s_Line;
-    bool b_FirstLine = true;
-
-    while (std::getline(file, s_Line)) {
-        if (s_Line.empty()) continue;
+    vec_Stations.reserve(reader.EstimateRowCount());
 
+    // id,pos_x,pos_y,station_type
+    bool b_FirstLine = true;
+    while (reader.NextRow()) {
         if (b_FirstLine) {
             b_FirstLine = false;
             continue;
         }
 
         StationData station;
-        if (ParseStationLine(s_Line, station)) {
-            vec_Stations.push_back(station);
+        float f_X = 0.0f;
+        float f_Y = 0.0f;
+        if (reader.GetFieldCount() < 4 ||
+            !CsvReader::ParseInt(reader.GetField(0), station.i_StationID) ||
+            !CsvReader::ParseFloat(reader.GetField(1), f_X) ||
+            !CsvReader::ParseFloat(reader.GetField(2), f_Y)) {
+            std::cerr << "[MapDataLoader] WARNING: Invalid line format: " << reader.GetRow() << std::endl;
+            continue;
         }
+
+        station.vec2_Position = glm::vec2(f_X, f_Y);
+        SplitTransportTypes(reader.GetField(3), station.vec_TransportTypes);
+        vec_Stations.push_back(std::move(station));
     }
 
-    file.close();
     std::cout << "[MapDataLoader] Loaded " << vec_Stations.size() << " stations from " << s_FilePath << std::endl;
     return vec_Stations;
 }
 
-bool MapDataLoader::ParseStationLine(const std::string& s_Line, StationData& out_Station) {
-    std::stringstream ss(s_Line);
-    std::string s_IdStr, s_XStr, s_YStr, s_TypeStr;
+std::vector<StationData> MapDataLoader::LoadStations(const BinaryMap& map) {
+    TRACE_SCOPE("MapDataLoader::LoadStations");
+    static const std::pair<int, const char*> k_TransportNames[] = {
+        {Core::k_TransportTypeTaxi, "taxi"},
+        {Core::k_TransportTypeBus, "bus"},
+        {Core::k_TransportTypeMetro, "metro"},
+        {Core::k_TransportTypeWater, "water"},
+    };
 
-    if (!std::getline(ss, s_IdStr, ',')) return false;
-    if (!std::getline(ss, s_XStr, ',')) return false;
-    if (!std::getline(ss, s_YStr, ',')) return false;
-    if (!std::getline(ss, s_TypeStr, ',')) return false;
+    std::vector<StationData> vec_Stations;
+    vec_Stations.reserve(map.GetNodeCount());
 
-    try {
-        out_Station.i_StationID = std::stoi(s_IdStr);
-        float f_X = std::stof(s_XStr);
-        float f_Y = std::stof(s_YStr);
-        out_Station.vec2_Position = glm::vec2(f_X, f_Y);
-        out_Station.vec_TransportTypes = SplitTransportTypes(s_TypeStr);
-        return true;
-    }
-    catch (const std::exception& e) {
-        std::cerr << "[MapDataLoader] WARNING: Invalid line format: " << s_Line << std::endl;
-        return false;
+    const BinaryMapNode* p_Nodes = map.GetNodes();
+    for (uint32_t i = 0; i < map.GetNodeCount(); ++i) {
+        StationData station;
+        station.i_StationID = p_Nodes[i].i32_Id;
+        station.vec2_Position = glm::vec2(p_Nodes[i].f_X, p_Nodes[i].f_Y);
+        for (const auto& transport : k_TransportNames) {
+            if (p_Nodes[i].u32_StationMask & BinaryMap::StationBit(transport.first)) {
+                station.vec_TransportTypes.emplace_back(transport.second);
+            }
+        }
+        vec_Stations.push_back(std::move(station));
     }
+
+    return vec_Stations;
 }
 
-std::vector<std::string> MapDataLoader::SplitTransportTypes(const std::string& s_TypeString) {
-    std::vector<std::string> vec_Types;
-    std::stringstream ss(s_TypeString);
-    std::string s_Transport;
+void MapDataLoader::SplitTransportTypes(std::string_view sv_TypeString, std::vector<std::string>& out_Types) {
+    sv_TypeString = CsvReader::Trim(sv_TypeString);
 
-    while (std::getline(ss, s_Transport, '_')) {
-        if (!s_Transport.empty()) {
-            vec_Types.push_back(s_Transport);
+    while (!sv_TypeString.empty()) {
+        size_t pos = sv_TypeString.find('_');
+        std::string_view sv_Transport = sv_TypeString.substr(0, pos);
+        if (!sv_Transport.empty()) {
+            out_Types.emplace_back(sv_Transport);
         }
+        if (pos == std::string_view::npos) break;
+        sv_TypeString.remove_prefix(pos + 1);
     }
-
-    return vec_Types;
 }
 
 } // namespace Utils
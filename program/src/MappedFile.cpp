@@ -0,0 +1,179 @@
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace ScotlandYard {
+namespace Utils {
+
+MappedFile::MappedFile()
+    : m_p_Data(nullptr)
+    , m_num_Size(0)
+    , m_b_Open(false)
+#ifdef _WIN32
+    , m_p_FileHandle(nullptr)
+    , m_p_MappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : MappedFile()
+{
+    MoveFrom(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        MoveFrom(other);
+    }
+    return *this;
+}
+
+void MappedFile::MoveFrom(MappedFile& other) {
+    m_p_Data = other.m_p_Data;
+    m_num_Size = other.m_num_Size;
+    m_b_Open = other.m_b_Open;
+#ifdef _WIN32
+    m_p_FileHandle = other.m_p_FileHandle;
+    m_p_MappingHandle = other.m_p_MappingHandle;
+    other.m_p_FileHandle = nullptr;
+    other.m_p_MappingHandle = nullptr;
+#endif
+    other.m_p_Data = nullptr;
+    other.m_num_Size = 0;
+    other.m_b_Open = false;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& s_Path, Access e_Access) {
+    Close();
+
+    DWORD u32_Flags = e_Access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    // FILE_SHARE_DELETE so a writer can still rename a new version over the file while it is mapped
+    HANDLE h_File = CreateFileA(s_Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, u32_Flags, nullptr);
+    if (h_File == INVALID_HANDLE_VALUE) {
+        std::cerr << "[MappedFile] ERROR: Could not open file: " << s_Path << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(h_File, &size)) {
+        std::cerr << "[MappedFile] ERROR: Could not stat file: " << s_Path << std::endl;
+        CloseHandle(h_File);
+        return false;
+    }
+
+    m_p_FileHandle = h_File;
+    m_num_Size = static_cast<size_t>(size.QuadPart);
+    m_b_Open = true;
+
+    // CreateFileMapping rejects zero-length files
+    if (m_num_Size == 0) {
+        return true;
+    }
+
+    HANDLE h_Mapping = CreateFileMappingA(h_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!h_Mapping) {
+        std::cerr << "[MappedFile] ERROR: Could not map file: " << s_Path << std::endl;
+        Close();
+        return false;
+    }
+    m_p_MappingHandle = h_Mapping;
+
+    m_p_Data = static_cast<const char*>(MapViewOfFile(h_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_p_Data) {
+        std::cerr << "[MappedFile] ERROR: Could not map file: " << s_Path << std::endl;
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_p_Data) {
+        UnmapViewOfFile(m_p_Data);
+    }
+    if (m_p_MappingHandle) {
+        CloseHandle(static_cast<HANDLE>(m_p_MappingHandle));
+    }
+    if (m_p_FileHandle) {
+        CloseHandle(static_cast<HANDLE>(m_p_FileHandle));
+    }
+
+    m_p_Data = nullptr;
+    m_p_MappingHandle = nullptr;
+    m_p_FileHandle = nullptr;
+    m_num_Size = 0;
+    m_b_Open = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& s_Path, Access e_Access) {
+    Close();
+
+    int i_Fd = ::open(s_Path.c_str(), O_RDONLY);
+    if (i_Fd < 0) {
+        std::cerr << "[MappedFile] ERROR: Could not open file: " << s_Path << std::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if (::fstat(i_Fd, &fileStat) != 0) {
+        std::cerr << "[MappedFile] ERROR: Could not stat file: " << s_Path << std::endl;
+        ::close(i_Fd);
+        return false;
+    }
+
+    m_num_Size = static_cast<size_t>(fileStat.st_size);
+
+    if (m_num_Size > 0) {
+        void* p_Map = ::mmap(nullptr, m_num_Size, PROT_READ, MAP_PRIVATE, i_Fd, 0);
+        if (p_Map == MAP_FAILED) {
+            std::cerr << "[MappedFile] ERROR: Could not map file: " << s_Path << std::endl;
+            ::close(i_Fd);
+            m_num_Size = 0;
+            return false;
+        }
+
+        // Parsers walk the file front to back exactly once; resident files are read in up front
+        ::madvise(p_Map, m_num_Size, e_Access == Access::Sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+        m_p_Data = static_cast<const char*>(p_Map);
+    }
+
+    // The mapping keeps its own reference to the file
+    ::close(i_Fd);
+    m_b_Open = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_p_Data) {
+        ::munmap(const_cast<char*>(m_p_Data), m_num_Size);
+    }
+
+    m_p_Data = nullptr;
+    m_num_Size = 0;
+    m_b_Open = false;
+}
+
+#endif
+
+} // namespace Utils
+} // namespace ScotlandYard
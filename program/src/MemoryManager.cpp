@@ -2,6 +2,7 @@
 #include <iostream>
 #include <unordered_map>
 #include <mutex>
+#include <new>
 
 namespace ScotlandYard {
 namespace Memory {
@@ -71,6 +72,31 @@ void MemoryManager::Free(void* ptr, MemoryTag tag) {
     }
 }
 
+void* MemoryManager::AllocateAligned(size_t size, size_t alignment, MemoryTag tag) {
+    void* ptr = ::operator new(size, std::align_val_t(alignment));
+
+    {
+        std::lock_guard<std::mutex> lock(s_mtx_Memory);
+        auto& stats = s_map_MemoryStats[tag];
+        stats.totalAllocated += size;
+        stats.allocationCount++;
+    }
+
+    return ptr;
+}
+
+void MemoryManager::FreeAligned(void* ptr, size_t alignment, MemoryTag tag) {
+    if (!ptr) return;
+
+    ::operator delete(ptr, std::align_val_t(alignment));
+
+    {
+        std::lock_guard<std::mutex> lock(s_mtx_Memory);
+        auto& stats = s_map_MemoryStats[tag];
+        stats.allocationCount--;
+    }
+}
+
 size_t MemoryManager::GetAllocatedMemory(MemoryTag tag) {
     std::lock_guard<std::mutex> lock(s_mtx_Memory);
     return s_map_MemoryStats[tag].totalAllocated;
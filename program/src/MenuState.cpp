@@ -70,48 +70,22 @@ void MenuState::Update(float f_DeltaTime) {
 }
 
 void MenuState::RenderText(const std::string& s_Text, float f_X, float f_Y, float f_Scale, float f_R, float f_G, float f_B, Core::Application* p_App) {
-    const auto& characters = p_App->GetCharacterMap();
-    GLuint shaderProgram = p_App->GetTextShaderProgram();
-    GLuint vao = p_App->GetTextVAO();
-    GLuint vbo = p_App->GetTextVBO();
-
-    glUseProgram(shaderProgram);
-    glUniform3f(glGetUniformLocation(shaderProgram, "textColor"), f_R, f_G, f_B);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(vao);
-
     for (auto c : s_Text) {
-        auto it = characters.find(c);
-        if (it == characters.end()) continue;
-
-        const Core::Character& ch = it->second;
+        const Core::Character* p_Ch = p_App->GetCharacter(c);
+        if (!p_Ch) continue;
 
-        float f_Xpos = f_X + ch.m_i_BearingX * f_Scale;
-        float f_Ypos = f_Y + (ch.m_i_Height - ch.m_i_BearingY) * f_Scale; 
+        float f_Xpos = f_X + p_Ch->m_i_BearingX * f_Scale;
+        float f_Ypos = f_Y + (p_Ch->m_i_Height - p_Ch->m_i_BearingY) * f_Scale; 
 
-        float f_W = ch.m_i_Width * f_Scale;
-        float f_H = ch.m_i_Height * f_Scale;
+        float f_W = p_Ch->m_i_Width * f_Scale;
+        float f_H = p_Ch->m_i_Height * f_Scale;
 
-        float vertices[6][4] = {
-            { f_Xpos,     f_Ypos - f_H,   0.0f, 1.0f },
-            { f_Xpos,     f_Ypos,         0.0f, 0.0f },
-            { f_Xpos + f_W, f_Ypos,         1.0f, 0.0f },
+        m_TextBatch.AddQuad(f_Xpos, f_Ypos - f_H, f_Xpos + f_W, f_Ypos,
+                            p_Ch->m_f_U0, p_Ch->m_f_V1, p_Ch->m_f_U1, p_Ch->m_f_V0,
+                            f_R, f_G, f_B, 1.0f);
 
-            { f_Xpos,     f_Ypos - f_H,   0.0f, 1.0f },
-            { f_Xpos + f_W, f_Ypos,         1.0f, 0.0f },
-            { f_Xpos + f_W, f_Ypos - f_H,   1.0f, 1.0f }
-        };
-
-        glBindTexture(GL_TEXTURE_2D, ch.m_TextureID);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        f_X += (ch.m_i_Advance >> 6) * f_Scale;
+        f_X += (p_Ch->m_i_Advance >> 6) * f_Scale;
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void MenuState::RenderTextBold(const std::string& s_Text, float f_X, float f_Y, float f_Scale, float f_R, float f_G, float f_B, Core::Application* p_App) {
@@ -126,9 +100,6 @@ void MenuState::RenderTextBold(const std::string& s_Text, float f_X, float f_Y,
 
 void MenuState::RenderButton(const Button& button, int i_Index, bool b_Selected, int i_WindowWidth, int i_WindowHeight, Core::Application* p_App) {
     GLuint shaderProgram = p_App->GetTextShaderProgram();
-    GLuint vao = p_App->GetTextVAO();
-    GLuint vbo = p_App->GetTextVBO();
-    const auto& characters = p_App->GetCharacterMap();
 
     glDisable(GL_DEPTH_TEST);
     glDisable(GL_CULL_FACE);
@@ -186,9 +157,9 @@ void MenuState::RenderButton(const Button& button, int i_Index, bool b_Selected,
     float maxTopOffset = -1e6f;  
     float minBottomOffset = 1e6f;
     for (auto c : button.m_s_Text) {
-        auto it = characters.find(c);
-        if (it != characters.end()) {
-            const auto& ch = it->second;
+        const Core::Character* p_Ch = p_App->GetCharacter(c);
+        if (p_Ch) {
+            const auto& ch = *p_Ch;
             f_TextWidth += (ch.m_i_Advance >> 6) * f_TextScale;
             float topOff = (ch.m_i_Height - ch.m_i_BearingY) * f_TextScale;
             float botOff = -ch.m_i_BearingY * f_TextScale;
@@ -209,7 +180,6 @@ void MenuState::RenderButton(const Button& button, int i_Index, bool b_Selected,
 void MenuState::Render(Core::Application* p_App) {
     int i_WindowWidth = p_App->GetWidth();
     int i_WindowHeight = p_App->GetHeight();
-    const auto& characters = p_App->GetCharacterMap();
 
     glClearColor(0.16f, 0.18f, 0.2f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -217,11 +187,7 @@ void MenuState::Render(Core::Application* p_App) {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(i_WindowWidth), 0.0f, static_cast<float>(i_WindowHeight));
-
-    GLuint shaderProgram = p_App->GetTextShaderProgram();
-    glUseProgram(shaderProgram);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    m_TextBatch.Clear();
 
     float f_TitleScale = 2.0f; 
     const float f_SpecialScaleMul = 1.35f; // multiplier for the larger letters
@@ -239,9 +205,9 @@ void MenuState::Render(Core::Application* p_App) {
         bool b_IsEdge = (idx == 0) || (static_cast<int>(idx) == i_LastIndex);
         float f_ThisScale = b_IsEdge ? (f_TitleScale * f_SpecialScaleMul) : f_TitleScale;
         charScales.push_back(f_ThisScale);
-        auto it = characters.find(c);
-        if (it != characters.end()) {
-            f_TitleWidth += (it->second.m_i_Advance >> 6) * f_ThisScale;
+        const Core::Character* p_Ch = p_App->GetCharacter(c);
+        if (p_Ch) {
+            f_TitleWidth += (p_Ch->m_i_Advance >> 6) * f_ThisScale;
         }
     }
     float f_TitleX = (i_WindowWidth - f_TitleWidth) / 2.0f;
@@ -252,9 +218,9 @@ void MenuState::Render(Core::Application* p_App) {
         float f_ThisScale = charScales[i];
         std::string s(1, c);
         RenderTextBold(s, f_CursorX, f_TitleY, f_ThisScale, 1.0f, 0.84f, 0.0f, p_App);
-        auto it = characters.find(c);
-        if (it != characters.end()) {
-            f_CursorX += (it->second.m_i_Advance >> 6) * f_ThisScale;
+        const Core::Character* p_Ch = p_App->GetCharacter(c);
+        if (p_Ch) {
+            f_CursorX += (p_Ch->m_i_Advance >> 6) * f_ThisScale;
         } else {
             f_CursorX += 8.0f * f_ThisScale;
         }
@@ -270,6 +236,9 @@ void MenuState::Render(Core::Application* p_App) {
     RenderButton(m_Buttons[i], i, i == m_i_SelectedOption, i_WindowWidth, i_WindowHeight, p_App);
     }
 
+    // Title and button labels are queued above and drawn in a single call, over the button rects
+    m_TextBatch.Flush(i_WindowWidth, i_WindowHeight, p_App);
+
     SDL_GL_SwapWindow(SDL_GL_GetCurrentWindow());
 }
 
@@ -0,0 +1,373 @@
+#include "MlpModel.h"
+#include "BinaryMap.h"
+#include "MemoryManager.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace ScotlandYard {
+namespace AI {
+
+namespace {
+    constexpr char k_Magic[4] = {'S', 'Y', 'N', 'N'};
+
+    uint64_t AlignUp(uint64_t u64_Value) {
+        return (u64_Value + MlpModel::k_TensorAlignment - 1) & ~static_cast<uint64_t>(MlpModel::k_TensorAlignment - 1);
+    }
+
+    // Same FNV-1a as the binary map
+    uint64_t Checksum(const void* p_Data, size_t num_Bytes) {
+        return Utils::BinaryMap::Checksum(p_Data, num_Bytes);
+    }
+
+    // "<path>.<pid>.<n>.tmp": next to the target so the rename stays on one
+    // filesystem, and unique so concurrent writers never share a temp file
+    std::string MakeTempPath(const std::string& s_Path) {
+        static std::atomic<uint64_t> s_u64_Counter{0};
+#ifdef _WIN32
+        const long long i64_ProcessId = _getpid();
+#else
+        const long long i64_ProcessId = getpid();
+#endif
+        return s_Path + "." + std::to_string(i64_ProcessId) + "." +
+               std::to_string(s_u64_Counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    }
+}
+
+MlpWorkspace::MlpWorkspace()
+    : m_arr_p_Buffers{ nullptr, nullptr }
+    , m_num_Capacity(0)
+    , m_p_Quantized(nullptr)
+    , m_num_QuantizedCapacity(0)
+{
+}
+
+MlpWorkspace::~MlpWorkspace() {
+    for (float* p_Buffer : m_arr_p_Buffers) {
+        Memory::MemoryManager::FreeAligned(p_Buffer, MlpModel::k_TensorAlignment, Memory::MemoryTag::AI);
+    }
+    Memory::MemoryManager::FreeAligned(m_p_Quantized, MlpModel::k_TensorAlignment, Memory::MemoryTag::AI);
+}
+
+void MlpWorkspace::Reserve(size_t num_Floats) {
+    if (num_Floats <= m_num_Capacity) return;
+
+    for (float*& p_Buffer : m_arr_p_Buffers) {
+        Memory::MemoryManager::FreeAligned(p_Buffer, MlpModel::k_TensorAlignment, Memory::MemoryTag::AI);
+        p_Buffer = static_cast<float*>(Memory::MemoryManager::AllocateAligned(
+            num_Floats * sizeof(float), MlpModel::k_TensorAlignment, Memory::MemoryTag::AI));
+    }
+    m_num_Capacity = num_Floats;
+}
+
+void MlpWorkspace::ReserveQuantized(size_t num_Bytes) {
+    if (num_Bytes <= m_num_QuantizedCapacity) return;
+
+    Memory::MemoryManager::FreeAligned(m_p_Quantized, MlpModel::k_TensorAlignment, Memory::MemoryTag::AI);
+    m_p_Quantized = static_cast<uint8_t*>(Memory::MemoryManager::AllocateAligned(
+        num_Bytes, MlpModel::k_TensorAlignment, Memory::MemoryTag::AI));
+    m_num_QuantizedCapacity = num_Bytes;
+}
+
+MlpModel::MlpModel()
+    : m_p_Data(nullptr)
+    , m_u32_InputSize(0)
+    , m_u32_PolicySize(0)
+    , m_u32_ValueSize(0)
+    , m_num_MaxStride(0)
+    , m_num_MaxQuantizedInputs(0)
+    , m_e_Kernel(GemmKernel::Scalar)
+    , m_e_Int8Kernel(Int8Kernel::Scalar)
+{
+}
+
+MlpModel::~MlpModel() {
+    Release();
+}
+
+void MlpModel::Release() {
+    m_vec_Layers.clear();
+    m_File.Close();
+    m_p_Data = nullptr;
+}
+
+bool MlpModel::Load(const std::string& s_Path) {
+    Release();
+
+    // Mapped whole and validated once; the pages stay shared with every
+    // other process that maps the same file
+    if (!m_File.Open(s_Path, Utils::MappedFile::Access::Resident)) {
+        return false;
+    }
+    m_p_Data = m_File.GetData();
+
+    if (!Validate(s_Path, m_File.GetSize())) {
+        Release();
+        return false;
+    }
+
+    m_e_Kernel = GetBestGemmKernel();
+    m_e_Int8Kernel = GetBestInt8Kernel();
+    return true;
+}
+
+bool MlpModel::Validate(const std::string& s_Path, size_t num_Size) {
+    auto fail = [&](const char* p_Reason) {
+        std::cerr << "[MlpModel] ERROR: " << s_Path << ": " << p_Reason << std::endl;
+        return false;
+    };
+
+    if (num_Size < sizeof(ModelFileHeader)) return fail("file too small");
+    // Tensor offsets are aligned relative to the start of the file
+    if (reinterpret_cast<uintptr_t>(m_p_Data) % k_TensorAlignment != 0) return fail("mapping is not aligned");
+
+    const ModelFileHeader* p_Header = reinterpret_cast<const ModelFileHeader*>(m_p_Data);
+    if (std::memcmp(p_Header->arr_Magic, k_Magic, sizeof(k_Magic)) != 0) return fail("not a model file");
+    if (p_Header->u32_Version != k_Version) return fail("unsupported version");
+    if (p_Header->u64_HeaderChecksum != Checksum(p_Header, offsetof(ModelFileHeader, u64_HeaderChecksum))) {
+        return fail("header checksum mismatch");
+    }
+    if (p_Header->u64_FileSize != num_Size) return fail("truncated file");
+    if (p_Header->u32_LayerCount == 0 || p_Header->u32_InputSize == 0 || p_Header->u32_ValueSize > 1) {
+        return fail("bad network shape");
+    }
+
+    const uint64_t u64_Size = num_Size;
+    const uint64_t u64_TableOffset = p_Header->u64_LayerTableOffset;
+    if (u64_TableOffset < sizeof(ModelFileHeader) || u64_TableOffset % alignof(ModelLayerHeader) != 0 ||
+        u64_TableOffset > u64_Size ||
+        static_cast<uint64_t>(p_Header->u32_LayerCount) * sizeof(ModelLayerHeader) > u64_Size - u64_TableOffset) {
+        return fail("layer table out of bounds");
+    }
+
+    const size_t num_PayloadBytes = num_Size - sizeof(ModelFileHeader);
+    if (p_Header->u64_PayloadChecksum != Checksum(m_p_Data + sizeof(ModelFileHeader), num_PayloadBytes)) {
+        return fail("payload checksum mismatch");
+    }
+
+    auto tensorFits = [&](uint64_t u64_Offset, uint64_t u64_Bytes) {
+        return u64_Offset % k_TensorAlignment == 0
+            && u64_Offset >= sizeof(ModelFileHeader)
+            && u64_Offset <= u64_Size
+            && u64_Bytes <= u64_Size - u64_Offset;
+    };
+
+    const ModelLayerHeader* p_Table = reinterpret_cast<const ModelLayerHeader*>(m_p_Data + u64_TableOffset);
+    std::vector<Layer> vec_Layers;
+    vec_Layers.reserve(p_Header->u32_LayerCount);
+    uint32_t u32_Inputs = p_Header->u32_InputSize;
+    size_t num_MaxStride = 0;
+    size_t num_MaxQuantizedInputs = 0;
+    for (uint32_t i = 0; i < p_Header->u32_LayerCount; ++i) {
+        const ModelLayerHeader& entry = p_Table[i];
+        if (entry.u32_Inputs != u32_Inputs || entry.u32_Outputs == 0 ||
+            entry.u32_Stride != PadColumns(entry.u32_Outputs) ||
+            entry.u32_Activation > static_cast<uint32_t>(Activation::Tanh) ||
+            entry.u32_Precision > static_cast<uint32_t>(LayerPrecision::Int8)) {
+            return fail("bad layer shape");
+        }
+
+        Layer layer{};
+        layer.u32_Inputs = entry.u32_Inputs;
+        layer.u32_Outputs = entry.u32_Outputs;
+        layer.u32_Stride = entry.u32_Stride;
+        layer.e_Activation = static_cast<Activation>(entry.u32_Activation);
+        layer.e_Precision = static_cast<LayerPrecision>(entry.u32_Precision);
+        const uint64_t u64_StrideBytes = static_cast<uint64_t>(entry.u32_Stride) * sizeof(float);
+        if (!tensorFits(entry.u64_BiasOffset, u64_StrideBytes)) return fail("tensor out of bounds");
+        layer.p_Bias = reinterpret_cast<const float*>(m_p_Data + entry.u64_BiasOffset);
+
+        if (layer.e_Precision == LayerPrecision::Float32) {
+            if (!tensorFits(entry.u64_WeightsOffset, static_cast<uint64_t>(entry.u32_Inputs) * u64_StrideBytes)) {
+                return fail("tensor out of bounds");
+            }
+            layer.p_Weights = reinterpret_cast<const float*>(m_p_Data + entry.u64_WeightsOffset);
+        } else {
+            layer.u32_QuantizedInputs = static_cast<uint32_t>(PadInt8Inner(entry.u32_Inputs));
+            if (layer.u32_QuantizedInputs > k_Int8MaxInner || !(entry.f_InputScale > 0.0f)) {
+                return fail("bad int8 layer");
+            }
+            if (!tensorFits(entry.u64_WeightsOffset, static_cast<uint64_t>(layer.u32_QuantizedInputs) * entry.u32_Stride) ||
+                !tensorFits(entry.u64_ScalesOffset, u64_StrideBytes) ||
+                !tensorFits(entry.u64_ColumnSumsOffset, static_cast<uint64_t>(entry.u32_Stride) * sizeof(int32_t))) {
+                return fail("tensor out of bounds");
+            }
+            layer.p_QuantizedWeights = reinterpret_cast<const int8_t*>(m_p_Data + entry.u64_WeightsOffset);
+            layer.p_Scales = reinterpret_cast<const float*>(m_p_Data + entry.u64_ScalesOffset);
+            layer.p_ColumnSums = reinterpret_cast<const int32_t*>(m_p_Data + entry.u64_ColumnSumsOffset);
+            layer.f_InputScale = entry.f_InputScale;
+            num_MaxQuantizedInputs = std::max<size_t>(num_MaxQuantizedInputs, layer.u32_QuantizedInputs);
+        }
+
+        vec_Layers.push_back(layer);
+        num_MaxStride = std::max<size_t>(num_MaxStride, entry.u32_Stride);
+        u32_Inputs = entry.u32_Outputs;
+    }
+    if (u32_Inputs != p_Header->u32_PolicySize + p_Header->u32_ValueSize) {
+        return fail("last layer does not match the policy and value sizes");
+    }
+
+    m_vec_Layers = std::move(vec_Layers);
+    m_u32_InputSize = p_Header->u32_InputSize;
+    m_u32_PolicySize = p_Header->u32_PolicySize;
+    m_u32_ValueSize = p_Header->u32_ValueSize;
+    m_num_MaxStride = num_MaxStride;
+    m_num_MaxQuantizedInputs = num_MaxQuantizedInputs;
+    return true;
+}
+
+const float* MlpModel::Forward(const float* p_Input, size_t num_InputStride, size_t num_Rows,
+                               MlpWorkspace& workspace) const {
+    workspace.Reserve(num_Rows * m_num_MaxStride);
+    workspace.ReserveQuantized(num_Rows * m_num_MaxQuantizedInputs);
+
+    const float* p_Current = p_Input;
+    size_t num_CurrentStride = num_InputStride;
+    int i_Target = 0;
+    for (const Layer& layer : m_vec_Layers) {
+        float* p_Output = workspace.GetBuffer(i_Target);
+        if (layer.e_Precision == LayerPrecision::Int8) {
+            uint8_t* p_Quantized = workspace.GetQuantizedBuffer();
+            QuantizeActivations(p_Current, num_CurrentStride, num_Rows, layer.u32_Inputs, 1.0f / layer.f_InputScale,
+                                p_Quantized, layer.u32_QuantizedInputs);
+            GemmInt8(m_e_Int8Kernel, p_Quantized, layer.u32_QuantizedInputs, layer.p_QuantizedWeights,
+                     layer.p_ColumnSums, layer.p_Scales, layer.p_Bias, p_Output, layer.u32_Stride, num_Rows,
+                     layer.u32_QuantizedInputs, layer.u32_Stride, layer.e_Activation);
+        } else {
+            Gemm(m_e_Kernel, p_Current, num_CurrentStride, layer.p_Weights, layer.u32_Stride, layer.p_Bias,
+                 p_Output, layer.u32_Stride, num_Rows, layer.u32_Inputs, layer.u32_Stride, layer.e_Activation);
+        }
+        p_Current = p_Output;
+        num_CurrentStride = layer.u32_Stride;
+        i_Target ^= 1;
+    }
+    return p_Current;
+}
+
+bool MlpModel::Write(const std::string& s_Path, uint32_t u32_InputSize, uint32_t u32_PolicySize,
+                     uint32_t u32_ValueSize, const std::vector<LayerData>& vec_Layers) {
+    ModelFileHeader header{};
+    std::memcpy(header.arr_Magic, k_Magic, sizeof(k_Magic));
+    header.u32_Version = k_Version;
+    header.u32_LayerCount = static_cast<uint32_t>(vec_Layers.size());
+    header.u32_InputSize = u32_InputSize;
+    header.u32_PolicySize = u32_PolicySize;
+    header.u32_ValueSize = u32_ValueSize;
+    header.u64_LayerTableOffset = sizeof(ModelFileHeader);
+
+    // Lay out the tensors after the layer table
+    std::vector<ModelLayerHeader> vec_Table(vec_Layers.size());
+    uint64_t u64_Offset = header.u64_LayerTableOffset + vec_Table.size() * sizeof(ModelLayerHeader);
+    for (size_t i = 0; i < vec_Layers.size(); ++i) {
+        const LayerData& layer = vec_Layers[i];
+        const size_t num_WeightCount = static_cast<size_t>(layer.u32_Inputs) * layer.u32_Outputs;
+        const bool b_Int8 = layer.e_Precision == LayerPrecision::Int8;
+        bool b_Matches = layer.vec_Bias.size() == layer.u32_Outputs;
+        if (b_Int8) {
+            b_Matches = b_Matches && layer.vec_QuantizedWeights.size() == num_WeightCount &&
+                        layer.vec_Scales.size() == layer.u32_Outputs && layer.f_InputScale > 0.0f &&
+                        PadInt8Inner(layer.u32_Inputs) <= k_Int8MaxInner;
+        } else {
+            b_Matches = b_Matches && layer.vec_Weights.size() == num_WeightCount;
+        }
+        if (!b_Matches) {
+            std::cerr << "[MlpModel] ERROR: Layer " << i << " tensors do not match its shape" << std::endl;
+            return false;
+        }
+
+        ModelLayerHeader& entry = vec_Table[i];
+        entry.u32_Inputs = layer.u32_Inputs;
+        entry.u32_Outputs = layer.u32_Outputs;
+        entry.u32_Stride = static_cast<uint32_t>(PadColumns(layer.u32_Outputs));
+        entry.u32_Activation = static_cast<uint32_t>(layer.e_Activation);
+        entry.u32_Precision = static_cast<uint32_t>(layer.e_Precision);
+        entry.f_InputScale = b_Int8 ? layer.f_InputScale : 0.0f;
+        const uint64_t u64_StrideBytes = static_cast<uint64_t>(entry.u32_Stride) * sizeof(float);
+        const uint64_t u64_WeightBytes = b_Int8 ? PadInt8Inner(entry.u32_Inputs) * static_cast<uint64_t>(entry.u32_Stride)
+                                                : entry.u32_Inputs * u64_StrideBytes;
+        entry.u64_WeightsOffset = AlignUp(u64_Offset);
+        entry.u64_BiasOffset = AlignUp(entry.u64_WeightsOffset + u64_WeightBytes);
+        u64_Offset = entry.u64_BiasOffset + u64_StrideBytes;
+        if (b_Int8) {
+            entry.u64_ScalesOffset = AlignUp(u64_Offset);
+            entry.u64_ColumnSumsOffset = AlignUp(entry.u64_ScalesOffset + u64_StrideBytes);
+            u64_Offset = entry.u64_ColumnSumsOffset + static_cast<uint64_t>(entry.u32_Stride) * sizeof(int32_t);
+        }
+    }
+    header.u64_FileSize = AlignUp(u64_Offset);
+
+    std::vector<char> vec_Payload(static_cast<size_t>(header.u64_FileSize - sizeof(ModelFileHeader)), 0);
+    auto at = [&](uint64_t u64_At) { return vec_Payload.data() + (u64_At - sizeof(ModelFileHeader)); };
+    std::memcpy(at(header.u64_LayerTableOffset), vec_Table.data(), vec_Table.size() * sizeof(ModelLayerHeader));
+    for (size_t i = 0; i < vec_Layers.size(); ++i) {
+        const LayerData& layer = vec_Layers[i];
+        const ModelLayerHeader& entry = vec_Table[i];
+        std::memcpy(at(entry.u64_BiasOffset), layer.vec_Bias.data(), layer.u32_Outputs * sizeof(float));
+        if (layer.e_Precision == LayerPrecision::Float32) {
+            for (uint32_t k = 0; k < layer.u32_Inputs; ++k) {
+                std::memcpy(at(entry.u64_WeightsOffset) + static_cast<size_t>(k) * entry.u32_Stride * sizeof(float),
+                            layer.vec_Weights.data() + static_cast<size_t>(k) * layer.u32_Outputs,
+                            layer.u32_Outputs * sizeof(float));
+            }
+            continue;
+        }
+
+        // Four consecutive inputs of one output share an int32 lane; see GemmInt8()
+        int8_t* p_Packed = reinterpret_cast<int8_t*>(at(entry.u64_WeightsOffset));
+        int32_t* p_ColumnSums = reinterpret_cast<int32_t*>(at(entry.u64_ColumnSumsOffset));
+        const size_t num_GroupStride = static_cast<size_t>(entry.u32_Stride) * k_Int8InnerGroup;
+        for (uint32_t k = 0; k < layer.u32_Inputs; ++k) {
+            for (uint32_t n = 0; n < layer.u32_Outputs; ++n) {
+                int8_t i8_Weight = layer.vec_QuantizedWeights[static_cast<size_t>(k) * layer.u32_Outputs + n];
+                p_Packed[(k / k_Int8InnerGroup) * num_GroupStride + n * k_Int8InnerGroup + k % k_Int8InnerGroup] = i8_Weight;
+                p_ColumnSums[n] += i8_Weight;
+            }
+        }
+        std::memcpy(at(entry.u64_ScalesOffset), layer.vec_Scales.data(), layer.u32_Outputs * sizeof(float));
+    }
+
+    header.u64_PayloadChecksum = Checksum(vec_Payload.data(), vec_Payload.size());
+    header.u64_HeaderChecksum = Checksum(&header, offsetof(ModelFileHeader, u64_HeaderChecksum));
+
+    // Written next to the target and renamed over it, so a process that has
+    // the old file mapped keeps reading intact weights
+    const std::string s_TempPath = MakeTempPath(s_Path);
+    {
+        std::ofstream file(s_TempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "[MlpModel] ERROR: Could not open " << s_TempPath << " for writing" << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(vec_Payload.data(), static_cast<std::streamsize>(vec_Payload.size()));
+        if (!file.good()) {
+            std::cerr << "[MlpModel] ERROR: Failed writing " << s_TempPath << std::endl;
+            // Unique names would otherwise pile up
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(s_TempPath, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(s_TempPath, s_Path, ec);
+    if (ec) {
+        std::cerr << "[MlpModel] ERROR: Could not replace " << s_Path << ": " << ec.message() << std::endl;
+        std::filesystem::remove(s_TempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace AI
+} // namespace ScotlandYard
@@ -1,20 +1,103 @@
 #include "NeuralNetworkManager.h"
+#include "MlpModel.h"
 #include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
 #include <iostream>
 
 namespace ScotlandYard {
 namespace AI {
 
 bool NeuralNetworkManager::s_b_Initialized = false;
-bool NeuralNetworkManager::s_b_ModelLoaded = false;
-size_t NeuralNetworkManager::s_num_Inferences = 0;
-float NeuralNetworkManager::s_f_AvgInferenceTime = 0.0f;
+std::atomic<bool> NeuralNetworkManager::s_b_ModelLoaded{false};
+NeuralNetworkManager::ActiveModel NeuralNetworkManager::s_Active;
+std::vector<std::shared_ptr<const MlpModel>> NeuralNetworkManager::s_vec_sp_RetiredModels;
+std::vector<NeuralNetworkManager::ModelCache*> NeuralNetworkManager::s_vec_p_ModelCaches;
+std::deque<std::shared_ptr<InferenceTelemetry>> NeuralNetworkManager::s_deque_sp_ModelTelemetry;
+std::atomic<uint64_t> NeuralNetworkManager::s_u64_ModelGeneration{0};
+std::mutex NeuralNetworkManager::s_mtx_Model;
+BatchingOptions NeuralNetworkManager::s_BatchingOptions;
+std::deque<NeuralNetworkManager::PendingRequest> NeuralNetworkManager::s_deque_Pending;
+std::mutex NeuralNetworkManager::s_mtx_Pending;
+std::condition_variable NeuralNetworkManager::s_cv_Pending;
+std::thread NeuralNetworkManager::s_t_Batcher;
+bool NeuralNetworkManager::s_b_Batching = false;
+
+namespace {
+    // Rows per forward pass; bounds the workspace at a few MB for wide layers
+    constexpr size_t k_MaxBatchRows = 256;
+    // Smallest slice of a queued batch worth handing to another pool thread
+    constexpr size_t k_MinRowsPerTask = 32;
+
+    thread_local MlpWorkspace t_Workspace;
+
+    using Clock = InferenceTelemetry::Clock;
+
+    // Softmax of each row's policy logits, sigmoid of its value logit
+    void WriteOutputs(const MlpModel& model, const float* p_Raw, size_t num_Rows, float* p_Policy, float* p_Values) {
+        const size_t num_Stride = model.GetOutputStride();
+        const size_t num_Policy = model.GetPolicySize();
+        for (size_t r = 0; r < num_Rows; ++r) {
+            const float* p_Logits = p_Raw + r * num_Stride;
+            float* p_Probabilities = p_Policy + r * num_Policy;
+
+            float f_Max = *std::max_element(p_Logits, p_Logits + num_Policy);
+            float f_Sum = 0.0f;
+            for (size_t i = 0; i < num_Policy; ++i) {
+                p_Probabilities[i] = std::exp(p_Logits[i] - f_Max);
+                f_Sum += p_Probabilities[i];
+            }
+            float f_Inverse = 1.0f / f_Sum;
+            for (size_t i = 0; i < num_Policy; ++i) {
+                p_Probabilities[i] *= f_Inverse;
+            }
+
+            if (p_Values) {
+                p_Values[r] = model.HasValue()
+                    ? 1.0f / (1.0f + std::exp(-p_Logits[num_Policy]))
+                    : *std::max_element(p_Probabilities, p_Probabilities + num_Policy);
+            }
+        }
+    }
+
+    bool CheckViews(const MlpModel& model, const NetworkInput& input, const NetworkOutput& output) {
+        if (input.view_Features.size() != model.GetInputSize()) {
+            std::cerr << "[NeuralNetwork] ERROR: Got " << input.view_Features.size() << " features, model takes "
+                      << model.GetInputSize() << std::endl;
+            return false;
+        }
+        if (output.view_ActionProbabilities.size() < model.GetPolicySize()) {
+            std::cerr << "[NeuralNetwork] ERROR: Output holds " << output.view_ActionProbabilities.size()
+                      << " probabilities, model has " << model.GetPolicySize() << " actions" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void EvaluateWith(const MlpModel& model, const float* p_Features, size_t num_Rows, float* p_Policy,
+                      float* p_Values) {
+        for (size_t r0 = 0; r0 < num_Rows; r0 += k_MaxBatchRows) {
+            size_t num_Block = std::min(k_MaxBatchRows, num_Rows - r0);
+            const float* p_Raw = model.Forward(p_Features + r0 * model.GetInputSize(), model.GetInputSize(),
+                                               num_Block, t_Workspace);
+            WriteOutputs(model, p_Raw, num_Block, p_Policy + r0 * model.GetPolicySize(),
+                         p_Values ? p_Values + r0 : nullptr);
+        }
+    }
+}
 
 void NeuralNetworkManager::Initialize() {
     if (s_b_Initialized) {
         return;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(s_mtx_Pending);
+        s_b_Batching = true;
+    }
+    s_t_Batcher = std::thread(&NeuralNetworkManager::BatcherThread);
     s_b_Initialized = true;
 }
 
@@ -23,6 +106,22 @@ void NeuralNetworkManager::Shutdown() {
         return;
     }
 
+    // The batcher drains the queue before it exits, so no future is left hanging
+    {
+        std::lock_guard<std::mutex> lock(s_mtx_Pending);
+        s_b_Batching = false;
+    }
+    s_cv_Pending.notify_all();
+    if (s_t_Batcher.joinable()) {
+        s_t_Batcher.join();
+    }
+
+    PublishModel(ActiveModel{});
+    {
+        std::lock_guard<std::mutex> lock(s_mtx_Model);
+        s_vec_sp_RetiredModels.clear();
+        s_deque_sp_ModelTelemetry.clear();
+    }
     s_b_ModelLoaded = false;
     s_b_Initialized = false;
 }
@@ -33,38 +132,369 @@ bool NeuralNetworkManager::LoadModel(const std::string& modelPath) {
         return false;
     }
 
+    TRACE_SCOPE("NeuralNetwork::LoadModel");
+    auto sp_Model = std::make_shared<MlpModel>();
+    if (!sp_Model->Load(modelPath)) {
+        return false;
+    }
+
+    std::cout << "[NeuralNetwork] Loaded " << modelPath << ": " << sp_Model->GetLayerCount() << " layers, "
+              << sp_Model->GetInputSize() << " inputs, " << sp_Model->GetPolicySize() << " actions"
+              << (sp_Model->HasValue() ? " + value" : "") << ", "
+              << (sp_Model->HasInt8Layers() ? GetInt8KernelName(sp_Model->GetInt8Kernel()) : "")
+              << (sp_Model->HasInt8Layers() ? " / " : "") << GetGemmKernelName(sp_Model->GetKernel())
+              << " kernels" << std::endl;
+
+    ActiveModel active;
+    active.sp_Telemetry = std::make_shared<InferenceTelemetry>(
+        modelPath, s_u64_ModelGeneration.load(std::memory_order_relaxed) + 1);
+    active.sp_Model = std::move(sp_Model);
+    PublishModel(std::move(active));
     s_b_ModelLoaded = true;
     return true;
 }
 
-NetworkOutput NeuralNetworkManager::Predict(const NetworkInput& input) {
-    if (!s_b_ModelLoaded) {
+struct NeuralNetworkManager::ModelCache {
+    ActiveModel active;
+    uint64_t u64_Generation = 0;            // of active; written by the owning thread under s_mtx_Model
+    std::atomic<uint32_t> u32_Leases{0};    // nonzero while the owning thread is inside an inference
+
+    ModelCache() {
+        std::lock_guard<std::mutex> lock(s_mtx_Model);
+        s_vec_p_ModelCaches.push_back(this);
+    }
+
+    ~ModelCache() {
+        std::lock_guard<std::mutex> lock(s_mtx_Model);
+        s_vec_p_ModelCaches.erase(std::find(s_vec_p_ModelCaches.begin(), s_vec_p_ModelCaches.end(), this));
+    }
+};
+
+NeuralNetworkManager::ModelCache& NeuralNetworkManager::GetModelCache() {
+    thread_local ModelCache t_ModelCache;
+    return t_ModelCache;
+}
+
+void NeuralNetworkManager::PublishModel(ActiveModel active) {
+    std::lock_guard<std::mutex> lock(s_mtx_Model);
+    if (s_Active.sp_Model) {
+        s_vec_sp_RetiredModels.push_back(std::move(s_Active.sp_Model));
+    }
+    if (active.sp_Telemetry) {
+        s_deque_sp_ModelTelemetry.push_back(active.sp_Telemetry);
+        if (s_deque_sp_ModelTelemetry.size() > k_MaxModelStats) {
+            s_deque_sp_ModelTelemetry.pop_front();
+        }
+    }
+    s_Active = std::move(active);
+    s_u64_ModelGeneration.fetch_add(1, std::memory_order_seq_cst);
+
+    // Every thread's copy is stale now; those outside an inference are dropped.
+    // Safe: a lease taken after the bump above sees the new generation and
+    // waits on the lock to refresh, one taken before it shows up here.
+    for (ModelCache* p_Cache : s_vec_p_ModelCaches) {
+        if (p_Cache->u32_Leases.load(std::memory_order_seq_cst) == 0) {
+            p_Cache->active = ActiveModel{};
+        }
+    }
+
+    // A retired model can no longer be acquired, so once this list holds the
+    // only reference it is unused for good and is unmapped here rather than
+    // on whichever inference thread happened to drop it last
+    s_vec_sp_RetiredModels.erase(
+        std::remove_if(s_vec_sp_RetiredModels.begin(), s_vec_sp_RetiredModels.end(),
+                       [](const std::shared_ptr<const MlpModel>& sp_Retired) { return sp_Retired.use_count() == 1; }),
+        s_vec_sp_RetiredModels.end());
+}
+
+NeuralNetworkManager::ModelLease::ModelLease()
+    : m_Cache(GetModelCache())
+{
+    // One atomic increment and load per call; the lock is only taken after a swap.
+    // A nested lease keeps the outer one's copy rather than swapping it underneath.
+    if (m_Cache.u32_Leases.fetch_add(1, std::memory_order_seq_cst) != 0) {
+        return;
+    }
+    uint64_t u64_Generation = s_u64_ModelGeneration.load(std::memory_order_seq_cst);
+    if (m_Cache.u64_Generation != u64_Generation) {
+        std::lock_guard<std::mutex> lock(s_mtx_Model);
+        m_Cache.active = s_Active;
+        m_Cache.u64_Generation = s_u64_ModelGeneration.load(std::memory_order_relaxed);
+    }
+}
+
+NeuralNetworkManager::ModelLease::~ModelLease() {
+    m_Cache.u32_Leases.fetch_sub(1, std::memory_order_release);
+}
+
+const NeuralNetworkManager::ActiveModel& NeuralNetworkManager::ModelLease::Get() const {
+    return m_Cache.active;
+}
+
+bool NeuralNetworkManager::Predict(const NetworkInput& input, NetworkOutput& output) {
+    TRACE_SCOPE("NeuralNetwork::Predict");
+    ModelLease lease;
+    const ActiveModel& active = lease.Get();
+    if (!active.sp_Model) {
         std::cerr << "No model loaded!" << std::endl;
-        return NetworkOutput{};
+        return false;
+    }
+    if (!CheckViews(*active.sp_Model, input, output)) {
+        active.sp_Telemetry->RecordRejected(1);
+        return false;
+    }
+
+    // A single row goes straight into the caller's view
+    Clock::time_point tp_Start = Clock::now();
+    EvaluateWith(*active.sp_Model, input.view_Features.data(), 1, output.view_ActionProbabilities.data(),
+                 &output.f_Confidence);
+    output.view_ActionProbabilities.num_Size = active.sp_Model->GetPolicySize();
+    uint64_t u64_Elapsed = InferenceTelemetry::ToNanoseconds(Clock::now() - tp_Start);
+    active.sp_Telemetry->RecordBatch(1, u64_Elapsed);
+    active.sp_Telemetry->RecordLatency(u64_Elapsed);
+    return true;
+}
+
+std::future<bool> NeuralNetworkManager::PredictAsync(const NetworkInput& input, NetworkOutput& output) {
+    PendingRequest request;
+    request.input = input;
+    request.p_Output = &output;
+    request.tp_Enqueued = Clock::now();
+    std::future<bool> future = request.promise.get_future();
+
+    bool b_Queued = false;
+    bool b_Wake = false;
+    {
+        std::lock_guard<std::mutex> lock(s_mtx_Pending);
+        if (s_b_Batching) {
+            s_deque_Pending.push_back(std::move(request));
+            b_Queued = true;
+            // The batcher only needs waking to start a deadline or cut a full batch
+            b_Wake = s_deque_Pending.size() == 1 || s_deque_Pending.size() >= s_BatchingOptions.num_MaxBatchSize;
+        }
+    }
+
+    if (!b_Queued) {
+        // No batcher to queue for
+        request.promise.set_value(Predict(request.input, output));
+    } else if (b_Wake) {
+        s_cv_Pending.notify_one();
+    }
+    return future;
+}
+
+void NeuralNetworkManager::SetBatchingOptions(const BatchingOptions& options) {
+    {
+        std::lock_guard<std::mutex> lock(s_mtx_Pending);
+        s_BatchingOptions = options;
+        s_BatchingOptions.num_MaxBatchSize = std::max<size_t>(1, options.num_MaxBatchSize);
     }
+    s_cv_Pending.notify_all();
+}
+
+BatchingOptions NeuralNetworkManager::GetBatchingOptions() {
+    std::lock_guard<std::mutex> lock(s_mtx_Pending);
+    return s_BatchingOptions;
+}
+
+void NeuralNetworkManager::BatcherThread() {
+    std::vector<PendingRequest> vec_Batch;
+    std::unique_lock<std::mutex> lock(s_mtx_Pending);
+    while (true) {
+        s_cv_Pending.wait(lock, [] { return !s_b_Batching || !s_deque_Pending.empty(); });
+        if (s_deque_Pending.empty()) {
+            break;
+        }
+
+        // Give other callers until the oldest request's deadline to fill the batch
+        auto tp_Deadline = s_deque_Pending.front().tp_Enqueued +
+                           std::chrono::microseconds(s_BatchingOptions.u32_MaxWaitMicroseconds);
+        s_cv_Pending.wait_until(lock, tp_Deadline, [] {
+            return !s_b_Batching || s_deque_Pending.size() >= s_BatchingOptions.num_MaxBatchSize;
+        });
+
+        size_t num_Take = std::min(s_deque_Pending.size(), s_BatchingOptions.num_MaxBatchSize);
+        for (size_t i = 0; i < num_Take; ++i) {
+            vec_Batch.push_back(std::move(s_deque_Pending.front()));
+            s_deque_Pending.pop_front();
+        }
 
-    NetworkOutput output;
-    output.vec_ActionProbabilities = {0.2f, 0.3f, 0.5f};
-    output.f_Confidence = 0.85f;
-    s_num_Inferences++;
-    return output;
+        lock.unlock();
+        RunBatch(vec_Batch);
+        vec_Batch.clear();
+        lock.lock();
+    }
 }
 
-std::future<NetworkOutput> NeuralNetworkManager::PredictAsync(const NetworkInput& input) {
-    return Threading::ThreadPool::Submit([input]() {
-        return Predict(input);
+void NeuralNetworkManager::RunBatch(std::vector<PendingRequest>& vec_Batch) {
+    TRACE_SCOPE("NeuralNetwork::RunBatch");
+    const Clock::time_point tp_Start = Clock::now();
+    ModelLease lease;
+    const ActiveModel& active = lease.Get();
+    const std::shared_ptr<const MlpModel>& sp_Model = active.sp_Model;
+    InferenceTelemetry* p_Telemetry = active.sp_Telemetry.get();
+    if (!sp_Model) {
+        std::cerr << "No model loaded!" << std::endl;
+        for (PendingRequest& request : vec_Batch) {
+            request.promise.set_value(false);
+        }
+        return;
+    }
+
+    // Rows with the wrong size are refused and left out of the GEMM
+    const size_t num_Inputs = sp_Model->GetInputSize();
+    const size_t num_Policy = sp_Model->GetPolicySize();
+    thread_local std::vector<float> t_vec_Features;
+    thread_local std::vector<float> t_vec_Policy;
+    thread_local std::vector<float> t_vec_Values;
+    thread_local std::vector<PendingRequest*> t_vec_Rows;
+    t_vec_Features.resize(vec_Batch.size() * num_Inputs);
+    t_vec_Rows.clear();
+    for (PendingRequest& request : vec_Batch) {
+        p_Telemetry->RecordQueueWait(InferenceTelemetry::ToNanoseconds(tp_Start - request.tp_Enqueued));
+        if (!CheckViews(*sp_Model, request.input, *request.p_Output)) {
+            p_Telemetry->RecordRejected(1);
+            request.promise.set_value(false);
+            continue;
+        }
+        std::copy(request.input.view_Features.begin(), request.input.view_Features.end(),
+                  t_vec_Features.begin() + t_vec_Rows.size() * num_Inputs);
+        t_vec_Rows.push_back(&request);
+    }
+
+    const size_t num_Rows = t_vec_Rows.size();
+    t_vec_Policy.resize(num_Rows * num_Policy);
+    t_vec_Values.resize(num_Rows);
+
+    // Idle pool threads take slices of a big batch; this thread runs the rest
+    const size_t num_Tasks = std::max<size_t>(1, std::min(Threading::ThreadPool::GetThreadCount() + 1,
+                                                          num_Rows / k_MinRowsPerTask));
+    // Plain pointers: inside the lambda the thread_local names would resolve
+    // to the helper thread's own buffers
+    const MlpModel& model = *sp_Model;
+    const float* p_Features = t_vec_Features.data();
+    float* p_Policy = t_vec_Policy.data();
+    float* p_Values = t_vec_Values.data();
+    Clock::time_point tp_Compute = Clock::now();
+    Threading::ThreadPool::ParallelFor(num_Tasks, [&](size_t i_Task) {
+        size_t i_Begin = num_Rows * i_Task / num_Tasks;
+        size_t i_End = num_Rows * (i_Task + 1) / num_Tasks;
+        EvaluateWith(model, p_Features + i_Begin * num_Inputs, i_End - i_Begin, p_Policy + i_Begin * num_Policy,
+                     p_Values + i_Begin);
     });
+    if (num_Rows > 0) {
+        p_Telemetry->RecordBatch(num_Rows, InferenceTelemetry::ToNanoseconds(Clock::now() - tp_Compute));
+    }
+
+    for (size_t i = 0; i < num_Rows; ++i) {
+        NetworkOutput& output = *t_vec_Rows[i]->p_Output;
+        std::copy_n(t_vec_Policy.begin() + i * num_Policy, num_Policy, output.view_ActionProbabilities.begin());
+        output.view_ActionProbabilities.num_Size = num_Policy;
+        output.f_Confidence = t_vec_Values[i];
+        p_Telemetry->RecordLatency(InferenceTelemetry::ToNanoseconds(Clock::now() - t_vec_Rows[i]->tp_Enqueued));
+        t_vec_Rows[i]->promise.set_value(true);
+    }
 }
 
-std::vector<NetworkOutput> NeuralNetworkManager::PredictBatch(const std::vector<NetworkInput>& vec_Inputs) {
-    std::vector<NetworkOutput> vec_Outputs;
-    vec_Outputs.reserve(vec_Inputs.size());
+bool NeuralNetworkManager::PredictBatch(const NetworkInput* p_Inputs, NetworkOutput* p_Outputs, size_t num_Count) {
+    TRACE_SCOPE("NeuralNetwork::PredictBatch");
+    const Clock::time_point tp_Start = Clock::now();
+    ModelLease lease;
+    const ActiveModel& active = lease.Get();
+    const std::shared_ptr<const MlpModel>& sp_Model = active.sp_Model;
+    if (!sp_Model) {
+        std::cerr << "No model loaded!" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < num_Count; ++i) {
+        if (!CheckViews(*sp_Model, p_Inputs[i], p_Outputs[i])) {
+            std::cerr << "[NeuralNetwork] ERROR: Batch row " << i << " rejected" << std::endl;
+            active.sp_Telemetry->RecordRejected(num_Count);
+            return false;
+        }
+    }
+
+    // Pack the rows so the whole batch goes through each layer as one GEMM
+    const size_t num_Inputs = sp_Model->GetInputSize();
+    const size_t num_Policy = sp_Model->GetPolicySize();
+    thread_local std::vector<float> t_vec_Features;
+    thread_local std::vector<float> t_vec_Policy;
+    thread_local std::vector<float> t_vec_Values;
+    t_vec_Features.resize(num_Count * num_Inputs);
+    t_vec_Policy.resize(num_Count * num_Policy);
+    t_vec_Values.resize(num_Count);
+    for (size_t i = 0; i < num_Count; ++i) {
+        std::copy(p_Inputs[i].view_Features.begin(), p_Inputs[i].view_Features.end(),
+                  t_vec_Features.begin() + i * num_Inputs);
+    }
 
-    for (const auto& input : vec_Inputs) {
-        vec_Outputs.push_back(Predict(input));
+    Clock::time_point tp_Compute = Clock::now();
+    EvaluateWith(*sp_Model, t_vec_Features.data(), num_Count, t_vec_Policy.data(), t_vec_Values.data());
+    if (num_Count > 0) {
+        active.sp_Telemetry->RecordBatch(num_Count, InferenceTelemetry::ToNanoseconds(Clock::now() - tp_Compute));
     }
 
-    return vec_Outputs;
+    for (size_t i = 0; i < num_Count; ++i) {
+        std::copy_n(t_vec_Policy.begin() + i * num_Policy, num_Policy, p_Outputs[i].view_ActionProbabilities.begin());
+        p_Outputs[i].view_ActionProbabilities.num_Size = num_Policy;
+        p_Outputs[i].f_Confidence = t_vec_Values[i];
+    }
+    active.sp_Telemetry->RecordLatency(InferenceTelemetry::ToNanoseconds(Clock::now() - tp_Start), num_Count);
+    return true;
+}
+
+bool NeuralNetworkManager::Evaluate(const float* p_Features, size_t num_Rows, float* p_Policy, float* p_Values) {
+    TRACE_SCOPE("NeuralNetwork::Evaluate");
+    ModelLease lease;
+    const ActiveModel& active = lease.Get();
+    if (!active.sp_Model) {
+        return false;
+    }
+
+    Clock::time_point tp_Start = Clock::now();
+    EvaluateWith(*active.sp_Model, p_Features, num_Rows, p_Policy, p_Values);
+    if (num_Rows > 0) {
+        uint64_t u64_Elapsed = InferenceTelemetry::ToNanoseconds(Clock::now() - tp_Start);
+        active.sp_Telemetry->RecordBatch(num_Rows, u64_Elapsed);
+        active.sp_Telemetry->RecordLatency(u64_Elapsed, num_Rows);
+    }
+    return true;
+}
+
+size_t NeuralNetworkManager::GetInputSize() {
+    ModelLease lease;
+    const std::shared_ptr<const MlpModel>& sp_Model = lease.Get().sp_Model;
+    return sp_Model ? sp_Model->GetInputSize() : 0;
+}
+
+size_t NeuralNetworkManager::GetPolicySize() {
+    ModelLease lease;
+    const std::shared_ptr<const MlpModel>& sp_Model = lease.Get().sp_Model;
+    return sp_Model ? sp_Model->GetPolicySize() : 0;
+}
+
+InferenceStats NeuralNetworkManager::GetStats() {
+    ModelLease lease;
+    const ActiveModel& active = lease.Get();
+    return active.sp_Telemetry ? active.sp_Telemetry->GetStats() : InferenceStats{};
+}
+
+std::vector<InferenceStats> NeuralNetworkManager::GetModelStats() {
+    std::lock_guard<std::mutex> lock(s_mtx_Model);
+    std::vector<InferenceStats> vec_Stats;
+    vec_Stats.reserve(s_deque_sp_ModelTelemetry.size());
+    for (const std::shared_ptr<InferenceTelemetry>& sp_Telemetry : s_deque_sp_ModelTelemetry) {
+        vec_Stats.push_back(sp_Telemetry->GetStats());
+    }
+    return vec_Stats;
+}
+
+void NeuralNetworkManager::ResetStats() {
+    ModelLease lease;
+    const ActiveModel& active = lease.Get();
+    if (active.sp_Telemetry) {
+        active.sp_Telemetry->Reset();
+    }
 }
 
 bool NeuralNetworkManager::IsReady() {
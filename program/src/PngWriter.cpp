@@ -0,0 +1,127 @@
+#include "PngWriter.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace ScotlandYard {
+namespace Utils {
+
+namespace {
+
+constexpr size_t k_MaxStoredBlock = 65535;
+
+const std::array<uint32_t, 256>& CrcTable() {
+    static const std::array<uint32_t, 256> s_Table = [] {
+        std::array<uint32_t, 256> arr_Table{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t u32_C = n;
+            for (int k = 0; k < 8; ++k) {
+                u32_C = (u32_C & 1) ? 0xEDB88320u ^ (u32_C >> 1) : u32_C >> 1;
+            }
+            arr_Table[n] = u32_C;
+        }
+        return arr_Table;
+    }();
+    return s_Table;
+}
+
+uint32_t UpdateCrc(uint32_t u32_Crc, const unsigned char* p_Data, size_t num_Bytes) {
+    const auto& arr_Table = CrcTable();
+    for (size_t i = 0; i < num_Bytes; ++i) {
+        u32_Crc = arr_Table[(u32_Crc ^ p_Data[i]) & 0xFF] ^ (u32_Crc >> 8);
+    }
+    return u32_Crc;
+}
+
+void AppendU32(std::vector<unsigned char>& vec_Out, uint32_t u32_Value) {
+    vec_Out.push_back(static_cast<unsigned char>(u32_Value >> 24));
+    vec_Out.push_back(static_cast<unsigned char>(u32_Value >> 16));
+    vec_Out.push_back(static_cast<unsigned char>(u32_Value >> 8));
+    vec_Out.push_back(static_cast<unsigned char>(u32_Value));
+}
+
+// Length, type, data, CRC over type and data
+void AppendChunk(std::vector<unsigned char>& vec_Out, const char* p_Type, const std::vector<unsigned char>& vec_Data) {
+    AppendU32(vec_Out, static_cast<uint32_t>(vec_Data.size()));
+    size_t num_TypeAt = vec_Out.size();
+    vec_Out.insert(vec_Out.end(), p_Type, p_Type + 4);
+    vec_Out.insert(vec_Out.end(), vec_Data.begin(), vec_Data.end());
+    uint32_t u32_Crc = UpdateCrc(0xFFFFFFFFu, vec_Out.data() + num_TypeAt, 4 + vec_Data.size());
+    AppendU32(vec_Out, u32_Crc ^ 0xFFFFFFFFu);
+}
+
+} // namespace
+
+bool PngWriter::Write(const std::string& s_Path, const unsigned char* p_Pixels, int i_Width, int i_Height,
+                      int i_Channels, bool b_FlipVertically) {
+    static const unsigned char k_ColorTypes[5] = { 0, 0, 4, 2, 6 };
+
+    if (!p_Pixels || i_Width <= 0 || i_Height <= 0 || i_Channels < 1 || i_Channels > 4) {
+        std::cerr << "[PngWriter] ERROR: Invalid image for " << s_Path << std::endl;
+        return false;
+    }
+
+    // Filter type 0 (none) in front of every row
+    size_t num_RowBytes = static_cast<size_t>(i_Width) * i_Channels;
+    std::vector<unsigned char> vec_Raw;
+    vec_Raw.reserve((num_RowBytes + 1) * i_Height);
+    for (int y = 0; y < i_Height; ++y) {
+        int i_SourceRow = b_FlipVertically ? i_Height - 1 - y : y;
+        const unsigned char* p_Row = p_Pixels + static_cast<size_t>(i_SourceRow) * num_RowBytes;
+        vec_Raw.push_back(0);
+        vec_Raw.insert(vec_Raw.end(), p_Row, p_Row + num_RowBytes);
+    }
+
+    // zlib stream of stored blocks, Adler-32 at the end
+    std::vector<unsigned char> vec_Deflate;
+    vec_Deflate.reserve(vec_Raw.size() + vec_Raw.size() / k_MaxStoredBlock * 5 + 16);
+    vec_Deflate.push_back(0x78);
+    vec_Deflate.push_back(0x01);
+    size_t num_Offset = 0;
+    do {
+        size_t num_Block = std::min(k_MaxStoredBlock, vec_Raw.size() - num_Offset);
+        bool b_Last = num_Offset + num_Block == vec_Raw.size();
+        vec_Deflate.push_back(b_Last ? 1 : 0);
+        vec_Deflate.push_back(static_cast<unsigned char>(num_Block));
+        vec_Deflate.push_back(static_cast<unsigned char>(num_Block >> 8));
+        vec_Deflate.push_back(static_cast<unsigned char>(~num_Block));
+        vec_Deflate.push_back(static_cast<unsigned char>(~num_Block >> 8));
+        vec_Deflate.insert(vec_Deflate.end(), vec_Raw.begin() + num_Offset, vec_Raw.begin() + num_Offset + num_Block);
+        num_Offset += num_Block;
+    } while (num_Offset < vec_Raw.size());
+
+    uint32_t u32_A = 1, u32_B = 0;
+    for (unsigned char u8_Byte : vec_Raw) {
+        u32_A = (u32_A + u8_Byte) % 65521;
+        u32_B = (u32_B + u32_A) % 65521;
+    }
+    AppendU32(vec_Deflate, (u32_B << 16) | u32_A);
+
+    std::vector<unsigned char> vec_Header;
+    AppendU32(vec_Header, static_cast<uint32_t>(i_Width));
+    AppendU32(vec_Header, static_cast<uint32_t>(i_Height));
+    vec_Header.push_back(8);                        // bit depth
+    vec_Header.push_back(k_ColorTypes[i_Channels]);
+    vec_Header.push_back(0);                        // deflate
+    vec_Header.push_back(0);                        // adaptive filtering
+    vec_Header.push_back(0);                        // not interlaced
+
+    static const unsigned char k_Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<unsigned char> vec_File(k_Signature, k_Signature + 8);
+    AppendChunk(vec_File, "IHDR", vec_Header);
+    AppendChunk(vec_File, "IDAT", vec_Deflate);
+    AppendChunk(vec_File, "IEND", {});
+
+    std::ofstream file(s_Path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(vec_File.data()), static_cast<std::streamsize>(vec_File.size()))) {
+        std::cerr << "[PngWriter] ERROR: Could not write " << s_Path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Utils
+} // namespace ScotlandYard
@@ -0,0 +1,140 @@
+#include "RenderBenchmark.h"
+#include "CsvReader.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace ScotlandYard {
+namespace Core {
+
+namespace {
+    // Nearest-rank percentile of sorted samples
+    double Percentile(const std::vector<double>& vec_Sorted, double d_Fraction) {
+        size_t num_Rank = static_cast<size_t>(std::ceil(d_Fraction * vec_Sorted.size()));
+        return vec_Sorted[std::min(vec_Sorted.size() - 1, num_Rank > 0 ? num_Rank - 1 : 0)];
+    }
+}
+
+bool CameraPath::Load(const std::string& s_Path) {
+    Utils::CsvReader reader;
+    if (!reader.Open(s_Path)) {
+        std::cerr << "[CameraPath] ERROR: Could not open " << s_Path << std::endl;
+        return false;
+    }
+
+    std::vector<CameraKey> vec_Keys;
+    reader.NextRow();   // header
+    while (reader.NextRow()) {
+        CameraKey key;
+        if (reader.GetFieldCount() < 5 ||
+            !Utils::CsvReader::ParseFloat(reader.GetField(0), key.f_Time) ||
+            !Utils::CsvReader::ParseFloat(reader.GetField(1), key.vec3_Position.x) ||
+            !Utils::CsvReader::ParseFloat(reader.GetField(2), key.vec3_Position.y) ||
+            !Utils::CsvReader::ParseFloat(reader.GetField(3), key.vec3_Position.z) ||
+            !Utils::CsvReader::ParseFloat(reader.GetField(4), key.f_Pitch)) {
+            std::cerr << "[CameraPath] ERROR: Bad row at " << s_Path << ":" << reader.GetLineNumber() << std::endl;
+            return false;
+        }
+        if (!vec_Keys.empty() && key.f_Time < vec_Keys.back().f_Time) {
+            std::cerr << "[CameraPath] ERROR: Times go backwards at " << s_Path << ":" << reader.GetLineNumber() << std::endl;
+            return false;
+        }
+        vec_Keys.push_back(key);
+    }
+
+    if (vec_Keys.empty()) {
+        std::cerr << "[CameraPath] ERROR: No keys in " << s_Path << std::endl;
+        return false;
+    }
+
+    m_vec_Keys = std::move(vec_Keys);
+    return true;
+}
+
+CameraPath CameraPath::MakeDefault() {
+    CameraPath path;
+    path.m_vec_Keys = {
+        { 0.0f, glm::vec3( 0.0f, 1.5f,  4.0f), -0.2915f },
+        { 2.0f, glm::vec3( 0.0f, 3.0f,  1.5f), -1.2f },
+        { 4.0f, glm::vec3(-0.8f, 0.6f,  0.5f), -0.35f },
+        { 6.0f, glm::vec3( 0.8f, 0.6f, -0.5f), -0.35f },
+        { 8.0f, glm::vec3( 0.0f, 1.5f,  4.0f), -0.2915f }
+    };
+    return path;
+}
+
+CameraKey CameraPath::Sample(float f_T) const {
+    if (m_vec_Keys.size() == 1) return m_vec_Keys.front();
+
+    float f_Time = m_vec_Keys.front().f_Time +
+                   std::clamp(f_T, 0.0f, 1.0f) * (m_vec_Keys.back().f_Time - m_vec_Keys.front().f_Time);
+    auto it_Next = std::upper_bound(m_vec_Keys.begin(), m_vec_Keys.end(), f_Time,
+        [](float f_Value, const CameraKey& key) { return f_Value < key.f_Time; });
+    if (it_Next == m_vec_Keys.end()) return m_vec_Keys.back();
+    if (it_Next == m_vec_Keys.begin()) return m_vec_Keys.front();
+
+    const CameraKey& a = *(it_Next - 1);
+    const CameraKey& b = *it_Next;
+    float f_Span = b.f_Time - a.f_Time;
+    float f_Alpha = f_Span > 0.0f ? (f_Time - a.f_Time) / f_Span : 1.0f;
+
+    CameraKey key;
+    key.f_Time = f_Time;
+    key.vec3_Position = a.vec3_Position + (b.vec3_Position - a.vec3_Position) * f_Alpha;
+    key.f_Pitch = a.f_Pitch + (b.f_Pitch - a.f_Pitch) * f_Alpha;
+    return key;
+}
+
+FrameTimeStats FrameTimeStats::Compute(const std::vector<double>& vec_FrameMs) {
+    FrameTimeStats stats;
+    if (vec_FrameMs.empty()) return stats;
+
+    std::vector<double> vec_Sorted = vec_FrameMs;
+    std::sort(vec_Sorted.begin(), vec_Sorted.end());
+
+    double d_Sum = 0.0;
+    for (double d_Ms : vec_Sorted) d_Sum += d_Ms;
+    stats.i_Frames = static_cast<int>(vec_Sorted.size());
+    stats.d_MeanMs = d_Sum / vec_Sorted.size();
+
+    double d_Variance = 0.0;
+    for (double d_Ms : vec_Sorted) d_Variance += (d_Ms - stats.d_MeanMs) * (d_Ms - stats.d_MeanMs);
+    stats.d_StdDevMs = std::sqrt(d_Variance / vec_Sorted.size());
+
+    stats.d_MinMs = vec_Sorted.front();
+    stats.d_MaxMs = vec_Sorted.back();
+    stats.d_P50Ms = Percentile(vec_Sorted, 0.50);
+    stats.d_P95Ms = Percentile(vec_Sorted, 0.95);
+    stats.d_P99Ms = Percentile(vec_Sorted, 0.99);
+    return stats;
+}
+
+void FrameTimeStats::Print() const {
+    std::cout << "[Benchmark] " << i_Frames << " frames: mean " << d_MeanMs << " ms (sd " << d_StdDevMs
+              << "), min " << d_MinMs << ", p50 " << d_P50Ms << ", p95 " << d_P95Ms
+              << ", p99 " << d_P99Ms << ", max " << d_MaxMs << " ms";
+    if (d_MeanMs > 0.0) {
+        std::cout << " (" << 1000.0 / d_MeanMs << " fps)";
+    }
+    std::cout << std::endl;
+}
+
+bool FrameTimeStats::WriteCsv(const std::string& s_Path, const std::vector<double>& vec_FrameMs) const {
+    std::ofstream file(s_Path);
+    if (!file) {
+        std::cerr << "[Benchmark] ERROR: Could not write " << s_Path << std::endl;
+        return false;
+    }
+
+    file << "frame,ms\n";
+    for (size_t i = 0; i < vec_FrameMs.size(); ++i) {
+        file << i << ',' << vec_FrameMs[i] << '\n';
+    }
+    file << "# mean," << d_MeanMs << "\n# stddev," << d_StdDevMs << "\n# min," << d_MinMs
+         << "\n# p50," << d_P50Ms << "\n# p95," << d_P95Ms << "\n# p99," << d_P99Ms << "\n# max," << d_MaxMs << '\n';
+    return static_cast<bool>(file);
+}
+
+} // namespace Core
+} // namespace ScotlandYard
@@ -0,0 +1,308 @@
+#include "ReplayBuffer.h"
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace ScotlandYard {
+namespace AI {
+
+namespace {
+    constexpr float k_PolicyScale = 65535.0f;       // as in the trajectory files
+    constexpr uint64_t k_Busy = ~0ull;
+    // Priorities are fixed point so the tree can sum them with integer
+    // fetch_add; capped so that a full tree of the largest ones still fits
+    // below k_Negative
+    constexpr double k_PriorityScale = 16777216.0;  // 2^24
+    constexpr double k_MaxPriority = 1024.0;
+    constexpr uint32_t k_MaxCapacity = 1u << 28;
+    // A sum above this is a decrease that overtook the increase before it
+    // on its way up the tree; it reads as empty until both have landed
+    constexpr uint64_t k_Negative = 1ull << 63;
+    constexpr size_t k_RowsPerTask = 64;
+    constexpr int k_MaxAttempts = 64;
+
+    uint32_t RoundUpToPowerOfTwo(uint32_t u32_Value) {
+        uint32_t u32_Result = 1;
+        while (u32_Result < u32_Value) u32_Result <<= 1;
+        return u32_Result;
+    }
+
+    std::atomic<uint64_t>* CarveAtomics(Memory::LinearArena& arena, size_t num_Count) {
+        void* p_Memory = arena.Allocate(num_Count * sizeof(std::atomic<uint64_t>));
+        std::atomic<uint64_t>* p_Atomics = static_cast<std::atomic<uint64_t>*>(p_Memory);
+        for (size_t i = 0; i < num_Count; ++i) {
+            new (&p_Atomics[i]) std::atomic<uint64_t>(0);
+        }
+        return p_Atomics;
+    }
+
+    // Checked before the arena is allocated, so a refused map costs nothing
+    const TrajectoryLayout& CheckLayout(const TrajectoryLayout& layout) {
+        if (!layout.Fits()) {
+            throw std::invalid_argument("[ReplayBuffer] " + std::to_string(layout.GetNodeCount()) + " nodes and " +
+                                        std::to_string(layout.GetActionCount()) +
+                                        " actions do not fit the step format");
+        }
+        return layout;
+    }
+
+    // Possible-Mr-X mask of the row being copied out, per sampling thread
+    std::vector<uint64_t>& GetMaskScratch() {
+        thread_local std::vector<uint64_t> t_vec_Mask;
+        return t_vec_Mask;
+    }
+}
+
+ReplayBuffer::ReplayBuffer(const TrajectoryLayout& layout, const ReplayBufferOptions& options)
+    : m_Layout(CheckLayout(layout))
+    , m_Options(options)
+    , m_u32_Capacity(RoundUpToPowerOfTwo(std::min(std::max(options.u32_Capacity, 1u), k_MaxCapacity)))
+    , m_Arena(GetArenaBytes(layout, m_u32_Capacity), Memory::MemoryTag::AI)
+    , m_u64_Head(0)
+    , m_u64_MaxPriority(static_cast<uint64_t>(k_PriorityScale))
+    , m_u64_Dropped(0)
+{
+    const size_t num_Slots = m_u32_Capacity;
+    m_p_Positions = m_Arena.AllocateArray<uint16_t>(num_Slots * Core::k_PlayerCount);
+    m_p_Tickets = m_Arena.AllocateArray<uint8_t>(num_Slots * Core::k_PlayerCount * Core::k_TicketTypeCount);
+    m_p_Rounds = m_Arena.AllocateArray<uint8_t>(num_Slots);
+    m_p_Turns = m_Arena.AllocateArray<uint8_t>(num_Slots);
+    m_p_Actions = m_Arena.AllocateArray<uint8_t>(num_Slots);
+    m_p_Values = m_Arena.AllocateArray<float>(num_Slots);
+    m_p_PossibleMisterX = m_Arena.AllocateArray<uint64_t>(num_Slots * layout.GetMaskWords());
+    m_p_Policy = m_Arena.AllocateArray<uint16_t>(num_Slots * layout.GetActionCount());
+    m_p_Sequence = CarveAtomics(m_Arena, num_Slots);
+    m_p_Tree = CarveAtomics(m_Arena, num_Slots * 2);
+}
+
+size_t ReplayBuffer::GetArenaBytes(const TrajectoryLayout& layout, uint32_t u32_Capacity) {
+    const size_t num_Slots = u32_Capacity;
+    const size_t num_SlotBytes = Core::k_PlayerCount * sizeof(uint16_t)
+                               + Core::k_PlayerCount * Core::k_TicketTypeCount
+                               + 3 * sizeof(uint8_t) + sizeof(float)
+                               + layout.GetMaskWords() * sizeof(uint64_t)
+                               + layout.GetActionCount() * sizeof(uint16_t)
+                               + 3 * sizeof(std::atomic<uint64_t>);
+    // Room to align each of the ten arrays
+    return num_Slots * num_SlotBytes + 10 * Memory::LinearArena::k_DefaultAlignment;
+}
+
+uint64_t ReplayBuffer::GetSize() const {
+    return std::min<uint64_t>(m_u64_Head.load(std::memory_order_relaxed), m_u32_Capacity);
+}
+
+uint64_t ReplayBuffer::ToFixedPriority(float f_Error) const {
+    double d_Priority = std::pow(static_cast<double>(std::fabs(f_Error)) + m_Options.f_Epsilon, m_Options.f_Alpha);
+    d_Priority = std::min(d_Priority, k_MaxPriority);
+    return std::max<uint64_t>(1, static_cast<uint64_t>(d_Priority * k_PriorityScale + 0.5));
+}
+
+void ReplayBuffer::SetPriority(uint32_t u32_Slot, uint64_t u64_Priority) {
+    uint32_t u32_Node = m_u32_Capacity + u32_Slot;
+    // acq_rel: an exchange that follows Push()'s final one also sees the id it published
+    uint64_t u64_Old = m_p_Tree[u32_Node].exchange(u64_Priority, std::memory_order_acq_rel);
+    uint64_t u64_Delta = u64_Priority - u64_Old;    // wraps for a decrease, which fetch_add undoes
+    if (u64_Delta == 0) {
+        return;
+    }
+    for (u32_Node /= 2; u32_Node >= 1; u32_Node /= 2) {
+        m_p_Tree[u32_Node].fetch_add(u64_Delta, std::memory_order_relaxed);
+    }
+}
+
+void ReplayBuffer::Push(const Core::RulesState& state, const uint64_t* p_PossibleMisterX, uint32_t u32_Action,
+                        const float* p_Policy, float f_Value) {
+    const uint64_t u64_Id = m_u64_Head.fetch_add(1, std::memory_order_relaxed) + 1;
+    const uint32_t u32_Slot = static_cast<uint32_t>((u64_Id - 1) & (m_u32_Capacity - 1));
+
+    // Claim the slot unless a producer a lap ahead already has
+    std::atomic<uint64_t>& sequence = m_p_Sequence[u32_Slot];
+    uint64_t u64_Current = sequence.load(std::memory_order_relaxed);
+    if (u64_Current == k_Busy || u64_Current > u64_Id ||
+        !sequence.compare_exchange_strong(u64_Current, k_Busy, std::memory_order_relaxed)) {
+        m_u64_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    SetPriority(u32_Slot, 0);
+
+    const size_t i_Slot = u32_Slot;
+    for (int i = 0; i < Core::k_PlayerCount; ++i) {
+        m_p_Positions[i_Slot * Core::k_PlayerCount + i] = static_cast<uint16_t>(state.arr_Positions[i]);
+    }
+    std::memcpy(&m_p_Tickets[i_Slot * Core::k_PlayerCount * Core::k_TicketTypeCount], state.arr_Tickets,
+                sizeof(state.arr_Tickets));
+    m_p_Rounds[i_Slot] = state.u8_Round;
+    m_p_Turns[i_Slot] = state.u8_Turn;
+    m_p_Actions[i_Slot] = static_cast<uint8_t>(u32_Action);
+    m_p_Values[i_Slot] = f_Value;
+
+    const size_t num_MaskWords = m_Layout.GetMaskWords();
+    std::memcpy(&m_p_PossibleMisterX[i_Slot * num_MaskWords], p_PossibleMisterX, num_MaskWords * sizeof(uint64_t));
+
+    const size_t num_Actions = m_Layout.GetActionCount();
+    uint16_t* p_SlotPolicy = &m_p_Policy[i_Slot * num_Actions];
+    for (size_t a = 0; a < num_Actions; ++a) {
+        float f_Scaled = std::min(std::max(p_Policy[a], 0.0f), 1.0f) * k_PolicyScale + 0.5f;
+        p_SlotPolicy[a] = static_cast<uint16_t>(f_Scaled);
+    }
+
+    sequence.store(u64_Id, std::memory_order_release);
+    SetPriority(u32_Slot, m_u64_MaxPriority.load(std::memory_order_relaxed));
+}
+
+bool ReplayBuffer::Sample(size_t num_Rows, std::mt19937_64& rng, const Core::FeatureEncoder& encoder,
+                          ReplaySample& sample) const {
+    TRACE_SCOPE("ReplayBuffer::Sample");
+    if (encoder.GetNodeCount() != m_Layout.GetNodeCount() || encoder.GetActionCount() != m_Layout.GetActionCount()) {
+        std::cerr << "[ReplayBuffer] ERROR: Encoder is for another map than the buffer" << std::endl;
+        return false;
+    }
+    const uint64_t u64_Total = m_p_Tree[1].load(std::memory_order_relaxed);
+    const uint64_t u64_Size = GetSize();
+    if (u64_Size == 0 || u64_Total == 0 || u64_Total >= k_Negative) {
+        return false;
+    }
+
+    sample.batch.num_Rows = num_Rows;
+    sample.batch.vec_Features.resize(num_Rows * encoder.GetFeatureSize());
+    sample.batch.vec_Policy.resize(num_Rows * m_Layout.GetActionCount());
+    sample.batch.vec_Values.resize(num_Rows);
+    sample.batch.vec_Actions.resize(num_Rows);
+    sample.vec_Ids.resize(num_Rows);
+    sample.vec_Weights.resize(num_Rows);
+
+    // Each task its own generator, seeded here so a seed gives the same draws however many threads run
+    const size_t num_Tasks = (num_Rows + k_RowsPerTask - 1) / k_RowsPerTask;
+    std::vector<uint64_t> vec_Seeds(num_Tasks);
+    for (uint64_t& u64_Seed : vec_Seeds) {
+        u64_Seed = rng();
+    }
+
+    std::atomic<bool> b_Ok(true);
+    Threading::ThreadPool::ParallelFor(num_Tasks, [&](size_t i_Task) {
+        std::mt19937_64 taskRng(vec_Seeds[i_Task]);
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        size_t i_End = std::min(num_Rows, (i_Task + 1) * k_RowsPerTask);
+        for (size_t i_Row = i_Task * k_RowsPerTask; i_Row < i_End; ++i_Row) {
+            bool b_Sampled = false;
+            for (int i_Attempt = 0; i_Attempt < k_MaxAttempts && !b_Sampled; ++i_Attempt) {
+                double d_Target = (static_cast<double>(i_Row) + dist(taskRng)) / static_cast<double>(num_Rows)
+                                  * static_cast<double>(u64_Total);
+                uint64_t u64_Target = std::min(static_cast<uint64_t>(d_Target), u64_Total - 1);
+                b_Sampled = TrySampleRow(u64_Target, encoder, i_Row, sample);
+            }
+            if (!b_Sampled) {
+                b_Ok.store(false, std::memory_order_relaxed);
+            }
+        }
+    });
+    if (!b_Ok.load()) {
+        std::cerr << "[ReplayBuffer] ERROR: Sampling kept racing with writers; is the buffer smaller than a batch of pushes?"
+                  << std::endl;
+        return false;
+    }
+
+    // TrySampleRow() left each row's priority in its weight
+    float f_MaxWeight = 0.0f;
+    for (float& f_Weight : sample.vec_Weights) {
+        double d_Probability = f_Weight / static_cast<double>(u64_Total);
+        f_Weight = static_cast<float>(std::pow(static_cast<double>(u64_Size) * d_Probability, -m_Options.f_Beta));
+        f_MaxWeight = std::max(f_MaxWeight, f_Weight);
+    }
+    for (float& f_Weight : sample.vec_Weights) {
+        f_Weight /= f_MaxWeight;
+    }
+    return true;
+}
+
+bool ReplayBuffer::TrySampleRow(uint64_t u64_Target, const Core::FeatureEncoder& encoder, size_t i_Row,
+                                ReplaySample& sample) const {
+    uint32_t u32_Node = 1;
+    while (u32_Node < m_u32_Capacity) {
+        uint64_t u64_Left = m_p_Tree[2 * u32_Node].load(std::memory_order_relaxed);
+        if (u64_Left >= k_Negative) u64_Left = 0;
+        if (u64_Target < u64_Left) {
+            u32_Node = 2 * u32_Node;
+        } else {
+            u64_Target -= u64_Left;
+            u32_Node = 2 * u32_Node + 1;
+        }
+    }
+    const uint64_t u64_Priority = m_p_Tree[u32_Node].load(std::memory_order_relaxed);
+    const size_t i_Slot = u32_Node - m_u32_Capacity;
+    const uint64_t u64_Id = m_p_Sequence[i_Slot].load(std::memory_order_acquire);
+    if (u64_Priority == 0 || u64_Id == 0 || u64_Id == k_Busy) {
+        return false;
+    }
+
+    Core::RulesState state;
+    for (int i = 0; i < Core::k_PlayerCount; ++i) {
+        state.arr_Positions[i] = m_p_Positions[i_Slot * Core::k_PlayerCount + i];
+    }
+    std::memcpy(state.arr_Tickets, &m_p_Tickets[i_Slot * Core::k_PlayerCount * Core::k_TicketTypeCount],
+                sizeof(state.arr_Tickets));
+    state.u8_Round = m_p_Rounds[i_Slot];
+    state.u8_Turn = m_p_Turns[i_Slot];
+    state.e_Outcome = Core::GameOutcome::None;
+
+    const size_t num_MaskWords = m_Layout.GetMaskWords();
+    std::vector<uint64_t>& vec_Mask = GetMaskScratch();
+    vec_Mask.resize(num_MaskWords);
+    std::memcpy(vec_Mask.data(), &m_p_PossibleMisterX[i_Slot * num_MaskWords], num_MaskWords * sizeof(uint64_t));
+
+    const size_t num_Actions = m_Layout.GetActionCount();
+    float* p_Policy = &sample.batch.vec_Policy[i_Row * num_Actions];
+    for (size_t a = 0; a < num_Actions; ++a) {
+        p_Policy[a] = m_p_Policy[i_Slot * num_Actions + a] / k_PolicyScale;
+    }
+    float f_Value = m_p_Values[i_Slot];
+    uint32_t u32_Action = m_p_Actions[i_Slot];
+
+    // Keep the copy only if no writer touched the slot meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_p_Sequence[i_Slot].load(std::memory_order_relaxed) != u64_Id) {
+        return false;
+    }
+
+    encoder.Encode(state, vec_Mask.data(), &sample.batch.vec_Features[i_Row * encoder.GetFeatureSize()]);
+    sample.batch.vec_Values[i_Row] = f_Value;
+    sample.batch.vec_Actions[i_Row] = u32_Action;
+    sample.vec_Ids[i_Row] = u64_Id;
+    sample.vec_Weights[i_Row] = static_cast<float>(u64_Priority);
+    return true;
+}
+
+void ReplayBuffer::UpdatePriorities(const uint64_t* p_Ids, const float* p_Errors, size_t num_Count) {
+    for (size_t i = 0; i < num_Count; ++i) {
+        const uint32_t u32_Slot = static_cast<uint32_t>((p_Ids[i] - 1) & (m_u32_Capacity - 1));
+        if (p_Ids[i] == 0 || m_p_Sequence[u32_Slot].load(std::memory_order_relaxed) != p_Ids[i]) {
+            continue;
+        }
+
+        uint64_t u64_Priority = ToFixedPriority(p_Errors[i]);
+        SetPriority(u32_Slot, u64_Priority);
+
+        // A Push() may have reused the slot between the check and the update and
+        // the error is not the new transition's, so give it the priority a fresh
+        // push gets. One landing while the slot is busy is overwritten anyway.
+        if (m_p_Sequence[u32_Slot].load(std::memory_order_relaxed) != p_Ids[i]) {
+            SetPriority(u32_Slot, m_u64_MaxPriority.load(std::memory_order_relaxed));
+            continue;
+        }
+
+        uint64_t u64_Max = m_u64_MaxPriority.load(std::memory_order_relaxed);
+        while (u64_Priority > u64_Max &&
+               !m_u64_MaxPriority.compare_exchange_weak(u64_Max, u64_Priority, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+} // namespace AI
+} // namespace ScotlandYard
@@ -18,6 +18,11 @@ void StateManager::RegisterState(const std::string& s_Name, std::unique_ptr<IGam
     m_map_States[s_Name] = std::move(u_State);
 }
 
+IGameState* StateManager::GetState(const std::string& s_Name) const {
+    auto it = m_map_States.find(s_Name);
+    return it != m_map_States.end() ? it->second.get() : nullptr;
+}
+
 void StateManager::PushState(const std::string& s_Name) {
     auto it = m_map_States.find(s_Name);
     if (it == m_map_States.end()) {
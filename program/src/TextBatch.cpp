@@ -0,0 +1,153 @@
+#include "TextBatch.h"
+#include "Application.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace ScotlandYard {
+namespace Core {
+
+namespace {
+    constexpr size_t k_InitialQuadCapacity = 256;
+}
+
+TextBatch::TextBatch()
+    : m_VAO_Uploaded(0)
+    , m_VBO_Uploaded(0)
+    , m_i_UploadedVertexCount(0)
+{
+    m_vec_Vertices.reserve(k_InitialQuadCapacity * k_FloatsPerQuad);
+}
+
+void TextBatch::AddText(const std::string& s_Text, float f_X, float f_BaselineY, float f_Scale,
+                        float f_R, float f_G, float f_B, float f_A, const Application* p_App) {
+    float f_PenX = f_X;
+    for (char c : s_Text) {
+        const Character* p_Ch = p_App->GetCharacter(c);
+        if (!p_Ch) continue;
+
+        if (p_Ch->m_i_Width > 0 && p_Ch->m_i_Height > 0) {
+            float f_Xpos = f_PenX + p_Ch->m_i_BearingX * f_Scale;
+            float f_Ypos = f_BaselineY - (p_Ch->m_i_Height - p_Ch->m_i_BearingY) * f_Scale;
+            float f_W = p_Ch->m_i_Width * f_Scale;
+            float f_H = p_Ch->m_i_Height * f_Scale;
+
+            // bitmap rows run top-down, so the bottom edge samples V1
+            AddQuad(f_Xpos, f_Ypos, f_Xpos + f_W, f_Ypos + f_H,
+                    p_Ch->m_f_U0, p_Ch->m_f_V1, p_Ch->m_f_U1, p_Ch->m_f_V0,
+                    f_R, f_G, f_B, f_A);
+        }
+
+        f_PenX += (p_Ch->m_i_Advance >> 6) * f_Scale;
+    }
+}
+
+void TextBatch::AddQuad(float f_X0, float f_Y0, float f_X1, float f_Y1,
+                        float f_U0, float f_V0, float f_U1, float f_V1,
+                        float f_R, float f_G, float f_B, float f_A) {
+    const float f_Quad[k_FloatsPerQuad] = {
+        f_X0, f_Y0, f_U0, f_V0, f_R, f_G, f_B, f_A,
+        f_X0, f_Y1, f_U0, f_V1, f_R, f_G, f_B, f_A,
+        f_X1, f_Y1, f_U1, f_V1, f_R, f_G, f_B, f_A,
+        f_X0, f_Y0, f_U0, f_V0, f_R, f_G, f_B, f_A,
+        f_X1, f_Y1, f_U1, f_V1, f_R, f_G, f_B, f_A,
+        f_X1, f_Y0, f_U1, f_V0, f_R, f_G, f_B, f_A,
+    };
+    m_vec_Vertices.insert(m_vec_Vertices.end(), f_Quad, f_Quad + k_FloatsPerQuad);
+}
+
+void TextBatch::BindForDraw(int i_ViewportWidth, int i_ViewportHeight, const Application* p_App) const {
+    GLuint prog = p_App->GetTextShaderProgram();
+    glUseProgram(prog);
+    glm::mat4 P = glm::ortho(0.0f, (float)i_ViewportWidth, 0.0f, (float)i_ViewportHeight);
+    glUniformMatrix4fv(glGetUniformLocation(prog, "projection"), 1, GL_FALSE, glm::value_ptr(P));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, p_App->GetGlyphAtlasTexture());
+    glUniform1i(glGetUniformLocation(prog, "text"), 0);
+}
+
+void TextBatch::Flush(int i_ViewportWidth, int i_ViewportHeight, const Application* p_App) {
+    if (m_vec_Vertices.empty()) return;
+
+    BindForDraw(i_ViewportWidth, i_ViewportHeight, p_App);
+
+    // Orphan the previous storage so the driver never waits on last frame's draw
+    glBindVertexArray(p_App->GetTextVAO());
+    glBindBuffer(GL_ARRAY_BUFFER, p_App->GetTextVBO());
+    glBufferData(GL_ARRAY_BUFFER, m_vec_Vertices.size() * sizeof(float), m_vec_Vertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_vec_Vertices.size() / k_FloatsPerVertex));
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+
+    m_vec_Vertices.clear();
+}
+
+void TextBatch::Upload() {
+    if (!m_VAO_Uploaded) {
+        glGenVertexArrays(1, &m_VAO_Uploaded);
+        glGenBuffers(1, &m_VBO_Uploaded);
+        glBindVertexArray(m_VAO_Uploaded);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Uploaded);
+        SetupVertexAttributes();
+    } else {
+        glBindVertexArray(m_VAO_Uploaded);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO_Uploaded);
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, m_vec_Vertices.size() * sizeof(float), m_vec_Vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    m_i_UploadedVertexCount = static_cast<GLsizei>(m_vec_Vertices.size() / k_FloatsPerVertex);
+    m_vec_Vertices.clear();
+}
+
+void TextBatch::DrawUploaded(int i_ViewportWidth, int i_ViewportHeight, const Application* p_App) const {
+    if (m_i_UploadedVertexCount == 0) return;
+
+    BindForDraw(i_ViewportWidth, i_ViewportHeight, p_App);
+
+    glBindVertexArray(m_VAO_Uploaded);
+    glDrawArrays(GL_TRIANGLES, 0, m_i_UploadedVertexCount);
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+}
+
+void TextBatch::ReleaseUploaded() {
+    if (m_VBO_Uploaded) {
+        glDeleteBuffers(1, &m_VBO_Uploaded);
+        m_VBO_Uploaded = 0;
+    }
+    if (m_VAO_Uploaded) {
+        glDeleteVertexArrays(1, &m_VAO_Uploaded);
+        m_VAO_Uploaded = 0;
+    }
+    m_i_UploadedVertexCount = 0;
+}
+
+float TextBatch::MeasureText(const std::string& s_Text, float f_Scale, const Application* p_App) {
+    float f_W = 0.0f;
+    for (char c : s_Text) {
+        const Character* p_Ch = p_App->GetCharacter(c);
+        if (!p_Ch) continue;
+        f_W += float(p_Ch->m_i_Advance >> 6) * f_Scale;
+    }
+    return f_W;
+}
+
+void TextBatch::SetupVertexAttributes() {
+    const GLsizei i_Stride = k_FloatsPerVertex * sizeof(float);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, i_Stride, (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, i_Stride, (void*)(4 * sizeof(float)));
+}
+
+} // namespace Core
+} // namespace ScotlandYard
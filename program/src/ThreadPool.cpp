@@ -1,5 +1,10 @@
 #include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <string>
 
 namespace ScotlandYard {
 namespace Threading {
@@ -26,7 +31,7 @@ void ThreadPool::Initialize(size_t numThreads) {
     s_b_Shutdown = false;
 
     for (size_t i = 0; i < numThreads; ++i) {
-        s_vec_WorkerThreads.emplace_back(WorkerThread);
+        s_vec_WorkerThreads.emplace_back(WorkerThread, i);
     }
 
     s_b_Initialized = true;
@@ -58,7 +63,10 @@ void ThreadPool::Shutdown() {
     s_b_Initialized = false;
 }
 
-void ThreadPool::WorkerThread() {
+void ThreadPool::WorkerThread(size_t i_WorkerIndex) {
+    const std::string s_ThreadName = "Worker " + std::to_string(i_WorkerIndex);
+    Core::TraceRecorder::SetThreadName(s_ThreadName.c_str());
+
     while (true) {
         std::function<void()> task;
 
@@ -80,6 +88,7 @@ void ThreadPool::WorkerThread() {
         }
 
         if (task) {
+            TRACE_SCOPE("ThreadPool::Task");
             try {
                 task();
             } catch (const std::exception& e) {
@@ -91,6 +100,71 @@ void ThreadPool::WorkerThread() {
     }
 }
 
+namespace {
+    struct ParallelForState {
+        std::function<void(size_t)> fn_Body;
+        size_t num_Count = 0;
+        std::atomic<size_t> num_Next{0};
+        std::atomic<size_t> num_Done{0};
+        std::exception_ptr p_Exception;
+        std::mutex mtx_Done;
+        std::condition_variable cv_Done;
+    };
+
+    // Claims indices until the range is exhausted. Helpers that start after the
+    // caller has returned find nothing left and never touch fn_Body.
+    void DrainParallelFor(ParallelForState& state) {
+        size_t i;
+        while ((i = state.num_Next.fetch_add(1)) < state.num_Count) {
+            try {
+                state.fn_Body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mtx_Done);
+                if (!state.p_Exception) state.p_Exception = std::current_exception();
+            }
+
+            if (state.num_Done.fetch_add(1) + 1 == state.num_Count) {
+                std::lock_guard<std::mutex> lock(state.mtx_Done);
+                state.cv_Done.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::ParallelFor(size_t num_Count, const std::function<void(size_t)>& fn_Body) {
+    if (num_Count == 0) return;
+
+    size_t num_Helpers = s_b_Initialized ? std::min(s_vec_WorkerThreads.size(), num_Count - 1) : 0;
+    if (num_Helpers == 0) {
+        for (size_t i = 0; i < num_Count; ++i) fn_Body(i);
+        return;
+    }
+
+    auto sp_State = std::make_shared<ParallelForState>();
+    sp_State->fn_Body = fn_Body;
+    sp_State->num_Count = num_Count;
+
+    {
+        std::unique_lock<std::mutex> lock(s_mtx_Queue);
+        for (size_t h = 0; h < num_Helpers; ++h) {
+            s_queue_Tasks.emplace([sp_State]() { DrainParallelFor(*sp_State); });
+        }
+    }
+    s_cv_Task.notify_all();
+
+    DrainParallelFor(*sp_State);
+
+    // Only indices already claimed by running helpers can still be in flight
+    {
+        std::unique_lock<std::mutex> lock(sp_State->mtx_Done);
+        sp_State->cv_Done.wait(lock, [&] { return sp_State->num_Done.load() == num_Count; });
+    }
+
+    if (sp_State->p_Exception) {
+        std::rethrow_exception(sp_State->p_Exception);
+    }
+}
+
 size_t ThreadPool::GetThreadCount() {
     return s_vec_WorkerThreads.size();
 }
@@ -0,0 +1,127 @@
+#include "TraceRecorder.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace ScotlandYard {
+namespace Core {
+
+std::atomic<bool> TraceRecorder::s_b_Enabled(false);
+std::mutex TraceRecorder::s_mtx_Buffers;
+std::vector<std::unique_ptr<TraceRecorder::ThreadBuffer>> TraceRecorder::s_vec_Buffers;
+const std::chrono::steady_clock::time_point TraceRecorder::s_tp_Origin = std::chrono::steady_clock::now();
+
+namespace {
+    void WriteJsonString(std::ostream& out, const char* p_Text) {
+        out << '"';
+        for (const char* p = p_Text; *p; ++p) {
+            char c = *p;
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << ' ';
+            } else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+}
+
+void TraceRecorder::SetEnabled(bool b_Enabled) {
+    s_b_Enabled.store(b_Enabled, std::memory_order_relaxed);
+}
+
+int64_t TraceRecorder::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - s_tp_Origin).count();
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::GetThreadBuffer() {
+    thread_local ThreadBuffer* p_Buffer = nullptr;
+    if (!p_Buffer) {
+        auto u_Buffer = std::make_unique<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(s_mtx_Buffers);
+        u_Buffer->u32_ThreadId = static_cast<uint32_t>(s_vec_Buffers.size()) + 1;
+        std::snprintf(u_Buffer->arr_Name, k_MaxThreadNameLength, "Thread %u", u_Buffer->u32_ThreadId);
+        p_Buffer = u_Buffer.get();
+        s_vec_Buffers.push_back(std::move(u_Buffer));
+    }
+    return *p_Buffer;
+}
+
+void TraceRecorder::SetThreadName(const char* p_Name) {
+    // Naming registers a buffer, so leave untraced runs without one
+    if (!IsEnabled()) return;
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(s_mtx_Buffers);
+    std::snprintf(buffer.arr_Name, k_MaxThreadNameLength, "%s", p_Name);
+}
+
+void TraceRecorder::Record(const char* p_Name, int64_t i64_StartNs, int64_t i64_DurationNs) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    uint32_t u32_Index = buffer.u32_Count.load(std::memory_order_relaxed);
+    if (u32_Index >= k_EventsPerThread) {
+        buffer.u32_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.arr_Events[u32_Index] = Event{p_Name, i64_StartNs, i64_DurationNs};
+    buffer.u32_Count.store(u32_Index + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::ExportChromeTrace(const std::string& s_Path) {
+    std::ofstream file(s_Path);
+    if (!file.is_open()) {
+        std::cerr << "[TraceRecorder] Could not open " << s_Path << " for writing\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mtx_Buffers);
+
+    size_t num_Events = 0;
+    uint32_t u32_Dropped = 0;
+    bool b_First = true;
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file.setf(std::ios::fixed);
+    file.precision(3);
+
+    for (const auto& u_Buffer : s_vec_Buffers) {
+        if (!b_First) file << ",\n";
+        b_First = false;
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << u_Buffer->u32_ThreadId
+             << ",\"args\":{\"name\":";
+        WriteJsonString(file, u_Buffer->arr_Name);
+        file << "}}";
+
+        uint32_t u32_Count = u_Buffer->u32_Count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < u32_Count; ++i) {
+            const Event& event = u_Buffer->arr_Events[i];
+            file << ",\n{\"name\":";
+            WriteJsonString(file, event.p_Name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << u_Buffer->u32_ThreadId
+                 << ",\"ts\":" << event.i64_StartNs / 1000.0
+                 << ",\"dur\":" << event.i64_DurationNs / 1000.0 << '}';
+        }
+
+        num_Events += u32_Count;
+        u32_Dropped += u_Buffer->u32_Dropped.load(std::memory_order_relaxed);
+    }
+
+    file << "\n]}\n";
+
+    std::cout << "[TraceRecorder] Wrote " << num_Events << " events from " << s_vec_Buffers.size()
+              << " threads to " << s_Path;
+    if (u32_Dropped > 0) {
+        std::cout << " (" << u32_Dropped << " dropped, buffers full)";
+    }
+    std::cout << std::endl;
+
+    return file.good();
+}
+
+} // namespace Core
+} // namespace ScotlandYard
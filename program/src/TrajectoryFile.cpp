@@ -0,0 +1,127 @@
+#include "TrajectoryFile.h"
+#include "BinaryMap.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace ScotlandYard {
+namespace AI {
+
+namespace {
+    constexpr float k_PolicyScale = 65535.0f;
+    constexpr size_t k_ShardDigits = 5;
+}
+
+std::string MakeTrajectoryShardName(const std::string& s_Prefix, uint32_t u32_Index) {
+    std::string s_Number = std::to_string(u32_Index);
+    if (s_Number.size() < k_ShardDigits) {
+        s_Number.insert(0, k_ShardDigits - s_Number.size(), '0');
+    }
+    return s_Prefix + "-" + s_Number + k_TrajectoryExtension;
+}
+
+bool ParseTrajectoryShardName(const std::string& s_FileName, const std::string& s_Prefix, uint32_t& u32_Index) {
+    const std::string s_Extension = k_TrajectoryExtension;
+    const size_t num_Fixed = s_Prefix.size() + 1 + s_Extension.size();
+    if (s_FileName.size() <= num_Fixed || s_FileName.compare(0, s_Prefix.size(), s_Prefix) != 0 ||
+        s_FileName[s_Prefix.size()] != '-' ||
+        s_FileName.compare(s_FileName.size() - s_Extension.size(), s_Extension.size(), s_Extension) != 0) {
+        return false;
+    }
+
+    uint64_t u64_Index = 0;
+    for (size_t i = s_Prefix.size() + 1; i < s_FileName.size() - s_Extension.size(); ++i) {
+        char c = s_FileName[i];
+        if (c < '0' || c > '9') return false;
+        u64_Index = u64_Index * 10 + static_cast<uint64_t>(c - '0');
+        if (u64_Index > 0xFFFFFFFFull) return false;
+    }
+    u32_Index = static_cast<uint32_t>(u64_Index);
+    return true;
+}
+
+TrajectoryLayout::TrajectoryLayout(uint32_t u32_NodeCount, uint32_t u32_ActionCount)
+    : m_u32_NodeCount(u32_NodeCount)
+    , m_u32_ActionCount(u32_ActionCount)
+    , m_u32_MaskWords((u32_NodeCount + 63) / 64)
+    , m_u32_StepBytes(static_cast<uint32_t>(sizeof(TrajectoryStepHeader)) + m_u32_MaskWords * 8
+                      + ((u32_ActionCount * 2 + 7) & ~7u))
+{
+}
+
+void TrajectoryLayout::FillHeader(TrajectoryShardHeader& header) const {
+    header = TrajectoryShardHeader{};
+    std::memcpy(header.arr_Magic, k_TrajectoryShardMagic, sizeof(k_TrajectoryShardMagic));
+    header.u32_Version = k_TrajectoryVersion;
+    header.u32_PlayerCount = Core::k_PlayerCount;
+    header.u32_NodeCount = m_u32_NodeCount;
+    header.u32_ActionCount = m_u32_ActionCount;
+    header.u32_MaskWords = m_u32_MaskWords;
+    header.u32_StepBytes = m_u32_StepBytes;
+    header.u64_HeaderChecksum = Utils::BinaryMap::Checksum(&header, offsetof(TrajectoryShardHeader, u64_HeaderChecksum));
+}
+
+bool TrajectoryLayout::Matches(const TrajectoryShardHeader& header) const {
+    return header.u32_PlayerCount == static_cast<uint32_t>(Core::k_PlayerCount)
+        && header.u32_NodeCount == m_u32_NodeCount
+        && header.u32_ActionCount == m_u32_ActionCount
+        && header.u32_MaskWords == m_u32_MaskWords
+        && header.u32_StepBytes == m_u32_StepBytes;
+}
+
+void TrajectoryLayout::PackStep(uint8_t* p_Step, const Core::RulesState& state, const uint64_t* p_PossibleMisterX,
+                                uint32_t u32_Action, const float* p_Policy) const {
+    TrajectoryStepHeader header{};
+    for (int i = 0; i < Core::k_PlayerCount; ++i) {
+        header.arr_Positions[i] = static_cast<uint16_t>(state.arr_Positions[i]);
+    }
+    std::memcpy(header.arr_Tickets, state.arr_Tickets, sizeof(header.arr_Tickets));
+    header.u8_Round = state.u8_Round;
+    header.u8_Turn = state.u8_Turn;
+    header.u8_Action = static_cast<uint8_t>(u32_Action);
+    std::memcpy(p_Step, &header, sizeof(header));
+    p_Step += sizeof(header);
+
+    std::memcpy(p_Step, p_PossibleMisterX, m_u32_MaskWords * sizeof(uint64_t));
+    p_Step += m_u32_MaskWords * sizeof(uint64_t);
+
+    uint8_t* p_PolicyEnd = p_Step + ((m_u32_ActionCount * 2 + 7) & ~7u);
+    for (uint32_t a = 0; a < m_u32_ActionCount; ++a) {
+        float f_Scaled = std::min(std::max(p_Policy[a], 0.0f), 1.0f) * k_PolicyScale + 0.5f;
+        uint16_t u16_Value = static_cast<uint16_t>(f_Scaled);
+        std::memcpy(p_Step, &u16_Value, sizeof(u16_Value));
+        p_Step += sizeof(u16_Value);
+    }
+    std::fill(p_Step, p_PolicyEnd, uint8_t{0});
+}
+
+void TrajectoryLayout::UnpackStep(const uint8_t* p_Step, Core::RulesState& state, uint64_t* p_PossibleMisterX,
+                                  uint32_t& u32_Action, float* p_Policy) const {
+    TrajectoryStepHeader header;
+    std::memcpy(&header, p_Step, sizeof(header));
+    p_Step += sizeof(header);
+    for (int i = 0; i < Core::k_PlayerCount; ++i) {
+        state.arr_Positions[i] = header.arr_Positions[i];
+    }
+    std::memcpy(state.arr_Tickets, header.arr_Tickets, sizeof(header.arr_Tickets));
+    state.u8_Round = header.u8_Round;
+    state.u8_Turn = header.u8_Turn;
+    state.e_Outcome = Core::GameOutcome::None;
+    u32_Action = header.u8_Action;
+
+    if (p_PossibleMisterX) {
+        std::memcpy(p_PossibleMisterX, p_Step, m_u32_MaskWords * sizeof(uint64_t));
+    }
+    p_Step += m_u32_MaskWords * sizeof(uint64_t);
+
+    if (p_Policy) {
+        for (uint32_t a = 0; a < m_u32_ActionCount; ++a) {
+            uint16_t u16_Value;
+            std::memcpy(&u16_Value, p_Step + a * sizeof(uint16_t), sizeof(u16_Value));
+            p_Policy[a] = u16_Value / k_PolicyScale;
+        }
+    }
+}
+
+} // namespace AI
+} // namespace ScotlandYard
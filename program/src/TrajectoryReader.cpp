@@ -0,0 +1,252 @@
+#include "TrajectoryReader.h"
+#include "BinaryMap.h"
+#include "Lz4Block.h"
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+namespace ScotlandYard {
+namespace AI {
+
+namespace {
+    // Decompressed chunk and one step's possible-Mr-X mask, per decoding thread
+    struct DecodeScratch {
+        std::vector<uint8_t> vec_Chunk;
+        std::vector<uint64_t> vec_Mask;
+    };
+
+    DecodeScratch& GetDecodeScratch() {
+        thread_local DecodeScratch t_Scratch;
+        return t_Scratch;
+    }
+}
+
+bool TrajectoryReader::Open(const std::string& s_Directory, const std::string& s_Prefix) {
+    TRACE_SCOPE("TrajectoryReader::Open");
+    Close();
+
+    std::error_code ec;
+    std::vector<std::pair<uint32_t, std::string>> vec_Files;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(s_Directory, ec)) {
+        uint32_t u32_Index;
+        if (ParseTrajectoryShardName(entry.path().filename().string(), s_Prefix, u32_Index)) {
+            vec_Files.emplace_back(u32_Index, entry.path().string());
+        }
+    }
+    if (ec) {
+        std::cerr << "[TrajectoryReader] ERROR: Cannot list " << s_Directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+    if (vec_Files.empty()) {
+        std::cerr << "[TrajectoryReader] ERROR: No " << s_Prefix << "-*" << k_TrajectoryExtension << " shards in "
+                  << s_Directory << std::endl;
+        return false;
+    }
+    std::sort(vec_Files.begin(), vec_Files.end());
+
+    for (const auto& file : vec_Files) {
+        if (!IndexShard(static_cast<uint32_t>(m_vec_Shards.size()), file.second)) {
+            Close();
+            return false;
+        }
+    }
+    if (m_vec_Shards.empty()) {
+        std::cerr << "[TrajectoryReader] ERROR: No complete " << s_Prefix << "-*" << k_TrajectoryExtension
+                  << " shards in " << s_Directory << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void TrajectoryReader::Close() {
+    m_vec_Shards.clear();
+    m_vec_Chunks.clear();
+    m_Layout = TrajectoryLayout();
+    m_u64_StepCount = 0;
+    m_u64_TrajectoryCount = 0;
+}
+
+bool TrajectoryReader::IndexShard(uint32_t u32_Shard, const std::string& s_Path) {
+    auto fail = [&](const char* p_Reason) {
+        std::cerr << "[TrajectoryReader] ERROR: " << s_Path << ": " << p_Reason << std::endl;
+        return false;
+    };
+
+    Utils::MappedFile file;
+    if (!file.Open(s_Path, Utils::MappedFile::Access::Resident)) {
+        return fail("cannot map file");
+    }
+
+    const size_t num_Size = file.GetSize();
+    const char* p_Data = file.GetData();
+    TrajectoryShardHeader header;
+    // A shard being created right now, or cut short by a crash before its
+    // header was flushed, holds nothing yet: skip it like a truncated tail
+    if (num_Size < sizeof(header)) {
+        std::cerr << "[TrajectoryReader] WARNING: " << s_Path << ": skipping shard without a complete header"
+                  << std::endl;
+        return true;
+    }
+    std::memcpy(&header, p_Data, sizeof(header));
+    if (std::memcmp(header.arr_Magic, k_TrajectoryShardMagic, sizeof(header.arr_Magic)) != 0) {
+        return fail("not a trajectory shard");
+    }
+    if (header.u32_Version != k_TrajectoryVersion) {
+        return fail("unsupported version");
+    }
+    if (header.u64_HeaderChecksum != Utils::BinaryMap::Checksum(&header, offsetof(TrajectoryShardHeader, u64_HeaderChecksum))) {
+        return fail("shard header checksum mismatch");
+    }
+
+    if (m_vec_Shards.empty()) {
+        m_Layout = TrajectoryLayout(header.u32_NodeCount, header.u32_ActionCount);
+    }
+    if (!m_Layout.Matches(header)) {
+        return fail("recorded on another map than the other shards");
+    }
+
+    // Chunks up to the first that is incomplete or damaged
+    size_t num_Offset = sizeof(header);
+    while (num_Size - num_Offset >= sizeof(TrajectoryChunkHeader)) {
+        TrajectoryChunkHeader chunk;
+        std::memcpy(&chunk, p_Data + num_Offset, sizeof(chunk));
+        if (std::memcmp(chunk.arr_Magic, k_TrajectoryChunkMagic, sizeof(chunk.arr_Magic)) != 0 ||
+            chunk.u64_HeaderChecksum != Utils::BinaryMap::Checksum(&chunk, offsetof(TrajectoryChunkHeader, u64_HeaderChecksum)) ||
+            chunk.u32_CompressedBytes > num_Size - num_Offset - sizeof(chunk) ||
+            chunk.u32_StepCount == 0 ||
+            chunk.u32_RawBytes != chunk.u32_TrajectoryCount * sizeof(TrajectoryRecord)
+                                  + static_cast<uint64_t>(chunk.u32_StepCount) * m_Layout.GetStepBytes()) {
+            break;
+        }
+
+        ChunkEntry entry;
+        entry.u64_FirstStep = m_u64_StepCount;
+        entry.u64_PayloadOffset = num_Offset + sizeof(chunk);
+        entry.u64_PayloadChecksum = chunk.u64_PayloadChecksum;
+        entry.u32_Shard = u32_Shard;
+        entry.u32_CompressedBytes = chunk.u32_CompressedBytes;
+        entry.u32_RawBytes = chunk.u32_RawBytes;
+        entry.u32_TrajectoryCount = chunk.u32_TrajectoryCount;
+        entry.u32_StepCount = chunk.u32_StepCount;
+        m_vec_Chunks.push_back(entry);
+
+        m_u64_StepCount += chunk.u32_StepCount;
+        m_u64_TrajectoryCount += chunk.u32_TrajectoryCount;
+        num_Offset += sizeof(chunk) + chunk.u32_CompressedBytes;
+    }
+    if (num_Offset != num_Size) {
+        std::cerr << "[TrajectoryReader] WARNING: " << s_Path << ": ignoring " << num_Size - num_Offset
+                  << " bytes after the last complete chunk" << std::endl;
+    }
+
+    m_vec_Shards.push_back(std::move(file));
+    return true;
+}
+
+bool TrajectoryReader::Sample(size_t num_Rows, std::mt19937_64& rng, const Core::FeatureEncoder& encoder,
+                              TrajectoryBatch& batch) const {
+    TRACE_SCOPE("TrajectoryReader::Sample");
+    if (m_u64_StepCount == 0) {
+        std::cerr << "[TrajectoryReader] ERROR: No steps to sample" << std::endl;
+        return false;
+    }
+    if (encoder.GetNodeCount() != m_Layout.GetNodeCount() || encoder.GetActionCount() != m_Layout.GetActionCount()) {
+        std::cerr << "[TrajectoryReader] ERROR: Encoder is for another map than the recorded games" << std::endl;
+        return false;
+    }
+
+    const size_t num_Features = encoder.GetFeatureSize();
+    const size_t num_Actions = m_Layout.GetActionCount();
+    batch.num_Rows = num_Rows;
+    batch.vec_Features.resize(num_Rows * num_Features);
+    batch.vec_Policy.resize(num_Rows * num_Actions);
+    batch.vec_Values.resize(num_Rows);
+    batch.vec_Actions.resize(num_Rows);
+
+    std::uniform_int_distribution<uint64_t> dist(0, m_u64_StepCount - 1);
+    std::vector<uint64_t> vec_Steps(num_Rows);
+    for (uint64_t& u64_Step : vec_Steps) {
+        u64_Step = dist(rng);
+    }
+    std::sort(vec_Steps.begin(), vec_Steps.end());
+
+    // Runs of rows that fall in the same chunk
+    struct Group { size_t i_Chunk; size_t i_FirstRow; size_t num_Rows; };
+    std::vector<Group> vec_Groups;
+    size_t i_Row = 0;
+    while (i_Row < num_Rows) {
+        auto it = std::upper_bound(m_vec_Chunks.begin(), m_vec_Chunks.end(), vec_Steps[i_Row],
+                                   [](uint64_t u64_Step, const ChunkEntry& chunk) { return u64_Step < chunk.u64_FirstStep; });
+        size_t i_Chunk = static_cast<size_t>(it - m_vec_Chunks.begin()) - 1;
+        uint64_t u64_End = m_vec_Chunks[i_Chunk].u64_FirstStep + m_vec_Chunks[i_Chunk].u32_StepCount;
+        size_t i_End = i_Row + 1;
+        while (i_End < num_Rows && vec_Steps[i_End] < u64_End) ++i_End;
+        vec_Groups.push_back({ i_Chunk, i_Row, i_End - i_Row });
+        i_Row = i_End;
+    }
+
+    std::atomic<bool> b_Ok(true);
+    const uint64_t* p_Steps = vec_Steps.data();
+    Threading::ThreadPool::ParallelFor(vec_Groups.size(), [&](size_t i_Group) {
+        const Group& group = vec_Groups[i_Group];
+        if (!DecodeSteps(m_vec_Chunks[group.i_Chunk], p_Steps + group.i_FirstRow, group.num_Rows, group.i_FirstRow,
+                         encoder, batch)) {
+            b_Ok.store(false, std::memory_order_relaxed);
+        }
+    });
+    return b_Ok.load();
+}
+
+bool TrajectoryReader::DecodeSteps(const ChunkEntry& chunk, const uint64_t* p_Steps, size_t num_Steps,
+                                   size_t i_FirstRow, const Core::FeatureEncoder& encoder,
+                                   TrajectoryBatch& batch) const {
+    DecodeScratch& scratch = GetDecodeScratch();
+    std::vector<uint8_t>& vec_Chunk = scratch.vec_Chunk;
+    vec_Chunk.resize(chunk.u32_RawBytes);
+    const uint8_t* p_Payload = reinterpret_cast<const uint8_t*>(m_vec_Shards[chunk.u32_Shard].GetData())
+                               + chunk.u64_PayloadOffset;
+    if (!Utils::Lz4Decompress(p_Payload, chunk.u32_CompressedBytes, vec_Chunk.data(), vec_Chunk.size()) ||
+        Utils::BinaryMap::Checksum(vec_Chunk.data(), vec_Chunk.size()) != chunk.u64_PayloadChecksum) {
+        std::cerr << "[TrajectoryReader] ERROR: Chunk at offset " << chunk.u64_PayloadOffset << " of shard "
+                  << chunk.u32_Shard << " is corrupt" << std::endl;
+        return false;
+    }
+
+    const TrajectoryRecord* p_Records = reinterpret_cast<const TrajectoryRecord*>(vec_Chunk.data());
+    const TrajectoryRecord* p_RecordsEnd = p_Records + chunk.u32_TrajectoryCount;
+    const uint8_t* p_StepData = vec_Chunk.data() + chunk.u32_TrajectoryCount * sizeof(TrajectoryRecord);
+
+    const size_t num_Features = encoder.GetFeatureSize();
+    const size_t num_Actions = m_Layout.GetActionCount();
+    scratch.vec_Mask.resize(m_Layout.GetMaskWords());
+    uint64_t* p_Mask = scratch.vec_Mask.data();
+
+    for (size_t i = 0; i < num_Steps; ++i) {
+        uint32_t u32_Step = static_cast<uint32_t>(p_Steps[i] - chunk.u64_FirstStep);
+        const TrajectoryRecord* p_Record = std::upper_bound(p_Records, p_RecordsEnd, u32_Step,
+            [](uint32_t u32_Value, const TrajectoryRecord& record) { return u32_Value < record.u32_FirstStep; }) - 1;
+        if (p_Record < p_Records) {
+            std::cerr << "[TrajectoryReader] ERROR: Step outside every trajectory in shard " << chunk.u32_Shard << std::endl;
+            return false;
+        }
+
+        size_t i_Row = i_FirstRow + i;
+        Core::RulesState state;
+        uint32_t u32_Action;
+        m_Layout.UnpackStep(p_StepData + static_cast<size_t>(u32_Step) * m_Layout.GetStepBytes(), state, p_Mask,
+                            u32_Action, &batch.vec_Policy[i_Row * num_Actions]);
+        encoder.Encode(state, p_Mask, &batch.vec_Features[i_Row * num_Features]);
+        batch.vec_Values[i_Row] = state.u8_Turn == 0 ? p_Record->i8_Outcome : -p_Record->i8_Outcome;
+        batch.vec_Actions[i_Row] = u32_Action;
+    }
+    return true;
+}
+
+} // namespace AI
+} // namespace ScotlandYard
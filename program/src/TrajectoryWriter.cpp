@@ -0,0 +1,266 @@
+#include "TrajectoryWriter.h"
+#include "BinaryMap.h"
+#include "Lz4Block.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace ScotlandYard {
+namespace AI {
+
+namespace {
+    // How long the I/O thread sleeps when there is nothing to write; producers
+    // never wake it, so this bounds how stale the newest chunk on disk can be
+    constexpr auto k_IdleSleep = std::chrono::milliseconds(2);
+}
+
+TrajectoryBlock::TrajectoryBlock(uint32_t u32_StepBytes, uint32_t u32_CapacitySteps)
+    : m_u32_StepBytes(u32_StepBytes)
+    , m_u32_CapacitySteps(u32_CapacitySteps)
+    , m_u32_StepCount(0)
+{
+    m_vec_Steps.resize(static_cast<size_t>(u32_StepBytes) * u32_CapacitySteps);
+    m_vec_Records.reserve(u32_CapacitySteps / 8 + 1);
+}
+
+bool TrajectoryBlock::Append(const uint8_t* p_Steps, uint32_t u32_StepCount, int8_t i8_Outcome) {
+    if (u32_StepCount == 0 || u32_StepCount > k_MaxTrajectorySteps ||
+        u32_StepCount > m_u32_CapacitySteps - m_u32_StepCount) {
+        return false;
+    }
+
+    TrajectoryRecord record{};
+    record.u32_FirstStep = m_u32_StepCount;
+    record.u16_StepCount = static_cast<uint16_t>(u32_StepCount);
+    record.i8_Outcome = i8_Outcome;
+    m_vec_Records.push_back(record);
+
+    std::memcpy(m_vec_Steps.data() + static_cast<size_t>(m_u32_StepCount) * m_u32_StepBytes, p_Steps,
+                static_cast<size_t>(u32_StepCount) * m_u32_StepBytes);
+    m_u32_StepCount += u32_StepCount;
+    return true;
+}
+
+void TrajectoryBlock::Clear() {
+    m_vec_Records.clear();
+    m_u32_StepCount = 0;
+}
+
+TrajectoryWriter::TrajectoryWriter()
+    : m_b_Open(false)
+    , m_b_Stopping(false)
+    , m_u64_ShardSize(0)
+    , m_u32_NextShard(0)
+    , m_b_Failed(false)
+    , m_u64_Trajectories(0)
+    , m_u64_Steps(0)
+    , m_u64_Dropped(0)
+    , m_u64_RawBytes(0)
+    , m_u64_CompressedBytes(0)
+    , m_u32_ShardsWritten(0)
+{
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    Close();
+}
+
+bool TrajectoryWriter::Open(const TrajectoryLayout& layout, const TrajectoryWriterOptions& options) {
+    Close();
+
+    if (!layout.Fits()) {
+        std::cerr << "[TrajectoryWriter] ERROR: " << layout.GetNodeCount() << " nodes and " << layout.GetActionCount()
+                  << " actions do not fit the step format" << std::endl;
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.s_Directory, ec);
+    if (ec) {
+        std::cerr << "[TrajectoryWriter] ERROR: Cannot create " << options.s_Directory << ": " << ec.message()
+                  << std::endl;
+        return false;
+    }
+
+    // Continue after the highest shard already there
+    m_u32_NextShard = 0;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(options.s_Directory, ec)) {
+        uint32_t u32_Index;
+        if (ParseTrajectoryShardName(entry.path().filename().string(), options.s_Prefix, u32_Index)) {
+            m_u32_NextShard = std::max(m_u32_NextShard, u32_Index + 1);
+        }
+    }
+
+    m_Layout = layout;
+    m_Options = options;
+    // A block must hold the longest game
+    m_Options.u32_ChunkSteps = std::max(options.u32_ChunkSteps, k_MaxTrajectorySteps);
+    m_Options.u32_Blocks = std::max<uint32_t>(options.u32_Blocks, 2);
+
+    // The full queue can hold every block, so SubmitBlock() always succeeds
+    m_vec_p_Blocks.clear();
+    m_p_FreeBlocks = std::make_unique<Threading::MpmcQueue<TrajectoryBlock*>>(m_Options.u32_Blocks);
+    m_p_FullBlocks = std::make_unique<Threading::MpmcQueue<TrajectoryBlock*>>(m_Options.u32_Blocks);
+    for (uint32_t i = 0; i < m_Options.u32_Blocks; ++i) {
+        m_vec_p_Blocks.emplace_back(new TrajectoryBlock(layout.GetStepBytes(), m_Options.u32_ChunkSteps));
+        m_p_FreeBlocks->TryPush(m_vec_p_Blocks.back().get());
+    }
+
+    m_u64_Trajectories = 0;
+    m_u64_Steps = 0;
+    m_u64_Dropped = 0;
+    m_u64_RawBytes = 0;
+    m_u64_CompressedBytes = 0;
+    m_u32_ShardsWritten = 0;
+    m_b_Failed = false;
+    m_b_Stopping = false;
+    m_b_Open = true;
+    m_t_Io = std::thread(&TrajectoryWriter::IoThread, this);
+    return true;
+}
+
+void TrajectoryWriter::Close() {
+    if (!m_b_Open) {
+        return;
+    }
+
+    m_b_Stopping.store(true, std::memory_order_release);
+    if (m_t_Io.joinable()) {
+        m_t_Io.join();
+    }
+    if (m_File.is_open()) {
+        m_File.close();
+    }
+    m_p_FreeBlocks.reset();
+    m_p_FullBlocks.reset();
+    m_vec_p_Blocks.clear();
+    m_b_Open = false;
+}
+
+TrajectoryBlock* TrajectoryWriter::AcquireBlock() {
+    TrajectoryBlock* p_Block = nullptr;
+    return m_b_Open && m_p_FreeBlocks->TryPop(p_Block) ? p_Block : nullptr;
+}
+
+void TrajectoryWriter::SubmitBlock(TrajectoryBlock* p_Block) {
+    if (!p_Block) {
+        return;
+    }
+    if (p_Block->IsEmpty()) {
+        m_p_FreeBlocks->TryPush(p_Block);
+        return;
+    }
+    m_p_FullBlocks->TryPush(p_Block);
+}
+
+void TrajectoryWriter::IoThread() {
+    Core::TraceRecorder::SetThreadName("TrajectoryWriter");
+
+    TrajectoryBlock* p_Block = nullptr;
+    while (true) {
+        if (m_p_FullBlocks->TryPop(p_Block)) {
+            WriteBlock(*p_Block);
+            p_Block->Clear();
+            m_p_FreeBlocks->TryPush(p_Block);
+            continue;
+        }
+
+        if (m_b_Stopping.load(std::memory_order_acquire)) {
+            // Everything submitted before Close() is visible now
+            while (m_p_FullBlocks->TryPop(p_Block)) {
+                WriteBlock(*p_Block);
+                p_Block->Clear();
+                m_p_FreeBlocks->TryPush(p_Block);
+            }
+            break;
+        }
+        std::this_thread::sleep_for(k_IdleSleep);
+    }
+}
+
+void TrajectoryWriter::WriteBlock(TrajectoryBlock& block) {
+    TRACE_SCOPE("TrajectoryWriter::WriteBlock");
+    if (m_b_Failed) {
+        m_u64_Dropped.fetch_add(block.GetTrajectoryCount(), std::memory_order_relaxed);
+        return;
+    }
+
+    const size_t num_RecordBytes = block.m_vec_Records.size() * sizeof(TrajectoryRecord);
+    const size_t num_StepBytes = static_cast<size_t>(block.m_u32_StepCount) * block.m_u32_StepBytes;
+    m_vec_Raw.resize(num_RecordBytes + num_StepBytes);
+    std::memcpy(m_vec_Raw.data(), block.m_vec_Records.data(), num_RecordBytes);
+    std::memcpy(m_vec_Raw.data() + num_RecordBytes, block.m_vec_Steps.data(), num_StepBytes);
+
+    m_vec_Compressed.resize(Utils::Lz4CompressBound(m_vec_Raw.size()));
+    size_t num_Compressed = Utils::Lz4Compress(m_vec_Raw.data(), m_vec_Raw.size(), m_vec_Compressed.data(),
+                                               m_vec_Compressed.size());
+
+    TrajectoryChunkHeader header{};
+    std::memcpy(header.arr_Magic, k_TrajectoryChunkMagic, sizeof(k_TrajectoryChunkMagic));
+    header.u32_RawBytes = static_cast<uint32_t>(m_vec_Raw.size());
+    header.u32_CompressedBytes = static_cast<uint32_t>(num_Compressed);
+    header.u32_TrajectoryCount = block.GetTrajectoryCount();
+    header.u32_StepCount = block.m_u32_StepCount;
+    header.u64_PayloadChecksum = Utils::BinaryMap::Checksum(m_vec_Raw.data(), m_vec_Raw.size());
+    header.u64_HeaderChecksum = Utils::BinaryMap::Checksum(&header, offsetof(TrajectoryChunkHeader, u64_HeaderChecksum));
+
+    if ((!m_File.is_open() || m_u64_ShardSize >= m_Options.u64_ShardBytes) && !OpenNextShard()) {
+        m_b_Failed = true;
+        m_u64_Dropped.fetch_add(block.GetTrajectoryCount(), std::memory_order_relaxed);
+        return;
+    }
+
+    // One flush per chunk, so a reader never sees half of one
+    m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_File.write(reinterpret_cast<const char*>(m_vec_Compressed.data()), static_cast<std::streamsize>(num_Compressed));
+    m_File.flush();
+    if (!m_File) {
+        std::cerr << "[TrajectoryWriter] ERROR: Write to shard " << m_u32_NextShard - 1
+                  << " failed; dropping further trajectories" << std::endl;
+        m_b_Failed = true;
+        m_u64_Dropped.fetch_add(block.GetTrajectoryCount(), std::memory_order_relaxed);
+        return;
+    }
+
+    m_u64_ShardSize += sizeof(header) + num_Compressed;
+    m_u64_Trajectories.fetch_add(block.GetTrajectoryCount(), std::memory_order_relaxed);
+    m_u64_Steps.fetch_add(block.m_u32_StepCount, std::memory_order_relaxed);
+    m_u64_RawBytes.fetch_add(m_vec_Raw.size(), std::memory_order_relaxed);
+    m_u64_CompressedBytes.fetch_add(num_Compressed, std::memory_order_relaxed);
+}
+
+bool TrajectoryWriter::OpenNextShard() {
+    if (m_File.is_open()) {
+        m_File.close();
+    }
+
+    std::filesystem::path path = std::filesystem::path(m_Options.s_Directory)
+                                 / MakeTrajectoryShardName(m_Options.s_Prefix, m_u32_NextShard);
+    m_File.clear();
+    m_File.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_File) {
+        std::cerr << "[TrajectoryWriter] ERROR: Cannot create " << path.string() << std::endl;
+        return false;
+    }
+
+    TrajectoryShardHeader header;
+    m_Layout.FillHeader(header);
+    m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_File.flush();
+    if (!m_File) {
+        std::cerr << "[TrajectoryWriter] ERROR: Cannot write " << path.string() << std::endl;
+        return false;
+    }
+
+    ++m_u32_NextShard;
+    m_u32_ShardsWritten.fetch_add(1, std::memory_order_relaxed);
+    m_u64_ShardSize = sizeof(header);
+    return true;
+}
+
+} // namespace AI
+} // namespace ScotlandYard
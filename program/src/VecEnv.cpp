@@ -0,0 +1,187 @@
+#include "VecEnv.h"
+#include "MapAsset.h"
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace ScotlandYard {
+namespace Core {
+
+namespace {
+    // Draws of a fresh start before giving up on a map where Mr X can never move
+    constexpr int k_MaxResetAttempts = 1000;
+
+    bool HasUsableEdge(const RulesState& state, const RulesGraph& graph) {
+        uint32_t u32_Node = state.arr_Positions[state.u8_Turn];
+        for (uint32_t e = graph.GetEdgeBegin(u32_Node); e < graph.GetEdgeEnd(u32_Node); ++e) {
+            if (GameRules::CanUseEdge(state, graph, e)) return true;
+        }
+        return false;
+    }
+
+    // Detectives with nothing to ride sit out their turn; a cornered Mr X loses
+    void SkipStuckPlayers(RulesState& state, const RulesGraph& graph) {
+        while (state.e_Outcome == GameOutcome::None && !HasUsableEdge(state, graph)) {
+            GameRules::ApplyMove(state, graph, GameRules::k_Pass);
+        }
+    }
+}
+
+VecEnv::VecEnv(std::shared_ptr<const MapAsset> sp_Map, size_t num_Envs, uint64_t u64_Seed)
+    : m_sp_Map(std::move(sp_Map))
+    , m_Graph(m_sp_Map->GetRulesGraph())
+    , m_Encoder(m_Graph)
+    , m_num_Envs(num_Envs)
+    , m_vec_Positions(num_Envs * k_PlayerCount)
+    , m_vec_Tickets(num_Envs * k_PlayerCount * k_TicketTypeCount)
+    , m_vec_Rounds(num_Envs)
+    , m_vec_Turns(num_Envs)
+    , m_vec_LastSeen(num_Envs, k_NotSeen)
+    , m_vec_PossibleMisterX(num_Envs * m_Encoder.GetMaskWords())
+    , m_vec_Dones(num_Envs, 0)
+    , m_vec_Rewards(num_Envs, 0.0f)
+    , m_vec_Observations(num_Envs * m_Encoder.GetFeatureSize(), 0.0f)
+    , m_u64_CompletedGames(0)
+    , m_u64_MisterXWins(0)
+    , m_u64_CompletedRounds(0)
+    , m_u64_InvalidActions(0)
+{
+    size_t num_Chunks = (num_Envs + k_EnvsPerChunk - 1) / k_EnvsPerChunk;
+    m_vec_ChunkRngs.reserve(num_Chunks);
+    for (size_t c = 0; c < num_Chunks; ++c) {
+        std::seed_seq seq{ static_cast<uint32_t>(u64_Seed), static_cast<uint32_t>(u64_Seed >> 32),
+                           static_cast<uint32_t>(c) };
+        m_vec_ChunkRngs.emplace_back(seq);
+    }
+    m_vec_ChunkTallies.resize(num_Chunks);
+
+    ResetAll();
+}
+
+const float* VecEnv::GetActionMask(size_t i_Env) const {
+    return m_vec_Observations.data() + i_Env * m_Encoder.GetFeatureSize() + m_Encoder.GetActionMaskOffset();
+}
+
+void VecEnv::ResetAll() {
+    RunChunks(true, nullptr);
+}
+
+void VecEnv::Step(const uint32_t* p_Actions) {
+    RunChunks(false, p_Actions);
+}
+
+void VecEnv::RunChunks(bool b_Reset, const uint32_t* p_Actions) {
+    TRACE_SCOPE("VecEnv::Step");
+
+    Threading::ThreadPool::ParallelFor(m_vec_ChunkRngs.size(), [&](size_t i_Chunk) {
+        std::mt19937& rng = m_vec_ChunkRngs[i_Chunk];
+        ChunkTally tally = {};
+        size_t i_End = std::min(m_num_Envs, (i_Chunk + 1) * k_EnvsPerChunk);
+        for (size_t i = i_Chunk * k_EnvsPerChunk; i < i_End; ++i) {
+            if (b_Reset) {
+                ResetEnv(i, rng);
+                m_vec_Dones[i] = 0;
+                m_vec_Rewards[i] = 0.0f;
+            } else {
+                StepEnv(i, p_Actions[i], rng, tally);
+            }
+            WriteObservation(i);
+        }
+        m_vec_ChunkTallies[i_Chunk] = tally;
+    });
+
+    for (const ChunkTally& tally : m_vec_ChunkTallies) {
+        m_u64_CompletedGames += tally.u64_Games;
+        m_u64_MisterXWins += tally.u64_MisterXWins;
+        m_u64_CompletedRounds += tally.u64_Rounds;
+        m_u64_InvalidActions += tally.u64_InvalidActions;
+    }
+}
+
+void VecEnv::LoadState(size_t i_Env, RulesState& state) const {
+    std::copy_n(&m_vec_Positions[i_Env * k_PlayerCount], k_PlayerCount, state.arr_Positions);
+    std::copy_n(&m_vec_Tickets[i_Env * k_PlayerCount * k_TicketTypeCount], k_PlayerCount * k_TicketTypeCount,
+                &state.arr_Tickets[0][0]);
+    state.u8_Round = m_vec_Rounds[i_Env];
+    state.u8_Turn = m_vec_Turns[i_Env];
+    state.e_Outcome = GameOutcome::None;
+}
+
+void VecEnv::StoreState(size_t i_Env, const RulesState& state) {
+    std::copy_n(state.arr_Positions, k_PlayerCount, &m_vec_Positions[i_Env * k_PlayerCount]);
+    std::copy_n(&state.arr_Tickets[0][0], k_PlayerCount * k_TicketTypeCount,
+                &m_vec_Tickets[i_Env * k_PlayerCount * k_TicketTypeCount]);
+    m_vec_Rounds[i_Env] = state.u8_Round;
+    m_vec_Turns[i_Env] = state.u8_Turn;
+}
+
+void VecEnv::ResetEnv(size_t i_Env, std::mt19937& rng) {
+    RulesState state;
+    // A start where Mr X is already cornered is simply drawn again; a map
+    // where that keeps happening cannot host a game at all
+    int i_Attempt = 0;
+    do {
+        if (i_Attempt++ == k_MaxResetAttempts) {
+            throw std::runtime_error("[VecEnv] No start in " + std::to_string(k_MaxResetAttempts) +
+                                     " draws lets Mr X move; check the map's connections and tickets");
+        }
+        GameRules::Reset(state, m_Graph, rng);
+        SkipStuckPlayers(state, m_Graph);
+    } while (state.e_Outcome != GameOutcome::None);
+
+    StoreState(i_Env, state);
+    m_vec_LastSeen[i_Env] = k_NotSeen;
+    m_Encoder.ResetPossibleLocations(&m_vec_PossibleMisterX[i_Env * m_Encoder.GetMaskWords()], state);
+}
+
+void VecEnv::StepEnv(size_t i_Env, uint32_t u32_Action, std::mt19937& rng, ChunkTally& tally) {
+    RulesState state;
+    LoadState(i_Env, state);
+
+    uint32_t u32_Node = state.arr_Positions[state.u8_Turn];
+    uint32_t u32_Begin = m_Graph.GetEdgeBegin(u32_Node);
+    uint32_t u32_Edge = u32_Begin + u32_Action;
+    if (u32_Action >= m_Graph.GetEdgeEnd(u32_Node) - u32_Begin || !GameRules::CanUseEdge(state, m_Graph, u32_Edge)) {
+        ++tally.u64_InvalidActions;
+        u32_Edge = u32_Begin;
+        while (!GameRules::CanUseEdge(state, m_Graph, u32_Edge)) ++u32_Edge;
+    }
+
+    bool b_MisterXMoved = state.u8_Turn == 0;
+    int i_Round = state.u8_Round;
+    GameRules::ApplyMove(state, m_Graph, u32_Edge);
+    uint64_t* p_Mask = &m_vec_PossibleMisterX[i_Env * m_Encoder.GetMaskWords()];
+    if (b_MisterXMoved) {
+        if (IsRevealRound(i_Round)) m_vec_LastSeen[i_Env] = state.arr_Positions[0];
+        m_Encoder.UpdateAfterMisterXMove(p_Mask, state, u32_Edge, i_Round);
+    } else {
+        m_Encoder.UpdateAfterDetectiveMove(p_Mask, m_Graph.GetTarget(u32_Edge));
+    }
+    SkipStuckPlayers(state, m_Graph);
+
+    if (state.e_Outcome == GameOutcome::None) {
+        StoreState(i_Env, state);
+        m_vec_Dones[i_Env] = 0;
+        m_vec_Rewards[i_Env] = 0.0f;
+        return;
+    }
+
+    ++tally.u64_Games;
+    tally.u64_Rounds += state.u8_Round;
+    if (state.e_Outcome == GameOutcome::MisterX) ++tally.u64_MisterXWins;
+    m_vec_Dones[i_Env] = 1;
+    m_vec_Rewards[i_Env] = state.e_Outcome == GameOutcome::MisterX ? 1.0f : -1.0f;
+    ResetEnv(i_Env, rng);
+}
+
+void VecEnv::WriteObservation(size_t i_Env) {
+    RulesState state;
+    LoadState(i_Env, state);
+    m_Encoder.Encode(state, &m_vec_PossibleMisterX[i_Env * m_Encoder.GetMaskWords()],
+                     &m_vec_Observations[i_Env * m_Encoder.GetFeatureSize()]);
+}
+
+} // namespace Core
+} // namespace ScotlandYard
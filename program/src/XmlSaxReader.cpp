@@ -0,0 +1,243 @@
+#include "XmlSaxReader.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+namespace ScotlandYard {
+namespace Utils {
+
+namespace {
+    bool IsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    bool IsNameEnd(char c) {
+        return IsSpace(c) || c == '/' || c == '>' || c == '=';
+    }
+
+    bool StartsWith(const char* p, const char* p_End, std::string_view sv_Prefix) {
+        return static_cast<size_t>(p_End - p) >= sv_Prefix.size() &&
+               std::memcmp(p, sv_Prefix.data(), sv_Prefix.size()) == 0;
+    }
+
+    // Position of sv_Needle at or after p, or nullptr
+    const char* Find(const char* p, const char* p_End, std::string_view sv_Needle) {
+        const char* p_Found = std::search(p, p_End, sv_Needle.begin(), sv_Needle.end());
+        return p_Found == p_End ? nullptr : p_Found;
+    }
+
+    void AppendUtf8(uint32_t u32_CodePoint, std::string& out_Text) {
+        if (u32_CodePoint < 0x80) {
+            out_Text += static_cast<char>(u32_CodePoint);
+        } else if (u32_CodePoint < 0x800) {
+            out_Text += static_cast<char>(0xC0 | (u32_CodePoint >> 6));
+            out_Text += static_cast<char>(0x80 | (u32_CodePoint & 0x3F));
+        } else if (u32_CodePoint < 0x10000) {
+            out_Text += static_cast<char>(0xE0 | (u32_CodePoint >> 12));
+            out_Text += static_cast<char>(0x80 | ((u32_CodePoint >> 6) & 0x3F));
+            out_Text += static_cast<char>(0x80 | (u32_CodePoint & 0x3F));
+        } else {
+            out_Text += static_cast<char>(0xF0 | (u32_CodePoint >> 18));
+            out_Text += static_cast<char>(0x80 | ((u32_CodePoint >> 12) & 0x3F));
+            out_Text += static_cast<char>(0x80 | ((u32_CodePoint >> 6) & 0x3F));
+            out_Text += static_cast<char>(0x80 | (u32_CodePoint & 0x3F));
+        }
+    }
+}
+
+XmlSaxReader::XmlSaxReader()
+    : m_num_ErrorLine(0)
+{
+}
+
+bool XmlSaxReader::ParseFile(const std::string& s_Path, Handler& handler) {
+    if (!m_File.Open(s_Path)) {
+        m_s_Error = "could not open " + s_Path;
+        m_num_ErrorLine = 0;
+        return false;
+    }
+
+    bool b_Ok = Parse(m_File.GetView(), handler);
+    m_File.Close();
+    return b_Ok;
+}
+
+bool XmlSaxReader::Fail(std::string_view sv_Document, const char* p_At, const char* p_Reason) {
+    m_s_Error = p_Reason;
+    m_num_ErrorLine = 1 + static_cast<size_t>(std::count(sv_Document.data(), p_At, '\n'));
+    return false;
+}
+
+bool XmlSaxReader::Parse(std::string_view sv_Document, Handler& handler) {
+    m_s_Error.clear();
+    m_num_ErrorLine = 0;
+
+    const char* p = sv_Document.data();
+    const char* p_End = p + sv_Document.size();
+
+    // Open element names, to catch mismatched end tags; views into the document
+    std::vector<std::string_view> vec_Open;
+
+    while (p < p_End) {
+        if (*p != '<') {
+            const char* p_Tag = static_cast<const char*>(std::memchr(p, '<', static_cast<size_t>(p_End - p)));
+            if (!p_Tag) p_Tag = p_End;
+            if (std::any_of(p, p_Tag, [](char c) { return !IsSpace(c); })) {
+                handler.OnText(std::string_view(p, static_cast<size_t>(p_Tag - p)));
+            }
+            p = p_Tag;
+            continue;
+        }
+
+        if (StartsWith(p, p_End, "<!--")) {
+            const char* p_Close = Find(p + 4, p_End, "-->");
+            if (!p_Close) return Fail(sv_Document, p, "unterminated comment");
+            p = p_Close + 3;
+        } else if (StartsWith(p, p_End, "<![CDATA[")) {
+            const char* p_Close = Find(p + 9, p_End, "]]>");
+            if (!p_Close) return Fail(sv_Document, p, "unterminated CDATA section");
+            handler.OnText(std::string_view(p + 9, static_cast<size_t>(p_Close - (p + 9))));
+            p = p_Close + 3;
+        } else if (StartsWith(p, p_End, "<?")) {
+            const char* p_Close = Find(p + 2, p_End, "?>");
+            if (!p_Close) return Fail(sv_Document, p, "unterminated processing instruction");
+            p = p_Close + 2;
+        } else if (StartsWith(p, p_End, "<!")) {
+            // DOCTYPE, possibly with an internal subset in brackets
+            const char* p_Start = p;
+            int i_Depth = 0;
+            for (p += 2; p < p_End; ++p) {
+                if (*p == '[') ++i_Depth;
+                else if (*p == ']') --i_Depth;
+                else if (*p == '>' && i_Depth <= 0) break;
+            }
+            if (p == p_End) return Fail(sv_Document, p_Start, "unterminated declaration");
+            ++p;
+        } else if (StartsWith(p, p_End, "</")) {
+            const char* p_Close = static_cast<const char*>(std::memchr(p, '>', static_cast<size_t>(p_End - p)));
+            if (!p_Close) return Fail(sv_Document, p, "unterminated end tag");
+
+            const char* p_NameEnd = p + 2;
+            while (p_NameEnd < p_Close && !IsSpace(*p_NameEnd)) ++p_NameEnd;
+            std::string_view sv_Name(p + 2, static_cast<size_t>(p_NameEnd - (p + 2)));
+            if (vec_Open.empty() || vec_Open.back() != sv_Name) {
+                return Fail(sv_Document, p, "mismatched end tag");
+            }
+
+            vec_Open.pop_back();
+            handler.OnEndElement(sv_Name);
+            p = p_Close + 1;
+        } else {
+            const char* p_Start = p;
+            const char* p_NameEnd = ++p;
+            while (p_NameEnd < p_End && !IsNameEnd(*p_NameEnd)) ++p_NameEnd;
+            if (p_NameEnd == p) return Fail(sv_Document, p_Start, "missing element name");
+            std::string_view sv_Name(p, static_cast<size_t>(p_NameEnd - p));
+            p = p_NameEnd;
+
+            m_vec_Attributes.clear();
+            bool b_SelfClosing = false;
+            for (;;) {
+                while (p < p_End && IsSpace(*p)) ++p;
+                if (p == p_End) return Fail(sv_Document, p_Start, "unterminated start tag");
+
+                if (*p == '>') {
+                    ++p;
+                    break;
+                }
+                if (*p == '/') {
+                    if (p + 1 == p_End || p[1] != '>') return Fail(sv_Document, p, "expected '>' after '/'");
+                    b_SelfClosing = true;
+                    p += 2;
+                    break;
+                }
+
+                const char* p_AttrName = p;
+                while (p < p_End && !IsNameEnd(*p)) ++p;
+                std::string_view sv_AttrName(p_AttrName, static_cast<size_t>(p - p_AttrName));
+                while (p < p_End && IsSpace(*p)) ++p;
+                if (sv_AttrName.empty() || p == p_End || *p != '=') {
+                    return Fail(sv_Document, p_AttrName, "malformed attribute");
+                }
+                ++p;
+                while (p < p_End && IsSpace(*p)) ++p;
+                if (p == p_End || (*p != '"' && *p != '\'')) {
+                    return Fail(sv_Document, p_AttrName, "attribute value must be quoted");
+                }
+
+                const char c_Quote = *p++;
+                const char* p_Close = static_cast<const char*>(std::memchr(p, c_Quote, static_cast<size_t>(p_End - p)));
+                if (!p_Close) return Fail(sv_Document, p_AttrName, "unterminated attribute value");
+                m_vec_Attributes.push_back({sv_AttrName, std::string_view(p, static_cast<size_t>(p_Close - p))});
+                p = p_Close + 1;
+            }
+
+            handler.OnStartElement(sv_Name, m_vec_Attributes);
+            if (b_SelfClosing) {
+                handler.OnEndElement(sv_Name);
+            } else {
+                vec_Open.push_back(sv_Name);
+            }
+        }
+    }
+
+    if (!vec_Open.empty()) {
+        return Fail(sv_Document, p_End, "unclosed element");
+    }
+    return true;
+}
+
+void XmlSaxReader::DecodeEntities(std::string_view sv_Raw, std::string& out_Text) {
+    out_Text.clear();
+
+    size_t pos = 0;
+    while (pos < sv_Raw.size()) {
+        size_t amp = sv_Raw.find('&', pos);
+        if (amp == std::string_view::npos) {
+            out_Text.append(sv_Raw.data() + pos, sv_Raw.size() - pos);
+            break;
+        }
+        out_Text.append(sv_Raw.data() + pos, amp - pos);
+
+        size_t semi = sv_Raw.find(';', amp);
+        std::string_view sv_Entity = semi == std::string_view::npos
+            ? std::string_view() : sv_Raw.substr(amp + 1, semi - amp - 1);
+
+        bool b_Known = true;
+        if (sv_Entity == "amp") out_Text += '&';
+        else if (sv_Entity == "lt") out_Text += '<';
+        else if (sv_Entity == "gt") out_Text += '>';
+        else if (sv_Entity == "quot") out_Text += '"';
+        else if (sv_Entity == "apos") out_Text += '\'';
+        else if (sv_Entity.size() > 1 && sv_Entity[0] == '#') {
+            const bool b_Hex = sv_Entity[1] == 'x' || sv_Entity[1] == 'X';
+            const char* p_Digits = sv_Entity.data() + (b_Hex ? 2 : 1);
+            const char* p_DigitsEnd = sv_Entity.data() + sv_Entity.size();
+            uint32_t u32_CodePoint = 0;
+            auto result = std::from_chars(p_Digits, p_DigitsEnd, u32_CodePoint, b_Hex ? 16 : 10);
+            b_Known = result.ec == std::errc() && result.ptr == p_DigitsEnd && u32_CodePoint <= 0x10FFFF;
+            if (b_Known) AppendUtf8(u32_CodePoint, out_Text);
+        } else {
+            b_Known = false;
+        }
+
+        if (b_Known) {
+            pos = semi + 1;
+        } else {
+            // Leave anything unrecognised as written
+            out_Text += '&';
+            pos = amp + 1;
+        }
+    }
+}
+
+std::string_view XmlSaxReader::FindAttribute(const std::vector<Attribute>& vec_Attributes, std::string_view sv_Name) {
+    for (const Attribute& attribute : vec_Attributes) {
+        if (attribute.sv_Name == sv_Name) return attribute.sv_Value;
+    }
+    return std::string_view();
+}
+
+} // namespace Utils
+} // namespace ScotlandYard
@@ -2,6 +2,11 @@
 #include "MemoryManager.h"
 #include "ThreadPool.h"
 #include "NeuralNetworkManager.h"
+#include "TraceRecorder.h"
+#include "MapAsset.h"
+#include "RenderBenchmark.h"
+#include "HeadlessTraining.h"
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -11,46 +16,105 @@ int main(int argc, char* argv[]) {
 
     // Parse command-line arguments
     bool b_TrainingMode = false;
-    int i_MaxSteps = 10000;
+    bool b_Offscreen = false;
+    Core::BenchmarkOptions benchmarkOptions;
+    Core::TrainingOptions trainingOptions;
+    std::string s_TracePath;
+    std::string s_ModelPath;
 
     for (int i = 1; i < argc; ++i) {
         std::string s_Arg = argv[i];
         if (s_Arg == "--training" || s_Arg == "-t") {
             b_TrainingMode = true;
-        } else if (s_Arg == "--steps" && i + 1 < argc) {
-            i_MaxSteps = std::atoi(argv[++i]);
+        } else if (s_Arg == "--games" && i + 1 < argc) {
+            trainingOptions.i64_Games = std::atoll(argv[++i]);
+        } else if (s_Arg == "--seed" && i + 1 < argc) {
+            trainingOptions.u64_Seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (s_Arg == "--model" && i + 1 < argc) {
+            s_ModelPath = argv[++i];
+        } else if (s_Arg == "--envs" && i + 1 < argc) {
+            trainingOptions.i_Envs = std::atoi(argv[++i]);
+        } else if (s_Arg == "--record" && i + 1 < argc) {
+            trainingOptions.s_RecordDirectory = argv[++i];
+        } else if (s_Arg == "--replay" && i + 1 < argc) {
+            trainingOptions.u32_ReplayCapacity = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (s_Arg == "--trace" && i + 1 < argc) {
+            s_TracePath = argv[++i];
+        } else if (s_Arg == "--offscreen") {
+            b_Offscreen = true;
+        } else if (s_Arg == "--frames" && i + 1 < argc) {
+            benchmarkOptions.i_Frames = std::atoi(argv[++i]);
+        } else if (s_Arg == "--warmup" && i + 1 < argc) {
+            benchmarkOptions.i_WarmupFrames = std::atoi(argv[++i]);
+        } else if (s_Arg == "--camera-path" && i + 1 < argc) {
+            benchmarkOptions.s_CameraPath = argv[++i];
+        } else if (s_Arg == "--frame-times" && i + 1 < argc) {
+            benchmarkOptions.s_FrameTimesPath = argv[++i];
+        } else if (s_Arg == "--snapshot-dir" && i + 1 < argc) {
+            benchmarkOptions.s_SnapshotDir = argv[++i];
+        } else if (s_Arg == "--snapshot-every" && i + 1 < argc) {
+            benchmarkOptions.i_SnapshotEvery = std::atoi(argv[++i]);
         }
     }
 
+    // Tracing has to be on before the pool spawns so worker threads get their names
+    if (!s_TracePath.empty()) {
+        Core::TraceRecorder::SetEnabled(true);
+        Core::TraceRecorder::SetThreadName("Main");
+    }
+
     try {
         // INITIALIZATION
         Memory::MemoryManager::Initialize();
         Threading::ThreadPool::Initialize();
         AI::NeuralNetworkManager::Initialize();
-
-        auto p_App = Memory::MakeUnique<Core::Application>("Scotland Yard++", 1280, 720, b_TrainingMode);
-        if (!p_App->Initialize()) {
-            std::cerr << "Failed to initialize application!" << std::endl;
-            return 1;
+        if (!s_ModelPath.empty() && !AI::NeuralNetworkManager::LoadModel(s_ModelPath)) {
+            std::cerr << "Failed to load model " << s_ModelPath << std::endl;
         }
 
-        p_App->LoadStates();
-
         // MAIN LOOP
+        int i_ExitCode = 0;
         if (b_TrainingMode) {
-            p_App->RunTraining(i_MaxSteps);
+            // Training never touches SDL or GL: games run straight through the rules on the pool
+            Core::TrainingReport report;
+            if (Core::RunHeadlessTraining(trainingOptions, report)) {
+                report.Print();
+                if (AI::NeuralNetworkManager::IsReady()) {
+                    AI::NeuralNetworkManager::GetStats().Print();
+                }
+            } else {
+                i_ExitCode = 1;
+            }
         } else {
-            p_App->Run();
+            auto p_App = Memory::MakeUnique<Core::Application>("Scotland Yard++", 1280, 720);
+            p_App->SetOffscreen(b_Offscreen);
+            if (!p_App->Initialize()) {
+                std::cerr << "Failed to initialize application!" << std::endl;
+                return 1;
+            }
+
+            p_App->LoadStates();
+
+            if (b_Offscreen) {
+                i_ExitCode = p_App->RunBenchmark(benchmarkOptions);
+            } else {
+                p_App->Run();
+            }
+
+            p_App->Shutdown();
         }
 
         // CLEANUP
-        p_App->Shutdown();
-        p_App.reset();
+        Core::MapAsset::ReleaseCache();
         AI::NeuralNetworkManager::Shutdown();
         Threading::ThreadPool::Shutdown();
         Memory::MemoryManager::Shutdown();
 
-        return 0;
+        if (!s_TracePath.empty()) {
+            Core::TraceRecorder::ExportChromeTrace(s_TracePath);
+        }
+
+        return i_ExitCode;
 
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
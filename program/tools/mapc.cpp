@@ -0,0 +1,33 @@
+#include "BinaryMap.h"
+#include "GameConstants.h"
+#include <iostream>
+#include <string>
+
+// mapc - compiles the map CSVs into the binary map format the game loads first.
+//
+//   mapc                                        compile the bundled assets/maps
+//   mapc <nodes.csv> <connections.csv> <out>    compile any other map
+int main(int argc, char* argv[]) {
+    using namespace ScotlandYard;
+
+    std::string s_NodesPath = Core::GetMapPath(Core::k_NodeDataRelativePath);
+    std::string s_ConnectionsPath = Core::GetMapPath(Core::k_ConnectionsRelativePath);
+    std::string s_OutputPath = Core::GetMapPath(Core::k_BinaryMapRelativePath);
+
+    if (argc == 4) {
+        s_NodesPath = argv[1];
+        s_ConnectionsPath = argv[2];
+        s_OutputPath = argv[3];
+    } else if (argc != 1) {
+        std::cerr << "Usage: " << argv[0] << " [<nodes.csv> <connections.csv> <output>]" << std::endl;
+        return 1;
+    }
+
+    if (!Utils::BinaryMap::Compile(s_NodesPath, s_ConnectionsPath, s_OutputPath)) {
+        return 1;
+    }
+
+    // Round-trip so a bad write is caught here rather than at game start
+    Utils::BinaryMap map;
+    return map.Open(s_OutputPath) ? 0 : 1;
+}
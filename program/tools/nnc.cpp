@@ -0,0 +1,479 @@
+#include "MlpModel.h"
+#include "BinaryMap.h"
+#include "MapAsset.h"
+#include "ThreadPool.h"
+#include "TrajectoryReader.h"
+#include "VecEnv.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// nnc - creates and converts .synn policy/value networks for NeuralNetworkManager.
+//
+//   nnc init <out.synn> [--hidden 256,256] [--inputs N --policy A] [--no-value] [--seed S]
+//       randomly initialised network (He init, ReLU hidden layers); sized for
+//       VecEnv observations and actions on the bundled map unless --inputs and
+//       --policy are given. Self-play can start from it before any training.
+//
+//   nnc record <out.synf> [--rows N] [--envs E] [--seed S]
+//       records N network input rows (NetworkInput features) from random
+//       VecEnv self-play, as calibration data for quantize.
+//
+//   nnc quantize <in.synn> <features.synf> <out.synn> [--quantize-output]
+//       post-training int8 quantization: per-output weight scales, and a
+//       per-layer input scale from the largest input each layer sees on the
+//       recorded features. The small output layer stays float unless
+//       --quantize-output is given. Prints the error against the float model.
+//
+//   nnc replay <dir> [--prefix P] [--batch N] [--batches B] [--seed S]
+//       indexes the trajectory shards --training --record wrote to <dir> and
+//       samples B minibatches of N steps from them on all cores, printing the
+//       data set's size and the sampling rate.
+namespace {
+
+using namespace ScotlandYard;
+
+int Usage(const char* p_Program) {
+    std::cerr << "Usage: " << p_Program << " init <out.synn> [--hidden 256,256] [--inputs N --policy A] [--no-value] [--seed S]\n"
+              << "       " << p_Program << " record <out.synf> [--rows N] [--envs E] [--seed S]\n"
+              << "       " << p_Program << " quantize <in.synn> <features.synf> <out.synn> [--quantize-output]\n"
+              << "       " << p_Program << " replay <dir> [--prefix P] [--batch N] [--batches B] [--seed S]" << std::endl;
+    return 1;
+}
+
+// .synf: this header, then u64_RowCount rows of u32_FeatureSize floats
+struct FeatureFileHeader {
+    char arr_Magic[4];
+    uint32_t u32_Version;
+    uint32_t u32_FeatureSize;
+    uint32_t u32_Reserved;
+    uint64_t u64_RowCount;
+    uint64_t u64_PayloadChecksum;
+    uint64_t u64_HeaderChecksum;
+};
+static_assert(sizeof(FeatureFileHeader) == 40, "FeatureFileHeader layout is part of the file format");
+
+constexpr char k_FeatureMagic[4] = {'S', 'Y', 'N', 'F'};
+constexpr uint32_t k_FeatureVersion = 1;
+
+bool WriteFeatures(const std::string& s_Path, uint32_t u32_FeatureSize, const std::vector<float>& vec_Rows) {
+    FeatureFileHeader header{};
+    std::memcpy(header.arr_Magic, k_FeatureMagic, sizeof(k_FeatureMagic));
+    header.u32_Version = k_FeatureVersion;
+    header.u32_FeatureSize = u32_FeatureSize;
+    header.u64_RowCount = vec_Rows.size() / u32_FeatureSize;
+    header.u64_PayloadChecksum = Utils::BinaryMap::Checksum(vec_Rows.data(), vec_Rows.size() * sizeof(float));
+    header.u64_HeaderChecksum = Utils::BinaryMap::Checksum(&header, offsetof(FeatureFileHeader, u64_HeaderChecksum));
+
+    std::ofstream file(s_Path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(vec_Rows.data()), static_cast<std::streamsize>(vec_Rows.size() * sizeof(float)));
+    if (!file.good()) {
+        std::cerr << "[nnc] ERROR: Failed writing " << s_Path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ReadFeatures(const std::string& s_Path, uint32_t& u32_FeatureSize, std::vector<float>& vec_Rows) {
+    auto fail = [&](const char* p_Reason) {
+        std::cerr << "[nnc] ERROR: " << s_Path << ": " << p_Reason << std::endl;
+        return false;
+    };
+
+    std::ifstream file(s_Path, std::ios::binary);
+    if (!file.is_open()) return fail("could not open");
+    FeatureFileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return fail("file too small");
+    if (std::memcmp(header.arr_Magic, k_FeatureMagic, sizeof(k_FeatureMagic)) != 0) return fail("not a feature file");
+    if (header.u32_Version != k_FeatureVersion) return fail("unsupported version");
+    if (header.u64_HeaderChecksum != Utils::BinaryMap::Checksum(&header, offsetof(FeatureFileHeader, u64_HeaderChecksum))) {
+        return fail("header checksum mismatch");
+    }
+    if (header.u32_FeatureSize == 0 || header.u64_RowCount == 0) return fail("no rows");
+
+    vec_Rows.resize(static_cast<size_t>(header.u64_RowCount) * header.u32_FeatureSize);
+    if (!file.read(reinterpret_cast<char*>(vec_Rows.data()), static_cast<std::streamsize>(vec_Rows.size() * sizeof(float)))) {
+        return fail("truncated file");
+    }
+    if (header.u64_PayloadChecksum != Utils::BinaryMap::Checksum(vec_Rows.data(), vec_Rows.size() * sizeof(float))) {
+        return fail("payload checksum mismatch");
+    }
+    u32_FeatureSize = header.u32_FeatureSize;
+    return true;
+}
+
+bool ParseSizes(const std::string& s_List, std::vector<uint32_t>& vec_Sizes) {
+    std::stringstream ss(s_List);
+    std::string s_Item;
+    while (std::getline(ss, s_Item, ',')) {
+        int i_Size = std::atoi(s_Item.c_str());
+        if (i_Size <= 0) return false;
+        vec_Sizes.push_back(static_cast<uint32_t>(i_Size));
+    }
+    return true;
+}
+
+int RunInit(int argc, char* argv[]) {
+    if (argc < 3) return Usage(argv[0]);
+
+    std::string s_OutputPath = argv[2];
+    std::vector<uint32_t> vec_Hidden = { 256, 256 };
+    uint32_t u32_Inputs = 0, u32_Policy = 0, u32_Value = 1;
+    uint32_t u32_Seed = 1;
+    for (int i = 3; i < argc; ++i) {
+        std::string s_Arg = argv[i];
+        if (s_Arg == "--hidden" && i + 1 < argc) {
+            vec_Hidden.clear();
+            if (!ParseSizes(argv[++i], vec_Hidden)) return Usage(argv[0]);
+        } else if (s_Arg == "--inputs" && i + 1 < argc) {
+            u32_Inputs = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (s_Arg == "--policy" && i + 1 < argc) {
+            u32_Policy = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (s_Arg == "--no-value") {
+            u32_Value = 0;
+        } else if (s_Arg == "--seed" && i + 1 < argc) {
+            u32_Seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+
+    if (u32_Inputs == 0 || u32_Policy == 0) {
+        Core::VecEnv env(Core::MapAsset::Acquire(), 1, 0);
+        if (u32_Inputs == 0) u32_Inputs = static_cast<uint32_t>(env.GetObservationSize());
+        if (u32_Policy == 0) u32_Policy = env.GetActionCount();
+    }
+
+    std::vector<uint32_t> vec_Sizes = { u32_Inputs };
+    vec_Sizes.insert(vec_Sizes.end(), vec_Hidden.begin(), vec_Hidden.end());
+    vec_Sizes.push_back(u32_Policy + u32_Value);
+
+    std::mt19937 rng(u32_Seed);
+    std::vector<AI::MlpModel::LayerData> vec_Layers;
+    for (size_t l = 0; l + 1 < vec_Sizes.size(); ++l) {
+        AI::MlpModel::LayerData layer;
+        layer.u32_Inputs = vec_Sizes[l];
+        layer.u32_Outputs = vec_Sizes[l + 1];
+        bool b_Output = l + 2 == vec_Sizes.size();
+        layer.e_Activation = b_Output ? AI::Activation::None : AI::Activation::Relu;
+
+        // Small output weights start the policy near uniform
+        float f_Scale = std::sqrt(2.0f / layer.u32_Inputs) * (b_Output ? 0.01f : 1.0f);
+        std::normal_distribution<float> dist(0.0f, f_Scale);
+        layer.vec_Weights.resize(static_cast<size_t>(layer.u32_Inputs) * layer.u32_Outputs);
+        for (float& f_Weight : layer.vec_Weights) f_Weight = dist(rng);
+        layer.vec_Bias.assign(layer.u32_Outputs, 0.0f);
+        vec_Layers.push_back(std::move(layer));
+    }
+
+    if (!AI::MlpModel::Write(s_OutputPath, u32_Inputs, u32_Policy, u32_Value, vec_Layers)) {
+        return 1;
+    }
+
+    // Round-trip so a bad write is caught here rather than at load time
+    AI::MlpModel model;
+    if (!model.Load(s_OutputPath)) return 1;
+    std::cout << "[nnc] Wrote " << s_OutputPath << ": " << u32_Inputs;
+    for (uint32_t u32_Size : vec_Hidden) std::cout << " -> " << u32_Size;
+    std::cout << " -> " << u32_Policy << (u32_Value ? " + value" : "") << std::endl;
+    return 0;
+}
+
+int RunRecord(int argc, char* argv[]) {
+    if (argc < 3) return Usage(argv[0]);
+
+    std::string s_OutputPath = argv[2];
+    size_t num_Rows = 65536;
+    size_t num_Envs = 256;
+    uint64_t u64_Seed = 1;
+    for (int i = 3; i < argc; ++i) {
+        std::string s_Arg = argv[i];
+        if (s_Arg == "--rows" && i + 1 < argc) {
+            num_Rows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (s_Arg == "--envs" && i + 1 < argc) {
+            num_Envs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (s_Arg == "--seed" && i + 1 < argc) {
+            u64_Seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (num_Rows == 0 || num_Envs == 0) return Usage(argv[0]);
+
+    Core::VecEnv env(Core::MapAsset::Acquire(), num_Envs, u64_Seed);
+    const size_t num_Features = env.GetObservationSize();
+    const uint32_t u32_ActionCount = env.GetActionCount();
+    std::vector<float> vec_Rows;
+    vec_Rows.reserve(num_Rows * num_Features);
+    std::vector<uint32_t> vec_Actions(num_Envs);
+    std::vector<uint32_t> vec_Legal(u32_ActionCount);
+    std::mt19937_64 rng(u64_Seed);
+
+    // Uniformly random legal moves; every step's observations are recorded
+    while (vec_Rows.size() < num_Rows * num_Features) {
+        size_t num_Take = std::min(num_Envs, num_Rows - vec_Rows.size() / num_Features);
+        vec_Rows.insert(vec_Rows.end(), env.GetObservations(), env.GetObservations() + num_Take * num_Features);
+
+        for (size_t e = 0; e < num_Envs; ++e) {
+            const float* p_Mask = env.GetActionMask(e);
+            size_t num_Legal = 0;
+            for (uint32_t a = 0; a < u32_ActionCount; ++a) {
+                if (p_Mask[a] > 0.0f) vec_Legal[num_Legal++] = a;
+            }
+            vec_Actions[e] = num_Legal ? vec_Legal[rng() % num_Legal] : 0;
+        }
+        env.Step(vec_Actions.data());
+    }
+
+    if (!WriteFeatures(s_OutputPath, static_cast<uint32_t>(num_Features), vec_Rows)) return 1;
+    std::cout << "[nnc] Wrote " << num_Rows << " rows of " << num_Features << " features to " << s_OutputPath << std::endl;
+    return 0;
+}
+
+// Runs the float model one layer at a time over all rows, returning the
+// largest absolute value that reaches each layer's input
+std::vector<float> CalibrateInputRanges(const AI::MlpModel& model, const std::vector<float>& vec_Features) {
+    constexpr size_t k_BatchRows = 256;
+    const size_t num_Inputs = model.GetInputSize();
+    const size_t num_Rows = vec_Features.size() / num_Inputs;
+    std::vector<float> vec_Ranges(model.GetLayerCount(), 0.0f);
+    std::vector<float> vec_In, vec_Out;
+
+    for (size_t r0 = 0; r0 < num_Rows; r0 += k_BatchRows) {
+        size_t num_Batch = std::min(k_BatchRows, num_Rows - r0);
+        vec_In.assign(vec_Features.begin() + r0 * num_Inputs, vec_Features.begin() + (r0 + num_Batch) * num_Inputs);
+        size_t num_Stride = num_Inputs;
+        for (size_t l = 0; l < model.GetLayerCount(); ++l) {
+            const AI::MlpModel::Layer& layer = model.GetLayer(l);
+            for (size_t r = 0; r < num_Batch; ++r) {
+                for (size_t k = 0; k < layer.u32_Inputs; ++k) {
+                    vec_Ranges[l] = std::max(vec_Ranges[l], std::fabs(vec_In[r * num_Stride + k]));
+                }
+            }
+            vec_Out.resize(num_Batch * layer.u32_Stride);
+            AI::Gemm(model.GetKernel(), vec_In.data(), num_Stride, layer.p_Weights, layer.u32_Stride, layer.p_Bias,
+                     vec_Out.data(), layer.u32_Stride, num_Batch, layer.u32_Inputs, layer.u32_Stride,
+                     layer.e_Activation);
+            vec_In.swap(vec_Out);
+            num_Stride = layer.u32_Stride;
+        }
+    }
+    return vec_Ranges;
+}
+
+AI::MlpModel::LayerData QuantizeLayer(const AI::MlpModel::Layer& layer, float f_InputRange) {
+    AI::MlpModel::LayerData data;
+    data.u32_Inputs = layer.u32_Inputs;
+    data.u32_Outputs = layer.u32_Outputs;
+    data.e_Activation = layer.e_Activation;
+    data.vec_Bias.assign(layer.p_Bias, layer.p_Bias + layer.u32_Outputs);
+    data.e_Precision = AI::LayerPrecision::Int8;
+    data.f_InputScale = f_InputRange > 0.0f ? f_InputRange / 127.0f : 1.0f;
+    data.vec_QuantizedWeights.resize(static_cast<size_t>(layer.u32_Inputs) * layer.u32_Outputs);
+    data.vec_Scales.resize(layer.u32_Outputs);
+
+    // Symmetric per-output scales: each output's largest weight maps to 127
+    for (uint32_t n = 0; n < layer.u32_Outputs; ++n) {
+        float f_Max = 0.0f;
+        for (uint32_t k = 0; k < layer.u32_Inputs; ++k) {
+            f_Max = std::max(f_Max, std::fabs(layer.p_Weights[static_cast<size_t>(k) * layer.u32_Stride + n]));
+        }
+        float f_WeightScale = f_Max > 0.0f ? f_Max / 127.0f : 1.0f;
+        for (uint32_t k = 0; k < layer.u32_Inputs; ++k) {
+            float f_Weight = layer.p_Weights[static_cast<size_t>(k) * layer.u32_Stride + n] / f_WeightScale;
+            data.vec_QuantizedWeights[static_cast<size_t>(k) * layer.u32_Outputs + n] =
+                static_cast<int8_t>(std::lrint(std::min(std::max(f_Weight, -127.0f), 127.0f)));
+        }
+        data.vec_Scales[n] = data.f_InputScale * f_WeightScale;
+    }
+    return data;
+}
+
+AI::MlpModel::LayerData CopyLayer(const AI::MlpModel::Layer& layer) {
+    AI::MlpModel::LayerData data;
+    data.u32_Inputs = layer.u32_Inputs;
+    data.u32_Outputs = layer.u32_Outputs;
+    data.e_Activation = layer.e_Activation;
+    data.vec_Bias.assign(layer.p_Bias, layer.p_Bias + layer.u32_Outputs);
+    data.vec_Weights.resize(static_cast<size_t>(layer.u32_Inputs) * layer.u32_Outputs);
+    for (uint32_t k = 0; k < layer.u32_Inputs; ++k) {
+        std::copy(layer.p_Weights + static_cast<size_t>(k) * layer.u32_Stride,
+                  layer.p_Weights + static_cast<size_t>(k) * layer.u32_Stride + layer.u32_Outputs,
+                  data.vec_Weights.begin() + static_cast<size_t>(k) * layer.u32_Outputs);
+    }
+    return data;
+}
+
+// Softmax policy agreement between the float and the quantized model
+void ReportQuantizationError(const AI::MlpModel& floatModel, const AI::MlpModel& int8Model,
+                             const std::vector<float>& vec_Features) {
+    constexpr size_t k_BatchRows = 256;
+    const size_t num_Inputs = floatModel.GetInputSize();
+    const size_t num_Policy = floatModel.GetPolicySize();
+    const size_t num_Rows = std::min<size_t>(vec_Features.size() / num_Inputs, 16384);
+    AI::MlpWorkspace floatWorkspace, int8Workspace;
+    double d_MaxError = 0.0, d_SumError = 0.0;
+    size_t num_TopAgree = 0;
+
+    auto softmax = [&](const float* p_Logits, std::vector<float>& vec_Out) {
+        float f_Max = *std::max_element(p_Logits, p_Logits + num_Policy);
+        float f_Sum = 0.0f;
+        vec_Out.resize(num_Policy);
+        for (size_t i = 0; i < num_Policy; ++i) f_Sum += vec_Out[i] = std::exp(p_Logits[i] - f_Max);
+        for (float& f_Value : vec_Out) f_Value /= f_Sum;
+    };
+
+    std::vector<float> vec_A, vec_B;
+    for (size_t r0 = 0; r0 < num_Rows; r0 += k_BatchRows) {
+        size_t num_Batch = std::min(k_BatchRows, num_Rows - r0);
+        const float* p_Input = vec_Features.data() + r0 * num_Inputs;
+        const float* p_Float = floatModel.Forward(p_Input, num_Inputs, num_Batch, floatWorkspace);
+        const float* p_Int8 = int8Model.Forward(p_Input, num_Inputs, num_Batch, int8Workspace);
+        for (size_t r = 0; r < num_Batch; ++r) {
+            softmax(p_Float + r * floatModel.GetOutputStride(), vec_A);
+            softmax(p_Int8 + r * int8Model.GetOutputStride(), vec_B);
+            for (size_t i = 0; i < num_Policy; ++i) {
+                double d_Error = std::fabs(vec_A[i] - vec_B[i]);
+                d_MaxError = std::max(d_MaxError, d_Error);
+                d_SumError += d_Error;
+            }
+            num_TopAgree += std::max_element(vec_A.begin(), vec_A.end()) - vec_A.begin() ==
+                            std::max_element(vec_B.begin(), vec_B.end()) - vec_B.begin();
+        }
+    }
+
+    std::cout << "[nnc] Policy error over " << num_Rows << " rows: max " << d_MaxError << ", mean "
+              << d_SumError / (num_Rows * num_Policy) << ", top-1 agreement "
+              << 100.0 * num_TopAgree / num_Rows << "%" << std::endl;
+}
+
+int RunQuantize(int argc, char* argv[]) {
+    if (argc < 5) return Usage(argv[0]);
+
+    std::string s_InputPath = argv[2];
+    std::string s_FeaturePath = argv[3];
+    std::string s_OutputPath = argv[4];
+    bool b_QuantizeOutput = false;
+    for (int i = 5; i < argc; ++i) {
+        if (std::string(argv[i]) == "--quantize-output") {
+            b_QuantizeOutput = true;
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+
+    AI::MlpModel floatModel;
+    if (!floatModel.Load(s_InputPath)) return 1;
+    if (floatModel.HasInt8Layers()) {
+        std::cerr << "[nnc] ERROR: " << s_InputPath << " is already quantized" << std::endl;
+        return 1;
+    }
+
+    uint32_t u32_FeatureSize = 0;
+    std::vector<float> vec_Features;
+    if (!ReadFeatures(s_FeaturePath, u32_FeatureSize, vec_Features)) return 1;
+    if (u32_FeatureSize != floatModel.GetInputSize()) {
+        std::cerr << "[nnc] ERROR: Features have " << u32_FeatureSize << " values per row, the model takes "
+                  << floatModel.GetInputSize() << std::endl;
+        return 1;
+    }
+
+    std::vector<float> vec_Ranges = CalibrateInputRanges(floatModel, vec_Features);
+    std::vector<AI::MlpModel::LayerData> vec_Layers;
+    for (size_t l = 0; l < floatModel.GetLayerCount(); ++l) {
+        bool b_Output = l + 1 == floatModel.GetLayerCount();
+        vec_Layers.push_back(b_Output && !b_QuantizeOutput ? CopyLayer(floatModel.GetLayer(l))
+                                                           : QuantizeLayer(floatModel.GetLayer(l), vec_Ranges[l]));
+        std::cout << "[nnc] Layer " << l << ": input range " << vec_Ranges[l]
+                  << (vec_Layers.back().e_Precision == AI::LayerPrecision::Int8 ? ", int8" : ", float") << std::endl;
+    }
+
+    if (!AI::MlpModel::Write(s_OutputPath, floatModel.GetInputSize(), floatModel.GetPolicySize(),
+                             floatModel.HasValue() ? 1 : 0, vec_Layers)) {
+        return 1;
+    }
+
+    AI::MlpModel int8Model;
+    if (!int8Model.Load(s_OutputPath)) return 1;
+    ReportQuantizationError(floatModel, int8Model, vec_Features);
+    std::cout << "[nnc] Wrote " << s_OutputPath << " (" << AI::GetInt8KernelName(int8Model.GetInt8Kernel())
+              << " on this CPU)" << std::endl;
+    return 0;
+}
+
+int RunReplay(int argc, char* argv[]) {
+    if (argc < 3) return Usage(argv[0]);
+
+    std::string s_Directory = argv[2];
+    std::string s_Prefix = "selfplay";
+    size_t num_BatchRows = 1024;
+    size_t num_Batches = 100;
+    uint64_t u64_Seed = 1;
+    for (int i = 3; i < argc; ++i) {
+        std::string s_Arg = argv[i];
+        if (s_Arg == "--prefix" && i + 1 < argc) {
+            s_Prefix = argv[++i];
+        } else if (s_Arg == "--batch" && i + 1 < argc) {
+            num_BatchRows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (s_Arg == "--batches" && i + 1 < argc) {
+            num_Batches = std::strtoull(argv[++i], nullptr, 10);
+        } else if (s_Arg == "--seed" && i + 1 < argc) {
+            u64_Seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (num_BatchRows == 0) return Usage(argv[0]);
+
+    auto t_Start = std::chrono::steady_clock::now();
+    AI::TrajectoryReader reader;
+    if (!reader.Open(s_Directory, s_Prefix)) return 1;
+    double d_IndexSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+    std::cout << "[nnc] " << reader.GetTrajectoryCount() << " games, " << reader.GetStepCount() << " steps in "
+              << reader.GetChunkCount() << " chunks over " << reader.GetShardCount() << " shard(s), indexed in "
+              << d_IndexSeconds * 1000.0 << " ms" << std::endl;
+    if (reader.GetStepCount() == 0) return 0;
+
+    std::shared_ptr<const Core::MapAsset> sp_Map = Core::MapAsset::Acquire();
+    Core::FeatureEncoder encoder(sp_Map->GetRulesGraph());
+    Threading::ThreadPool::Initialize();
+
+    std::mt19937_64 rng(u64_Seed);
+    AI::TrajectoryBatch batch;
+    double d_ValueSum = 0.0;
+    bool b_Ok = true;
+    t_Start = std::chrono::steady_clock::now();
+    for (size_t b = 0; b < num_Batches && b_Ok; ++b) {
+        b_Ok = reader.Sample(num_BatchRows, rng, encoder, batch);
+        for (float f_Value : batch.vec_Values) d_ValueSum += f_Value;
+    }
+    double d_Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+    Threading::ThreadPool::Shutdown();
+    if (!b_Ok) return 1;
+
+    double d_Rows = static_cast<double>(num_Batches * num_BatchRows);
+    std::cout << "[nnc] Sampled " << num_Batches << " batches of " << num_BatchRows << " in " << d_Seconds << " s ("
+              << (d_Seconds > 0.0 ? d_Rows / d_Seconds : 0.0) << " rows/s), mean value for the side to move "
+              << (d_Rows > 0.0 ? d_ValueSum / d_Rows : 0.0) << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string s_Command = argc >= 2 ? argv[1] : "";
+    if (s_Command == "init") return RunInit(argc, argv);
+    if (s_Command == "record") return RunRecord(argc, argv);
+    if (s_Command == "quantize") return RunQuantize(argc, argv);
+    if (s_Command == "replay") return RunReplay(argc, argv);
+    return Usage(argv[0]);
+}
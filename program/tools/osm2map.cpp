@@ -0,0 +1,484 @@
+#include "BinaryMap.h"
+#include "CsvReader.h"
+#include "GameConstants.h"
+#include "XmlSaxReader.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// osm2map - turns an OpenStreetMap street graph saved as GraphML (osmnx
+// save_graphml, see map/openstreetmap.py) into a playable board.
+//
+//   osm2map <city.graphml> [<out.sybin>] [--extent <units>] [--min-streets <n>]
+//           [--csv <nodes.csv> <connections.csv>]
+//
+// Intersections become stations and the road chains between them become
+// connections. Transport follows the road class: every road carries a taxi,
+// primary/secondary/tertiary roads also a bus, motorways and trunk roads
+// stand in for the metro a drive network does not contain, and ferries are
+// water. The file is streamed, so memory grows with the graph, not the XML.
+
+using namespace ScotlandYard;
+
+namespace {
+
+    enum class KeyRole : uint8_t { None, NodeX, NodeY, StreetCount, Highway, Route };
+
+    struct OsmNode {
+        double d_Lon;
+        double d_Lat;
+        uint8_t u8_StreetCount;     // 0 when the export has no street_count
+    };
+
+    struct OsmEdge {
+        int64_t i64_Source;
+        int64_t i64_Target;
+        uint8_t u8_Type;
+    };
+
+    bool Contains(std::string_view sv_Text, std::string_view sv_Word) {
+        return sv_Text.find(sv_Word) != std::string_view::npos;
+    }
+
+    // osmnx joins the tags of merged ways into a list, "['primary', 'residential']";
+    // the best road on the segment decides
+    uint8_t TransportTypeFromHighway(std::string_view sv_Highway) {
+        if (Contains(sv_Highway, "ferry")) return Core::k_TransportTypeWater;
+        if (Contains(sv_Highway, "motorway") || Contains(sv_Highway, "trunk")) return Core::k_TransportTypeMetro;
+        if (Contains(sv_Highway, "primary") || Contains(sv_Highway, "secondary") ||
+            Contains(sv_Highway, "tertiary")) {
+            return Core::k_TransportTypeBus;
+        }
+        return Core::k_TransportTypeTaxi;
+    }
+
+    template <typename T>
+    bool ParseNumber(std::string_view sv_Text, T& out_Value) {
+        const char* p_End = sv_Text.data() + sv_Text.size();
+        auto result = std::from_chars(sv_Text.data(), p_End, out_Value);
+        return result.ec == std::errc() && result.ptr == p_End;
+    }
+
+    // Floating-point from_chars is missing from some standard libraries;
+    // CsvReader falls back to strtod there
+    bool ParseNumber(std::string_view sv_Text, double& out_Value) {
+        return Utils::CsvReader::ParseDouble(sv_Text, out_Value);
+    }
+
+    // Collects nodes and edges from the GraphML stream; <data> values are
+    // matched to their meaning through the <key> declarations in the header.
+    class GraphMlHandler : public Utils::XmlSaxReader::Handler {
+    public:
+        std::vector<OsmNode> m_vec_Nodes;
+        std::unordered_map<int64_t, uint32_t> m_map_IndexByOsmId;
+        std::vector<OsmEdge> m_vec_Edges;
+        size_t m_num_SkippedNodes = 0;
+
+        void OnStartElement(std::string_view sv_Name,
+                            const std::vector<Utils::XmlSaxReader::Attribute>& vec_Attributes) override {
+            using Utils::XmlSaxReader;
+
+            if (sv_Name == "data") {
+                m_role_Current = m_b_InNode || m_b_InEdge
+                    ? FindRole(XmlSaxReader::FindAttribute(vec_Attributes, "key")) : KeyRole::None;
+                m_sv_Text = std::string_view();
+            } else if (sv_Name == "node") {
+                m_b_InNode = true;
+                m_b_HasX = m_b_HasY = false;
+                m_CurrentNode = OsmNode{};
+                m_b_IdValid = ParseNumber(XmlSaxReader::FindAttribute(vec_Attributes, "id"), m_i64_CurrentId);
+            } else if (sv_Name == "edge") {
+                m_b_InEdge = true;
+                m_CurrentEdge = OsmEdge{};
+                m_CurrentEdge.u8_Type = Core::k_TransportTypeTaxi;
+                m_b_IdValid = ParseNumber(XmlSaxReader::FindAttribute(vec_Attributes, "source"), m_CurrentEdge.i64_Source) &&
+                              ParseNumber(XmlSaxReader::FindAttribute(vec_Attributes, "target"), m_CurrentEdge.i64_Target);
+            } else if (sv_Name == "key") {
+                std::string_view sv_For = XmlSaxReader::FindAttribute(vec_Attributes, "for");
+                std::string_view sv_AttrName = XmlSaxReader::FindAttribute(vec_Attributes, "attr.name");
+                KeyRole role = KeyRole::None;
+                if (sv_For == "node") {
+                    if (sv_AttrName == "x") role = KeyRole::NodeX;
+                    else if (sv_AttrName == "y") role = KeyRole::NodeY;
+                    else if (sv_AttrName == "street_count") role = KeyRole::StreetCount;
+                } else if (sv_For == "edge") {
+                    if (sv_AttrName == "highway") role = KeyRole::Highway;
+                    else if (sv_AttrName == "route") role = KeyRole::Route;
+                }
+                if (role != KeyRole::None) {
+                    m_vec_Keys.push_back({std::string(XmlSaxReader::FindAttribute(vec_Attributes, "id")), role});
+                }
+            }
+        }
+
+        void OnText(std::string_view sv_Text) override {
+            if (m_role_Current != KeyRole::None) m_sv_Text = sv_Text;
+        }
+
+        void OnEndElement(std::string_view sv_Name) override {
+            if (sv_Name == "data") {
+                ApplyData();
+                m_role_Current = KeyRole::None;
+            } else if (sv_Name == "node") {
+                m_b_InNode = false;
+                if (!m_b_IdValid || !m_b_HasX || !m_b_HasY || m_map_IndexByOsmId.count(m_i64_CurrentId) != 0) {
+                    ++m_num_SkippedNodes;
+                    return;
+                }
+                m_map_IndexByOsmId.emplace(m_i64_CurrentId, static_cast<uint32_t>(m_vec_Nodes.size()));
+                m_vec_Nodes.push_back(m_CurrentNode);
+            } else if (sv_Name == "edge") {
+                m_b_InEdge = false;
+                if (m_b_IdValid) m_vec_Edges.push_back(m_CurrentEdge);
+            }
+        }
+
+    private:
+        KeyRole FindRole(std::string_view sv_KeyId) const {
+            for (const auto& key : m_vec_Keys) {
+                if (key.first == sv_KeyId) return key.second;
+            }
+            return KeyRole::None;
+        }
+
+        void ApplyData() {
+            if (m_role_Current == KeyRole::None) return;
+            Utils::XmlSaxReader::DecodeEntities(m_sv_Text, m_s_Decoded);
+
+            switch (m_role_Current) {
+            case KeyRole::NodeX:
+                m_b_HasX = ParseNumber(std::string_view(m_s_Decoded), m_CurrentNode.d_Lon);
+                break;
+            case KeyRole::NodeY:
+                m_b_HasY = ParseNumber(std::string_view(m_s_Decoded), m_CurrentNode.d_Lat);
+                break;
+            case KeyRole::StreetCount: {
+                int i_Count = 0;
+                if (ParseNumber(std::string_view(m_s_Decoded), i_Count)) {
+                    m_CurrentNode.u8_StreetCount = static_cast<uint8_t>(std::clamp(i_Count, 0, 255));
+                }
+                break;
+            }
+            case KeyRole::Highway:
+                m_CurrentEdge.u8_Type = std::max(m_CurrentEdge.u8_Type, TransportTypeFromHighway(m_s_Decoded));
+                break;
+            case KeyRole::Route:
+                if (Contains(m_s_Decoded, "ferry")) m_CurrentEdge.u8_Type = Core::k_TransportTypeWater;
+                break;
+            case KeyRole::None:
+                break;
+            }
+        }
+
+        std::vector<std::pair<std::string, KeyRole>> m_vec_Keys;
+        KeyRole m_role_Current = KeyRole::None;
+        std::string_view m_sv_Text;
+        std::string m_s_Decoded;
+
+        bool m_b_InNode = false;
+        bool m_b_InEdge = false;
+        bool m_b_IdValid = false;
+        bool m_b_HasX = false;
+        bool m_b_HasY = false;
+        int64_t m_i64_CurrentId = 0;
+        OsmNode m_CurrentNode{};
+        OsmEdge m_CurrentEdge{};
+    };
+
+    struct Segment {
+        uint32_t u32_A;
+        uint32_t u32_B;
+        uint8_t u8_Type;
+    };
+
+    struct Board {
+        std::vector<Utils::BinaryMapNode> vec_Nodes;
+        std::vector<Utils::BinaryMapConnection> vec_Connections;
+    };
+
+    // Intersections, dead ends and ferry terminals become stations; chains of
+    // plain road points between them collapse into one connection whose type
+    // is the weakest transport along the whole chain.
+    Board BuildBoard(const GraphMlHandler& graph, int i_MinStreets, float f_Extent) {
+        const uint32_t u32_NodeCount = static_cast<uint32_t>(graph.m_vec_Nodes.size());
+
+        // Directed, possibly parallel edges -> one undirected segment per node pair
+        std::vector<Segment> vec_Segments;
+        vec_Segments.reserve(graph.m_vec_Edges.size());
+        for (const OsmEdge& edge : graph.m_vec_Edges) {
+            auto itSource = graph.m_map_IndexByOsmId.find(edge.i64_Source);
+            auto itTarget = graph.m_map_IndexByOsmId.find(edge.i64_Target);
+            if (itSource == graph.m_map_IndexByOsmId.end() || itTarget == graph.m_map_IndexByOsmId.end() ||
+                itSource->second == itTarget->second) {
+                continue;
+            }
+            vec_Segments.push_back({std::min(itSource->second, itTarget->second),
+                                    std::max(itSource->second, itTarget->second), edge.u8_Type});
+        }
+        std::sort(vec_Segments.begin(), vec_Segments.end(), [](const Segment& a, const Segment& b) {
+            return a.u32_A != b.u32_A ? a.u32_A < b.u32_A
+                 : a.u32_B != b.u32_B ? a.u32_B < b.u32_B
+                 : a.u8_Type > b.u8_Type;
+        });
+        // Sorted best type first, so keeping the first of each pair keeps the best
+        vec_Segments.erase(std::unique(vec_Segments.begin(), vec_Segments.end(),
+                                       [](const Segment& a, const Segment& b) {
+                                           return a.u32_A == b.u32_A && a.u32_B == b.u32_B;
+                                       }),
+                           vec_Segments.end());
+
+        // CSR adjacency over segments
+        std::vector<uint32_t> vec_Offsets(u32_NodeCount + 1, 0);
+        for (const Segment& segment : vec_Segments) {
+            ++vec_Offsets[segment.u32_A + 1];
+            ++vec_Offsets[segment.u32_B + 1];
+        }
+        for (uint32_t i = 0; i < u32_NodeCount; ++i) {
+            vec_Offsets[i + 1] += vec_Offsets[i];
+        }
+        std::vector<uint32_t> vec_Neighbours(vec_Offsets.back());
+        std::vector<uint8_t> vec_Types(vec_Offsets.back());
+        std::vector<uint32_t> vec_Cursor(vec_Offsets.begin(), vec_Offsets.end() - 1);
+        for (const Segment& segment : vec_Segments) {
+            uint32_t u32_A = vec_Cursor[segment.u32_A]++;
+            vec_Neighbours[u32_A] = segment.u32_B;
+            vec_Types[u32_A] = segment.u8_Type;
+            uint32_t u32_B = vec_Cursor[segment.u32_B]++;
+            vec_Neighbours[u32_B] = segment.u32_A;
+            vec_Types[u32_B] = segment.u8_Type;
+        }
+
+        std::vector<bool> vec_IsStation(u32_NodeCount, false);
+        for (uint32_t i = 0; i < u32_NodeCount; ++i) {
+            const uint32_t u32_Degree = vec_Offsets[i + 1] - vec_Offsets[i];
+            if (u32_Degree == 0) continue;
+
+            bool b_Ferry = false;
+            for (uint32_t e = vec_Offsets[i]; e < vec_Offsets[i + 1]; ++e) {
+                b_Ferry |= vec_Types[e] == Core::k_TransportTypeWater;
+            }
+            vec_IsStation[i] = u32_Degree != 2 || b_Ferry || graph.m_vec_Nodes[i].u8_StreetCount >= i_MinStreets;
+        }
+
+        // Walk every chain from both ends; emit it once, from its lower end
+        std::vector<Segment> vec_Chains;
+        for (uint32_t s = 0; s < u32_NodeCount; ++s) {
+            if (!vec_IsStation[s]) continue;
+
+            for (uint32_t e = vec_Offsets[s]; e < vec_Offsets[s + 1]; ++e) {
+                uint32_t u32_Previous = s;
+                uint32_t u32_Current = vec_Neighbours[e];
+                uint8_t u8_Type = vec_Types[e];
+
+                // Non-stations have exactly two neighbours, so the walk cannot branch
+                for (uint32_t u32_Steps = 0; !vec_IsStation[u32_Current] && u32_Steps < u32_NodeCount; ++u32_Steps) {
+                    const uint32_t u32_First = vec_Offsets[u32_Current];
+                    const uint32_t u32_Next = vec_Neighbours[u32_First] != u32_Previous ? u32_First : u32_First + 1;
+                    u8_Type = std::min(u8_Type, vec_Types[u32_Next]);
+                    u32_Previous = u32_Current;
+                    u32_Current = vec_Neighbours[u32_Next];
+                }
+
+                if (vec_IsStation[u32_Current] && s < u32_Current) {
+                    vec_Chains.push_back({s, u32_Current, u8_Type});
+                    // Bus and metro roads are drivable too, as on the printed board
+                    if (u8_Type == Core::k_TransportTypeBus || u8_Type == Core::k_TransportTypeMetro) {
+                        vec_Chains.push_back({s, u32_Current, static_cast<uint8_t>(Core::k_TransportTypeTaxi)});
+                    }
+                }
+            }
+        }
+        std::sort(vec_Chains.begin(), vec_Chains.end(), [](const Segment& a, const Segment& b) {
+            return a.u32_A != b.u32_A ? a.u32_A < b.u32_A
+                 : a.u32_B != b.u32_B ? a.u32_B < b.u32_B
+                 : a.u8_Type < b.u8_Type;
+        });
+        vec_Chains.erase(std::unique(vec_Chains.begin(), vec_Chains.end(),
+                                     [](const Segment& a, const Segment& b) {
+                                         return a.u32_A == b.u32_A && a.u32_B == b.u32_B && a.u8_Type == b.u8_Type;
+                                     }),
+                         vec_Chains.end());
+
+        // Keep stations that ended up connected, numbered 1..N in file order
+        constexpr uint32_t k_Unused = UINT32_MAX;
+        std::vector<uint32_t> vec_BoardIndex(u32_NodeCount, k_Unused);
+        for (const Segment& chain : vec_Chains) {
+            vec_BoardIndex[chain.u32_A] = 0;
+            vec_BoardIndex[chain.u32_B] = 0;
+        }
+
+        double d_MinLon = 180.0, d_MaxLon = -180.0, d_MinLat = 90.0, d_MaxLat = -90.0;
+        Board board;
+        for (uint32_t i = 0; i < u32_NodeCount; ++i) {
+            if (vec_BoardIndex[i] == k_Unused) continue;
+            vec_BoardIndex[i] = static_cast<uint32_t>(board.vec_Nodes.size());
+
+            Utils::BinaryMapNode node{};
+            node.i32_Id = static_cast<int32_t>(board.vec_Nodes.size() + 1);
+            board.vec_Nodes.push_back(node);
+
+            const OsmNode& osmNode = graph.m_vec_Nodes[i];
+            d_MinLon = std::min(d_MinLon, osmNode.d_Lon);
+            d_MaxLon = std::max(d_MaxLon, osmNode.d_Lon);
+            d_MinLat = std::min(d_MinLat, osmNode.d_Lat);
+            d_MaxLat = std::max(d_MaxLat, osmNode.d_Lat);
+        }
+
+        board.vec_Connections.reserve(vec_Chains.size());
+        for (const Segment& chain : vec_Chains) {
+            const uint32_t u32_A = vec_BoardIndex[chain.u32_A];
+            const uint32_t u32_B = vec_BoardIndex[chain.u32_B];
+            board.vec_Connections.push_back({u32_A, u32_B, chain.u8_Type});
+            board.vec_Nodes[u32_A].u32_StationMask |= Utils::BinaryMap::StationBit(chain.u8_Type);
+            board.vec_Nodes[u32_B].u32_StationMask |= Utils::BinaryMap::StationBit(chain.u8_Type);
+        }
+
+        // Equirectangular projection around the middle latitude, north at y = 0,
+        // scaled so the longer side spans f_Extent board units
+        const double d_LonScale = std::cos((d_MinLat + d_MaxLat) * 0.5 * 3.14159265358979323846 / 180.0);
+        const double d_Width = (d_MaxLon - d_MinLon) * d_LonScale;
+        const double d_Height = d_MaxLat - d_MinLat;
+        const double d_Scale = std::max(d_Width, d_Height) > 0.0 ? f_Extent / std::max(d_Width, d_Height) : 0.0;
+        for (uint32_t i = 0; i < u32_NodeCount; ++i) {
+            if (vec_BoardIndex[i] == k_Unused) continue;
+            const OsmNode& osmNode = graph.m_vec_Nodes[i];
+            Utils::BinaryMapNode& node = board.vec_Nodes[vec_BoardIndex[i]];
+            node.f_X = static_cast<float>((osmNode.d_Lon - d_MinLon) * d_LonScale * d_Scale);
+            node.f_Y = static_cast<float>((d_MaxLat - osmNode.d_Lat) * d_Scale);
+        }
+
+        return board;
+    }
+
+    const char* TransportName(int i_Type) {
+        switch (i_Type) {
+        case Core::k_TransportTypeTaxi: return "taxi";
+        case Core::k_TransportTypeBus: return "bus";
+        case Core::k_TransportTypeMetro: return "metro";
+        case Core::k_TransportTypeWater: return "water";
+        default: return "none";
+        }
+    }
+
+    // Same layout as assets/maps/nodes_with_station.csv and polaczenia.csv
+    bool WriteCsv(const Board& board, const std::string& s_NodesPath, const std::string& s_ConnectionsPath) {
+        std::ofstream nodesFile(s_NodesPath, std::ios::trunc);
+        std::ofstream connectionsFile(s_ConnectionsPath, std::ios::trunc);
+        if (!nodesFile.is_open() || !connectionsFile.is_open()) {
+            std::cerr << "[osm2map] ERROR: Could not open CSV output files" << std::endl;
+            return false;
+        }
+
+        nodesFile << "id,pos_x,pos_y,station_type\n";
+        for (const Utils::BinaryMapNode& node : board.vec_Nodes) {
+            nodesFile << node.i32_Id << ',' << node.f_X << ',' << node.f_Y << ',';
+            bool b_First = true;
+            for (int i_Type : {Core::k_TransportTypeMetro, Core::k_TransportTypeBus,
+                               Core::k_TransportTypeTaxi, Core::k_TransportTypeWater}) {
+                if (node.u32_StationMask & Utils::BinaryMap::StationBit(i_Type)) {
+                    nodesFile << (b_First ? "" : "_") << TransportName(i_Type);
+                    b_First = false;
+                }
+            }
+            nodesFile << (b_First ? "none\n" : "\n");
+        }
+
+        connectionsFile << "source,destination,connection_type\n";
+        for (const Utils::BinaryMapConnection& connection : board.vec_Connections) {
+            connectionsFile << board.vec_Nodes[connection.u32_Source].i32_Id << ','
+                            << board.vec_Nodes[connection.u32_Target].i32_Id << ','
+                            << TransportName(connection.u8_Type) << '\n';
+        }
+
+        return nodesFile.good() && connectionsFile.good();
+    }
+
+    long long MillisecondsSince(std::chrono::steady_clock::time_point t_Start) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_Start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string s_InputPath;
+    std::string s_OutputPath = Core::GetMapPath(Core::k_BinaryMapRelativePath);
+    std::string s_CsvNodesPath;
+    std::string s_CsvConnectionsPath;
+    float f_Extent = Core::k_MapSizeMeters;
+    int i_MinStreets = 3;
+
+    bool b_UsageError = false;
+    int i_Positional = 0;
+    for (int i = 1; i < argc && !b_UsageError; ++i) {
+        std::string_view sv_Arg = argv[i];
+        if (sv_Arg == "--extent" && i + 1 < argc) {
+            f_Extent = std::strtof(argv[++i], nullptr);
+            b_UsageError = !(f_Extent > 0.0f);
+        } else if (sv_Arg == "--min-streets" && i + 1 < argc) {
+            i_MinStreets = std::atoi(argv[++i]);
+            b_UsageError = i_MinStreets < 1;
+        } else if (sv_Arg == "--csv" && i + 2 < argc) {
+            s_CsvNodesPath = argv[++i];
+            s_CsvConnectionsPath = argv[++i];
+        } else if (!sv_Arg.empty() && sv_Arg[0] != '-' && i_Positional < 2) {
+            (i_Positional++ == 0 ? s_InputPath : s_OutputPath) = argv[i];
+        } else {
+            b_UsageError = true;
+        }
+    }
+
+    if (b_UsageError || s_InputPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <city.graphml> [<output.sybin>] [--extent <units>]"
+                  << " [--min-streets <n>] [--csv <nodes.csv> <connections.csv>]" << std::endl;
+        return 1;
+    }
+
+    auto t_Start = std::chrono::steady_clock::now();
+
+    GraphMlHandler graph;
+    Utils::XmlSaxReader reader;
+    if (!reader.ParseFile(s_InputPath, graph)) {
+        std::cerr << "[osm2map] ERROR: " << s_InputPath << ":" << reader.GetErrorLine() << ": "
+                  << reader.GetError() << std::endl;
+        return 1;
+    }
+    std::cout << "[osm2map] Read " << graph.m_vec_Nodes.size() << " nodes and " << graph.m_vec_Edges.size()
+              << " edges in " << MillisecondsSince(t_Start) << " ms";
+    if (graph.m_num_SkippedNodes > 0) {
+        std::cout << " (skipped " << graph.m_num_SkippedNodes << " nodes without id or coordinates)";
+    }
+    std::cout << std::endl;
+
+    auto t_Build = std::chrono::steady_clock::now();
+    Board board = BuildBoard(graph, i_MinStreets, f_Extent);
+    if (board.vec_Nodes.empty()) {
+        std::cerr << "[osm2map] ERROR: No connected stations in " << s_InputPath << std::endl;
+        return 1;
+    }
+    std::cout << "[osm2map] Built " << board.vec_Nodes.size() << " stations and " << board.vec_Connections.size()
+              << " connections in " << MillisecondsSince(t_Build) << " ms" << std::endl;
+
+    if (!Utils::BinaryMap::Write(s_OutputPath, board.vec_Nodes, board.vec_Connections)) {
+        return 1;
+    }
+    if (!s_CsvNodesPath.empty() && !WriteCsv(board, s_CsvNodesPath, s_CsvConnectionsPath)) {
+        return 1;
+    }
+
+    // Round-trip so a bad write is caught here rather than at game start
+    Utils::BinaryMap map;
+    if (!map.Open(s_OutputPath)) {
+        return 1;
+    }
+
+    std::cout << "[osm2map] Done in " << MillisecondsSince(t_Start) << " ms" << std::endl;
+    return 0;
+}
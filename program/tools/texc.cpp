@@ -0,0 +1,45 @@
+#include "CompressedTexture.h"
+#include "GameConstants.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../external/stb_image.h"
+
+// texc - precompresses a texture into a BC1 (or, with transparency, BC3) mip
+// chain that Application loads instead of decoding the PNG and generating
+// mipmaps at run time.
+//
+//   texc                       compress the board texture in assets/textures
+//   texc <in.png> [<out>]      compress any other image (default: in.sytex)
+int main(int argc, char* argv[]) {
+    using namespace ScotlandYard;
+
+    std::string s_InputPath = Core::GetMapPath(Core::k_BoardTextureRelativePath);
+    if (argc >= 2) {
+        s_InputPath = argv[1];
+    }
+    std::string s_OutputPath = argc >= 3 ? argv[2] : Utils::CompressedTexture::CachePathFor(s_InputPath);
+
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [<input.png> [<output.sytex>]]" << std::endl;
+        return 1;
+    }
+
+    int i_Width = 0, i_Height = 0, i_Channels = 0;
+    unsigned char* p_Pixels = stbi_load(s_InputPath.c_str(), &i_Width, &i_Height, &i_Channels, 0);
+    if (!p_Pixels) {
+        std::cerr << "[texc] ERROR: Could not decode " << s_InputPath << ": " << stbi_failure_reason() << std::endl;
+        return 1;
+    }
+
+    Threading::ThreadPool::Initialize();
+    bool b_Ok = Utils::CompressedTexture::Build(p_Pixels, i_Width, i_Height, i_Channels, s_OutputPath);
+    Threading::ThreadPool::Shutdown();
+    stbi_image_free(p_Pixels);
+
+    // Round-trip so a bad write is caught here rather than at game start
+    Utils::CompressedTexture texture;
+    return b_Ok && texture.Open(s_OutputPath) ? 0 : 1;
+}